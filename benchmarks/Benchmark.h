@@ -0,0 +1,244 @@
+// benchmarks/Benchmark.h
+//
+// Minimal self-contained micro-benchmark harness: calibration, warm-up,
+// repeated timing, median / MAD statistics and JSON output.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Bench {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Keep the compiler from discarding a value computed by a benchmark
+ */
+template <typename T> inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void *sink;
+  sink = &value;
+#endif
+}
+
+/**
+ * @brief Body of a benchmark: runs the measured operation `iterations`
+ * times. The loop lives inside the body so no indirect call is timed per
+ * iteration.
+ */
+using Body = std::function<void(std::uint64_t iterations)>;
+
+/**
+ * @brief Creates the body; everything done here (file generation, input
+ * data) is setup and is not timed. Only called if the case is selected.
+ */
+using Factory = std::function<Body()>;
+
+struct Case {
+  std::string name;
+  std::uint64_t itemsPerIteration;
+  Factory factory;
+};
+
+struct Options {
+  std::size_t warmup = 2;
+  std::size_t repetitions = 11;
+  double minRepetitionSeconds = 0.02;
+  std::string filter;
+  std::string jsonPath;
+  bool listOnly = false;
+};
+
+struct Result {
+  std::string name;
+  std::uint64_t itemsPerIteration = 1;
+  std::uint64_t iterations = 0;
+  std::size_t repetitions = 0;
+  double medianNs = 0.0; // per iteration
+  double madNs = 0.0;    // median absolute deviation, per iteration
+  double minNs = 0.0;
+  double maxNs = 0.0;
+
+  double itemsPerSecond() const {
+    return medianNs > 0.0
+               ? static_cast<double>(itemsPerIteration) * 1e9 / medianNs
+               : 0.0;
+  }
+};
+
+class Registry {
+public:
+  void add(std::string name, std::uint64_t itemsPerIteration,
+           Factory factory) {
+    m_cases.push_back(
+        {std::move(name), itemsPerIteration, std::move(factory)});
+  }
+
+  const std::vector<Case> &cases() const { return m_cases; }
+
+private:
+  std::vector<Case> m_cases;
+};
+
+inline double median(std::vector<double> values) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  const std::size_t mid = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + mid, values.end());
+  const double upper = values[mid];
+  if (values.size() % 2 != 0) {
+    return upper;
+  }
+  const double lower = *std::max_element(values.begin(), values.begin() + mid);
+  return 0.5 * (lower + upper);
+}
+
+inline double timeSeconds(const Body &body, std::uint64_t iterations) {
+  const auto start = Clock::now();
+  body(iterations);
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+inline Result measure(const Case &benchCase, const Options &options) {
+  const Body body = benchCase.factory();
+
+  // Calibrate: double the iteration count until one repetition is long
+  // enough to time reliably, then scale to the target duration.
+  std::uint64_t iterations = 1;
+  double elapsed = timeSeconds(body, iterations);
+  while (elapsed < options.minRepetitionSeconds / 10.0 &&
+         iterations < (std::uint64_t{1} << 40)) {
+    iterations *= 2;
+    elapsed = timeSeconds(body, iterations);
+  }
+  if (elapsed < options.minRepetitionSeconds) {
+    const double scale = options.minRepetitionSeconds / std::max(elapsed, 1e-9);
+    iterations = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(
+               static_cast<double>(iterations) * scale)));
+  }
+
+  for (std::size_t i = 0; i < options.warmup; ++i) {
+    body(iterations);
+  }
+
+  std::vector<double> samples;
+  samples.reserve(options.repetitions);
+  for (std::size_t i = 0; i < options.repetitions; ++i) {
+    samples.push_back(timeSeconds(body, iterations) * 1e9 /
+                      static_cast<double>(iterations));
+  }
+
+  Result result;
+  result.name = benchCase.name;
+  result.itemsPerIteration = benchCase.itemsPerIteration;
+  result.iterations = iterations;
+  result.repetitions = samples.size();
+  result.medianNs = median(samples);
+  std::vector<double> deviations;
+  deviations.reserve(samples.size());
+  for (const double s : samples) {
+    deviations.push_back(std::abs(s - result.medianNs));
+  }
+  result.madNs = median(deviations);
+  result.minNs = *std::min_element(samples.begin(), samples.end());
+  result.maxNs = *std::max_element(samples.begin(), samples.end());
+  return result;
+}
+
+inline std::string jsonEscape(const std::string &text) {
+  std::string escaped;
+  for (const char c : text) {
+    switch (c) {
+    case '"':
+      escaped += "\\\"";
+      break;
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    default:
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+inline std::string compilerName() {
+#if defined(__clang__)
+  return "clang " __clang_version__;
+#elif defined(__GNUC__)
+  return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+  return "msvc " + std::to_string(_MSC_VER);
+#else
+  return "unknown";
+#endif
+}
+
+/**
+ * @brief Write results as JSON; the "context" block identifies the build
+ * so files from different releases can be compared directly
+ */
+inline void writeJson(std::ostream &out, const std::vector<Result> &results,
+                      const std::string &version,
+                      const std::string &buildType) {
+  char timestamp[32] = {};
+  const std::time_t now = std::time(nullptr);
+  std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ",
+                std::gmtime(&now));
+
+  out << std::setprecision(10);
+  out << "{\n";
+  out << "  \"context\": {\n";
+  out << "    \"project\": \"ComputationalPhysics\",\n";
+  out << "    \"version\": \"" << jsonEscape(version) << "\",\n";
+  out << "    \"build_type\": \"" << jsonEscape(buildType) << "\",\n";
+  out << "    \"compiler\": \"" << jsonEscape(compilerName()) << "\",\n";
+  out << "    \"hardware_threads\": " << std::thread::hardware_concurrency()
+      << ",\n";
+  out << "    \"date\": \"" << timestamp << "\"\n";
+  out << "  },\n";
+  out << "  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    out << (i == 0 ? "\n" : ",\n");
+    out << "    {\"name\": \"" << jsonEscape(r.name) << "\""
+        << ", \"iterations\": " << r.iterations
+        << ", \"repetitions\": " << r.repetitions
+        << ", \"items_per_iteration\": " << r.itemsPerIteration
+        << ", \"median_ns\": " << r.medianNs << ", \"mad_ns\": " << r.madNs
+        << ", \"min_ns\": " << r.minNs << ", \"max_ns\": " << r.maxNs
+        << ", \"items_per_second\": " << r.itemsPerSecond() << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+inline void printResult(std::ostream &out, const Result &r) {
+  const double madPercent =
+      r.medianNs > 0.0 ? 100.0 * r.madNs / r.medianNs : 0.0;
+  out << std::left << std::setw(44) << r.name << std::right << std::fixed
+      << std::setprecision(1) << std::setw(14) << r.medianNs << " ns"
+      << std::setw(8) << madPercent << " %" << std::scientific
+      << std::setprecision(3) << std::setw(14) << r.itemsPerSecond()
+      << " items/s" << std::defaultfloat << '\n';
+}
+
+} // namespace Bench
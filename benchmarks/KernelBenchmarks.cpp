@@ -0,0 +1,345 @@
+// benchmarks/KernelBenchmarks.cpp
+//
+// Step loops of the chapter1 simulations: row() + step() per item, which is
+// exactly what the executables do between writes. Kernel/<name>/<scalar>/...
+// cases time the other scalar and summation instantiations of a kernel.
+// Grid/* cases time the chunked parallel writer used by the closed-form
+// simulations, including formatting, into a discarding stream; the
+// /replay variants serve the rows from one cached period. Columns/* cases
+// time Sim::evaluateColumns alone, on one thread: the kernel's SIMD batches,
+// or with /rows one at() per row as for kernels without batches.
+// HardDisks/* cases count disk-disk collisions of the event-driven gas,
+// LennardJones/* cases particle steps (neighbour-list rebuilds included).
+// Ensemble/* cases time Monte Carlo launch ensembles per sample, on all
+// cores. Bifurcation/* cases time driven-pendulum diagram columns, on all
+// cores.
+
+#include "Suites.h"
+#include <Box1D.h>
+#include <Box2D.h>
+#include <Circle.h>
+#include <DrivenPendulum.h>
+#include <HardDisks.h>
+#include <LaunchEnsemble.h>
+#include <LennardJones.h>
+#include <Lissajous.h>
+#include <MiniGolf.h>
+#include <Pendulum.h>
+#include <PeriodicReplay.h>
+#include <Projectile.h>
+#include <Scalar.h>
+#include <TimeGrid.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::uint64_t kSteps = 100000;
+
+// Restarts the kernel whenever it finishes so every iteration does exactly
+// kSteps steps regardless of the scenario.
+template <typename Kernel>
+void addKernel(Bench::Registry &registry, const typename Kernel::Params &p,
+               const std::string &variant = "") {
+  registry.add("Kernel/" + std::string(Kernel::name) + variant, kSteps, [p] {
+    return [p](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        Kernel sim(p);
+        double checksum = 0.0;
+        for (std::uint64_t step = 0; step < kSteps; ++step) {
+          if (sim.done()) {
+            sim = Kernel(p);
+          }
+          checksum += sim.row()[1];
+          sim.step();
+        }
+        Bench::doNotOptimize(checksum);
+      }
+    };
+  });
+}
+
+template <template <typename, Sim::Summation> class Kernel>
+void addVariants(Bench::Registry &registry,
+                 const typename Kernel<double, Sim::Summation::Plain>::Params
+                     &p) {
+  using Sim::Summation;
+  addKernel<Kernel<float, Summation::Plain>>(registry, p, "/float/plain");
+  addKernel<Kernel<float, Summation::Compensated>>(registry, p,
+                                                   "/float/compensated");
+  addKernel<Kernel<double, Summation::Plain>>(registry, p, "/double/plain");
+  addKernel<Kernel<double, Summation::Compensated>>(registry, p,
+                                                    "/double/compensated");
+}
+
+class NullBuffer : public std::streambuf {
+protected:
+  std::streamsize xsputn(const char *, std::streamsize count) override {
+    return count;
+  }
+  int_type overflow(int_type c) override { return c; }
+};
+
+// tf is set so the kernel produces exactly kSteps rows.
+template <typename Kernel>
+void addGrid(Bench::Registry &registry, typename Kernel::Params p,
+             const std::string &variant = "") {
+  p.tf = (static_cast<double>(kSteps) - 0.5) * p.dt;
+  registry.add("Grid/" + std::string(Kernel::name) + variant, kSteps, [p] {
+    return [p](std::uint64_t iterations) {
+      NullBuffer buffer;
+      std::ostream out(&buffer);
+      const Kernel sim(p);
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        Bench::doNotOptimize(Sim::writeGrid(sim, out));
+      }
+    };
+  });
+}
+
+// Items are rows, evaluated in chunks of the size writeGrid uses.
+template <typename Kernel, bool Batches>
+void addColumnsCase(Bench::Registry &registry, typename Kernel::Params p,
+                    const std::string &variant) {
+  static constexpr std::size_t kChunk = 65536;
+  constexpr std::size_t N = Kernel::columns.size();
+  p.tf = (static_cast<double>(kSteps) - 0.5) * p.dt;
+  registry.add("Columns/" + std::string(Kernel::name) + variant, kSteps, [p] {
+    auto buffers = std::make_shared<std::array<std::vector<double>, N>>();
+    for (auto &column : *buffers) {
+      column.resize(kChunk);
+    }
+    return [p, buffers](std::uint64_t iterations) {
+      const Kernel sim(p);
+      std::array<double *, N> out{};
+      for (std::size_t c = 0; c < N; ++c) {
+        out[c] = (*buffers)[c].data();
+      }
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        for (std::uint64_t first = 0; first < kSteps; first += kChunk) {
+          const auto count = static_cast<std::size_t>(
+              std::min<std::uint64_t>(kChunk, kSteps - first));
+          if constexpr (Batches) {
+            Sim::evaluateColumns(sim, first, count, out);
+          } else {
+            for (std::size_t j = 0; j < count; ++j) {
+              const auto row = sim.at(first + j);
+              for (std::size_t c = 0; c < N; ++c) {
+                out[c][j] = row[c];
+              }
+            }
+          }
+        }
+        Bench::doNotOptimize(out[1][0]);
+      }
+    };
+  });
+}
+
+template <typename Kernel>
+void addColumns(Bench::Registry &registry, const typename Kernel::Params &p,
+                const std::string &variant = "") {
+  addColumnsCase<Kernel, true>(registry, p, variant);
+  addColumnsCase<Kernel, false>(registry, p, variant + "/rows");
+}
+
+// Items are collisions: each iteration samples until kCollisions more
+// disk-disk collisions happened, continuing one long run.
+void addHardDisks(Bench::Registry &registry, const Sim::HardDisksParams &p,
+                  const std::string &variant) {
+  static constexpr std::uint64_t kCollisions = 100000;
+  registry.add("HardDisks/" + variant, kCollisions, [p] {
+    auto sim = std::make_shared<Sim::HardDisks>(p);
+    return [sim](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        const std::uint64_t target = sim->collisions() + kCollisions;
+        while (sim->collisions() < target) {
+          sim->step();
+        }
+        Bench::doNotOptimize(sim->row()[2]);
+      }
+    };
+  });
+}
+
+template <typename Kernel>
+void addLennardJones(Bench::Registry &registry,
+                     const Sim::LennardJonesParams &p,
+                     const std::string &variant) {
+  static constexpr std::uint64_t kMdSteps = 10;
+  const auto particles = static_cast<std::uint64_t>(p.N);
+  registry.add("LennardJones/" + variant, kMdSteps * particles, [p] {
+    auto sim = std::make_shared<Kernel>(p);
+    return [sim](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations * kMdSteps; ++i) {
+        sim->step();
+      }
+      Bench::doNotOptimize(sim->row()[4]);
+    };
+  });
+}
+
+// Items are samples of one ensemble; each iteration reruns it with the next
+// seed.
+template <typename Run>
+void addEnsemble(Bench::Registry &registry, const std::string &variant,
+                 std::uint64_t samples, Run run) {
+  registry.add("Ensemble/" + variant, samples, [samples, run] {
+    return [samples, run](std::uint64_t iterations) {
+      Sim::EnsembleOptions options;
+      options.samples = samples;
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        options.seed = i + 1;
+        Bench::doNotOptimize(run(options).samples);
+      }
+    };
+  });
+}
+
+// Items are columns of the diagram (the sweep of Baker and Gollub's
+// pendulum through its periodic and chaotic windows).
+void addBifurcation(Bench::Registry &registry, std::size_t columns) {
+  registry.add("Bifurcation/pendulum/" + std::to_string(columns), columns,
+               [columns] {
+                 return [columns](std::uint64_t iterations) {
+                   Sim::BifurcationOptions options;
+                   options.from = 0.9;
+                   options.to = 1.5;
+                   options.columns = columns;
+                   for (std::uint64_t i = 0; i < iterations; ++i) {
+                     Bench::doNotOptimize(Sim::bifurcation(
+                         Sim::DrivenPendulumParams{}, options,
+                         [](const Sim::BifurcationColumn &) {}));
+                   }
+                 };
+               });
+}
+
+} // namespace
+
+void registerKernelBenchmarks(Bench::Registry &registry) {
+  const float infinite = std::numeric_limits<float>::max();
+
+  Sim::Box1DParams box1D;
+  box1D.L = 10.0F;
+  box1D.x0 = 1.0F;
+  box1D.v0 = 3.0F;
+  box1D.tf = infinite;
+  box1D.dt = 1e-4F;
+  addKernel<Sim::Box1D>(registry, box1D);
+
+  Sim::Box2DParams box2D;
+  box2D.Lx = 10.0F;
+  box2D.Ly = 5.0F;
+  box2D.x0 = 1.0F;
+  box2D.y0 = 1.0F;
+  box2D.vx0 = 3.0F;
+  box2D.vy0 = 2.0F;
+  box2D.tf = infinite;
+  box2D.dt = 1e-4F;
+  addKernel<Sim::Box2D>(registry, box2D);
+  addVariants<Sim::BasicBox2D>(registry, box2D);
+
+  Sim::MiniGolfParams golf;
+  golf.dt = 1e-4;
+  addKernel<Sim::MiniGolf>(registry, golf);
+  addVariants<Sim::BasicMiniGolf>(registry, golf);
+
+  // Fast enough that the ground impact comes after the kSteps rows.
+  Sim::ProjectileParams projectile;
+  projectile.v0 = 200.0;
+  projectile.k = 0.1;
+  projectile.tf = 1e9;
+  projectile.dt = 1e-4;
+  addKernel<Sim::Projectile>(registry, projectile);
+  addKernel<Sim::ProjectileAirResistance>(registry, projectile);
+  addGrid<Sim::ProjectileAirResistance>(registry, projectile);
+  addColumns<Sim::ProjectileAirResistance>(registry, projectile);
+
+  Sim::PendulumParams pendulum;
+  pendulum.tf = 1e9;
+  pendulum.dt = 1e-4;
+  addKernel<Sim::Pendulum>(registry, pendulum);
+  addGrid<Sim::Pendulum>(registry, pendulum);
+  addColumns<Sim::Pendulum>(registry, pendulum);
+
+  Sim::CircleParams circle;
+  circle.tf = 1e9;
+  circle.dt = 1e-4;
+  addKernel<Sim::Circle>(registry, circle);
+  addKernel<Sim::BasicCircle<float>>(registry, circle, "/float");
+  addGrid<Sim::Circle>(registry, circle);
+  addColumns<Sim::Circle>(registry, circle);
+  addColumns<Sim::BasicCircle<float>>(registry, circle, "/float");
+  // One turn per 1000 steps, so the replay caches 1000 rows.
+  Sim::CircleParams turn = circle;
+  turn.omega = 2.0 * Phy::Const::PI;
+  turn.dt = 1e-3;
+  addGrid<Sim::PeriodicReplay<Sim::Circle>>(registry, turn, "/replay");
+
+  Sim::LissajousParams lissajous;
+  lissajous.tf = 1e9;
+  lissajous.dt = 1e-4;
+  addKernel<Sim::Lissajous>(registry, lissajous);
+  addGrid<Sim::Lissajous>(registry, lissajous);
+  addColumns<Sim::Lissajous>(registry, lissajous);
+  // T1 = 1 and T2 = 2/3: a common period of 2000 steps.
+  Sim::LissajousParams figure = lissajous;
+  figure.w1 = 2.0 * Phy::Const::PI;
+  figure.w2 = 3.0 * Phy::Const::PI;
+  figure.dt = 1e-3;
+  addGrid<Sim::PeriodicReplay<Sim::Lissajous>>(registry, figure, "/replay");
+
+  // Packing fractions 0.30 and 0.60; short sample intervals keep the
+  // overshoot past kCollisions small.
+  Sim::HardDisksParams disks;
+  disks.N = 1e5F;
+  disks.radius = 0.00098F;
+  disks.tf = infinite;
+  disks.dt = 1e-5F;
+  addHardDisks(registry, disks, "1e5-disks/dilute");
+  disks.N = 1e4F;
+  disks.radius = 0.00437F;
+  addHardDisks(registry, disks, "1e4-disks/dense");
+
+  // Liquid density 0.6 sigma^-2
+  Sim::LennardJonesParams lj;
+  lj.N = 1e5F;
+  lj.Lx = 408.0F;
+  lj.Ly = 408.0F;
+  lj.tf = infinite;
+  addLennardJones<Sim::LennardJones>(registry, lj, "1e5-particles/periodic");
+  addLennardJones<Sim::BasicLennardJones<Sim::Walls::Reflecting>>(
+      registry, lj, "1e5-particles/reflecting");
+
+  Sim::LaunchSpread launch;
+  launch.v0 = {20.0, 1.0};
+  launch.theta = {40.0, 3.0};
+  launch.k = {0.1, 0.02};
+  addEnsemble(registry, "projectile/1e6", 1000000,
+              [launch](const Sim::EnsembleOptions &options) {
+                return Sim::projectileEnsemble(launch, options);
+              });
+  addEnsemble(registry, "projectile_air/1e6", 1000000,
+              [launch](const Sim::EnsembleOptions &options) {
+                return Sim::airResistanceEnsemble(launch, options);
+              });
+  Sim::LaunchSpread putt;
+  putt.v0 = {5.0, 0.3};
+  putt.theta = {0.0, 2.0};
+  addEnsemble(registry, "minigolf/1e4", 10000,
+              [putt](const Sim::EnsembleOptions &options) {
+                return Sim::miniGolfEnsemble(Sim::MiniGolfParams{}, putt,
+                                             options);
+              });
+
+  addBifurcation(registry, 400);
+}
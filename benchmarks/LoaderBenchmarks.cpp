@@ -0,0 +1,337 @@
+// benchmarks/LoaderBenchmarks.cpp
+
+#include "Suites.h"
+#include <ColumnCodec.h>
+#include <ColumnExpr.h>
+#include <ColumnStats.h>
+#include <DataLoader.h>
+#include <Physics.h>
+#include <TrajectorySampler.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr std::array<std::string_view, 5> kColumns{"Time(s)", "x(t)", "y(t)",
+                                                   "vx(t)", "vy(t)"};
+
+// Box2D-like rows: float time grid, float-integrated positions and
+// velocities that flip at the walls.
+std::array<std::vector<double>, 5> makeColumns(std::size_t rows) {
+  std::array<std::vector<double>, 5> columns;
+  for (auto &column : columns) {
+    column.resize(rows);
+  }
+  const float dt = 1e-3F;
+  float x = 1.0F;
+  float y = 1.0F;
+  float vx = 3.0F;
+  float vy = 2.0F;
+  for (std::size_t i = 0; i < rows; ++i) {
+    columns[0][i] = static_cast<float>(i) * dt;
+    columns[1][i] = x;
+    columns[2][i] = y;
+    columns[3][i] = vx;
+    columns[4][i] = vy;
+    x += vx * dt;
+    y += vy * dt;
+    vx = (x < 0.0F || x > 10.0F) ? -vx : vx;
+    vy = (y < 0.0F || y > 5.0F) ? -vy : vy;
+  }
+  return columns;
+}
+
+void writeCompressed(std::ostream &out,
+                     const std::array<std::vector<double>, 5> &columns) {
+  Codec::Writer writer(out, kColumns);
+  for (std::size_t i = 0; i < columns[0].size(); ++i) {
+    writer.append(std::array<double, 5>{columns[0][i], columns[1][i],
+                                        columns[2][i], columns[3][i],
+                                        columns[4][i]});
+  }
+}
+
+// Writes a box2D-style file once and removes it when the benchmark is done
+class TempDataFile {
+public:
+  explicit TempDataFile(std::size_t rows, bool compressed = false)
+      : m_path(std::filesystem::temp_directory_path() /
+               ("cp_bench_" + std::to_string(rows) +
+                (compressed ? ".cpts" : ".dat"))) {
+    if (compressed) {
+      std::ofstream file(m_path, std::ios::binary);
+      writeCompressed(file, makeColumns(rows));
+      return;
+    }
+    std::ofstream file(m_path);
+    file.precision(17);
+    file << "Time(s), x(t), y(t), vx(t), vy(t)\n";
+    const double dt = 0.001;
+    for (std::size_t i = 0; i < rows; ++i) {
+      const double t = static_cast<double>(i) * dt;
+      file << t << ", " << std::cos(t) << ", " << std::sin(t) << ", "
+           << -std::sin(t) << ", " << std::cos(t) << '\n';
+    }
+  }
+
+  TempDataFile(const TempDataFile &) = delete;
+  TempDataFile &operator=(const TempDataFile &) = delete;
+
+  ~TempDataFile() {
+    std::error_code ec;
+    std::filesystem::remove(m_path, ec);
+  }
+
+  std::string path() const { return m_path.string(); }
+
+private:
+  std::filesystem::path m_path;
+};
+
+// A sampler of columns over a file holding text: whether it is rejected
+// with std::invalid_argument, and otherwise its value of the first column
+// halfway between the first two rows.
+struct SamplerCase {
+  std::string name;
+  std::string text;
+  std::vector<std::string> columns;
+  std::string timeColumn = "Time(s)";
+  bool rejected = false;
+  float midpoint = 0.0F;
+};
+
+bool checkSampler(const SamplerCase &check) {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "cp_sampler_check.dat";
+  {
+    std::ofstream file(path);
+    file << check.text;
+  }
+  bool ok = false;
+  try {
+    const DataLoader loader(path.string());
+    const TrajectorySampler sampler(loader, check.columns, check.timeColumn);
+    const std::vector<float> &time = loader.getColumn(check.timeColumn);
+    const float t = 0.5F * (time[0] + time[1]);
+    const auto values =
+        sampler.sample(std::span<const float>(&t, 1),
+                       TrajectorySampler::Interpolation::Hermite);
+    ok = !check.rejected && std::abs(values[0][0] - check.midpoint) < 1e-6F;
+  } catch (const std::invalid_argument &) {
+    ok = check.rejected;
+  }
+  std::error_code ec;
+  std::filesystem::remove(path, ec);
+  std::cout << std::left << std::setw(28) << check.name << std::right
+            << (ok ? "  ok" : "  FAIL") << '\n';
+  return ok;
+}
+
+} // namespace
+
+void registerLoaderBenchmarks(Bench::Registry &registry) {
+  const auto load = [](std::size_t rows, bool compressed) -> Bench::Factory {
+    return [rows, compressed] {
+      auto file = std::make_shared<TempDataFile>(rows, compressed);
+      return [file](std::uint64_t iterations) {
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+          DataLoader loader(file->path());
+          Bench::doNotOptimize(loader.getRowCount());
+        }
+      };
+    };
+  };
+  for (const std::size_t rows : {1000U, 10000U, 100000U}) {
+    registry.add("DataLoader/parse/" + std::to_string(rows), rows,
+                 load(rows, false));
+    registry.add("DataLoader/compressed/" + std::to_string(rows), rows,
+                 load(rows, true));
+  }
+
+  // Items are bytes of raw doubles, so items/s reads as B/s.
+  constexpr std::size_t kCodecRows = 1U << 20;
+  constexpr std::uint64_t kCodecBytes = kCodecRows * kColumns.size() * 8;
+  registry.add("Codec/encode", kCodecBytes, [] {
+    auto columns = std::make_shared<std::array<std::vector<double>, 5>>(
+        makeColumns(kCodecRows));
+    return [columns](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        std::ostringstream out;
+        writeCompressed(out, *columns);
+        Bench::doNotOptimize(out.tellp());
+      }
+    };
+  });
+  for (const unsigned threads : {1U, 0U}) {
+    const std::string name = threads == 1 ? "Codec/decode/1-thread"
+                                           : "Codec/decode/all-threads";
+    registry.add(name, kCodecBytes, [threads] {
+      std::ostringstream out;
+      writeCompressed(out, makeColumns(kCodecRows));
+      auto bytes = std::make_shared<std::string>(out.str());
+      return [bytes, threads](std::uint64_t iterations) {
+        const Codec::Reader reader(*bytes);
+        std::array<std::vector<double>, 5> columns;
+        std::vector<double *> pointers;
+        for (auto &column : columns) {
+          column.resize(reader.rowCount());
+          pointers.push_back(column.data());
+        }
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+          reader.decodeColumns(pointers, threads);
+          Bench::doNotOptimize(columns[0].back());
+        }
+      };
+    });
+  }
+
+  // Items are query times: a frame's worth of sorted times over the data.
+  static constexpr std::size_t kQueries = 4096;
+  using Interpolation = TrajectorySampler::Interpolation;
+  for (const auto interpolation :
+       {Interpolation::Linear, Interpolation::Hermite}) {
+    const std::string name = interpolation == Interpolation::Linear
+                                 ? "Sampler/linear"
+                                 : "Sampler/hermite";
+    registry.add(name, kQueries, [interpolation] {
+      const TempDataFile file(100000, true);
+      auto loader = std::make_shared<DataLoader>(file.path());
+      auto sampler = std::make_shared<TrajectorySampler>(
+          *loader, std::vector<std::string>{"x(t)", "y(t)"});
+      const float span = loader->getColumn("Time(s)").back();
+      auto times = std::make_shared<std::vector<float>>(kQueries);
+      for (std::size_t k = 0; k < kQueries; ++k) {
+        (*times)[k] = span * static_cast<float>(k) / kQueries;
+      }
+      return [loader, sampler, times,
+              interpolation](std::uint64_t iterations) {
+        std::vector<float> x(kQueries);
+        std::vector<float> y(kQueries);
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+          sampler->sample(*times, {x.data(), y.data()}, interpolation);
+          Bench::doNotOptimize(x.back());
+        }
+      };
+    });
+  }
+
+  // Items are values; box2D-like columns, as smooth as real trajectories.
+  constexpr std::size_t kStatsRows = std::size_t{1} << 22;
+  for (const unsigned threads : {1U, 0U}) {
+    const std::string name = threads == 1 ? "ColumnStats/1-thread"
+                                          : "ColumnStats/all-threads";
+    registry.add(name, kStatsRows, [threads] {
+      const auto columns = makeColumns(kStatsRows);
+      auto values = std::make_shared<std::vector<float>>(
+          columns[3].begin(), columns[3].end());
+      return [values, threads](std::uint64_t iterations) {
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+          const ColumnStats stats = ColumnStats::compute(*values, threads);
+          Bench::doNotOptimize(stats.max());
+        }
+      };
+    });
+  }
+
+  // Items are rows of kinetic energy in calories from vx and vy: one fused
+  // expression next to a materialized column per step.
+  constexpr std::size_t kExprRows = std::size_t{1} << 20;
+  static constexpr double kMass = 0.145;
+  const auto exprColumns = [] {
+    const auto columns = makeColumns(kExprRows);
+    auto floats = std::make_shared<std::array<std::vector<float>, 2>>();
+    (*floats)[0].assign(columns[3].begin(), columns[3].end());
+    (*floats)[1].assign(columns[4].begin(), columns[4].end());
+    return floats;
+  };
+  registry.add("Expr/energy/fused", kExprRows, [exprColumns] {
+    auto columns = exprColumns();
+    return [columns](std::uint64_t iterations) {
+      const auto speed = Expr::hypot(Expr::column((*columns)[0]),
+                                     Expr::column((*columns)[1]));
+      const auto calories = Expr::apply(
+          [](double v) {
+            return Phy::units::joules_to_calories(
+                Phy::calculations::kinetic_energy(kMass, v));
+          },
+          speed);
+      std::vector<float> out(kExprRows);
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        Expr::evaluate(calories, out);
+        Bench::doNotOptimize(out.back());
+      }
+    };
+  });
+  registry.add("Expr/energy/materialized", kExprRows, [exprColumns] {
+    auto columns = exprColumns();
+    return [columns](std::uint64_t iterations) {
+      const auto &vx = (*columns)[0];
+      const auto &vy = (*columns)[1];
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        std::vector<float> speed(kExprRows);
+        std::transform(vx.begin(), vx.end(), vy.begin(), speed.begin(),
+                       [](float x, float y) {
+                         return std::sqrt((x * x) + (y * y));
+                       });
+        std::vector<float> energy(kExprRows);
+        std::transform(speed.begin(), speed.end(), energy.begin(),
+                       [](float v) {
+                         return static_cast<float>(
+                             Phy::calculations::kinetic_energy(kMass, v));
+                       });
+        std::vector<float> calories(kExprRows);
+        std::transform(energy.begin(), energy.end(), calories.begin(),
+                       [](float e) {
+                         return static_cast<float>(
+                             Phy::units::joules_to_calories(e));
+                       });
+        Bench::doNotOptimize(calories.back());
+      }
+    };
+  });
+  registry.add("Expr/speed/stats", kExprRows, [exprColumns] {
+    auto columns = exprColumns();
+    return [columns](std::uint64_t iterations) {
+      const auto speed = Expr::hypot(Expr::column((*columns)[0]),
+                                     Expr::column((*columns)[1]));
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        const ColumnStats stats = Expr::stats(speed);
+        Bench::doNotOptimize(stats.max());
+      }
+    };
+  });
+}
+
+int verifySampler() {
+  std::cout << "TrajectorySampler column check\n";
+  const std::string header = "Time(s), x(t), vx(t)\n";
+  const std::string rows = "0, 0, 2\n1, 2, 2\n";
+  const std::vector<SamplerCase> checks{
+      {"complete", header + rows, {"x(t)"}, "Time(s)", false, 1.0F},
+      {"missing value column", header + rows, {"y(t)"}, "Time(s)", true},
+      {"missing time column", header + rows, {"x(t)"}, "t", true},
+      {"short value column", header + rows + "2\n", {"x(t)"}, "Time(s)",
+       true},
+      // The derivative is dropped, so the midpoint is linear: 1, not 1.5.
+      {"short derivative", header + "0, 0, 4\n1, 2, 0\n2, 4\n", {"x(t)"},
+       "Time(s)", false, 1.0F},
+  };
+  bool passed = true;
+  for (const auto &check : checks) {
+    passed = checkSampler(check) && passed;
+  }
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+// benchmarks/PhysicsBenchmarks.cpp
+
+#include "Suites.h"
+#include <Physics.h>
+#include <Vector2D.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+constexpr std::size_t kVectors = 4096;
+} // namespace
+
+void registerPhysicsBenchmarks(Bench::Registry &registry) {
+  registry.add("Quantity/add", 1, [] {
+    return [](std::uint64_t iterations) {
+      Phy::Length a(1.5, "m");
+      const Phy::Length b(0.25, "m");
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        a = a + b;
+        Bench::doNotOptimize(a);
+      }
+    };
+  });
+
+  registry.add("Quantity/scale", 1, [] {
+    return [](std::uint64_t iterations) {
+      Phy::Velocity v(3.0, "m/s");
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        v = v * 1.0000001;
+        Bench::doNotOptimize(v);
+      }
+    };
+  });
+
+  registry.add("Vector2D/integrate/4096", kVectors, [] {
+    auto positions = std::make_shared<std::vector<Vector2Dd>>(kVectors);
+    auto velocities = std::make_shared<std::vector<Vector2Dd>>(kVectors);
+    for (std::size_t i = 0; i < kVectors; ++i) {
+      (*velocities)[i] = Vector2Dd(1.0 + static_cast<double>(i), -0.5);
+    }
+    return [positions, velocities](std::uint64_t iterations) {
+      const double dt = 1e-3;
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        for (std::size_t j = 0; j < kVectors; ++j) {
+          (*positions)[j] += (*velocities)[j] * dt;
+        }
+        Bench::doNotOptimize(positions->front());
+      }
+    };
+  });
+
+  registry.add("Vector2D/normalize/4096", kVectors, [] {
+    auto vectors = std::make_shared<std::vector<Vector2Dd>>(kVectors);
+    for (std::size_t i = 0; i < kVectors; ++i) {
+      (*vectors)[i] = Vector2Dd(static_cast<double>(i) + 1.0, 2.0);
+    }
+    return [vectors](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        double sum = 0.0;
+        for (const auto &v : *vectors) {
+          sum += v.normalized().dot(v);
+        }
+        Bench::doNotOptimize(sum);
+      }
+    };
+  });
+}
@@ -0,0 +1,219 @@
+// benchmarks/PrecisionReport.cpp
+//
+// Error of every simulation kernel per scalar type and summation mode
+// (`benchmarks --precision [--steps <n>]`). Each variant is run side by side
+// with a compensated reference in the widest available scalar (long double
+// where it is wider than double, double otherwise) and the largest deviation
+// over the run is printed relative to the range of each column. For kernels
+// that bounce, a variant whose bounce count departs from the reference's
+// (a wall reached one step earlier or later) is a timing divergence, not a
+// position error: it is reported on its own, and the errors are taken over
+// the rows before it.
+
+#include "Suites.h"
+#include <Box1D.h>
+#include <Box2D.h>
+#include <Circle.h>
+#include <Lissajous.h>
+#include <MiniGolf.h>
+#include <Pendulum.h>
+#include <Projectile.h>
+#include <Scalar.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace {
+
+using Sim::Summation;
+
+using ReferenceScalar =
+    std::conditional_t<(std::numeric_limits<long double>::digits >
+                        std::numeric_limits<double>::digits),
+                       long double, double>;
+
+// Kernels that count their bounces (events(), as used by Decimator)
+template <typename Kernel>
+concept CountsEvents = requires(const Kernel &kernel) {
+  { kernel.events() } -> std::convertible_to<int>;
+};
+
+struct Error {
+  std::uint64_t rows = 0;
+  double maxRelative = 0.0;
+  double finalRelative = 0.0;
+  std::string column;
+  // First row after the bounce counts differ; the errors are over the rows
+  // before it.
+  std::optional<std::uint64_t> divergence;
+  // Bounces of the variant minus those of the reference after the last row
+  std::optional<int> bounceDifference;
+};
+
+// Steps both kernels until either is done (or steps rows were compared).
+// Errors are relative to the largest magnitude the reference column reaches.
+template <typename Kernel, typename Reference>
+Error compare(const typename Kernel::Params &params, std::uint64_t steps) {
+  constexpr std::size_t N = Kernel::columns.size();
+  Kernel kernel(params);
+  Reference reference(params);
+  std::array<double, N> maxError{};
+  std::array<double, N> lastError{};
+  std::array<double, N> scale{};
+  Error error;
+  while (!kernel.done() && !reference.done() && error.rows < steps) {
+    if constexpr (CountsEvents<Kernel>) {
+      if (!error.divergence && kernel.events() != reference.events()) {
+        error.divergence = error.rows;
+      }
+    }
+    const auto expected = reference.row();
+    for (std::size_t c = 0; c < N; ++c) {
+      scale[c] = std::max(scale[c], std::abs(expected[c]));
+    }
+    if (!error.divergence) {
+      const auto row = kernel.row();
+      for (std::size_t c = 0; c < N; ++c) {
+        lastError[c] = std::abs(row[c] - expected[c]);
+        maxError[c] = std::max(maxError[c], lastError[c]);
+      }
+    }
+    kernel.step();
+    reference.step();
+    ++error.rows;
+  }
+  if constexpr (CountsEvents<Kernel>) {
+    error.bounceDifference = kernel.events() - reference.events();
+  }
+  for (std::size_t c = 0; c < N; ++c) {
+    const double range = scale[c] > 0.0 ? scale[c] : 1.0;
+    if (maxError[c] / range >= error.maxRelative) {
+      error.maxRelative = maxError[c] / range;
+      error.finalRelative = lastError[c] / range;
+      error.column = Kernel::columns[c];
+    }
+  }
+  return error;
+}
+
+void printRow(std::string_view kernel, std::string_view scalar,
+              std::string_view summation, const Error &error) {
+  std::cout << std::left << std::setw(16) << kernel << std::setw(13)
+            << scalar << std::setw(13) << summation << std::right
+            << std::setw(10) << error.rows << std::setw(13)
+            << std::setprecision(3) << std::scientific << error.maxRelative
+            << std::setw(13) << error.finalRelative << std::defaultfloat
+            << std::setw(11)
+            << (error.divergence ? std::to_string(*error.divergence) : "-")
+            << std::setw(9)
+            << (error.bounceDifference
+                    ? std::to_string(*error.bounceDifference)
+                    : "-")
+            << "  " << error.column << '\n';
+}
+
+template <typename Variant, typename Reference>
+void report(const typename Variant::Params &params, std::uint64_t steps,
+            std::string_view summation) {
+  printRow(Variant::name, Sim::scalarName<typename Variant::Scalar>(),
+           summation, compare<Variant, Reference>(params, steps));
+}
+
+// Integrating kernels: every scalar in both summation modes.
+template <template <typename, Summation> class Kernel>
+void reportIntegrator(
+    const typename Kernel<double, Summation::Plain>::Params &params,
+    std::uint64_t steps) {
+  using Reference = Kernel<ReferenceScalar, Summation::Compensated>;
+  constexpr auto plain = Sim::summationName(Summation::Plain);
+  constexpr auto compensated = Sim::summationName(Summation::Compensated);
+  report<Kernel<float, Summation::Plain>, Reference>(params, steps, plain);
+  report<Kernel<float, Summation::Compensated>, Reference>(params, steps,
+                                                            compensated);
+  report<Kernel<double, Summation::Plain>, Reference>(params, steps, plain);
+  report<Kernel<double, Summation::Compensated>, Reference>(params, steps,
+                                                             compensated);
+}
+
+// Closed-form kernels have nothing to accumulate; only the scalar varies.
+template <template <typename> class Kernel>
+void reportClosedForm(const typename Kernel<double>::Params &params,
+                      std::uint64_t steps) {
+  using Reference = Kernel<ReferenceScalar>;
+  report<Kernel<float>, Reference>(params, steps, "-");
+  report<Kernel<double>, Reference>(params, steps, "-");
+}
+
+} // namespace
+
+int reportKernelPrecision(std::uint64_t steps) {
+  std::cout << "Simulation kernel error against a compensated "
+            << Sim::scalarName<ReferenceScalar>() << " reference, up to "
+            << steps << " rows per run\n"
+            << "(relative to the largest |value| of the column, over the rows "
+               "before the bounce\ncounts diverge; bounces: variant minus "
+               "reference at the end)\n\n";
+  std::cout << std::left << std::setw(16) << "kernel" << std::setw(13)
+            << "scalar" << std::setw(13) << "summation" << std::right
+            << std::setw(10) << "rows" << std::setw(13) << "max error"
+            << std::setw(13) << "final error" << std::setw(11) << "diverges"
+            << std::setw(9) << "bounces" << "  column\n";
+
+  // Velocities and steps with full float mantissas: with short ones such
+  // as 3 and 1e-4F every v * dt and every sum is exact in double.
+  Sim::Box1DParams box1D;
+  box1D.L = 10.0F;
+  box1D.x0 = 1.0F;
+  box1D.v0 = 2.9F;
+  box1D.tf = 100.0F;
+  box1D.dt = 1.1e-4F;
+  reportIntegrator<Sim::BasicBox1D>(box1D, steps);
+
+  Sim::Box2DParams box2D;
+  box2D.Lx = 10.0F;
+  box2D.Ly = 5.0F;
+  box2D.x0 = 1.0F;
+  box2D.y0 = 1.0F;
+  box2D.vx0 = 2.9F;
+  box2D.vy0 = 1.7F;
+  box2D.tf = 100.0F;
+  box2D.dt = 1.1e-4F;
+  reportIntegrator<Sim::BasicBox2D>(box2D, steps);
+
+  Sim::MiniGolfParams golf;
+  golf.theta = 5.0;
+  golf.dt = 1e-5;
+  reportIntegrator<Sim::BasicMiniGolf>(golf, steps);
+
+  Sim::ProjectileParams projectile;
+  projectile.k = 0.1;
+  projectile.tf = 100.0;
+  projectile.dt = 1e-4;
+  reportClosedForm<Sim::BasicProjectile>(projectile, steps);
+  reportClosedForm<Sim::BasicProjectileAirResistance>(projectile, steps);
+
+  Sim::PendulumParams pendulum;
+  pendulum.tf = 100.0;
+  pendulum.dt = 1e-4;
+  reportClosedForm<Sim::BasicPendulum>(pendulum, steps);
+
+  Sim::CircleParams circle;
+  circle.tf = 100.0;
+  circle.dt = 1e-4;
+  reportClosedForm<Sim::BasicCircle>(circle, steps);
+
+  Sim::LissajousParams lissajous;
+  lissajous.tf = 100.0;
+  lissajous.dt = 1e-4;
+  reportClosedForm<Sim::BasicLissajous>(lissajous, steps);
+  return 0;
+}
@@ -0,0 +1,145 @@
+// benchmarks/RendererBenchmarks.cpp
+//
+// Vertex generation only: nothing here needs a window or a GL context.
+
+#include "Suites.h"
+#include <GridRenderer.h>
+#include <LineRenderer.h>
+#include <MultiSeriesRenderer.h>
+#include <ParticleRenderer.h>
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+void registerRendererBenchmarks(Bench::Registry &registry) {
+  for (const std::size_t points : {1000U, 100000U}) {
+    registry.add(
+        "LineRenderer/setData/" + std::to_string(points), points, [points] {
+          auto x = std::make_shared<std::vector<float>>(points);
+          auto y = std::make_shared<std::vector<float>>(points);
+          for (std::size_t i = 0; i < points; ++i) {
+            (*x)[i] = static_cast<float>(i) * 0.01F;
+            (*y)[i] = std::sin((*x)[i]);
+          }
+          auto renderer = std::make_shared<LineRenderer>();
+          renderer->setThickness(2.0F);
+          return [x, y, renderer](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; ++i) {
+              renderer->setData(*x, *y, 5.0F, 10.0F);
+              Bench::doNotOptimize(renderer->getVertexCount());
+            }
+          };
+        });
+  }
+
+  // 20 overlaid signals: one LineRenderer each against one shared buffer.
+  static constexpr std::size_t kSeries = 20;
+  static constexpr std::size_t kSamples = 10000;
+  const auto signals = [] {
+    auto columns = std::make_shared<std::vector<std::vector<float>>>(
+        kSeries + 1, std::vector<float>(kSamples));
+    for (std::size_t i = 0; i < kSamples; ++i) {
+      (*columns)[0][i] = static_cast<float>(i) * 0.01F;
+      for (std::size_t s = 1; s <= kSeries; ++s) {
+        (*columns)[s][i] = std::sin((*columns)[0][i] * static_cast<float>(s));
+      }
+    }
+    return columns;
+  };
+  registry.add("LineRenderer/setData/20x10000", kSeries * kSamples,
+               [signals] {
+                 auto columns = signals();
+                 auto renderers = std::make_shared<std::vector<LineRenderer>>(
+                     kSeries);
+                 return [columns, renderers](std::uint64_t iterations) {
+                   for (std::uint64_t i = 0; i < iterations; ++i) {
+                     for (std::size_t s = 0; s < kSeries; ++s) {
+                       (*renderers)[s].setData((*columns)[0],
+                                               (*columns)[s + 1], 5.0F, 10.0F);
+                     }
+                     Bench::doNotOptimize(renderers->back().getVertexCount());
+                   }
+                 };
+               });
+  registry.add("MultiSeriesRenderer/setData/20x10000", kSeries * kSamples,
+               [signals] {
+                 auto columns = signals();
+                 auto renderer = std::make_shared<MultiSeriesRenderer>();
+                 std::vector<const std::vector<float> *> ys;
+                 for (std::size_t s = 0; s < kSeries; ++s) {
+                   renderer->addSeries(sf::Color(0, 205, 0, 200));
+                   ys.push_back(&(*columns)[s + 1]);
+                 }
+                 return [columns, renderer, ys](std::uint64_t iterations) {
+                   for (std::uint64_t i = 0; i < iterations; ++i) {
+                     renderer->setData((*columns)[0], ys, 5.0F, 10.0F);
+                     Bench::doNotOptimize(renderer->getVertexCount());
+                   }
+                 };
+               });
+
+  // A million particles, about half of them inside the view, coloured by
+  // speed.
+  static constexpr std::size_t kParticles = 1000000;
+  for (const auto shape :
+       {ParticleRenderer::Shape::Point, ParticleRenderer::Shape::Quad}) {
+    const std::string name = shape == ParticleRenderer::Shape::Point
+                                 ? "ParticleRenderer/update/1M-points"
+                                 : "ParticleRenderer/update/1M-quads";
+    registry.add(name, kParticles, [shape] {
+      auto columns = std::make_shared<std::array<std::vector<float>, 3>>();
+      for (auto &column : *columns) {
+        column.resize(kParticles);
+      }
+      std::uint32_t seed = 12345;
+      const auto next = [&seed] {
+        seed = (seed * 1664525U) + 1013904223U;
+        return static_cast<float>(seed >> 8) / 16777216.0F;
+      };
+      for (std::size_t i = 0; i < kParticles; ++i) {
+        (*columns)[0][i] = (next() - 0.5F) * 1200.0F;
+        (*columns)[1][i] = (next() - 0.5F) * 900.0F;
+        (*columns)[2][i] = next();
+      }
+      auto renderer = std::make_shared<ParticleRenderer>();
+      renderer->setShape(shape);
+      auto view = std::make_shared<sf::View>();
+      view->setSize({800.0F, -600.0F});
+      view->setCenter({0.0F, 0.0F});
+      return [columns, renderer, view](std::uint64_t iterations) {
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+          renderer->update((*columns)[0], (*columns)[1], (*columns)[2],
+                           *view);
+          Bench::doNotOptimize(renderer->getVisibleCount());
+        }
+      };
+    });
+  }
+
+  struct ViewCase {
+    const char *name;
+    sf::Vector2f size;
+  };
+  const ViewCase viewCases[] = {{"800x600", {800.0F, -600.0F}},
+                                {"8000x6000", {8000.0F, -6000.0F}}};
+  for (const ViewCase &viewCase : viewCases) {
+    const sf::Vector2f size = viewCase.size;
+    registry.add(std::string("GridRenderer/buildGrid/") + viewCase.name, 1,
+                 [size] {
+                   auto grid = std::make_shared<GridRenderer>();
+                   auto view = std::make_shared<sf::View>();
+                   view->setSize(size);
+                   view->setCenter({0.0F, 0.0F});
+                   return [grid, view](std::uint64_t iterations) {
+                     for (std::uint64_t i = 0; i < iterations; ++i) {
+                       grid->buildGrid(*view);
+                       Bench::doNotOptimize(*grid);
+                     }
+                   };
+                 });
+  }
+}
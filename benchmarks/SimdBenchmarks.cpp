@@ -0,0 +1,342 @@
+// benchmarks/SimdBenchmarks.cpp
+//
+// Phy::simd throughput per accuracy tier next to the libm loop it replaces
+// (Simd/<function>/<type>/<ulp1|ulp4|libm>), batch Philox variates
+// (Rng/<uniform|normal>), and the ULP verification run by
+// `benchmarks --verify-ulp`.
+
+#include "Suites.h"
+#include <PhysicsSimd.h>
+#include <Random.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using Phy::simd::Accuracy;
+
+constexpr std::size_t kValues = 4096;
+
+template <typename T> struct Inputs {
+  std::vector<T> x;
+  std::vector<T> y;
+  std::vector<T> out;
+  std::vector<T> out2;
+};
+
+template <typename T>
+std::shared_ptr<Inputs<T>> makeInputs(T xLo, T xHi, T yLo, T yHi) {
+  auto inputs = std::make_shared<Inputs<T>>();
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<T> xs(xLo, xHi);
+  std::uniform_real_distribution<T> ys(yLo, yHi);
+  for (std::size_t i = 0; i < kValues; ++i) {
+    inputs->x.push_back(xs(rng));
+    inputs->y.push_back(ys(rng));
+  }
+  inputs->out.resize(kValues);
+  inputs->out2.resize(kValues);
+  return inputs;
+}
+
+// Run(inputs) evaluates one batch of kValues arguments.
+template <typename T, typename Run>
+void addCase(Bench::Registry &registry, const std::string &name,
+             std::shared_ptr<Inputs<T>> inputs, Run run) {
+  registry.add(name, kValues, [inputs, run] {
+    return [inputs, run](std::uint64_t iterations) {
+      for (std::uint64_t i = 0; i < iterations; ++i) {
+        run(*inputs);
+        Bench::doNotOptimize(inputs->out.front());
+      }
+    };
+  });
+}
+
+template <typename T>
+void addFunctions(Bench::Registry &registry, const std::string &type) {
+  const auto expInputs = makeInputs<T>(-20, 20, 0, 1);
+  const auto logInputs = makeInputs<T>(1e-3F, 1e3F, 0, 1);
+  const auto trigInputs = makeInputs<T>(-100, 100, 0, 1);
+  const auto powInputs = makeInputs<T>(1e-2F, 1e2F, -8, 8);
+  const std::string prefix = "Simd/";
+
+  addCase<T>(registry, prefix + "exp/" + type + "/ulp1", expInputs,
+             [](Inputs<T> &in) {
+               Phy::simd::exp<Accuracy::Ulp1>(in.x, in.out);
+             });
+  addCase<T>(registry, prefix + "exp/" + type + "/ulp4", expInputs,
+             [](Inputs<T> &in) {
+               Phy::simd::exp<Accuracy::Ulp4>(in.x, in.out);
+             });
+  addCase<T>(registry, prefix + "exp/" + type + "/libm", expInputs,
+             [](Inputs<T> &in) {
+               for (std::size_t i = 0; i < kValues; ++i) {
+                 in.out[i] = std::exp(in.x[i]);
+               }
+             });
+
+  addCase<T>(registry, prefix + "log/" + type + "/ulp1", logInputs,
+             [](Inputs<T> &in) {
+               Phy::simd::log<Accuracy::Ulp1>(in.x, in.out);
+             });
+  addCase<T>(registry, prefix + "log/" + type + "/ulp4", logInputs,
+             [](Inputs<T> &in) {
+               Phy::simd::log<Accuracy::Ulp4>(in.x, in.out);
+             });
+  addCase<T>(registry, prefix + "log/" + type + "/libm", logInputs,
+             [](Inputs<T> &in) {
+               for (std::size_t i = 0; i < kValues; ++i) {
+                 in.out[i] = std::log(in.x[i]);
+               }
+             });
+
+  addCase<T>(registry, prefix + "sincos/" + type + "/ulp1", trigInputs,
+             [](Inputs<T> &in) {
+               Phy::simd::sincos<Accuracy::Ulp1>(in.x, in.out, in.out2);
+             });
+  addCase<T>(registry, prefix + "sincos/" + type + "/ulp4", trigInputs,
+             [](Inputs<T> &in) {
+               Phy::simd::sincos<Accuracy::Ulp4>(in.x, in.out, in.out2);
+             });
+  addCase<T>(registry, prefix + "sincos/" + type + "/libm", trigInputs,
+             [](Inputs<T> &in) {
+               for (std::size_t i = 0; i < kValues; ++i) {
+                 in.out[i] = std::sin(in.x[i]);
+                 in.out2[i] = std::cos(in.x[i]);
+               }
+             });
+
+  addCase<T>(registry, prefix + "pow/" + type + "/ulp1", powInputs,
+             [](Inputs<T> &in) {
+               Phy::simd::pow<Accuracy::Ulp1>(in.x, in.y, in.out);
+             });
+  addCase<T>(registry, prefix + "pow/" + type + "/ulp4", powInputs,
+             [](Inputs<T> &in) {
+               Phy::simd::pow<Accuracy::Ulp4>(in.x, in.y, in.out);
+             });
+  addCase<T>(registry, prefix + "pow/" + type + "/libm", powInputs,
+             [](Inputs<T> &in) {
+               for (std::size_t i = 0; i < kValues; ++i) {
+                 in.out[i] = std::pow(in.x[i], in.y[i]);
+               }
+             });
+}
+
+//-----------------------------------------------------------------------------
+// ULP verification
+//-----------------------------------------------------------------------------
+
+// double results are checked against long double libm where it is wider,
+// float results against double libm.
+template <typename T> using Wide = std::conditional_t<std::is_same_v<T, float>,
+                                                      double, long double>;
+
+template <typename T> constexpr bool hasWideReference() {
+  return std::numeric_limits<Wide<T>>::digits > std::numeric_limits<T>::digits;
+}
+
+template <typename T> long double ulpError(T value, Wide<T> reference) {
+  if (std::isnan(reference) || std::isnan(value)) {
+    return std::isnan(reference) && std::isnan(value)
+               ? 0.0L
+               : std::numeric_limits<long double>::infinity();
+  }
+  // Compare overflow in T: a float pow reference of 1e39 is float infinity.
+  const T rounded = static_cast<T>(reference);
+  if (std::isinf(rounded) || std::isinf(value)) {
+    return value == rounded ? 0.0L
+                            : std::numeric_limits<long double>::infinity();
+  }
+  int exponent = 0;
+  std::frexp(static_cast<long double>(reference), &exponent);
+  const long double ulp = std::max(
+      std::ldexp(1.0L, exponent - std::numeric_limits<T>::digits),
+      static_cast<long double>(std::numeric_limits<T>::denorm_min()));
+  return std::abs(static_cast<long double>(value) -
+                  static_cast<long double>(reference)) /
+         ulp;
+}
+
+struct Worst {
+  long double ulp = 0.0L;
+  long double x = 0.0L;
+  long double y = 0.0L;
+
+  void update(long double error, long double xv, long double yv = 0.0L) {
+    if (error > ulp) {
+      ulp = error;
+      x = xv;
+      y = yv;
+    }
+  }
+};
+
+class Verifier {
+public:
+  explicit Verifier(std::uint64_t samples) : m_samples(samples) {}
+
+  template <typename T, Accuracy A> void run(const std::string &type) {
+    const double bound = (A == Accuracy::Ulp1 ? 1.0 : 4.0) +
+                         (hasWideReference<T>() ? 0.0 : 1.0);
+    const std::string tier = A == Accuracy::Ulp1 ? "ulp1" : "ulp4";
+
+    report("exp/" + type + "/" + tier, bound, checkExp<T, A>());
+    report("log/" + type + "/" + tier, bound, checkLog<T, A>());
+    report("sin/cos/" + type + "/" + tier, bound, checkSinCos<T, A>());
+    report("pow/" + type + "/" + tier, bound, checkPow<T, A>());
+  }
+
+  bool passed() const { return m_passed; }
+
+private:
+  std::uint64_t m_samples;
+  std::mt19937_64 m_rng{12345};
+  bool m_passed = true;
+
+  void report(const std::string &name, double bound, const Worst &worst) {
+    const bool ok = worst.ulp <= bound;
+    m_passed = m_passed && ok;
+    std::cout << std::left << std::setw(22) << name << std::right
+              << " max " << std::setw(8) << std::fixed << std::setprecision(3)
+              << static_cast<double>(worst.ulp) << " ulp (bound "
+              << std::setprecision(0) << bound << ")  at x = "
+              << std::setprecision(17) << std::defaultfloat
+              << static_cast<double>(worst.x);
+    if (worst.y != 0.0L) {
+      std::cout << ", y = " << static_cast<double>(worst.y);
+    }
+    std::cout << (ok ? "  ok" : "  FAIL") << '\n';
+    std::cout << std::defaultfloat;
+  }
+
+  // Half the samples near the origin, half spread over the whole exponent
+  // range of [lo, hi] so every binade is exercised.
+  template <typename T> std::vector<T> sample(T lo, T hi, T nearLo, T nearHi) {
+    std::vector<T> values(m_samples);
+    std::uniform_real_distribution<double> near(nearLo, nearHi);
+    std::uniform_real_distribution<double> wide(lo, hi);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<T>(i % 2 == 0 ? near(m_rng) : wide(m_rng));
+    }
+    return values;
+  }
+
+  template <typename T> std::vector<T> sampleLog(int minExp, int maxExp) {
+    std::vector<T> values(m_samples);
+    std::uniform_real_distribution<double> mantissa(1.0, 2.0);
+    std::uniform_int_distribution<int> exponent(minExp, maxExp);
+    std::uniform_real_distribution<double> near(0.5, 2.0);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<T>(
+          i % 2 == 0 ? near(m_rng)
+                     : std::ldexp(mantissa(m_rng), exponent(m_rng)));
+    }
+    return values;
+  }
+
+  template <typename T, Accuracy A> Worst checkExp() {
+    const T limit = std::is_same_v<T, float> ? T(87) : T(708);
+    const auto x = sample<T>(-limit, limit, -1, 1);
+    std::vector<T> out(x.size());
+    Phy::simd::exp<A>(x, out);
+    Worst worst;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      worst.update(ulpError(out[i], std::exp(static_cast<Wide<T>>(x[i]))),
+                   x[i]);
+    }
+    return worst;
+  }
+
+  template <typename T, Accuracy A> Worst checkLog() {
+    const int range = std::is_same_v<T, float> ? 125 : 1020;
+    const auto x = sampleLog<T>(-range, range);
+    std::vector<T> out(x.size());
+    Phy::simd::log<A>(x, out);
+    Worst worst;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      worst.update(ulpError(out[i], std::log(static_cast<Wide<T>>(x[i]))),
+                   x[i]);
+    }
+    return worst;
+  }
+
+  template <typename T, Accuracy A> Worst checkSinCos() {
+    const T limit = std::is_same_v<T, float> ? T(1e4) : T(1e6);
+    const auto x = sample<T>(-limit, limit, -4, 4);
+    std::vector<T> s(x.size());
+    std::vector<T> c(x.size());
+    Phy::simd::sincos<A>(x, s, c);
+    Worst worst;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      const auto wide = static_cast<Wide<T>>(x[i]);
+      worst.update(ulpError(s[i], std::sin(wide)), x[i]);
+      worst.update(ulpError(c[i], std::cos(wide)), x[i]);
+    }
+    return worst;
+  }
+
+  template <typename T, Accuracy A> Worst checkPow() {
+    const bool single = std::is_same_v<T, float>;
+    const auto x = sampleLog<T>(single ? -8 : -20, single ? 8 : 20);
+    const T yLimit = single ? T(15) : T(40);
+    const auto y = sample<T>(-yLimit, yLimit, -3, 3);
+    std::vector<T> out(x.size());
+    Phy::simd::pow<A>(x, y, out);
+    Worst worst;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      const auto reference = std::pow(static_cast<Wide<T>>(x[i]),
+                                      static_cast<Wide<T>>(y[i]));
+      worst.update(ulpError(out[i], reference), x[i], y[i]);
+    }
+    return worst;
+  }
+};
+
+} // namespace
+
+void registerSimdBenchmarks(Bench::Registry &registry) {
+  addFunctions<double>(registry, "double");
+  addFunctions<float>(registry, "float");
+
+  // Batches of Philox variates; successive iterations draw new counters.
+  const auto variates = makeInputs<double>(0, 1, 0, 1);
+  addCase<double>(registry, "Rng/uniform", variates, [](Inputs<double> &in) {
+    static const Rng::Philox rng(42);
+    static std::uint64_t first = 0;
+    rng.uniform(0, first, in.out);
+    first += kValues;
+  });
+  addCase<double>(registry, "Rng/normal", variates, [](Inputs<double> &in) {
+    static const Rng::Philox rng(42);
+    static std::uint64_t first = 0;
+    rng.normal(0, first, in.out);
+    first += kValues;
+  });
+}
+
+int verifySimdUlp(std::uint64_t samples) {
+  std::cout << "Phy::simd ULP check, " << samples << " samples per function";
+  if (!hasWideReference<double>()) {
+    std::cout << " (no extended long double: double results are compared "
+                 "with libm and the bound is relaxed by 1 ULP)";
+  }
+  std::cout << '\n';
+
+  Verifier verifier(samples);
+  verifier.run<double, Accuracy::Ulp1>("double");
+  verifier.run<double, Accuracy::Ulp4>("double");
+  verifier.run<float, Accuracy::Ulp1>("float");
+  verifier.run<float, Accuracy::Ulp4>("float");
+  return verifier.passed() ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+// benchmarks/Suites.h
+
+#pragma once
+
+#include "Benchmark.h"
+
+void registerLoaderBenchmarks(Bench::Registry &registry);
+void registerRendererBenchmarks(Bench::Registry &registry);
+void registerPhysicsBenchmarks(Bench::Registry &registry);
+void registerKernelBenchmarks(Bench::Registry &registry);
+void registerSimdBenchmarks(Bench::Registry &registry);
+
+// Checks the Phy::simd accuracy tiers; returns the process exit code.
+int verifySimdUlp(std::uint64_t samples);
+
+// Checks that TrajectorySampler rejects missing and short columns; returns
+// the process exit code.
+int verifySampler();
+
+// Prints the error of every simulation kernel per scalar and summation
+// mode; returns the process exit code.
+int reportKernelPrecision(std::uint64_t steps);
@@ -0,0 +1,104 @@
+// benchmarks/main.cpp
+//
+// Usage: benchmarks [--filter <substring>] [--json <file>] [--reps <n>]
+//                   [--warmup <n>] [--min-time <seconds>] [--list]
+//        benchmarks --verify-ulp [--samples <n>]
+//        benchmarks --verify-sampler
+//        benchmarks --precision [--steps <n>]
+
+#include "Benchmark.h"
+#include "Suites.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef CP_VERSION
+#define CP_VERSION "unknown"
+#endif
+#ifndef CP_BUILD_TYPE
+#define CP_BUILD_TYPE "unknown"
+#endif
+
+int main(int argc, char *argv[]) {
+  Bench::Options options;
+  bool verifyUlp = false;
+  bool verifySamplerColumns = false;
+  std::uint64_t ulpSamples = 1U << 20;
+  bool precision = false;
+  std::uint64_t precisionSteps = 1000000;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--filter" && hasValue) {
+      options.filter = argv[++i];
+    } else if (arg == "--json" && hasValue) {
+      options.jsonPath = argv[++i];
+    } else if (arg == "--reps" && hasValue) {
+      options.repetitions = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--warmup" && hasValue) {
+      options.warmup = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "--min-time" && hasValue) {
+      options.minRepetitionSeconds = std::atof(argv[++i]);
+    } else if (arg == "--list") {
+      options.listOnly = true;
+    } else if (arg == "--verify-ulp") {
+      verifyUlp = true;
+    } else if (arg == "--verify-sampler") {
+      verifySamplerColumns = true;
+    } else if (arg == "--samples" && hasValue) {
+      ulpSamples = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--precision") {
+      precision = true;
+    } else if (arg == "--steps" && hasValue) {
+      precisionSteps = std::strtoull(argv[++i], nullptr, 10);
+    } else {
+      std::cerr << "Unknown argument '" << arg << "'\n";
+      return 1;
+    }
+  }
+
+  if (verifyUlp) {
+    return verifySimdUlp(ulpSamples);
+  }
+  if (verifySamplerColumns) {
+    return verifySampler();
+  }
+  if (precision) {
+    return reportKernelPrecision(precisionSteps);
+  }
+
+  Bench::Registry registry;
+  registerLoaderBenchmarks(registry);
+  registerRendererBenchmarks(registry);
+  registerPhysicsBenchmarks(registry);
+  registerKernelBenchmarks(registry);
+  registerSimdBenchmarks(registry);
+
+  std::vector<Bench::Result> results;
+  for (const auto &benchCase : registry.cases()) {
+    if (!options.filter.empty() &&
+        benchCase.name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+    if (options.listOnly) {
+      std::cout << benchCase.name << '\n';
+      continue;
+    }
+    results.push_back(Bench::measure(benchCase, options));
+    Bench::printResult(std::cout, results.back());
+  }
+
+  if (!options.jsonPath.empty()) {
+    std::ofstream json(options.jsonPath);
+    if (!json) {
+      std::cerr << "Error: Could not open '" << options.jsonPath << "'\n";
+      return 1;
+    }
+    Bench::writeJson(json, results, CP_VERSION, CP_BUILD_TYPE);
+  }
+  return 0;
+}
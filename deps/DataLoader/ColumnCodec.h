@@ -0,0 +1,654 @@
+// deps/DataLoader/ColumnCodec.h
+
+#pragma once
+
+#include <Trace.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @file ColumnCodec.h
+ * @brief Lossless compression of trajectory columns (the CPTS format)
+ *
+ * Rows are cut into blocks of up to blockRows rows and every block stores
+ * each column as its own bit stream, so any block, and any column within
+ * it, decodes without touching the rest of the file.
+ *
+ *   DeltaOfDelta  the difference between consecutive deltas of the IEEE
+ *                 bit patterns (minus their common trailing zeros), zigzag
+ *                 coded in buckets of 0, 7, 9, 12 or 64 bits. A time column
+ *                 with constant dt costs one to a dozen bits per row.
+ *   Xor           Gorilla: the XOR with the previous value, keeping only the
+ *                 bits between its leading and trailing zeros and reusing
+ *                 the previous window when the new bits fit in it.
+ *
+ * Writer uses DeltaOfDelta for column 0 (time) and Xor for the others.
+ *
+ * Layout (native byte order, like Checkpoint.h):
+ *   "CPTS" | u32 version | u32 columns | columns x (u32 length | name) |
+ *   blocks...
+ * block:
+ *   u32 stream bytes | u32 rows | columns x (u8 encoding | u32 bytes) |
+ *   streams
+ * Streams are whole 64-bit words plus 24 zero bytes of padding, so the
+ * decoder can always load 8 bytes from where it is. Blocks are
+ * self-delimiting: a file that is still being written simply ends at its
+ * last complete block.
+ */
+
+namespace Codec {
+
+constexpr std::string_view kMagic = "CPTS";
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kDefaultBlockRows = 4096;
+
+enum class Encoding : std::uint8_t { Xor = 0, DeltaOfDelta = 1 };
+
+/**
+ * @brief True if bytes starts like a CPTS file (DataLoader uses this to
+ * tell it apart from text)
+ */
+inline bool isCompressed(std::string_view bytes) {
+  return bytes.substr(0, kMagic.size()) == kMagic;
+}
+
+namespace detail {
+
+template <typename T> void appendPod(std::string &out, const T &value) {
+  out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T loadPod(const char *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+inline std::uint64_t bitsOf(double value) {
+  return std::bit_cast<std::uint64_t>(value);
+}
+
+inline std::uint64_t zigzag(std::uint64_t value) {
+  return (value << 1) ^
+         static_cast<std::uint64_t>(static_cast<std::int64_t>(value) >> 63);
+}
+
+inline std::uint64_t unzigzag(std::uint64_t value) {
+  return (value >> 1) ^ (~(value & 1) + 1);
+}
+
+// Low 1..64 bits set
+inline std::uint64_t lowMask(unsigned bits) { return ~0ULL >> (64 - bits); }
+
+// Zero bytes after every stream: a value reads at most 78 bits, so a
+// reader that stopped within the data can always load 8 bytes further.
+constexpr std::size_t kPadBytes = 24;
+
+class BitReader {
+public:
+  explicit BitReader(std::string_view stream)
+      : m_data(stream.data()), m_limit((stream.size() - kPadBytes) * 8) {}
+
+  // At least the next 57 bits, from a single unaligned load.
+  std::uint64_t peek() const {
+    return loadPod<std::uint64_t>(m_data + (m_pos >> 3)) >> (m_pos & 7);
+  }
+
+  void skip(unsigned bits) { m_pos += bits; }
+
+  std::uint64_t read(unsigned bits) {
+    if (bits > 56) {
+      const std::uint64_t low = read(32);
+      return low | (read(bits - 32) << 32);
+    }
+    const std::uint64_t value = peek() & lowMask(bits);
+    m_pos += bits;
+    return value;
+  }
+
+  // True once the position left the data, which only a corrupt stream
+  // does; checked before every value so the padding is never overrun.
+  bool overrun() const { return m_pos > m_limit; }
+
+private:
+  const char *m_data;
+  std::size_t m_limit;
+  std::size_t m_pos = 0;
+};
+
+/**
+ * @brief Appends bit fields, least significant bit first, to a string in
+ * whole 64-bit words
+ */
+class BitWriter {
+public:
+  // Room for maxBits is reserved up front so put() never reallocates.
+  BitWriter(std::string &out, std::size_t maxBits)
+      : m_out(out), m_start(out.size()) {
+    m_out.resize(m_start + ((maxBits + 63) / 64 * 8) + kPadBytes);
+    m_next = m_out.data() + m_start;
+  }
+
+  // Appends the low `bits` bits of value (1 <= bits <= 64).
+  void put(std::uint64_t value, unsigned bits) {
+    value &= lowMask(bits);
+    m_word |= value << m_fill;
+    const unsigned total = m_fill + bits;
+    if (total >= 64) {
+      std::memcpy(m_next, &m_word, sizeof(m_word));
+      m_next += sizeof(m_word);
+      m_word = m_fill == 0 ? 0 : value >> (64 - m_fill);
+      m_fill = total - 64;
+    } else {
+      m_fill = total;
+    }
+  }
+
+  // Flushes the partial word and appends the padding.
+  void finish() {
+    if (m_fill > 0) {
+      std::memcpy(m_next, &m_word, sizeof(m_word));
+      m_next += sizeof(m_word);
+    }
+    std::memset(m_next, 0, kPadBytes);
+    m_out.resize(static_cast<std::size_t>(m_next - m_out.data()) + kPadBytes);
+  }
+
+private:
+  std::string &m_out;
+  std::size_t m_start;
+  char *m_next = nullptr;
+  std::uint64_t m_word = 0;
+  unsigned m_fill = 0;
+};
+
+} // namespace detail
+
+inline void encodeXor(std::span<const double> values, std::string &out) {
+  // At most 2 + 12 + 64 bits per value.
+  detail::BitWriter writer(out, values.size() * 78);
+  if (values.empty()) {
+    writer.finish();
+    return;
+  }
+  std::uint64_t previous = detail::bitsOf(values[0]);
+  writer.put(previous, 64);
+  unsigned lead = 0;
+  unsigned trail = 0;
+  for (std::size_t i = 1; i < values.size(); ++i) {
+    const std::uint64_t current = detail::bitsOf(values[i]);
+    const std::uint64_t x = current ^ previous;
+    previous = current;
+    if (x == 0) {
+      writer.put(0, 1);
+      continue;
+    }
+    const auto l = static_cast<unsigned>(std::countl_zero(x));
+    const auto t = static_cast<unsigned>(std::countr_zero(x));
+    const unsigned windowBits = 64 - lead - trail;
+    const unsigned bits = 64 - l - t;
+    // Reuse the window unless a new one (12 bits of header) is cheaper.
+    if (l >= lead && t >= trail && windowBits <= bits + 12) {
+      if (windowBits <= 62) {
+        writer.put(0b01 | ((x >> trail) << 2), windowBits + 2);
+      } else {
+        writer.put(0b01, 2);
+        writer.put(x >> trail, windowBits);
+      }
+    } else {
+      const std::uint64_t header = 0b11 | (l << 2) | ((bits - 1) << 8);
+      if (bits <= 50) {
+        writer.put(header | ((x >> t) << 14), bits + 14);
+      } else {
+        writer.put(header, 14);
+        writer.put(x >> t, bits);
+      }
+      lead = l;
+      trail = t;
+    }
+  }
+  writer.finish();
+}
+
+inline void encodeDeltaOfDelta(std::span<const double> values,
+                               std::string &out) {
+  // 6 bits of shift, then at most 4 + 64 bits per value.
+  detail::BitWriter writer(out, 6 + (values.size() * 68));
+  // Values widened from float have 29 zero bits at the bottom; shifting
+  // out the trailing zeros every value shares keeps their deltas small.
+  std::uint64_t all = 0;
+  for (const double value : values) {
+    all |= detail::bitsOf(value);
+  }
+  const unsigned shift =
+      all == 0 ? 0 : static_cast<unsigned>(std::countr_zero(all));
+  writer.put(shift, 6);
+  std::uint64_t previous = 0;
+  std::uint64_t delta = 0;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    const std::uint64_t current = detail::bitsOf(values[i]) >> shift;
+    if (i < 2) {
+      // The first value and the first delta are stored as is.
+      delta = current - previous;
+      writer.put(delta, 64);
+      previous = current;
+      continue;
+    }
+    const std::uint64_t next = current - previous;
+    const std::uint64_t z = detail::zigzag(next - delta);
+    delta = next;
+    previous = current;
+    if (z == 0) {
+      writer.put(0, 1);
+    } else if (z < (1U << 7)) {
+      writer.put(0b01 | (z << 2), 9);
+    } else if (z < (1U << 9)) {
+      writer.put(0b011 | (z << 3), 12);
+    } else if (z < (1U << 12)) {
+      writer.put(0b0111 | (z << 4), 16);
+    } else {
+      writer.put(0b1111, 4);
+      writer.put(z, 64);
+    }
+  }
+  writer.finish();
+}
+
+/**
+ * @brief Decodes count values of a stream made by encodeXor() or
+ * encodeDeltaOfDelta(); throws std::runtime_error if the stream is corrupt
+ */
+inline void decode(Encoding encoding, std::string_view stream,
+                   std::size_t count, double *out) {
+  if (stream.size() < detail::kPadBytes || stream.size() % 8 != 0) {
+    throw std::runtime_error("corrupt CPTS stream");
+  }
+  const auto corrupt = [] { throw std::runtime_error("corrupt CPTS stream"); };
+  detail::BitReader reader(stream);
+  if (encoding == Encoding::Xor) {
+    std::uint64_t value = 0;
+    unsigned lead = 0;
+    unsigned trail = 0;
+    unsigned bits = 64;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (reader.overrun()) {
+        corrupt();
+      }
+      if (i == 0) {
+        value = reader.read(64);
+      } else {
+        const std::uint64_t head = reader.peek();
+        if ((head & 1) == 0) {
+          reader.skip(1);
+        } else {
+          if ((head & 2) == 0) {
+            reader.skip(2);
+          } else {
+            lead = (head >> 2) & 63;
+            bits = static_cast<unsigned>((head >> 8) & 63) + 1;
+            if (lead + bits > 64) {
+              corrupt();
+            }
+            trail = 64 - lead - bits;
+            reader.skip(14);
+          }
+          value ^= reader.read(bits) << trail;
+        }
+      }
+      out[i] = std::bit_cast<double>(value);
+    }
+  } else {
+    // Payload width per bucket (0, 7, 9 or 12 bits), one byte each, indexed
+    // by the number of 1 bits in the prefix; a shift is cheaper than a
+    // table load on the bit position's dependency chain.
+    constexpr std::uint32_t kWidths = 0x0C090700;
+    const auto shift = static_cast<unsigned>(reader.read(6));
+    std::uint64_t value = 0;
+    std::uint64_t delta = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (reader.overrun()) {
+        corrupt();
+      }
+      if (i < 2) {
+        delta = reader.read(64);
+      } else {
+        const std::uint64_t head = reader.peek();
+        const auto ones = static_cast<unsigned>(std::countr_one(head));
+        std::uint64_t z = 0;
+        if (ones < 4) {
+          const unsigned width = (kWidths >> (ones * 8)) & 0xFF;
+          z = (head >> (ones + 1)) & ((1ULL << width) - 1);
+          reader.skip(ones + 1 + width);
+        } else {
+          reader.skip(4);
+          z = reader.read(64);
+        }
+        delta += detail::unzigzag(z);
+      }
+      value += delta;
+      out[i] = std::bit_cast<double>(value << shift);
+    }
+  }
+  if (reader.overrun()) {
+    corrupt();
+  }
+}
+
+struct Stream {
+  Encoding encoding;
+  std::size_t offset; // into the bytes given to indexBlocks()
+  std::size_t size;
+};
+
+struct Block {
+  std::uint64_t firstRow;
+  std::uint32_t rows;
+  std::vector<Stream> columns;
+};
+
+struct BlockIndex {
+  std::vector<Block> blocks;
+  std::uint64_t rows = 0;
+  std::size_t bytes = 0; // up to the end of the last complete block
+};
+
+/**
+ * @brief Parses the file header
+ * @return Header size, or 0 if bytes does not hold all of it yet. Throws
+ * std::runtime_error if bytes is not a CPTS file.
+ */
+inline std::size_t readHeader(std::string_view bytes,
+                              std::vector<std::string> &columns) {
+  constexpr std::size_t kFixed = kMagic.size() + 8;
+  if (bytes.size() < kFixed) {
+    return 0;
+  }
+  if (!isCompressed(bytes)) {
+    throw std::runtime_error("not a CPTS file");
+  }
+  if (detail::loadPod<std::uint32_t>(bytes.data() + 4) != kVersion) {
+    throw std::runtime_error("unsupported CPTS version");
+  }
+  const auto count = detail::loadPod<std::uint32_t>(bytes.data() + 8);
+  std::vector<std::string> names;
+  std::size_t pos = kFixed;
+  for (std::uint32_t c = 0; c < count; ++c) {
+    if (bytes.size() < pos + 4) {
+      return 0;
+    }
+    const auto length = detail::loadPod<std::uint32_t>(bytes.data() + pos);
+    pos += 4;
+    if (bytes.size() < pos + length) {
+      return 0;
+    }
+    names.emplace_back(bytes.substr(pos, length));
+    pos += length;
+  }
+  columns = std::move(names);
+  return pos;
+}
+
+/**
+ * @brief Finds the complete blocks in bytes, which must start at a block
+ * boundary; firstRow is the row number of the first one
+ */
+inline BlockIndex indexBlocks(std::string_view bytes, std::size_t columns,
+                              std::uint64_t firstRow = 0) {
+  BlockIndex index;
+  index.rows = firstRow;
+  const std::size_t headerSize = 8 + (columns * 5);
+  std::size_t pos = 0;
+  while (bytes.size() - pos >= headerSize) {
+    const char *header = bytes.data() + pos;
+    const auto streamBytes = detail::loadPod<std::uint32_t>(header);
+    if (bytes.size() - pos - headerSize < streamBytes) {
+      break;
+    }
+    Block block{index.rows, detail::loadPod<std::uint32_t>(header + 4), {}};
+    block.columns.reserve(columns);
+    std::size_t offset = pos + headerSize;
+    for (std::size_t c = 0; c < columns; ++c) {
+      const char *entry = header + 8 + (c * 5);
+      const auto encoding = static_cast<Encoding>(entry[0]);
+      const auto size = detail::loadPod<std::uint32_t>(entry + 1);
+      // Every value after the first two takes at least one bit.
+      if (static_cast<std::uint8_t>(entry[0]) >
+              static_cast<std::uint8_t>(Encoding::DeltaOfDelta) ||
+          block.rows > (std::uint64_t{size} * 8) + 2) {
+        throw std::runtime_error("corrupt CPTS block");
+      }
+      block.columns.push_back({encoding, offset, size});
+      offset += size;
+    }
+    if (offset != pos + headerSize + streamBytes) {
+      throw std::runtime_error("corrupt CPTS block");
+    }
+    index.rows += block.rows;
+    index.blocks.push_back(std::move(block));
+    pos = offset;
+  }
+  index.rows -= firstRow;
+  index.bytes = pos;
+  return index;
+}
+
+/**
+ * @brief Decodes every indexed block into one array per column, converting
+ * to T; out[c] must hold index.rows values
+ *
+ * Blocks are independent, so they are spread over up to `threads` threads
+ * (0: std::thread::hardware_concurrency()). Throws std::runtime_error if a
+ * block is corrupt.
+ */
+template <typename T>
+void decodeColumns(std::string_view bytes, const BlockIndex &index,
+                   const std::vector<T *> &out, unsigned threads = 0) {
+  CP_TRACE_SCOPE("Codec::decodeColumns");
+  if (index.blocks.empty()) {
+    return;
+  }
+  const std::uint64_t base = index.blocks.front().firstRow;
+  std::atomic<std::size_t> next{0};
+  std::mutex mutex;
+  std::exception_ptr failure; // guarded by mutex
+  auto worker = [&] {
+    std::vector<double> values;
+    std::size_t b = 0;
+    try {
+      while ((b = next.fetch_add(1, std::memory_order_relaxed)) <
+             index.blocks.size()) {
+        const Block &block = index.blocks[b];
+        values.resize(block.rows);
+        for (std::size_t c = 0; c < out.size(); ++c) {
+          const Stream &stream = block.columns[c];
+          T *target = out[c] + (block.firstRow - base);
+          const auto bits = bytes.substr(stream.offset, stream.size);
+          if constexpr (std::is_same_v<T, double>) {
+            decode(stream.encoding, bits, block.rows, target);
+          } else {
+            decode(stream.encoding, bits, block.rows, values.data());
+            std::copy(values.begin(), values.end(), target);
+          }
+        }
+      }
+    } catch (...) {
+      const std::lock_guard lock(mutex);
+      failure = std::current_exception();
+      next.store(index.blocks.size(), std::memory_order_relaxed);
+    }
+  };
+
+  // Tens of blocks are not worth a thread each.
+  constexpr std::size_t kBlocksPerThread = 16;
+  unsigned count = threads != 0
+                       ? threads
+                       : std::max(1U, std::thread::hardware_concurrency());
+  count = static_cast<unsigned>(std::min<std::size_t>(
+      count, (index.blocks.size() + kBlocksPerThread - 1) / kBlocksPerThread));
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < count; ++t) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+}
+
+/**
+ * @brief Streams rows into a CPTS file
+ *
+ * Rows are buffered per column and encoded one block at a time; flush()
+ * (also run by the destructor) writes the rows buffered so far as a short
+ * block.
+ */
+class Writer {
+public:
+  template <typename Columns>
+  Writer(std::ostream &out, const Columns &columns,
+         std::size_t blockRows = kDefaultBlockRows)
+      : m_out(out), m_buffer(std::size(columns)),
+        m_blockRows(std::max<std::size_t>(1, blockRows)) {
+    std::string header(kMagic);
+    detail::appendPod(header, kVersion);
+    detail::appendPod(header, static_cast<std::uint32_t>(m_buffer.size()));
+    for (const auto &column : columns) {
+      const std::string_view name(column);
+      detail::appendPod(header, static_cast<std::uint32_t>(name.size()));
+      header.append(name);
+    }
+    m_out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    for (auto &values : m_buffer) {
+      values.reserve(m_blockRows);
+    }
+  }
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  ~Writer() { flush(); }
+
+  // row holds one value per column.
+  void append(std::span<const double> row) {
+    for (std::size_t c = 0; c < m_buffer.size(); ++c) {
+      m_buffer[c].push_back(row[c]);
+    }
+    if (m_buffer[0].size() == m_blockRows) {
+      writeBlock();
+    }
+  }
+
+  void flush() {
+    if (!m_buffer.empty() && !m_buffer[0].empty()) {
+      writeBlock();
+    }
+    m_out.flush();
+  }
+
+  std::uint64_t rows() const {
+    return m_rows + (m_buffer.empty() ? 0 : m_buffer[0].size());
+  }
+
+private:
+  void writeBlock() {
+    CP_TRACE_SCOPE("Codec::writeBlock");
+    const std::size_t columns = m_buffer.size();
+    const auto rows = static_cast<std::uint32_t>(m_buffer[0].size());
+    m_streams.clear();
+    m_block.assign(8 + (columns * 5), '\0');
+    for (std::size_t c = 0; c < columns; ++c) {
+      const std::size_t before = m_streams.size();
+      const Encoding encoding =
+          c == 0 ? Encoding::DeltaOfDelta : Encoding::Xor;
+      if (encoding == Encoding::DeltaOfDelta) {
+        encodeDeltaOfDelta(m_buffer[c], m_streams);
+      } else {
+        encodeXor(m_buffer[c], m_streams);
+      }
+      const auto size = static_cast<std::uint32_t>(m_streams.size() - before);
+      char *entry = m_block.data() + 8 + (c * 5);
+      entry[0] = static_cast<char>(encoding);
+      std::memcpy(entry + 1, &size, sizeof(size));
+      m_buffer[c].clear();
+    }
+    const auto streamBytes = static_cast<std::uint32_t>(m_streams.size());
+    std::memcpy(m_block.data(), &streamBytes, sizeof(streamBytes));
+    std::memcpy(m_block.data() + 4, &rows, sizeof(rows));
+    m_out.write(m_block.data(), static_cast<std::streamsize>(m_block.size()));
+    m_out.write(m_streams.data(),
+                static_cast<std::streamsize>(m_streams.size()));
+    m_rows += rows;
+  }
+
+  std::ostream &m_out;
+  std::vector<std::vector<double>> m_buffer;
+  std::size_t m_blockRows;
+  std::uint64_t m_rows = 0;
+  std::string m_block;
+  std::string m_streams;
+};
+
+/**
+ * @brief Random access to the blocks of a complete CPTS file held in memory
+ */
+class Reader {
+public:
+  // bytes must outlive the reader.
+  explicit Reader(std::string_view bytes) : m_bytes(bytes) {
+    const std::size_t header = readHeader(bytes, m_columns);
+    if (header == 0) {
+      throw std::runtime_error("truncated CPTS header");
+    }
+    m_bytes = bytes.substr(header);
+    m_index = indexBlocks(m_bytes, m_columns.size());
+  }
+
+  const std::vector<std::string> &columns() const { return m_columns; }
+  std::uint64_t rowCount() const { return m_index.rows; }
+  const BlockIndex &index() const { return m_index; }
+
+  // Block holding row (row < rowCount()).
+  std::size_t findBlock(std::uint64_t row) const {
+    const auto it = std::upper_bound(
+        m_index.blocks.begin(), m_index.blocks.end(), row,
+        [](std::uint64_t r, const Block &block) { return r < block.firstRow; });
+    return static_cast<std::size_t>(it - m_index.blocks.begin()) - 1;
+  }
+
+  // Decodes column of one block; out must hold index().blocks[b].rows.
+  void decodeBlock(std::size_t b, std::size_t column, double *out) const {
+    const Block &block = m_index.blocks.at(b);
+    const Stream &stream = block.columns.at(column);
+    decode(stream.encoding, m_bytes.substr(stream.offset, stream.size),
+           block.rows, out);
+  }
+
+  template <typename T>
+  void decodeColumns(const std::vector<T *> &out, unsigned threads = 0) const {
+    Codec::decodeColumns(m_bytes, m_index, out, threads);
+  }
+
+private:
+  std::string_view m_bytes;
+  std::vector<std::string> m_columns;
+  BlockIndex m_index;
+};
+
+} // namespace Codec
@@ -0,0 +1,346 @@
+// deps/DataLoader/ColumnExpr.h
+
+#pragma once
+
+#include "ColumnStats.h"
+#include "DataLoader.h"
+#include <PhysicsSimd.h>
+#include <Pragmas.h>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Lazy derived columns over DataLoader tables
+ *
+ * An expression such as
+ *
+ *   const auto vx = Expr::column(loader, "vx(t)");
+ *   const auto vy = Expr::column(loader, "vy(t)");
+ *   const auto speed = Expr::hypot(vx, vy);
+ *   const auto energy = Expr::apply(
+ *       [m](double v) { return Phy::calculations::kinetic_energy(m, v); },
+ *       speed);
+ *
+ * only records the operations; its type is the whole tree and nothing is
+ * computed or allocated. Evaluation (evaluate(), forEachBlock(), stats())
+ * binds the tree to the columns' current data and runs it as one fused
+ * loop: every row reads its inputs once and produces the result without
+ * intermediate columns. Columns are read at evaluation time, so an
+ * expression over a followed file sees the rows appended since it was
+ * built.
+ *
+ * forEachBlock() evaluates several expressions over blocks of kBlock rows
+ * into stack buffers, so the source columns they share are read from L1
+ * once per block and the consumer (a plot, a statistic) sees each block
+ * while it is still in cache.
+ */
+namespace Expr {
+
+/** @brief Rows per block of forEachBlock(): 4 KiB per expression */
+inline constexpr std::size_t kBlock = 1024;
+
+/**
+ * @brief A lazy column: size() rows, and bind(), which returns an object
+ * whose operator[](row) gives the value of a row
+ */
+template <typename E>
+concept Expression = std::remove_cvref_t<E>::isExpression &&
+                     requires(const std::remove_cvref_t<E> &e) {
+                       { e.size() } -> std::same_as<std::size_t>;
+                       { e.bind()[std::size_t{}] } -> std::same_as<float>;
+                     };
+
+template <typename T>
+concept Operand = Expression<T> || std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+/** @brief A loaded column; reads the vector's data as of evaluation */
+class Column {
+public:
+  static constexpr bool isExpression = true;
+
+  struct Bound {
+    const float *data;
+    float operator[](std::size_t row) const { return data[row]; }
+  };
+
+  explicit Column(const std::vector<float> &data) : m_data(&data) {}
+
+  std::size_t size() const { return m_data->size(); }
+  Bound bind() const { return {m_data->data()}; }
+
+private:
+  const std::vector<float> *m_data;
+};
+
+/** @brief A value shared by every row */
+class Constant {
+public:
+  static constexpr bool isExpression = true;
+
+  explicit Constant(float value) : m_value(value) {}
+
+  std::size_t size() const { return std::numeric_limits<std::size_t>::max(); }
+  const Constant &bind() const { return *this; }
+  float operator[](std::size_t /*row*/) const { return m_value; }
+
+private:
+  float m_value;
+};
+
+/** @brief op applied row by row to the values of args */
+template <typename Op, typename... Args> class Node {
+public:
+  static constexpr bool isExpression = true;
+
+  explicit Node(Op op, Args... args)
+      : m_op(std::move(op)), m_args(std::move(args)...) {}
+
+  /** @brief The shortest argument's rows */
+  std::size_t size() const {
+    return std::apply(
+        [](const auto &...args) { return std::min({args.size()...}); },
+        m_args);
+  }
+
+  auto bind() const {
+    return std::apply(
+        [this](const auto &...args) {
+          return Node<Op, std::remove_cvref_t<decltype(args.bind())>...>(
+              m_op, args.bind()...);
+        },
+        m_args);
+  }
+
+  float operator[](std::size_t row) const {
+    return std::apply(
+        [this, row](const auto &...args) {
+          return static_cast<float>(m_op(args[row]...));
+        },
+        m_args);
+  }
+
+private:
+  Op m_op;
+  std::tuple<Args...> m_args;
+};
+
+inline Column column(const std::vector<float> &data) { return Column(data); }
+
+/**
+ * @brief The column of loader named header (empty if there is none); the
+ * expression must not outlive loader
+ */
+inline Column column(const DataLoader &loader, const std::string &header) {
+  return Column(loader.getColumn(header));
+}
+
+namespace detail {
+
+template <Operand T> auto lift(const T &operand) {
+  if constexpr (Expression<T>) {
+    return operand;
+  } else {
+    return Constant(static_cast<float>(operand));
+  }
+}
+
+template <typename Op, Operand... Ts> auto node(Op op, const Ts &...operands) {
+  return Node<Op, decltype(lift(operands))...>(std::move(op),
+                                               lift(operands)...);
+}
+
+// std::sqrt keeps a loop scalar: GCC and Clang branch to libm for the errno
+// of a negative argument. This is four Newton steps for 1/sqrt in double
+// from a bit-level first guess, which is exactly std::sqrt for every
+// non-negative float (checked exhaustively), and vectorizes.
+inline float sqrt(float value) {
+  using Phy::simd::lane::select;
+  const double x = value;
+  double y = std::bit_cast<double>(0x5FE6EB50C7B537A9ULL -
+                                   (std::bit_cast<std::uint64_t>(x) >> 1));
+  const double half = 0.5 * x;
+  y *= 1.5 - (half * y * y);
+  y *= 1.5 - (half * y * y);
+  y *= 1.5 - (half * y * y);
+  y *= 1.5 - (half * y * y);
+  const double root =
+      select(x == std::numeric_limits<double>::infinity(), x, x * y);
+  return static_cast<float>(
+      select(x < 0.0, std::numeric_limits<double>::quiet_NaN(), root));
+}
+
+struct Sqrt {
+  float operator()(float x) const { return detail::sqrt(x); }
+};
+struct Abs {
+  float operator()(float x) const { return std::abs(x); }
+};
+struct Square {
+  float operator()(float x) const { return x * x; }
+};
+struct Min {
+  float operator()(float a, float b) const { return std::min(a, b); }
+};
+struct Max {
+  float operator()(float a, float b) const { return std::max(a, b); }
+};
+
+} // namespace detail
+
+template <Operand L, Operand R>
+  requires(Expression<L> || Expression<R>)
+auto operator+(const L &l, const R &r) {
+  return detail::node(std::plus<>{}, l, r);
+}
+template <Operand L, Operand R>
+  requires(Expression<L> || Expression<R>)
+auto operator-(const L &l, const R &r) {
+  return detail::node(std::minus<>{}, l, r);
+}
+template <Operand L, Operand R>
+  requires(Expression<L> || Expression<R>)
+auto operator*(const L &l, const R &r) {
+  return detail::node(std::multiplies<>{}, l, r);
+}
+template <Operand L, Operand R>
+  requires(Expression<L> || Expression<R>)
+auto operator/(const L &l, const R &r) {
+  return detail::node(std::divides<>{}, l, r);
+}
+template <Expression E> auto operator-(const E &e) {
+  return detail::node(std::negate<>{}, e);
+}
+
+template <Expression E> auto sqrt(const E &e) {
+  return detail::node(detail::Sqrt{}, e);
+}
+template <Expression E> auto abs(const E &e) {
+  return detail::node(detail::Abs{}, e);
+}
+template <Expression E> auto square(const E &e) {
+  return detail::node(detail::Square{}, e);
+}
+template <Operand L, Operand R>
+  requires(Expression<L> || Expression<R>)
+auto min(const L &l, const R &r) {
+  return detail::node(detail::Min{}, l, r);
+}
+template <Operand L, Operand R>
+  requires(Expression<L> || Expression<R>)
+auto max(const L &l, const R &r) {
+  return detail::node(detail::Max{}, l, r);
+}
+/** @brief sqrt(x^2 + y^2), e.g. the speed from vx and vy; unlike
+ * std::hypot it does not guard against overflow of the squares */
+template <Operand X, Operand Y>
+  requires(Expression<X> || Expression<Y>)
+auto hypot(const X &x, const Y &y) {
+  return sqrt(square(detail::lift(x)) + square(detail::lift(y)));
+}
+
+/**
+ * @brief f(row values of operands...) as a column, for the scalar formulas
+ * of Physics.h (Phy::units, Phy::calculations)
+ *
+ * f is inlined into the evaluation loop; pass a lambda rather than a
+ * function pointer, which the compiler may not see through. The result is
+ * stored as float.
+ */
+template <typename F, Operand... Ts>
+  requires(Expression<Ts> || ...)
+auto apply(F f, const Ts &...operands) {
+  return detail::node(std::move(f), operands...);
+}
+
+/** @brief Rows every expression has: the shortest one's */
+template <Expression... Es> std::size_t rows(const Es &...exprs) {
+  return std::min({exprs.size()...});
+}
+
+/**
+ * @brief Writes rows first, first + 1, ... of e into out in one fused pass
+ * @throws std::invalid_argument if e has fewer rows
+ */
+template <Expression E>
+void evaluate(const E &e, std::span<float> out, std::size_t first = 0) {
+  CP_TRACE_SCOPE("Expr::evaluate");
+  if (first > e.size() || out.size() > e.size() - first) {
+    throw std::invalid_argument("expression has fewer rows than requested");
+  }
+  const auto bound = e.bind();
+  float *target = out.data();
+  const std::size_t count = out.size();
+  CP_SIMD
+  for (std::size_t i = 0; i < count; ++i) {
+    target[i] = bound[first + i];
+  }
+}
+
+/** @brief All rows of e as a new column; the only allocation is its own */
+template <Expression E> std::vector<float> materialize(const E &e) {
+  std::vector<float> values(e.size());
+  evaluate(e, values);
+  return values;
+}
+
+/**
+ * @brief Evaluates exprs over rows [first, last) block by block and calls
+ * consumer(row, values...) with the block's first row and one
+ * std::span<const float> per expression
+ *
+ * last is clamped to rows(exprs...). The spans point into stack buffers
+ * that are reused for the next block.
+ */
+template <typename Consumer, Expression... Es>
+void forEachBlock(std::size_t first, std::size_t last, Consumer &&consumer,
+                  const Es &...exprs) {
+  CP_TRACE_SCOPE("Expr::forEachBlock");
+  static_assert(sizeof...(Es) > 0, "forEachBlock needs an expression");
+  last = std::min(last, rows(exprs...));
+  const auto bound = std::make_tuple(exprs.bind()...);
+  std::array<std::array<float, kBlock>, sizeof...(Es)> buffers;
+  for (std::size_t row = first; row < last; row += kBlock) {
+    const std::size_t count = std::min(kBlock, last - row);
+    [&]<std::size_t... K>(std::index_sequence<K...>) {
+      (
+          [&] {
+            const auto &e = std::get<K>(bound);
+            float *target = buffers[K].data();
+            CP_SIMD
+            for (std::size_t i = 0; i < count; ++i) {
+              target[i] = e[row + i];
+            }
+          }(),
+          ...);
+      consumer(row, std::span<const float>(buffers[K].data(), count)...);
+    }(std::index_sequence_for<Es...>{});
+  }
+}
+
+/** @brief ColumnStats of e, computed block by block without storing it */
+template <Expression E> ColumnStats stats(const E &e) {
+  ColumnStats result;
+  forEachBlock(
+      0, e.size(),
+      [&result](std::size_t /*row*/, std::span<const float> values) {
+        result.add(values);
+      },
+      e);
+  return result;
+}
+
+} // namespace Expr
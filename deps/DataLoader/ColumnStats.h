@@ -0,0 +1,320 @@
+// deps/DataLoader/ColumnStats.h
+
+#pragma once
+
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Mergeable quantile sketch with a relative error bound
+ *
+ * Values are counted in logarithmic buckets taken straight from the float
+ * bit pattern: sign, exponent and the top kSubBits mantissa bits. A bucket
+ * spans a factor of at most 1 + 2^-kSubBits, so reporting its midpoint is
+ * within 2^-(kSubBits + 1) of every value in it (for normal floats). Adding
+ * a value is one shift and one increment, and sketches of disjoint ranges
+ * merge by adding counts.
+ */
+class QuantileSketch {
+public:
+  static constexpr int kSubBits = 6;
+  static constexpr double kRelativeError = 1.0 / (2 << kSubBits);
+
+  /** @brief Counts v; NaN must be filtered out by the caller. */
+  void add(float v) {
+    ++m_counts[key(v)];
+    ++m_count;
+  }
+
+  /**
+   * @brief Counts values; NaN must be filtered out by the caller
+   *
+   * Neighbouring rows of a trajectory mostly share a bucket. Counting runs
+   * of one bucket in a register avoids a chain of increments of the same
+   * memory word, each waiting for the store of the one before.
+   */
+  void add(std::span<const float> values) {
+    if (values.empty()) {
+      return;
+    }
+    std::size_t run = key(values[0]);
+    std::uint64_t length = 0;
+    for (const float v : values) {
+      const std::size_t k = key(v);
+      if (k != run) {
+        m_counts[run] += length;
+        run = k;
+        length = 0;
+      }
+      ++length;
+    }
+    m_counts[run] += length;
+    m_count += values.size();
+  }
+
+  void merge(const QuantileSketch &other) {
+    for (std::size_t k = 0; k < kBuckets; ++k) {
+      m_counts[k] += other.m_counts[k];
+    }
+    m_count += other.m_count;
+  }
+
+  std::uint64_t count() const { return m_count; }
+
+  /** @brief Value of rank q * (count() - 1), q in [0, 1]; 0 when empty */
+  float quantile(double q) const {
+    if (m_count == 0) {
+      return 0.0F;
+    }
+    const double rank =
+        std::clamp(q, 0.0, 1.0) * static_cast<double>(m_count - 1);
+    const auto target = static_cast<std::uint64_t>(rank);
+    std::uint64_t seen = 0;
+    // Ascending values: negative keys from the largest magnitude down, then
+    // positive keys up.
+    for (std::size_t k = kBuckets; k-- > kBuckets / 2;) {
+      seen += m_counts[k];
+      if (seen > target) {
+        return midpoint(k);
+      }
+    }
+    for (std::size_t k = 0; k < kBuckets / 2; ++k) {
+      seen += m_counts[k];
+      if (seen > target) {
+        return midpoint(k);
+      }
+    }
+    return midpoint(kBuckets / 2 - 1);
+  }
+
+private:
+  static constexpr int kShift = 23 - kSubBits;
+  static constexpr std::size_t kBuckets = std::size_t{1} << (32 - kShift);
+
+  static std::size_t key(float v) {
+    return std::bit_cast<std::uint32_t>(v) >> kShift;
+  }
+
+  static float midpoint(std::size_t k) {
+    const auto bits = (static_cast<std::uint32_t>(k) << kShift) |
+                      (std::uint32_t{1} << (kShift - 1));
+    return std::bit_cast<float>(bits);
+  }
+
+  std::vector<std::uint64_t> m_counts = std::vector<std::uint64_t>(kBuckets);
+  std::uint64_t m_count = 0;
+};
+
+/**
+ * @brief Single-pass statistics of a float column: extent, mean, variance
+ * and quantiles
+ *
+ * add() consumes values in cache-sized chunks: min, max and the chunk sum
+ * run in fixed-width lanes the compiler vectorizes, the chunk's squared
+ * deviations are summed while it is still in L1, and the chunk is folded
+ * into the running mean and variance with Chan's parallel update (Welford
+ * for a chunk instead of a value). merge() applies the same update to a
+ * whole ColumnStats, so per-thread partial results combine exactly as if
+ * one thread had seen every value. NaN values are counted as missing and
+ * ignored otherwise.
+ */
+class ColumnStats {
+public:
+  /** @brief Statistics of values, split over up to `threads` threads
+   * (0: std::thread::hardware_concurrency()) */
+  static ColumnStats compute(std::span<const float> values,
+                             unsigned threads = 0) {
+    CP_TRACE_SCOPE("ColumnStats::compute");
+    // Below this a thread costs more than it saves.
+    constexpr std::size_t kValuesPerThread = std::size_t{1} << 20;
+    unsigned count = threads != 0
+                         ? threads
+                         : std::max(1U, std::thread::hardware_concurrency());
+    count = static_cast<unsigned>(std::clamp<std::size_t>(
+        values.size() / kValuesPerThread, 1, count));
+    std::vector<ColumnStats> partial(count);
+    const std::size_t per = (values.size() + count - 1) / count;
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < count; ++t) {
+      const std::size_t first = std::min(values.size(), t * per);
+      const std::size_t last = std::min(values.size(), first + per);
+      pool.emplace_back([&partial, t, values, first, last] {
+        partial[t].add(values.subspan(first, last - first));
+      });
+    }
+    partial[0].add(values.first(std::min(values.size(), per)));
+    for (auto &thread : pool) {
+      thread.join();
+    }
+    for (unsigned t = 1; t < count; ++t) {
+      partial[0].merge(partial[t]);
+    }
+    return std::move(partial[0]);
+  }
+
+  void add(std::span<const float> values) {
+    for (std::size_t first = 0; first < values.size(); first += kChunk) {
+      addChunk(values.subspan(first, std::min(kChunk, values.size() - first)));
+    }
+  }
+
+  void merge(const ColumnStats &other) {
+    m_missing += other.m_missing;
+    if (other.m_count == 0) {
+      return;
+    }
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    combine(other.m_count, other.m_mean, other.m_m2);
+    m_sketch.merge(other.m_sketch);
+  }
+
+  bool empty() const { return m_count == 0; }
+  /** @brief Values seen, without NaN */
+  std::uint64_t count() const { return m_count; }
+  /** @brief NaN values seen */
+  std::uint64_t missing() const { return m_missing; }
+  float min() const { return m_count == 0 ? 0.0F : m_min; }
+  float max() const { return m_count == 0 ? 0.0F : m_max; }
+  /** @brief Largest magnitude, the extent around the origin */
+  float maxAbs() const { return std::max(std::abs(min()), std::abs(max())); }
+  double mean() const { return m_mean; }
+  double variance() const {
+    return m_count < 2 ? 0.0 : m_m2 / static_cast<double>(m_count - 1);
+  }
+  double stddev() const { return std::sqrt(variance()); }
+
+  /**
+   * @brief Value at quantile q in [0, 1], within
+   * QuantileSketch::kRelativeError of the exact one and clamped to
+   * [min(), max()]
+   */
+  float quantile(double q) const {
+    if (q <= 0.0 || q >= 1.0) {
+      return q <= 0.0 ? min() : max();
+    }
+    return std::clamp(m_sketch.quantile(q), min(), max());
+  }
+
+private:
+  static constexpr std::size_t kChunk = 1024;
+  static constexpr std::size_t kLanes = 8;
+
+  void addChunk(std::span<const float> values) {
+    const std::size_t n = values.size();
+    const float *v = values.data();
+    std::array<float, kLanes> low;
+    std::array<float, kLanes> high;
+    std::array<double, kLanes> sum{};
+    low.fill(std::numeric_limits<float>::infinity());
+    high.fill(-std::numeric_limits<float>::infinity());
+    std::size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+      for (std::size_t j = 0; j < kLanes; ++j) {
+        low[j] = std::min(low[j], v[i + j]);
+        high[j] = std::max(high[j], v[i + j]);
+        sum[j] += v[i + j];
+      }
+    }
+    for (std::size_t j = 0; i + j < n; ++j) {
+      low[j] = std::min(low[j], v[i + j]);
+      high[j] = std::max(high[j], v[i + j]);
+      sum[j] += v[i + j];
+    }
+    double total = 0.0;
+    for (std::size_t j = 0; j < kLanes; ++j) {
+      total += sum[j];
+    }
+    // A NaN poisons the sum: take the chunk again without the NaNs.
+    if (std::isnan(total) && addWithoutMissing(values)) {
+      return;
+    }
+    for (std::size_t j = 0; j < kLanes; ++j) {
+      m_min = std::min(m_min, low[j]);
+      m_max = std::max(m_max, high[j]);
+    }
+
+    // Second pass over the chunk, still in L1: squared deviations from the
+    // chunk mean, which keeps the update numerically stable.
+    const double mean = total / static_cast<double>(n);
+    std::array<double, kLanes> squares{};
+    i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+      for (std::size_t j = 0; j < kLanes; ++j) {
+        const double d = v[i + j] - mean;
+        squares[j] += d * d;
+      }
+    }
+    double m2 = 0.0;
+    for (; i < n; ++i) {
+      const double d = v[i] - mean;
+      m2 += d * d;
+    }
+    for (const double s : squares) {
+      m2 += s;
+    }
+    combine(n, mean, m2);
+
+    m_sketch.add(values);
+  }
+
+  // False if values hold no NaN (the sum was NaN from inf - inf).
+  bool addWithoutMissing(std::span<const float> values) {
+    std::vector<float> present;
+    for (const float x : values) {
+      if (!std::isnan(x)) {
+        present.push_back(x);
+      }
+    }
+    if (present.size() == values.size()) {
+      return false;
+    }
+    m_missing += values.size() - present.size();
+    if (!present.empty()) {
+      addChunk(present);
+    }
+    return true;
+  }
+
+  // Chan et al.: merges a disjoint set of count values with the given mean
+  // and sum of squared deviations.
+  void combine(std::uint64_t count, double mean, double m2) {
+    const double na = static_cast<double>(m_count);
+    const double nb = static_cast<double>(count);
+    const double n = na + nb;
+    const double delta = mean - m_mean;
+    m_mean += delta * (nb / n);
+    m_m2 += m2 + (delta * delta * (na * nb / n));
+    m_count += count;
+  }
+
+  std::uint64_t m_count = 0;
+  std::uint64_t m_missing = 0;
+  float m_min = std::numeric_limits<float>::infinity();
+  float m_max = -std::numeric_limits<float>::infinity();
+  double m_mean = 0.0;
+  double m_m2 = 0.0;
+  QuantileSketch m_sketch;
+};
+
+/**
+ * @brief View scale that maps the largest magnitude of the data to
+ * halfExtent, keeping the origin (and the grid's axes) at the centre
+ *
+ * fallback is used when there is nothing to fit: no values, or all zero.
+ */
+inline float fitScale(const ColumnStats &stats, float halfExtent,
+                      float fallback) {
+  const float extent = stats.maxAbs();
+  return extent > 0.0F && std::isfinite(extent) ? halfExtent / extent
+                                                : fallback;
+}
@@ -1,16 +1,57 @@
 #pragma once
 
+#include "ColumnCodec.h"
+#include "ColumnStats.h"
+#include "FileWatcher.h"
+#include <Trace.h>
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <sstream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 class DataLoader {
 public:
-  DataLoader(const std::string &filename, char delimiter = ',')
-      : m_filename(filename), m_delimiter(delimiter) {
+  /**
+   * Once:   parse the file in the constructor and never look at it again.
+   * Follow: additionally watch the file; update() parses only the rows
+   *         appended since the last call. A trailing line without '\n' is
+   *         treated as still being written and is left for a later update.
+   *         A file that shrank, or whose first bytes or bytes before the
+   *         parsed offset changed (a new run, even one that already wrote
+   *         past the old offset), is parsed again from the start.
+   *
+   * Files written with --compress (ColumnCodec.h) are recognised by their
+   * magic and decoded block by block instead of parsed; in Follow mode an
+   * incomplete trailing block waits for a later update like a partial line.
+   */
+  enum class Mode { Once, Follow };
+
+  /**
+   * Called with the index of the first new row and the number of rows
+   * appended. firstRow == 0 after the file was truncated or replaced: the
+   * columns were rebuilt from scratch and anything derived from earlier
+   * rows should be discarded.
+   */
+  using RowsListener = std::function<void(size_t firstRow, size_t count)>;
+
+  DataLoader(const std::string &filename, char delimiter = ',',
+             Mode mode = Mode::Once)
+      : m_filename(filename), m_delimiter(delimiter), m_mode(mode) {
+    if (m_mode == Mode::Follow) {
+      m_watcher = std::make_unique<FileWatcher>(m_filename);
+    }
     parseFile();
   }
 
@@ -26,6 +67,49 @@ public:
     return (it != m_data.end()) ? it->second : empty;
   }
 
+  /**
+   * @brief Extent, mean, variance and quantiles of a column
+   *
+   * Computed in one pass on first use and extended by the rows appended
+   * since the last call, so a loader that never asks pays nothing and a
+   * followed file is never rescanned. The reference is valid until the
+   * file is truncated or replaced.
+   */
+  const ColumnStats &getStats(const std::string &header) const {
+    const auto &column = getColumn(header);
+    CachedStats &cached = m_stats[header];
+    if (cached.rows < column.size()) {
+      const std::span<const float> added(column.data() + cached.rows,
+                                         column.size() - cached.rows);
+      cached.stats.merge(ColumnStats::compute(added));
+      cached.rows = column.size();
+    }
+    return cached.stats;
+  }
+
+  size_t getRowCount() const {
+    return m_headers.empty() ? 0 : m_data.at(m_headers[0]).size();
+  }
+
+  void addListener(RowsListener listener) {
+    m_listeners.push_back(std::move(listener));
+  }
+
+  /**
+   * @brief Parse rows appended since the last call (Follow mode only)
+   *
+   * Cheap when nothing happened: the watcher is checked first and the file
+   * is only reopened if it reports a change. Cost is proportional to the
+   * number of new bytes, not to the file size.
+   * @return Number of rows appended
+   */
+  size_t update() {
+    if (m_mode != Mode::Follow || !m_watcher->changed()) {
+      return 0;
+    }
+    return parseFile();
+  }
+
   void printData() const {
     for (size_t i = 0; i < m_headers.size(); ++i) {
       std::cout << m_headers[i];
@@ -59,67 +143,238 @@ private:
   std::vector<std::string> m_headers;
   std::string m_filename;
   char m_delimiter;
+  Mode m_mode;
+
+  // Byte offset just past the last complete ('\n'-terminated) line or
+  // compressed block parsed
+  std::streamoff m_offset = 0;
+  bool m_compressed = false;
+  // The first bytes of the file and the bytes just before m_offset as last
+  // parsed; if either differs on the next update, the file was rewritten.
+  std::string m_head;
+  std::string m_tail;
+  std::unique_ptr<FileWatcher> m_watcher;
+  std::vector<RowsListener> m_listeners;
+
+  // Files are read this many bytes at a time.
+  static constexpr std::size_t kReadBlock = std::size_t{1} << 20;
+  static constexpr std::size_t kAnchorBytes = 64;
 
-  void parseFile() {
-    std::ifstream datFile(m_filename);
+  struct CachedStats {
+    ColumnStats stats;
+    size_t rows = 0; // rows of the column already in stats
+  };
+  mutable std::unordered_map<std::string, CachedStats> m_stats;
+
+  // Parses everything from m_offset on, kReadBlock bytes at a time, and
+  // returns the number of new rows.
+  size_t parseFile() {
+    CP_TRACE_SCOPE("DataLoader::parseFile");
+    std::ifstream datFile(m_filename, std::ios::binary);
 
     if (!datFile.is_open()) {
-      std::cerr << "Error: Could not open file '" << m_filename << "'"
-                << std::endl;
-      return;
+      if (m_mode == Mode::Once) {
+        std::cerr << "Error: Could not open file '" << m_filename << "'"
+                  << std::endl;
+      }
+      return 0;
     }
 
-    std::string line;
-    bool isFirstLine = true;
+    datFile.seekg(0, std::ios::end);
+    const std::streamoff size = datFile.tellg();
+    bool rebuilt = false;
+    if (m_offset > 0 && (size < m_offset || !sameRun(datFile))) {
+      // Truncated or replaced by a new run: start over.
+      m_data.clear();
+      m_headers.clear();
+      m_stats.clear();
+      m_offset = 0;
+      m_compressed = false;
+      m_head.clear();
+      m_tail.clear();
+      rebuilt = true;
+    }
+
+    const size_t firstRow = getRowCount();
+    std::string pending; // read from m_offset on, not parsed yet
+    datFile.clear();
+    datFile.seekg(m_offset);
+    for (std::streamoff left = size - m_offset; left > 0;) {
+      const auto want =
+          static_cast<size_t>(std::min<std::streamoff>(left, kReadBlock));
+      const size_t kept = pending.size();
+      pending.resize(kept + want);
+      datFile.read(pending.data() + kept, static_cast<std::streamsize>(want));
+      const auto got = static_cast<size_t>(datFile.gcount());
+      pending.resize(kept + got);
+      left = got < want ? 0 : left - static_cast<std::streamoff>(got);
+
+      if (m_offset == 0 && kept == 0) {
+        m_compressed = Codec::isCompressed(pending);
+      }
+      const std::optional<size_t> used = parseChunk(pending, left == 0);
+      if (!used) {
+        m_offset = size; // undecodable: skip to the end
+        break;
+      }
+      m_offset += static_cast<std::streamoff>(*used);
+      pending.erase(0, *used);
+    }
+    remember(datFile);
 
-    while (std::getline(datFile, line)) {
-      if (line.empty() || line.find_first_not_of(" \t") == std::string::npos) {
-        continue;
+    const size_t rowCount = getRowCount();
+    const size_t added = rowCount - (rebuilt ? 0 : firstRow);
+    if (added > 0 || rebuilt) {
+      for (const auto &listener : m_listeners) {
+        listener(rebuilt ? 0 : firstRow, added);
       }
+    }
+    return added;
+  }
+
+  // Parses the complete lines or blocks at the start of chunk (all of it if
+  // it is the end of a file nobody writes) and returns the bytes used;
+  // std::nullopt if a compressed block cannot be decoded.
+  std::optional<size_t> parseChunk(std::string_view chunk, bool atEnd) {
+    if (m_compressed) {
+      return parseCompressed(chunk);
+    }
+    size_t lineStart = 0;
+    size_t lineEnd = 0;
+    while ((lineEnd = chunk.find('\n', lineStart)) != std::string_view::npos) {
+      parseLine(chunk.substr(lineStart, lineEnd - lineStart));
+      lineStart = lineEnd + 1;
+    }
+    // A final line without '\n' is complete only if nobody is writing.
+    if (atEnd && m_mode == Mode::Once && lineStart < chunk.size()) {
+      parseLine(chunk.substr(lineStart));
+      lineStart = chunk.size();
+    }
+    return lineStart;
+  }
+
+  static std::string readAt(std::ifstream &file, std::streamoff offset,
+                            size_t count) {
+    std::string bytes(count, '\0');
+    file.clear();
+    file.seekg(offset);
+    file.read(bytes.data(), static_cast<std::streamsize>(count));
+    bytes.resize(static_cast<size_t>(file.gcount()));
+    return bytes;
+  }
 
-      std::vector<std::string> tokens;
+  // Whether the bytes parsed so far are still in the file: a rerun that
+  // truncates the file and writes past the old offset before the next
+  // update() is caught here, not by the size.
+  bool sameRun(std::ifstream &file) const {
+    return readAt(file, 0, m_head.size()) == m_head &&
+           readAt(file, m_offset - static_cast<std::streamoff>(m_tail.size()),
+                  m_tail.size()) == m_tail;
+  }
 
-      // Use logic based on the delimiter
-      if (m_delimiter == ' ') {
-        // Use stringstream extraction for space-separated data
-        // This handles multiple spaces gracefully
-        std::istringstream iss(line);
-        std::string token;
-        while (iss >> token) {
-          tokens.push_back(token);
+  void remember(std::ifstream &file) {
+    if (m_mode != Mode::Follow) {
+      return;
+    }
+    const auto anchor = static_cast<size_t>(
+        std::min<std::streamoff>(m_offset, kAnchorBytes));
+    if (m_head.size() < anchor) {
+      m_head = readAt(file, 0, anchor);
+    }
+    m_tail = readAt(file, m_offset - static_cast<std::streamoff>(anchor),
+                    anchor);
+  }
+
+  // Decodes the header (first call) and every complete block of chunk;
+  // returns the number of bytes consumed.
+  std::optional<size_t> parseCompressed(std::string_view chunk) {
+    const size_t rows = getRowCount();
+    try {
+      size_t header = 0;
+      if (m_headers.empty()) {
+        header = Codec::readHeader(chunk, m_headers);
+        if (header == 0) {
+          return 0;
         }
-      } else {
-        std::stringstream ss(line);
-        std::string token;
-        while (std::getline(ss, token, m_delimiter)) {
-          const auto first = token.find_first_not_of(" \t\n\r");
-          if (first == std::string::npos) {
-            continue;
-          }
-          const auto last = token.find_last_not_of(" \t\n\r");
-          tokens.push_back(token.substr(first, last - first + 1));
+        for (const auto &name : m_headers) {
+          m_data[name] = std::vector<float>();
         }
       }
+      const std::string_view blocks = chunk.substr(header);
+      const Codec::BlockIndex index =
+          Codec::indexBlocks(blocks, m_headers.size(), getRowCount());
+      std::vector<float *> columns;
+      for (const auto &name : m_headers) {
+        auto &column = m_data[name];
+        column.resize(column.size() + index.rows);
+        columns.push_back(column.data() + column.size() - index.rows);
+      }
+      Codec::decodeColumns(blocks, index, columns);
+      return header + index.bytes;
+    } catch (const std::runtime_error &e) {
+      std::cerr << "Error: '" << m_filename << "': " << e.what() << std::endl;
+      for (auto &entry : m_data) {
+        entry.second.resize(rows);
+      }
+      return std::nullopt;
+    }
+  }
 
-      if (isFirstLine) {
-        m_headers = tokens;
-        for (const auto &header : m_headers) {
-          m_data[header] = std::vector<float>();
-        }
-        isFirstLine = false;
-      } else {
-        for (size_t i = 0; i < tokens.size() && i < m_headers.size(); ++i) {
-          try {
-            float value = std::stof(tokens[i]);
-            m_data[m_headers[i]].push_back(value);
-          } catch (const std::exception &e) {
-            std::cerr << "Warning: Could not parse value '" << tokens[i]
-                      << "' for column '" << m_headers[i] << "'" << std::endl;
-          }
-        }
+  // Whitespace-separated for ' ', otherwise split at the delimiter; tokens
+  // are trimmed and empty ones skipped.
+  template <typename Visit>
+  void forEachToken(std::string_view line, Visit visit) const {
+    constexpr std::string_view kSpace = " \t\n\r";
+    const std::string_view separators =
+        m_delimiter == ' ' ? kSpace : std::string_view(&m_delimiter, 1);
+    size_t start = 0;
+    while (start <= line.size()) {
+      size_t end = line.find_first_of(separators, start);
+      if (end == std::string_view::npos) {
+        end = line.size();
+      }
+      std::string_view token = line.substr(start, end - start);
+      const auto first = token.find_first_not_of(kSpace);
+      if (first != std::string_view::npos) {
+        const auto last = token.find_last_not_of(kSpace);
+        visit(token.substr(first, last - first + 1));
       }
+      start = end + 1;
+    }
+  }
+
+  void parseLine(std::string_view line) {
+    if (line.empty() || line.find_first_not_of(" \t\r") == line.npos) {
+      return;
     }
 
-    datFile.close();
+    if (m_headers.empty()) {
+      forEachToken(line, [this](std::string_view token) {
+        m_headers.emplace_back(token);
+      });
+      for (const auto &header : m_headers) {
+        m_data[header] = std::vector<float>();
+      }
+      return;
+    }
+    size_t i = 0;
+    forEachToken(line, [this, &i](std::string_view token) {
+      if (i >= m_headers.size()) {
+        return;
+      }
+      // from_chars does not take the sign stof accepts
+      const std::string_view digits =
+          token.front() == '+' ? token.substr(1) : token;
+      float value = 0.0F;
+      const auto result =
+          std::from_chars(digits.data(), digits.data() + digits.size(), value);
+      if (result.ec == std::errc{}) {
+        m_data[m_headers[i]].push_back(value);
+      } else {
+        std::cerr << "Warning: Could not parse value '" << token
+                  << "' for column '" << m_headers[i] << "'" << std::endl;
+      }
+      ++i;
+    });
   }
-};
\ No newline at end of file
+};
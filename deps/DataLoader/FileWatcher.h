@@ -0,0 +1,103 @@
+// deps/DataLoader/FileWatcher.h
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#if defined(__linux__)
+#include <array>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Non-blocking "has this file changed?" check
+ *
+ * On Linux this is an inotify watch on the file's directory (so it also
+ * notices the file being created or replaced); changed() only drains the
+ * pending events and never blocks. Elsewhere it falls back to comparing
+ * the file size and modification time on every call.
+ */
+class FileWatcher {
+public:
+  explicit FileWatcher(const std::string &filename)
+      : m_path(std::filesystem::absolute(filename)) {
+#if defined(__linux__)
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd >= 0) {
+      const std::string directory = m_path.parent_path().string();
+      if (inotify_add_watch(m_fd, directory.c_str(),
+                            IN_MODIFY | IN_CREATE | IN_CLOSE_WRITE |
+                                IN_MOVED_TO) < 0) {
+        close(m_fd);
+        m_fd = -1;
+      }
+    }
+#endif
+    snapshot();
+  }
+
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  ~FileWatcher() {
+#if defined(__linux__)
+    if (m_fd >= 0) {
+      close(m_fd);
+    }
+#endif
+  }
+
+  bool changed() {
+#if defined(__linux__)
+    if (m_fd >= 0) {
+      return drainEvents();
+    }
+#endif
+    return snapshot();
+  }
+
+private:
+  std::filesystem::path m_path;
+  std::uintmax_t m_lastSize = 0;
+  std::filesystem::file_time_type m_lastWrite{};
+
+  // Returns true if size or mtime differ from the previous snapshot
+  bool snapshot() {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(m_path, ec);
+    if (ec) {
+      return false;
+    }
+    const auto written = std::filesystem::last_write_time(m_path, ec);
+    const bool different = size != m_lastSize || written != m_lastWrite;
+    m_lastSize = size;
+    m_lastWrite = written;
+    return different;
+  }
+
+#if defined(__linux__)
+  int m_fd = -1;
+
+  bool drainEvents() {
+    const std::string name = m_path.filename().string();
+    alignas(inotify_event) std::array<char, 4096> buffer{};
+    bool relevant = false;
+    ssize_t length = 0;
+    while ((length = read(m_fd, buffer.data(), buffer.size())) > 0) {
+      for (ssize_t offset = 0; offset < length;) {
+        const auto *event =
+            reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+        if (event->len > 0 && name == event->name) {
+          relevant = true;
+        }
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+      }
+    }
+    return relevant;
+  }
+#endif
+};
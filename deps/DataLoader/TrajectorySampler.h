@@ -0,0 +1,301 @@
+// deps/DataLoader/TrajectorySampler.h
+
+#pragma once
+
+#include "DataLoader.h"
+#include <Pragmas.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Values of loaded columns at arbitrary times
+ *
+ * The time column is indexed once: when it is uniform (every t_i within
+ * dt/4 of t0 + i * dt, except a last row off the grid such as the exact
+ * capture row of MiniGolf.dat) a time maps to its row with one
+ * multiplication and at most one correction step; otherwise every
+ * kBlock-th time is copied into a small top-level array, searched first,
+ * and only one block of the full column is searched after it.
+ *
+ * sample() resolves a whole batch of query times in two passes, first the
+ * rows and interpolation weights of every query and then one tight loop per
+ * column, so the per-column work vectorizes over the queries. Hermite uses
+ * the velocity column of a position column ("vx(t)" or "Vx(t)" for
+ * "x(t)") as its derivative and falls back to linear interpolation for
+ * columns without one. Times outside the data clamp to the first or last
+ * row.
+ *
+ * The sampler refers to the loader's columns by name: call rebuild() after
+ * DataLoader::update() appended rows or replaced the columns (a truncated
+ * or replaced file); it looks them up again and re-indexes the time column.
+ * The constructor and rebuild() throw std::invalid_argument if the time
+ * column or a sampled column is missing, or a sampled column has fewer
+ * rows than the time column.
+ */
+class TrajectorySampler {
+public:
+  enum class Interpolation { Linear, Hermite };
+
+  static constexpr std::size_t kBlock = 64;
+
+  TrajectorySampler(const DataLoader &loader,
+                    const std::vector<std::string> &columns,
+                    const std::string &timeColumn = "Time(s)")
+      : m_loader(&loader), m_timeName(timeColumn), m_names(columns) {
+    rebuild();
+  }
+
+  /** @brief Looks the columns up again and re-indexes the time column. */
+  void rebuild() {
+    resolve();
+    const std::vector<float> &time = *m_time;
+    const std::size_t n = time.size();
+    if (!std::is_sorted(time.begin(), time.end())) {
+      throw std::invalid_argument("time column is not sorted");
+    }
+    m_blockTimes.clear();
+    for (std::size_t i = 0; i < n; i += kBlock) {
+      m_blockTimes.push_back(time[i]);
+    }
+    m_uniform = false;
+    // Rows on the grid: a last row may be off it. guess() never returns
+    // the last row, so it only has to be sorted.
+    const std::size_t gridRows = n > 2 ? n - 1 : n;
+    if (n < 2 || !(time[gridRows - 1] > time[0])) {
+      return;
+    }
+    m_t0 = time[0];
+    m_dt = (time[gridRows - 1] - time[0]) /
+           static_cast<double>(gridRows - 1);
+    const double slack = m_dt / 4.0;
+    for (std::size_t i = 0; i < gridRows; ++i) {
+      const double expected = m_t0 + (static_cast<double>(i) * m_dt);
+      if (std::abs(time[i] - expected) > slack) {
+        return;
+      }
+    }
+    m_uniform = true;
+  }
+
+  bool uniform() const { return m_uniform; }
+  std::size_t size() const { return m_time->size(); }
+
+  /**
+   * @brief Row i with t_i <= t < t_{i+1}, clamped to [0, size() - 2] so
+   * that i + 1 is always a row (0 for fewer than two rows)
+   */
+  std::size_t locate(float t) const {
+    const std::vector<float> &time = *m_time;
+    const std::size_t n = time.size();
+    if (n < 2) {
+      return 0;
+    }
+    if (m_uniform) {
+      return correct(guess(t), t);
+    }
+    const auto block =
+        std::upper_bound(m_blockTimes.begin(), m_blockTimes.end(), t);
+    const std::size_t first =
+        block == m_blockTimes.begin()
+            ? 0
+            : static_cast<std::size_t>(block - m_blockTimes.begin() - 1) *
+                  kBlock;
+    const auto last = time.begin() + static_cast<std::ptrdiff_t>(
+                                         std::min(first + kBlock + 1, n));
+    const auto it = std::upper_bound(
+        time.begin() + static_cast<std::ptrdiff_t>(first), last, t);
+    const std::size_t i = it == time.begin()
+                              ? 0
+                              : static_cast<std::size_t>(it - time.begin()) - 1;
+    return std::min(i, n - 2);
+  }
+
+  /**
+   * @brief Interpolates every column at every query time
+   *
+   * out[c] receives times.size() values of the c-th column given to the
+   * constructor.
+   */
+  void sample(std::span<const float> times, const std::vector<float *> &out,
+              Interpolation interpolation = Interpolation::Linear) const {
+    const std::size_t count = times.size();
+    const std::size_t n = m_time->size();
+    if (out.size() != m_columns.size()) {
+      throw std::invalid_argument("one output per sampled column expected");
+    }
+    if (n < 2) {
+      for (std::size_t c = 0; c < out.size(); ++c) {
+        const float value = n == 0 ? 0.0F : (*m_columns[c].values)[0];
+        std::fill(out[c], out[c] + count, value);
+      }
+      return;
+    }
+
+    for (std::size_t first = 0; first < count; first += kChunk) {
+      const std::size_t chunk = std::min(kChunk, count - first);
+      std::vector<float *> target(out.size());
+      for (std::size_t c = 0; c < out.size(); ++c) {
+        target[c] = out[c] + first;
+      }
+      sampleChunk(times.subspan(first, chunk), target, interpolation);
+    }
+  }
+
+  /** @brief Convenience: one vector per sampled column */
+  std::vector<std::vector<float>>
+  sample(std::span<const float> times,
+         Interpolation interpolation = Interpolation::Linear) const {
+    std::vector<std::vector<float>> columns(m_columns.size());
+    std::vector<float *> out;
+    for (auto &column : columns) {
+      column.resize(times.size());
+      out.push_back(column.data());
+    }
+    sample(times, out, interpolation);
+    return columns;
+  }
+
+private:
+  // Queries are resolved kChunk at a time, so the per-query rows and
+  // weights stay in L1 and need no allocation.
+  static constexpr std::size_t kChunk = 256;
+
+  void sampleChunk(std::span<const float> times,
+                   const std::vector<float *> &out,
+                   Interpolation interpolation) const {
+    const std::size_t count = times.size();
+    std::array<std::size_t, kChunk> rows;
+    std::array<float, kChunk> weights;
+    std::array<float, kChunk> widths;
+    const float *time = m_time->data();
+
+    // Pass 1: row, weight and interval of every query
+    if (m_uniform) {
+      CP_SIMD
+      for (std::size_t k = 0; k < count; ++k) {
+        rows[k] = guess(times[k]);
+      }
+      for (std::size_t k = 0; k < count; ++k) {
+        rows[k] = correct(rows[k], times[k]);
+      }
+    } else {
+      for (std::size_t k = 0; k < count; ++k) {
+        rows[k] = locate(times[k]);
+      }
+    }
+    CP_SIMD
+    for (std::size_t k = 0; k < count; ++k) {
+      const std::size_t i = rows[k];
+      const float width = time[i + 1] - time[i];
+      const float s = width > 0.0F ? (times[k] - time[i]) / width : 0.0F;
+      weights[k] = std::clamp(s, 0.0F, 1.0F);
+      widths[k] = width;
+    }
+
+    // Pass 2: one loop per column
+    for (std::size_t c = 0; c < m_columns.size(); ++c) {
+      const float *values = m_columns[c].values->data();
+      float *target = out[c];
+      if (interpolation == Interpolation::Hermite &&
+          m_columns[c].derivative != nullptr) {
+        const float *slopes = m_columns[c].derivative->data();
+        CP_SIMD
+        for (std::size_t k = 0; k < count; ++k) {
+          const std::size_t i = rows[k];
+          const float s = weights[k];
+          const float s2 = s * s;
+          const float s3 = s2 * s;
+          const float h00 = (2.0F * s3) - (3.0F * s2) + 1.0F;
+          const float h10 = s3 - (2.0F * s2) + s;
+          const float h01 = (3.0F * s2) - (2.0F * s3);
+          const float h11 = s3 - s2;
+          target[k] = (h00 * values[i]) + (h10 * widths[k] * slopes[i]) +
+                      (h01 * values[i + 1]) +
+                      (h11 * widths[k] * slopes[i + 1]);
+        }
+      } else {
+        CP_SIMD
+        for (std::size_t k = 0; k < count; ++k) {
+          const std::size_t i = rows[k];
+          target[k] =
+              values[i] + (weights[k] * (values[i + 1] - values[i]));
+        }
+      }
+    }
+  }
+
+  struct Column {
+    const std::vector<float> *values;
+    const std::vector<float> *derivative; // nullptr: linear only
+  };
+
+  // The loader replaces its vectors when the file is truncated or replaced,
+  // so the pointers are only kept until the next rebuild(). A derivative
+  // column shorter than the time column is not used.
+  void resolve() {
+    m_time = find(m_timeName);
+    if (m_time == nullptr) {
+      throw std::invalid_argument("no time column '" + m_timeName + "'");
+    }
+    m_columns.clear();
+    for (const auto &name : m_names) {
+      const auto *column = find(name);
+      if (column == nullptr) {
+        throw std::invalid_argument("no column '" + name + "'");
+      }
+      if (column->size() < m_time->size()) {
+        throw std::invalid_argument("column '" + name +
+                                    "' is shorter than the time column");
+      }
+      const auto *derivative = find("v" + name);
+      if (derivative == nullptr) {
+        derivative = find("V" + name);
+      }
+      if (derivative != nullptr && derivative->size() < m_time->size()) {
+        derivative = nullptr;
+      }
+      m_columns.push_back({column, derivative});
+    }
+  }
+
+  // nullptr if the loader has no column of that name
+  const std::vector<float> *find(const std::string &name) const {
+    const auto &data = m_loader->getData();
+    const auto it = data.find(name);
+    return it == data.end() ? nullptr : &it->second;
+  }
+
+  // Uniform grid: the row t falls in if the grid were exact.
+  std::size_t guess(float t) const {
+    const double g = std::floor((t - m_t0) / m_dt);
+    const double last = static_cast<double>(m_time->size() - 2);
+    return static_cast<std::size_t>(g >= 0.0 ? std::min(g, last) : 0.0);
+  }
+
+  // Times are within dt/4 of the grid, so the guess is at most one off.
+  std::size_t correct(std::size_t i, float t) const {
+    const std::vector<float> &time = *m_time;
+    if (i > 0 && t < time[i]) {
+      --i;
+    } else if (i + 2 < time.size() && t >= time[i + 1]) {
+      ++i;
+    }
+    return i;
+  }
+
+  const DataLoader *m_loader;
+  std::string m_timeName;
+  std::vector<std::string> m_names;
+  const std::vector<float> *m_time = nullptr;
+  std::vector<Column> m_columns;
+  std::vector<float> m_blockTimes;
+  bool m_uniform = false;
+  double m_t0 = 0.0;
+  double m_dt = 0.0;
+};
@@ -0,0 +1,376 @@
+// deps/Live/SharedChannel.h
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Live {
+
+/**
+ * @brief Shared-memory layout of a named simulation channel
+ *
+ * A channel is one POSIX shared-memory segment: a header describing the
+ * columns followed by a power-of-two ring of fixed-size row slots. There is
+ * exactly one writer (the simulation) and any number of readers. Readers
+ * never write to the segment; each keeps its own cursor, so attaching a
+ * viewer costs the writer nothing.
+ *
+ * Every slot carries a sequence number (a per-slot seqlock): the writer sets
+ * it to 2n+1 while filling row n and to 2n+2 once the row is complete. A
+ * reader accepts row n only if it sees 2n+2 both before and after copying
+ * the values, which rejects torn or overwritten rows without locking.
+ */
+namespace shm {
+
+inline constexpr std::uint32_t kMagic = 0x43505348; // "CPSH"
+inline constexpr std::uint32_t kVersion = 1;
+inline constexpr std::size_t kMaxColumns = 16;
+inline constexpr std::size_t kColumnNameLength = 32;
+
+static_assert(std::atomic<double>::is_always_lock_free &&
+                  std::atomic<std::uint64_t>::is_always_lock_free,
+              "shared-memory channels need address-free atomics");
+
+struct Header {
+  std::atomic<std::uint32_t> magic;
+  std::uint32_t version;
+  std::uint32_t columnCount;
+  std::uint32_t reserved;
+  std::uint64_t capacity;
+  std::array<std::array<char, kColumnNameLength>, kMaxColumns> columns;
+  alignas(64) std::atomic<std::uint64_t> writeIndex;
+  std::atomic<std::uint32_t> closed;
+};
+
+struct alignas(64) Slot {
+  std::atomic<std::uint64_t> sequence;
+  std::array<std::atomic<double>, kMaxColumns> values;
+};
+
+inline std::size_t segmentSize(std::uint64_t capacity) {
+  return sizeof(Header) + (static_cast<std::size_t>(capacity) * sizeof(Slot));
+}
+
+inline Slot *slots(void *base) {
+  return reinterpret_cast<Slot *>(static_cast<char *>(base) + sizeof(Header));
+}
+
+inline std::string segmentName(const std::string &name) {
+  return (!name.empty() && name.front() == '/') ? name : "/" + name;
+}
+
+inline std::runtime_error error(const std::string &what,
+                                const std::string &name) {
+  return std::runtime_error(what + " '" + name + "': " + std::strerror(errno));
+}
+
+} // namespace shm
+
+/**
+ * @brief Publishes simulation rows into a named shared-memory channel
+ *
+ * publish() is a handful of relaxed stores and never makes a system call or
+ * waits for readers; a reader that falls more than capacity rows behind
+ * skips ahead. The segment is unlinked when the writer is destroyed, readers
+ * that are already attached keep their mapping until they detach.
+ */
+class SharedChannelWriter {
+public:
+  SharedChannelWriter(const std::string &name,
+                      const std::vector<std::string> &columns,
+                      std::uint64_t capacity = 1U << 16)
+      : m_name(shm::segmentName(name)) {
+#if defined(_WIN32)
+    (void)columns;
+    (void)capacity;
+    throw std::runtime_error("Shared-memory channels require POSIX");
+#else
+    if (columns.empty() || columns.size() > shm::kMaxColumns) {
+      throw std::invalid_argument("Channel needs 1.." +
+                                  std::to_string(shm::kMaxColumns) +
+                                  " columns");
+    }
+    capacity = std::bit_ceil(std::max<std::uint64_t>(capacity, 2));
+    m_size = shm::segmentSize(capacity);
+
+    const int fd = ::shm_open(m_name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+      throw shm::error("Could not create shared memory", m_name);
+    }
+    if (::ftruncate(fd, static_cast<off_t>(m_size)) != 0) {
+      ::close(fd);
+      ::shm_unlink(m_name.c_str());
+      throw shm::error("Could not size shared memory", m_name);
+    }
+    m_base = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m_base == MAP_FAILED) {
+      m_base = nullptr;
+      ::shm_unlink(m_name.c_str());
+      throw shm::error("Could not map shared memory", m_name);
+    }
+
+    // ftruncate zero-fills, so the atomics start out as 0.
+    m_header = static_cast<shm::Header *>(m_base);
+    m_header->version = shm::kVersion;
+    m_header->columnCount = static_cast<std::uint32_t>(columns.size());
+    m_header->capacity = capacity;
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+      auto &dst = m_header->columns[i];
+      const std::size_t n = std::min(columns[i].size(), dst.size() - 1);
+      std::memcpy(dst.data(), columns[i].data(), n);
+      dst[n] = '\0';
+    }
+    m_slots = shm::slots(m_base);
+    m_mask = capacity - 1;
+    m_columnCount = columns.size();
+    // Readers refuse the segment until the magic is visible.
+    m_header->magic.store(shm::kMagic, std::memory_order_release);
+#endif
+  }
+
+  SharedChannelWriter(const SharedChannelWriter &) = delete;
+  SharedChannelWriter &operator=(const SharedChannelWriter &) = delete;
+
+  ~SharedChannelWriter() {
+#if !defined(_WIN32)
+    if (m_base != nullptr) {
+      m_header->closed.store(1, std::memory_order_release);
+      ::munmap(m_base, m_size);
+      ::shm_unlink(m_name.c_str());
+    }
+#endif
+  }
+
+  void publish(std::span<const double> row) {
+    const std::uint64_t n = m_next++;
+    shm::Slot &slot = m_slots[n & m_mask];
+    slot.sequence.store((2 * n) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    const std::size_t count = std::min(row.size(), m_columnCount);
+    for (std::size_t i = 0; i < count; ++i) {
+      slot.values[i].store(row[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store((2 * n) + 2, std::memory_order_release);
+    m_header->writeIndex.store(n + 1, std::memory_order_release);
+  }
+
+  void publish(std::initializer_list<double> row) {
+    publish(std::span<const double>(row.begin(), row.size()));
+  }
+
+  const std::string &name() const { return m_name; }
+
+private:
+  std::string m_name;
+  void *m_base = nullptr;
+  std::size_t m_size = 0;
+  shm::Header *m_header = nullptr;
+  shm::Slot *m_slots = nullptr;
+  std::uint64_t m_mask = 0;
+  std::uint64_t m_next = 0;
+  std::size_t m_columnCount = 0;
+};
+
+/**
+ * @brief Read-only view of a channel created by SharedChannelWriter
+ *
+ * A new reader starts at the oldest row still held in the ring, so a viewer
+ * attached mid-run also sees the recent history. poll() only reads shared
+ * memory; it never blocks and never makes a system call.
+ */
+class SharedChannelReader {
+public:
+  explicit SharedChannelReader(const std::string &name)
+      : m_name(shm::segmentName(name)) {
+#if defined(_WIN32)
+    throw std::runtime_error("Shared-memory channels require POSIX");
+#else
+    const int fd = ::shm_open(m_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      throw shm::error("Could not open shared memory", m_name);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 ||
+        static_cast<std::size_t>(st.st_size) < sizeof(shm::Header)) {
+      ::close(fd);
+      throw std::runtime_error("Shared memory '" + m_name +
+                               "' is not initialised yet");
+    }
+    m_size = static_cast<std::size_t>(st.st_size);
+    m_base = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m_base == MAP_FAILED) {
+      m_base = nullptr;
+      throw shm::error("Could not map shared memory", m_name);
+    }
+
+    m_header = static_cast<const shm::Header *>(m_base);
+    if (m_header->magic.load(std::memory_order_acquire) != shm::kMagic ||
+        m_header->version != shm::kVersion ||
+        m_header->columnCount > shm::kMaxColumns ||
+        !std::has_single_bit(m_header->capacity) ||
+        m_size < shm::segmentSize(m_header->capacity)) {
+      ::munmap(m_base, m_size);
+      m_base = nullptr;
+      throw std::runtime_error("Shared memory '" + m_name +
+                               "' is not a simulation channel");
+    }
+
+    m_slots = shm::slots(m_base);
+    m_mask = m_header->capacity - 1;
+    for (std::uint32_t i = 0; i < m_header->columnCount; ++i) {
+      m_columns.emplace_back(m_header->columns[i].data());
+    }
+    const std::uint64_t written =
+        m_header->writeIndex.load(std::memory_order_acquire);
+    m_cursor = written > m_header->capacity ? written - m_header->capacity : 0;
+#endif
+  }
+
+  SharedChannelReader(const SharedChannelReader &) = delete;
+  SharedChannelReader &operator=(const SharedChannelReader &) = delete;
+
+  ~SharedChannelReader() {
+#if !defined(_WIN32)
+    if (m_base != nullptr) {
+      ::munmap(m_base, m_size);
+    }
+#endif
+  }
+
+  const std::vector<std::string> &columns() const { return m_columns; }
+
+  /**
+   * @brief Deliver up to maxRows new rows to fn(std::span<const double>)
+   * @return Number of rows delivered
+   */
+  template <typename Fn> std::size_t poll(Fn &&fn, std::size_t maxRows = ~0U) {
+    const std::uint64_t written =
+        m_header->writeIndex.load(std::memory_order_acquire);
+    if (written - m_cursor > m_header->capacity) {
+      m_skipped += written - m_header->capacity - m_cursor;
+      m_cursor = written - m_header->capacity;
+    }
+
+    std::array<double, shm::kMaxColumns> row{};
+    const std::size_t count = m_columns.size();
+    std::size_t delivered = 0;
+    while (m_cursor < written && delivered < maxRows) {
+      const std::uint64_t n = m_cursor++;
+      const shm::Slot &slot = m_slots[n & m_mask];
+      const std::uint64_t expected = (2 * n) + 2;
+      if (slot.sequence.load(std::memory_order_acquire) != expected) {
+        ++m_skipped; // already overwritten by a newer row
+        continue;
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        row[i] = slot.values[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+        ++m_skipped;
+        continue;
+      }
+      fn(std::span<const double>(row.data(), count));
+      ++delivered;
+    }
+    return delivered;
+  }
+
+  // True once the writer has gone away and every row has been read.
+  bool finished() const {
+    return m_header->closed.load(std::memory_order_acquire) != 0 &&
+           m_cursor >= m_header->writeIndex.load(std::memory_order_acquire);
+  }
+
+  std::uint64_t skipped() const { return m_skipped; }
+  const std::string &name() const { return m_name; }
+
+private:
+  std::string m_name;
+  void *m_base = nullptr;
+  std::size_t m_size = 0;
+  const shm::Header *m_header = nullptr;
+  const shm::Slot *m_slots = nullptr;
+  std::uint64_t m_mask = 0;
+  std::uint64_t m_cursor = 0;
+  std::uint64_t m_skipped = 0;
+  std::vector<std::string> m_columns;
+};
+
+/**
+ * @brief Output options shared by the chapter executables
+ *
+ *   --shm <name>   also publish every row to the shared-memory channel <name>
+ *   --no-file      skip the .dat file (useful together with --shm)
+ *   --compress     write the .dat file in the compressed column format of
+ *                  deps/DataLoader/ColumnCodec.h (read back by DataLoader);
+ *                  only executables that pass compressible = true to parse()
+ *                  write it, the others reject the option
+ */
+struct OutputOptions {
+  std::string channel;
+  bool writeFile = true;
+  bool compress = false;
+
+  // Throws std::invalid_argument for --compress unless compressible.
+  static OutputOptions parse(int argc, char *argv[],
+                             bool compressible = false) {
+    OutputOptions options;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--shm" && i + 1 < argc) {
+        options.channel = argv[++i];
+      } else if (arg == "--no-file") {
+        options.writeFile = false;
+      } else if (arg == "--compress") {
+        if (!compressible) {
+          throw std::invalid_argument(
+              "--compress is not supported by this program");
+        }
+        options.compress = true;
+      }
+    }
+    return options;
+  }
+
+  // nullptr when no channel was requested; throws if it cannot be created.
+  std::unique_ptr<SharedChannelWriter>
+  openChannel(const std::vector<std::string> &columns) const {
+    if (channel.empty()) {
+      return nullptr;
+    }
+    return std::make_unique<SharedChannelWriter>(channel, columns);
+  }
+
+  template <typename Columns>
+  std::unique_ptr<SharedChannelWriter>
+  openChannel(const Columns &columns) const {
+    return openChannel(
+        std::vector<std::string>(std::begin(columns), std::end(columns)));
+  }
+};
+
+} // namespace Live
@@ -0,0 +1,170 @@
+// deps/Live/SimulationWorker.h
+
+#pragma once
+
+#include "SpscRing.h"
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+namespace Live {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief One published simulation row plus the bookkeeping the viewer needs
+ * to decimate and to measure sample-to-screen latency
+ */
+template <std::size_t N> struct Sample {
+  std::array<double, N> row{};
+  std::uint64_t step = 0;
+  Clock::time_point published{};
+  bool last = false;
+};
+
+/**
+ * @brief Runs a simulation kernel on its own thread and publishes its rows
+ * through a wait-free SPSC ring
+ *
+ * The physics never waits for the viewer. When a push fails because the
+ * ring is full, the worker doubles its publishing stride (only every
+ * stride-th step is offered to the ring) and keeps integrating. Once the
+ * viewer has caught up and the ring is nearly empty, the stride is halved
+ * again. The final row is always delivered.
+ *
+ * With realTimeFactor > 0 the worker paces simulated time against the wall
+ * clock (column 0 of every kernel row is time); 0 runs flat out.
+ */
+template <typename Kernel> class SimulationWorker {
+public:
+  static constexpr std::size_t kColumns =
+      std::tuple_size_v<typename Kernel::Row>;
+  using SampleType = Sample<kColumns>;
+
+  static constexpr std::size_t kMaxStride = std::size_t{1} << 16;
+
+  explicit SimulationWorker(Kernel kernel, std::size_t capacity = 1U << 14,
+                            double realTimeFactor = 1.0)
+      : m_kernel(std::move(kernel)), m_ring(capacity),
+        m_realTimeFactor(realTimeFactor) {}
+
+  SimulationWorker(const SimulationWorker &) = delete;
+  SimulationWorker &operator=(const SimulationWorker &) = delete;
+
+  ~SimulationWorker() { stop(); }
+
+  void start() {
+    if (!m_thread.joinable()) {
+      m_thread = std::thread([this] { run(); });
+    }
+  }
+
+  void stop() {
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    if (m_thread.joinable()) {
+      m_thread.join();
+    }
+  }
+
+  SpscRing<SampleType> &ring() { return m_ring; }
+
+  bool finished() const { return m_finished.load(std::memory_order_acquire); }
+  std::size_t stride() const {
+    return m_stride.load(std::memory_order_relaxed);
+  }
+  std::uint64_t published() const {
+    return m_published.load(std::memory_order_relaxed);
+  }
+  std::uint64_t dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  Kernel m_kernel;
+  SpscRing<SampleType> m_ring;
+  double m_realTimeFactor;
+  std::thread m_thread;
+
+  std::atomic<bool> m_stopRequested{false};
+  std::atomic<bool> m_finished{false};
+  std::atomic<std::size_t> m_stride{1};
+  std::atomic<std::uint64_t> m_published{0};
+  std::atomic<std::uint64_t> m_dropped{0};
+
+  SampleType makeSample(bool last) const {
+    SampleType sample;
+    sample.row = m_kernel.row();
+    sample.step = m_kernel.stepIndex();
+    sample.published = Clock::now();
+    sample.last = last;
+    return sample;
+  }
+
+  void publish(std::size_t &stride) {
+    if (m_ring.tryPush(makeSample(false))) {
+      m_published.fetch_add(1, std::memory_order_relaxed);
+      if (stride > 1 && m_ring.size() < m_ring.capacity() / 8) {
+        stride /= 2;
+        m_stride.store(stride, std::memory_order_relaxed);
+      }
+      return;
+    }
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+    stride = std::min(stride * 2, kMaxStride);
+    m_stride.store(stride, std::memory_order_relaxed);
+  }
+
+  void pace(const Clock::time_point &wallStart, double simStart) const {
+    if (m_realTimeFactor <= 0.0) {
+      return;
+    }
+    const double simElapsed = (m_kernel.row()[0] - simStart) / m_realTimeFactor;
+    const auto due =
+        wallStart + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double>(simElapsed));
+    if (due - Clock::now() > std::chrono::milliseconds(1)) {
+      std::this_thread::sleep_until(due);
+    }
+  }
+
+  void run() {
+    CP_TRACE_THREAD_NAME("simulation");
+    CP_TRACE_SCOPE("SimulationWorker::run");
+    const auto wallStart = Clock::now();
+    const double simStart = m_kernel.row()[0];
+    std::size_t stride = 1;
+
+    while (!m_kernel.done() &&
+           !m_stopRequested.load(std::memory_order_relaxed)) {
+      if (m_kernel.stepIndex() % stride == 0) {
+        publish(stride);
+        pace(wallStart, simStart);
+      }
+      m_kernel.step();
+    }
+
+    // The physics is finished, so waiting here no longer stalls anything.
+    // A stop abandons the last sample, which is then not counted.
+    const SampleType last = makeSample(true);
+    while (true) {
+      if (m_ring.tryPush(last)) {
+        m_published.fetch_add(1, std::memory_order_relaxed);
+        break;
+      }
+      if (m_stopRequested.load(std::memory_order_relaxed)) {
+        break;
+      }
+      std::this_thread::yield();
+    }
+    m_finished.store(true, std::memory_order_release);
+  }
+};
+
+} // namespace Live
@@ -0,0 +1,110 @@
+// deps/Live/SpscRing.h
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+
+namespace Live {
+
+// Fixed instead of std::hardware_destructive_interference_size, which is
+// not available on every standard library we build with.
+inline constexpr std::size_t kCacheLine = 64;
+
+/**
+ * @brief Wait-free single-producer / single-consumer ring buffer
+ *
+ * Exactly one thread may call tryPush() and exactly one other thread may
+ * call tryPop()/drain(). Neither side ever blocks or spins: a full ring
+ * makes tryPush() return false and leaves the decision (drop, decimate,
+ * retry) to the producer.
+ *
+ * Each side keeps a private copy of the other side's index and only
+ * reloads the shared atomic when the cached value says the ring is
+ * full/empty, so in steady state a push or pop touches a single shared
+ * cache line.
+ */
+template <typename T> class SpscRing {
+public:
+  explicit SpscRing(std::size_t capacity)
+      : m_capacity(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity)),
+        m_mask(m_capacity - 1), m_slots(std::make_unique<T[]>(m_capacity)) {}
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // Producer side
+  bool tryPush(const T &value) {
+    const std::size_t head = m_producer.head.load(std::memory_order_relaxed);
+    if (head - m_producer.cachedTail == m_capacity) {
+      m_producer.cachedTail = m_consumer.tail.load(std::memory_order_acquire);
+      if (head - m_producer.cachedTail == m_capacity) {
+        return false;
+      }
+    }
+    m_slots[head & m_mask] = value;
+    m_producer.head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool tryPop(T &value) {
+    const std::size_t tail = m_consumer.tail.load(std::memory_order_relaxed);
+    if (tail == m_consumer.cachedHead) {
+      m_consumer.cachedHead = m_producer.head.load(std::memory_order_acquire);
+      if (tail == m_consumer.cachedHead) {
+        return false;
+      }
+    }
+    value = m_slots[tail & m_mask];
+    m_consumer.tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Pop up to maxItems elements, invoking fn(const T&) for each
+   * @return Number of elements consumed
+   */
+  template <typename Fn> std::size_t drain(std::size_t maxItems, Fn &&fn) {
+    const std::size_t tail = m_consumer.tail.load(std::memory_order_relaxed);
+    m_consumer.cachedHead = m_producer.head.load(std::memory_order_acquire);
+    std::size_t available = m_consumer.cachedHead - tail;
+    if (available > maxItems) {
+      available = maxItems;
+    }
+    for (std::size_t i = 0; i < available; ++i) {
+      fn(m_slots[(tail + i) & m_mask]);
+    }
+    m_consumer.tail.store(tail + available, std::memory_order_release);
+    return available;
+  }
+
+  // Approximate when called concurrently with push/pop
+  std::size_t size() const {
+    const std::size_t head = m_producer.head.load(std::memory_order_acquire);
+    const std::size_t tail = m_consumer.tail.load(std::memory_order_acquire);
+    return head - tail;
+  }
+
+  std::size_t capacity() const { return m_capacity; }
+
+private:
+  struct alignas(kCacheLine) ProducerIndex {
+    std::atomic<std::size_t> head{0};
+    std::size_t cachedTail = 0;
+  };
+  struct alignas(kCacheLine) ConsumerIndex {
+    std::atomic<std::size_t> tail{0};
+    std::size_t cachedHead = 0;
+  };
+
+  const std::size_t m_capacity;
+  const std::size_t m_mask;
+  std::unique_ptr<T[]> m_slots;
+  ProducerIndex m_producer;
+  ConsumerIndex m_consumer;
+};
+
+} // namespace Live
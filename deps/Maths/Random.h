@@ -0,0 +1,163 @@
+// deps/Maths/Random.h
+
+#pragma once
+
+#include <PhysicsSimd.h>
+#include <Pragmas.h>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+
+namespace Rng {
+
+/**
+ * @brief Philox4x32-10 counter-based random numbers (Salmon et al., SC'11)
+ *
+ * A counter-based generator has no state to advance: the random words are
+ * a keyed bijection of a 128-bit counter, ten rounds of two 32x32->64
+ * multiplications. Variate i of stream s is therefore a pure function of
+ * (seed, s, i), so a Monte Carlo ensemble split over any number of threads
+ * draws exactly the same numbers for every sample, and a batch of
+ * consecutive variates is a loop without a dependency chain that the
+ * compiler vectorizes.
+ *
+ * Each counter {i, s} yields four 32-bit words: two uniform doubles (53
+ * bits each, in the open interval (0, 1)) or two Gaussians by Box-Muller.
+ * Variate i of a stream comes from counter i / 2. The uniform and normal
+ * variates of one stream share their words, so draw independent
+ * quantities from different streams.
+ */
+class Philox {
+public:
+  using Counter = std::array<std::uint32_t, 4>;
+
+  explicit Philox(std::uint64_t seed = 0)
+      : m_key0(static_cast<std::uint32_t>(seed)),
+        m_key1(static_cast<std::uint32_t>(seed >> 32)) {}
+
+  /** @brief The keyed bijection itself: ten Philox rounds of counter */
+  Counter operator()(Counter counter) const {
+    std::uint32_t key0 = m_key0;
+    std::uint32_t key1 = m_key1;
+    for (int round = 0; round < kRounds; ++round) {
+      const std::uint64_t p0 = std::uint64_t{kM0} * counter[0];
+      const std::uint64_t p1 = std::uint64_t{kM1} * counter[2];
+      counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key0,
+                 static_cast<std::uint32_t>(p1),
+                 static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key1,
+                 static_cast<std::uint32_t>(p0)};
+      key0 += kW0;
+      key1 += kW1;
+    }
+    return counter;
+  }
+
+  /** @brief Uniform variate index of stream, in (0, 1) */
+  double uniform(std::uint64_t stream, std::uint64_t index) const {
+    const Counter words = (*this)(counter(stream, index / 2));
+    return index % 2 == 0 ? toUnit(words[0], words[1])
+                          : toUnit(words[2], words[3]);
+  }
+
+  /** @brief Standard normal variate index of stream */
+  double normal(std::uint64_t stream, std::uint64_t index) const {
+    const Counter words = (*this)(counter(stream, index / 2));
+    double a = 0.0;
+    double b = 0.0;
+    boxMuller(words, a, b);
+    return index % 2 == 0 ? a : b;
+  }
+
+  /** @brief Uniform variates first, first + 1, ... of stream into out */
+  void uniform(std::uint64_t stream, std::uint64_t first,
+               std::span<double> out) const {
+    fill(stream, first, out, &Philox::uniform,
+         [](const Counter &words, double &a, double &b) {
+           a = toUnit(words[0], words[1]);
+           b = toUnit(words[2], words[3]);
+         });
+  }
+
+  /** @brief Standard normal variates first, first + 1, ... of stream */
+  void normal(std::uint64_t stream, std::uint64_t first,
+              std::span<double> out) const {
+    fill(stream, first, out, &Philox::normal,
+         [](const Counter &words, double &a, double &b) {
+           boxMuller(words, a, b);
+         });
+  }
+
+private:
+  static constexpr int kRounds = 10;
+  static constexpr std::uint32_t kM0 = 0xD2511F53;
+  static constexpr std::uint32_t kM1 = 0xCD9E8D57;
+  static constexpr std::uint32_t kW0 = 0x9E3779B9; // golden ratio
+  static constexpr std::uint32_t kW1 = 0xBB67AE85; // sqrt(3) - 1
+
+  static Counter counter(std::uint64_t stream, std::uint64_t block) {
+    return {static_cast<std::uint32_t>(block),
+            static_cast<std::uint32_t>(block >> 32),
+            static_cast<std::uint32_t>(stream),
+            static_cast<std::uint32_t>(stream >> 32)};
+  }
+
+  // Top 53 bits of hi:lo, centred in their interval: never 0 or 1.
+  static double toUnit(std::uint32_t hi, std::uint32_t lo) {
+    const std::uint64_t bits =
+        ((std::uint64_t{hi} << 32) | std::uint64_t{lo}) >> 11;
+    return (static_cast<double>(bits) + 0.5) * 0x1.0p-53;
+  }
+
+  // Both Box-Muller variates of one counter, with the lane kernels of
+  // PhysicsSimd.h. u is in (0, 1), -2 log(u) in (1e-16, 75) and the
+  // angle in (0, 2 pi), all inside the kernels' fast domains, so their libm
+  // fallbacks are not needed. The radius is exp(log(.) / 2) rather than
+  // std::sqrt, whose errno branch would keep the loop scalar.
+  static void boxMuller(const Counter &words, double &a, double &b) {
+    using Phy::simd::Accuracy;
+    using Phy::simd::lane::exp;
+    using Phy::simd::lane::log;
+    const double u = toUnit(words[0], words[1]);
+    const double r2 = -2.0 * log<Accuracy::Ulp1>(u);
+    const double r = exp<Accuracy::Ulp1>(0.5 * log<Accuracy::Ulp1>(r2));
+    double s = 0.0;
+    double c = 0.0;
+    Phy::simd::lane::sincos<Accuracy::Ulp1>(
+        2.0 * std::numbers::pi * toUnit(words[2], words[3]), s, c);
+    a = r * c;
+    b = r * s;
+  }
+
+  // Whole counters in one vectorizable loop; an odd variate at either end
+  // goes through the scalar path.
+  template <typename Pair>
+  void fill(std::uint64_t stream, std::uint64_t first, std::span<double> out,
+            double (Philox::*single)(std::uint64_t, std::uint64_t) const,
+            Pair pair) const {
+    std::size_t k = 0;
+    if (first % 2 == 1 && k < out.size()) {
+      out[k] = (this->*single)(stream, first);
+      ++k;
+    }
+    const std::uint64_t block = (first + k) / 2;
+    const std::size_t pairs = (out.size() - k) / 2;
+    double *target = out.data() + k;
+    CP_SIMD
+    for (std::size_t p = 0; p < pairs; ++p) {
+      const Counter words = (*this)(counter(stream, block + p));
+      pair(words, target[2 * p], target[(2 * p) + 1]);
+    }
+    k += 2 * pairs;
+    if (k < out.size()) {
+      out[k] = (this->*single)(stream, first + k);
+    }
+  }
+
+  std::uint32_t m_key0;
+  std::uint32_t m_key1;
+};
+
+} // namespace Rng
@@ -0,0 +1,196 @@
+// deps/Maths/RootFinding.h
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace Roots {
+
+/** @brief Result of minimize(): the abscissa and the function value */
+struct Minimum {
+  double x;
+  double fx;
+};
+
+/**
+ * @brief Root of f in [a, b] by Brent's method (Brent 1973, zeroin)
+ *
+ * f(a) = fa and f(b) = fb must not have the same sign. Each iteration takes
+ * an inverse quadratic or secant step when it stays inside the bracket and
+ * shrinks it fast enough, and a bisection step otherwise, so convergence is
+ * superlinear on smooth functions and never slower than bisection. Stops
+ * when the bracket is narrower than 4 eps |x| + 2 tolerance.
+ *
+ * @throws std::invalid_argument if [a, b] does not bracket a root
+ */
+template <typename F>
+double brent(F f, double a, double b, double fa, double fb,
+             double tolerance = 0.0, int maxIterations = 100) {
+  if (fa == 0.0) {
+    return a;
+  }
+  if (fb == 0.0) {
+    return b;
+  }
+  if ((fa > 0.0) == (fb > 0.0)) {
+    throw std::invalid_argument("root is not bracketed");
+  }
+  constexpr double eps = std::numeric_limits<double>::epsilon();
+  double c = a;
+  double fc = fa;
+  double d = b - a;
+  double e = d;
+  for (int i = 0; i < maxIterations; ++i) {
+    // b is the best estimate and [b, c] the bracket.
+    if ((fb > 0.0) == (fc > 0.0)) {
+      c = a;
+      fc = fa;
+      d = b - a;
+      e = d;
+    }
+    if (std::abs(fc) < std::abs(fb)) {
+      a = b;
+      b = c;
+      c = a;
+      fa = fb;
+      fb = fc;
+      fc = fa;
+    }
+    const double tol = (2.0 * eps * std::abs(b)) + tolerance;
+    const double m = 0.5 * (c - b);
+    if (std::abs(m) <= tol || fb == 0.0) {
+      return b;
+    }
+    if (std::abs(e) >= tol && std::abs(fa) > std::abs(fb)) {
+      const double s = fb / fa;
+      double p = 0.0;
+      double q = 0.0;
+      if (a == c) {
+        p = 2.0 * m * s;
+        q = 1.0 - s;
+      } else {
+        const double r = fb / fc;
+        const double t = fa / fc;
+        p = s * ((2.0 * m * t * (t - r)) - ((b - a) * (r - 1.0)));
+        q = (t - 1.0) * (r - 1.0) * (s - 1.0);
+      }
+      if (p > 0.0) {
+        q = -q;
+      } else {
+        p = -p;
+      }
+      if (2.0 * p < std::min((3.0 * m * q) - std::abs(tol * q),
+                             std::abs(e * q))) {
+        e = d;
+        d = p / q;
+      } else {
+        d = m;
+        e = d;
+      }
+    } else {
+      d = m;
+      e = d;
+    }
+    a = b;
+    fa = fb;
+    b += std::abs(d) > tol ? d : (m > 0.0 ? tol : -tol);
+    fb = f(b);
+  }
+  return b;
+}
+
+/** @brief brent() with f evaluated at the ends of the bracket */
+template <typename F>
+double brent(F f, double a, double b, double tolerance = 0.0) {
+  return brent(f, a, b, f(a), f(b), tolerance);
+}
+
+/**
+ * @brief Minimum of f on [a, b] by Brent's method (Brent 1973, localmin)
+ *
+ * Golden-section steps with parabolic interpolation. Finds the global
+ * minimum of a unimodal f; otherwise a local one. Stops when the minimum is
+ * known to within sqrt(eps) |x| + tolerance.
+ */
+template <typename F>
+Minimum minimize(F f, double a, double b, double tolerance = 0.0,
+                 int maxIterations = 100) {
+  if (b < a) {
+    std::swap(a, b);
+  }
+  const double golden = 0.5 * (3.0 - std::sqrt(5.0));
+  const double relative = std::sqrt(std::numeric_limits<double>::epsilon());
+  double x = a + (golden * (b - a));
+  double w = x;
+  double v = x;
+  double fx = f(x);
+  double fw = fx;
+  double fv = fx;
+  double d = 0.0;
+  double e = 0.0;
+  for (int i = 0; i < maxIterations; ++i) {
+    const double m = 0.5 * (a + b);
+    const double tol = (relative * std::abs(x)) + tolerance + 1e-300;
+    const double tol2 = 2.0 * tol;
+    if (std::abs(x - m) <= tol2 - (0.5 * (b - a))) {
+      break;
+    }
+    bool goldenStep = true;
+    if (std::abs(e) > tol) {
+      // Parabola through x, w and v.
+      double r = (x - w) * (fx - fv);
+      double q = (x - v) * (fx - fw);
+      double p = ((x - v) * q) - ((x - w) * r);
+      q = 2.0 * (q - r);
+      if (q > 0.0) {
+        p = -p;
+      } else {
+        q = -q;
+      }
+      r = e;
+      e = d;
+      if (std::abs(p) < std::abs(0.5 * q * r) && p > q * (a - x) &&
+          p < q * (b - x)) {
+        d = p / q;
+        const double u = x + d;
+        if (u - a < tol2 || b - u < tol2) {
+          d = x < m ? tol : -tol;
+        }
+        goldenStep = false;
+      }
+    }
+    if (goldenStep) {
+      e = (x < m ? b : a) - x;
+      d = golden * e;
+    }
+    const double u = x + (std::abs(d) >= tol ? d : (d > 0.0 ? tol : -tol));
+    const double fu = f(u);
+    if (fu <= fx) {
+      (u < x ? b : a) = x;
+      v = w;
+      fv = fw;
+      w = x;
+      fw = fx;
+      x = u;
+      fx = fu;
+    } else {
+      (u < x ? a : b) = u;
+      if (fu <= fw || w == x) {
+        v = w;
+        fv = fw;
+        w = u;
+        fw = fu;
+      } else if (fu <= fv || v == x || v == w) {
+        v = u;
+        fv = fu;
+      }
+    }
+  }
+  return {x, fx};
+}
+
+} // namespace Roots
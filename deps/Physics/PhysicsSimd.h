@@ -0,0 +1,766 @@
+// PhysicsSimd.h
+
+#pragma once
+
+#include "Pragmas.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @file PhysicsSimd.h
+ * @brief Vectorizable sincos, exp, log and pow for float and double
+ *
+ * The libm functions are opaque calls, so loops over std::sin or std::exp
+ * stay scalar. The kernels here are branch-free polynomial evaluations
+ * written so the compiler can vectorize a loop over them; the batch
+ * overloads (taking spans) are the intended entry points.
+ *
+ * Every function comes in two accuracy tiers:
+ * - Accuracy::Ulp1: at most 1 ULP error (float: computed in double)
+ * - Accuracy::Ulp4: at most 4 ULP error, cheaper (float: computed in float)
+ *
+ * Arguments outside a kernel's fast domain (huge sin/cos arguments,
+ * exp/pow overflow and underflow, non-positive or subnormal log arguments,
+ * NaN and infinity) are handed to the corresponding std:: function, so the
+ * results always match libm's special-case behaviour. The bounds are
+ * checked by `benchmarks --verify-ulp`.
+ *
+ * The kernels rely on strict IEEE evaluation order; do not build them with
+ * -ffast-math.
+ */
+
+namespace Phy::simd {
+
+enum class Accuracy { Ulp1, Ulp4 };
+
+namespace detail {
+
+template <typename T> constexpr T kNaN = std::numeric_limits<T>::quiet_NaN();
+
+// Branch-free `condition ? a : b`. With plain ternaries GCC jump-threads the
+// out-of-domain path into real branches, which it then refuses to if-convert
+// under the default -ftrapping-math, and the loops stay scalar.
+template <std::floating_point T> inline T select(bool condition, T a, T b) {
+  using Bits = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+  const Bits mask = Bits{0} - static_cast<Bits>(condition);
+  return std::bit_cast<T>((std::bit_cast<Bits>(a) & mask) |
+                          (std::bit_cast<Bits>(b) & ~mask));
+}
+
+// Adding 1.5 * 2^52 rounds to the nearest integer and leaves it in the low
+// mantissa bits (valid for |v| < 2^51).
+constexpr double kRoundShift = 0x1.8p52;
+constexpr float kRoundShiftF = 0x1.8p23F;
+
+inline std::int64_t roundedBits(double shifted) {
+  return static_cast<std::int64_t>(std::bit_cast<std::uint64_t>(shifted) &
+                                   0x000fffffffffffffULL) -
+         (std::int64_t{1} << 51);
+}
+
+inline std::int32_t roundedBits(float shifted) {
+  return static_cast<std::int32_t>(std::bit_cast<std::uint32_t>(shifted) &
+                                   0x007fffffU) -
+         (std::int32_t{1} << 22);
+}
+
+// 2^k for -1022 <= k <= 1023
+inline double pow2(std::int64_t k) {
+  return std::bit_cast<double>(static_cast<std::uint64_t>(k + 1023) << 52);
+}
+
+// 2^k for -126 <= k <= 127
+inline float pow2(std::int32_t k) {
+  return std::bit_cast<float>(static_cast<std::uint32_t>(k + 127) << 23);
+}
+
+// Error-free transformations (Knuth TwoSum, Dekker TwoProduct). Where the
+// target has a fast FMA the compiler may contract a * b - c on its own,
+// which breaks Dekker's splitting, so the FMA is used directly instead.
+inline void twoSum(double a, double b, double &sum, double &err) {
+  sum = a + b;
+  const double bv = sum - a;
+  err = (a - (sum - bv)) + (b - bv);
+}
+
+#if defined(FP_FAST_FMA)
+inline double twoProductError(double a, double b, double product) {
+  return std::fma(a, b, -product);
+}
+#else
+inline void split(double a, double &hi, double &lo) {
+  const double c = 134217729.0 * a; // 2^27 + 1
+  hi = c - (c - a);
+  lo = a - hi;
+}
+
+inline double twoProductError(double a, double b, double product) {
+  double ah = 0.0;
+  double al = 0.0;
+  double bh = 0.0;
+  double bl = 0.0;
+  split(a, ah, al);
+  split(b, bh, bl);
+  return (((ah * bh - product) + (ah * bl)) + (al * bh)) + (al * bl);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// exp
+//-----------------------------------------------------------------------------
+
+constexpr double kLog2e = 1.44269504088896338700e+00;
+constexpr double kLn2Hi = 6.93147180369123816490e-01;
+constexpr double kLn2Lo = 1.90821492927058770002e-10;
+constexpr double kExpMax = 708.0;
+
+/**
+ * @brief exp(x + xlo) for |x| <= kExpMax, NaN otherwise. xlo is a small
+ * tail (|xlo| < 2^-40 |x|) carried by pow.
+ */
+template <Accuracy A> inline double expKernel(double x, double xlo) {
+  const bool inDomain = std::abs(x) <= kExpMax;
+  const double xs = select(inDomain, x, 0.0);
+  const double shifted = (xs * kLog2e) + kRoundShift;
+  const double kd = shifted - kRoundShift;
+  const double hi = xs - (kd * kLn2Hi);
+  const double lo = (kd * kLn2Lo) - xlo;
+  const double r = hi - lo;
+  double y = 0.0;
+  if constexpr (A == Accuracy::Ulp1) {
+    // Remez rational form of FreeBSD's e_exp.c, error < 1 ULP.
+    constexpr double P1 = 1.66666666666666019037e-01;
+    constexpr double P2 = -2.77777777770155933842e-03;
+    constexpr double P3 = 6.61375632143793436117e-05;
+    constexpr double P4 = -1.65339022054652515390e-06;
+    constexpr double P5 = 4.13813679705723846039e-08;
+    const double z = r * r;
+    const double c =
+        r - (z * (P1 + (z * (P2 + (z * (P3 + (z * (P4 + (z * P5)))))))));
+    y = 1.0 - ((lo - ((r * c) / (2.0 - c))) - hi);
+  } else {
+    // Degree 13 Taylor polynomial, no division.
+    double p = 1.0 / 6227020800.0;
+    p = (p * r) + (1.0 / 479001600.0);
+    p = (p * r) + (1.0 / 39916800.0);
+    p = (p * r) + (1.0 / 3628800.0);
+    p = (p * r) + (1.0 / 362880.0);
+    p = (p * r) + (1.0 / 40320.0);
+    p = (p * r) + (1.0 / 5040.0);
+    p = (p * r) + (1.0 / 720.0);
+    p = (p * r) + (1.0 / 120.0);
+    p = (p * r) + (1.0 / 24.0);
+    p = (p * r) + (1.0 / 6.0);
+    p = (p * r) + 0.5;
+    y = 1.0 + (r + ((r * r) * p));
+  }
+  const double result = y * pow2(roundedBits(shifted));
+  return select(inDomain, result, kNaN<double>);
+}
+
+/**
+ * @brief exp(x + xlo) for |x| <= kExpMax with the tail fully used, NaN
+ * otherwise. The reduced argument and 1 + expm1(r) are carried in double
+ * double so only the final rounding is visible (error < 0.7 ULP).
+ */
+inline double expKernelDD(double x, double xlo) {
+  const bool inDomain = std::abs(x) <= kExpMax;
+  const double xs = select(inDomain, x, 0.0);
+  const double xt = select(inDomain, xlo, 0.0);
+  const double shifted = (xs * kLog2e) + kRoundShift;
+  const double kd = shifted - kRoundShift;
+  // xs - kd * ln2Hi is exact; the tail collects everything else.
+  double r = 0.0;
+  double rlo = 0.0;
+  twoSum(xs - (kd * kLn2Hi), xt - (kd * kLn2Lo), r, rlo);
+  // Degree 14 Taylor polynomial for (e^r - 1 - r) / r^2.
+  double p = 1.0 / 87178291200.0;
+  p = (p * r) + (1.0 / 6227020800.0);
+  p = (p * r) + (1.0 / 479001600.0);
+  p = (p * r) + (1.0 / 39916800.0);
+  p = (p * r) + (1.0 / 3628800.0);
+  p = (p * r) + (1.0 / 362880.0);
+  p = (p * r) + (1.0 / 40320.0);
+  p = (p * r) + (1.0 / 5040.0);
+  p = (p * r) + (1.0 / 720.0);
+  p = (p * r) + (1.0 / 120.0);
+  p = (p * r) + (1.0 / 24.0);
+  p = (p * r) + (1.0 / 6.0);
+  p = (p * r) + 0.5;
+  double head = 0.0;
+  double err = 0.0;
+  twoSum(1.0, r, head, err);
+  const double y = head + (err + (((r * r) * p) + (rlo * (1.0 + r))));
+  const double result = y * pow2(roundedBits(shifted));
+  return select(inDomain, result, kNaN<double>);
+}
+
+inline float expKernelF(float x) {
+  // Cephes expf, error < 2 ULP.
+  constexpr float kMax = 87.0F;
+  const bool inDomain = std::abs(x) <= kMax;
+  const float xs = select(inDomain, x, 0.0F);
+  const float shifted = (xs * 1.44269504088896341F) + kRoundShiftF;
+  const float n = shifted - kRoundShiftF;
+  const float r = (xs - (n * 0.693359375F)) - (n * -2.12194440e-4F);
+  const float z = r * r;
+  float p = 1.9875691500E-4F;
+  p = (p * r) + 1.3981999507E-3F;
+  p = (p * r) + 8.3334519073E-3F;
+  p = (p * r) + 4.1665795894E-2F;
+  p = (p * r) + 1.6666665459E-1F;
+  p = (p * r) + 5.0000001201E-1F;
+  const float y = ((p * z) + r) + 1.0F;
+  const float result = y * pow2(roundedBits(shifted));
+  return select(inDomain, result, kNaN<float>);
+}
+
+//-----------------------------------------------------------------------------
+// log
+//-----------------------------------------------------------------------------
+
+constexpr double kLg1 = 6.666666666666735130e-01;
+constexpr double kLg2 = 3.999999999940941908e-01;
+constexpr double kLg3 = 2.857142874366239149e-01;
+constexpr double kLg4 = 2.222219843214978396e-01;
+constexpr double kLg5 = 1.818357216161805012e-01;
+constexpr double kLg6 = 1.531383769920937332e-01;
+constexpr double kLg7 = 1.479819860511658591e-01;
+
+inline bool logDomain(double x) {
+  // & rather than && keeps the check branch-free.
+  return (x >= std::numeric_limits<double>::min()) &
+         (x <= std::numeric_limits<double>::max());
+}
+
+/**
+ * @brief Splits x = 2^k * (1 + f) with 1 + f in [sqrt(2)/2, sqrt(2)); f is
+ * exact. Only valid for positive normal x.
+ */
+inline void logReduce(double x, double &k, double &f) {
+  constexpr std::uint64_t kSqrtHalf = 0x3fe6a09e667f3bcdULL;
+  const std::uint64_t ix =
+      std::bit_cast<std::uint64_t>(x) + (0x3ff0000000000000ULL - kSqrtHalf);
+  // Converts the biased exponent to double without an int64 conversion.
+  k = std::bit_cast<double>((ix >> 52) | 0x4330000000000000ULL) -
+      (4503599627370496.0 + 1023.0);
+  f = std::bit_cast<double>((ix & 0x000fffffffffffffULL) + kSqrtHalf) - 1.0;
+}
+
+// R(s) in log(1 + f) = 2s + s * R(s), from FreeBSD's e_log.c
+inline double logRemainder(double s) {
+  const double z = s * s;
+  const double w = z * z;
+  const double t1 = w * (kLg2 + (w * (kLg4 + (w * kLg6))));
+  const double t2 = z * (kLg1 + (w * (kLg3 + (w * (kLg5 + (w * kLg7))))));
+  return t2 + t1;
+}
+
+template <Accuracy A> inline double logKernel(double x) {
+  const bool inDomain = logDomain(x);
+  double k = 0.0;
+  double f = 0.0;
+  logReduce(select(inDomain, x, 1.0), k, f);
+  const double s = f / (2.0 + f);
+  const double R = logRemainder(s);
+  const double hfsq = 0.5 * f * f;
+  double result = 0.0;
+  if constexpr (A == Accuracy::Ulp1) {
+    result = (k * kLn2Hi) - ((hfsq - ((s * (hfsq + R)) + (k * kLn2Lo))) - f);
+  } else {
+    result = (k * (kLn2Hi + kLn2Lo)) + ((f - hfsq) + (s * (hfsq + R)));
+  }
+  return select(inDomain, result, kNaN<double>);
+}
+
+/**
+ * @brief log(x) as hi + lo with about 2^-64 relative error, for pow
+ *
+ * Uses log(1 + f) = 2s + (2/3)s^3 + s^5 R'(s^2) with s = f / (2 + f). s and
+ * the cubic term are carried in double double; the remaining series terms
+ * are small enough for plain double.
+ */
+inline void logKernelDD(double x, double &hi, double &lo) {
+  double k = 0.0;
+  double f = 0.0;
+  logReduce(x, k, f);
+  double d = 0.0;
+  double dlo = 0.0;
+  twoSum(2.0, f, d, dlo);
+  const double s = f / d;
+  const double sd = s * d;
+  const double residual = ((f - sd) - twoProductError(s, d, sd)) - (s * dlo);
+  const double slo = residual / d;
+
+  // (2/3) s^3 in double double.
+  constexpr double kTwoThirdsHi = 6.66666666666666629659e-01;
+  constexpr double kTwoThirdsLo = 3.70074341541718826536e-17;
+  const double s2 = s * s;
+  const double s2lo = twoProductError(s, s, s2);
+  const double s3 = s2 * s;
+  const double s3lo = twoProductError(s2, s, s3) + (s2lo * s);
+  const double cubic = kTwoThirdsHi * s3;
+  const double cubicLo = twoProductError(kTwoThirdsHi, s3, cubic) +
+                         ((kTwoThirdsHi * s3lo) + (kTwoThirdsLo * s3));
+
+  // Taylor terms 2 s^(2j) / (2j + 1), j = 2..11; truncation < 2^-67.
+  double r = 2.0 / 23.0;
+  r = (r * s2) + (2.0 / 21.0);
+  r = (r * s2) + (2.0 / 19.0);
+  r = (r * s2) + (2.0 / 17.0);
+  r = (r * s2) + (2.0 / 15.0);
+  r = (r * s2) + (2.0 / 13.0);
+  r = (r * s2) + (2.0 / 11.0);
+  r = (r * s2) + (2.0 / 9.0);
+  r = (r * s2) + (2.0 / 7.0);
+  r = (r * s2) + (2.0 / 5.0);
+  const double tail = cubicLo + ((2.0 * slo) * (1.0 + s2)) +
+                      (s * ((s2 * s2) * r)) + (k * kLn2Lo);
+
+  // k * ln2Hi is exact (ln2Hi has 32 significant bits, |k| < 2^11).
+  double head = 0.0;
+  double err1 = 0.0;
+  twoSum(k * kLn2Hi, 2.0 * s, head, err1);
+  double sum = 0.0;
+  double err2 = 0.0;
+  twoSum(head, cubic, sum, err2);
+  const double low = (err1 + err2) + tail;
+  hi = sum + low;
+  lo = low - (hi - sum);
+}
+
+inline float logKernelF(float x) {
+  // Cephes logf, error < 2 ULP.
+  const bool inDomain = (x >= std::numeric_limits<float>::min()) &
+                        (x <= std::numeric_limits<float>::max());
+  constexpr std::uint32_t kSqrtHalf = 0x3f3504f3U;
+  const std::uint32_t ix =
+      std::bit_cast<std::uint32_t>(select(inDomain, x, 1.0F)) +
+      (0x3f800000U - kSqrtHalf);
+  const auto k = static_cast<float>(static_cast<std::int32_t>(ix >> 23) - 127);
+  const float f = std::bit_cast<float>((ix & 0x007fffffU) + kSqrtHalf) - 1.0F;
+  const float z = f * f;
+  float p = 7.0376836292E-2F;
+  p = (p * f) - 1.1514610310E-1F;
+  p = (p * f) + 1.1676998740E-1F;
+  p = (p * f) - 1.2420140846E-1F;
+  p = (p * f) + 1.4249322787E-1F;
+  p = (p * f) - 1.6668057665E-1F;
+  p = (p * f) + 2.0000714765E-1F;
+  p = (p * f) - 2.4999993993E-1F;
+  p = (p * f) + 3.3333331174E-1F;
+  float y = p * f * z;
+  y += k * -2.12194440e-4F;
+  y += -0.5F * z;
+  const float result = (f + y) + (k * 0.693359375F);
+  return select(inDomain, result, kNaN<float>);
+}
+
+//-----------------------------------------------------------------------------
+// pow
+//-----------------------------------------------------------------------------
+
+template <Accuracy A> inline double powKernel(double x, double y) {
+  const bool inDomain = logDomain(x) & (std::abs(y) <= 0x1p900);
+  double lhi = 0.0;
+  double llo = 0.0;
+  logKernelDD(select(inDomain, x, 1.0), lhi, llo);
+  const double yv = select(inDomain, y, 0.0);
+  const double phi = yv * lhi;
+  const double plo = twoProductError(yv, lhi, phi) + (yv * llo);
+  // Out-of-range exponents come back as NaN from the exp kernels.
+  double result = 0.0;
+  if constexpr (A == Accuracy::Ulp1) {
+    result = expKernelDD(phi, plo);
+  } else {
+    result = expKernel<A>(phi, plo);
+  }
+  return select(inDomain, result, kNaN<double>);
+}
+
+//-----------------------------------------------------------------------------
+// sincos
+//-----------------------------------------------------------------------------
+
+constexpr double kInvPio2 = 6.36619772367581382433e-01;
+constexpr double kPio2_1 = 1.57079632673412561417e+00;  // first 33 bits
+constexpr double kPio2_2 = 6.07710050630396597660e-11;  // next 33 bits
+constexpr double kPio2_3 = 2.02226624871116645580e-21;  // next 33 bits
+constexpr double kPio2_3t = 8.47842766036889956997e-32; // pi/2 - (1 + 2 + 3)
+constexpr double kSinCosMax = 0x1p19 * 1.57079632679489661923;
+
+constexpr double kS1 = -1.66666666666666324348e-01;
+constexpr double kS2 = 8.33333333332248946124e-03;
+constexpr double kS3 = -1.98412698298579493134e-04;
+constexpr double kS4 = 2.75573137070700676789e-06;
+constexpr double kS5 = -2.50507602534068634195e-08;
+constexpr double kS6 = 1.58969099521155010221e-10;
+
+constexpr double kC1 = 4.16666666666666019037e-02;
+constexpr double kC2 = -1.38888888888741095749e-03;
+constexpr double kC3 = 2.48015872894767294178e-05;
+constexpr double kC4 = -2.75573143513906633035e-07;
+constexpr double kC5 = 2.08757232129817482790e-09;
+constexpr double kC6 = -1.13596475577881948265e-11;
+
+/**
+ * @brief Quadrant-corrected sin and cos from sin(r) and cos(r), where
+ * x = r + q * pi / 2
+ */
+template <typename T>
+inline void applyQuadrant(std::int64_t q, T sinR, T cosR, T &s, T &c) {
+  const bool swap = (q & 1) != 0;
+  const T sv = select(swap, cosR, sinR);
+  const T cv = select(swap, sinR, cosR);
+  s = select((q & 2) != 0, -sv, sv);
+  c = select(((q + 1) & 2) != 0, -cv, cv);
+}
+
+template <Accuracy A> inline void sincosKernel(double x, double &s, double &c) {
+  const bool inDomain = std::abs(x) <= kSinCosMax;
+  const double xs = select(inDomain, x, 0.0);
+  const double shifted = (xs * kInvPio2) + kRoundShift;
+  const double n = shifted - kRoundShift;
+  // n has at most 20 bits, so n * kPio2_1 and n * kPio2_2 are exact.
+  const double r1 = xs - (n * kPio2_1);
+  double r = 0.0;
+  double rlo = 0.0;
+  double sinR = 0.0;
+  double cosR = 0.0;
+  if constexpr (A == Accuracy::Ulp1) {
+    // FreeBSD's k_sin.c / k_cos.c with the reduced argument as r + rlo.
+    double head = 0.0;
+    double err = 0.0;
+    twoSum(r1, -(n * kPio2_2), head, err);
+    const double tail = err - ((n * kPio2_3) + (n * kPio2_3t));
+    r = head + tail;
+    rlo = tail - (r - head);
+
+    const double z = r * r;
+    const double w = z * z;
+    const double v = z * r;
+    const double sr =
+        kS2 + (z * (kS3 + (z * kS4))) + (z * w * (kS5 + (z * kS6)));
+    sinR = r - (((z * ((0.5 * rlo) - (v * sr))) - rlo) - (v * kS1));
+
+    const double cr = (z * (kC1 + (z * (kC2 + (z * kC3))))) +
+                      (w * w * (kC4 + (z * (kC5 + (z * kC6)))));
+    const double hz = 0.5 * z;
+    const double one = 1.0 - hz;
+    cosR = one + (((1.0 - one) - hz) + ((z * cr) - (r * rlo)));
+  } else {
+    r = (r1 - (n * kPio2_2)) - (n * kPio2_3);
+    const double z = r * r;
+    const double sp =
+        kS1 + (z * (kS2 + (z * (kS3 + (z * (kS4 + (z * (kS5 + (z * kS6)))))))));
+    sinR = r + (r * z * sp);
+    const double cp =
+        kC1 + (z * (kC2 + (z * (kC3 + (z * (kC4 + (z * (kC5 + (z * kC6)))))))));
+    cosR = (1.0 - (0.5 * z)) + (z * z * cp);
+  }
+  applyQuadrant(roundedBits(shifted), sinR, cosR, s, c);
+  s = select(inDomain, s, kNaN<double>);
+  c = select(inDomain, c, kNaN<double>);
+}
+
+inline void sincosKernelF(float x, float &s, float &c) {
+  // Cephes sinf / cosf polynomials, error < 2 ULP.
+  constexpr float kMax = 8192.0F;
+  const bool inDomain = std::abs(x) <= kMax;
+  const float xs = select(inDomain, x, 0.0F);
+  const float shifted = (xs * 0.636619772367581343F) + kRoundShiftF;
+  const float n = shifted - kRoundShiftF;
+  // pi/2 in four parts; the first three have at most 11 significant bits,
+  // so their products with n (|n| < 2^13) are exact.
+  const float r = (((xs - (n * 0x1.92p0F)) - (n * 0x1.fb4p-12F)) -
+                   (n * 0x1.444p-24F)) -
+                  (n * 0x1.68c234p-39F);
+  const float z = r * r;
+  const float sinR =
+      r + (r * z *
+           ((((-1.9515295891E-4F * z) + 8.3321608736E-3F) * z) -
+            1.6666654611E-1F));
+  const float cosR =
+      (1.0F - (0.5F * z)) +
+      (z * z *
+       ((((2.443315711809948E-5F * z) - 1.388731625493765E-3F) * z) +
+        4.166664568298827E-2F));
+  applyQuadrant(roundedBits(shifted), sinR, cosR, s, c);
+  s = select(inDomain, s, kNaN<float>);
+  c = select(inDomain, c, kNaN<float>);
+}
+
+//-----------------------------------------------------------------------------
+// Tier dispatch. float Ulp1 is evaluated through the double Ulp4 kernels:
+// a 4 ULP double result rounds to a correctly rounded float almost always
+// and is within 1 ULP always.
+//-----------------------------------------------------------------------------
+
+template <Accuracy A> inline double exp(double x) {
+  return expKernel<A>(x, 0.0);
+}
+template <Accuracy A> inline float exp(float x) {
+  if constexpr (A == Accuracy::Ulp1) {
+    return static_cast<float>(expKernel<Accuracy::Ulp4>(x, 0.0));
+  } else {
+    return expKernelF(x);
+  }
+}
+
+template <Accuracy A> inline double log(double x) { return logKernel<A>(x); }
+template <Accuracy A> inline float log(float x) {
+  if constexpr (A == Accuracy::Ulp1) {
+    return static_cast<float>(logKernel<Accuracy::Ulp4>(x));
+  } else {
+    return logKernelF(x);
+  }
+}
+
+template <Accuracy A> inline double pow(double x, double y) {
+  return powKernel<A>(x, y);
+}
+// float pow always goes through double: the exponent y * log(x) needs the
+// extra bits for the result to stay within 1 ULP.
+template <Accuracy A> inline float pow(float x, float y) {
+  const double lx = logKernel<Accuracy::Ulp4>(x);
+  const double result = expKernel<Accuracy::Ulp4>(
+      static_cast<double>(y) * select(std::isnan(lx), 0.0, lx), 0.0);
+  return select(std::isnan(lx), kNaN<float>, static_cast<float>(result));
+}
+
+template <Accuracy A> inline void sincos(double x, double &s, double &c) {
+  sincosKernel<A>(x, s, c);
+}
+template <Accuracy A> inline void sincos(float x, float &s, float &c) {
+  if constexpr (A == Accuracy::Ulp1) {
+    double sd = 0.0;
+    double cd = 0.0;
+    sincosKernel<Accuracy::Ulp4>(x, sd, cd);
+    s = static_cast<float>(sd);
+    c = static_cast<float>(cd);
+  } else {
+    sincosKernelF(x, s, c);
+  }
+}
+
+// Blocks keep the kernel output in cache for the libm fix-up pass and make
+// in-place calls (out aliasing x) safe.
+constexpr std::size_t kBlock = 256;
+
+inline void checkSizes(std::size_t expected, std::size_t actual) {
+  if (expected != actual) {
+    throw std::invalid_argument("Phy::simd: span sizes differ");
+  }
+}
+
+} // namespace detail
+
+/** @brief The scalars with kernels: float and double */
+template <typename T>
+concept Vectorizable = std::same_as<T, float> || std::same_as<T, double>;
+
+//-----------------------------------------------------------------------------
+// Scalar entry points (kernel + libm fallback). Other floating-point types
+// (long double) go to the std:: function directly, so generic code can call
+// these for any scalar.
+//-----------------------------------------------------------------------------
+
+template <Accuracy A = Accuracy::Ulp1, std::floating_point T> T exp(T x) {
+  if constexpr (!Vectorizable<T>) {
+    return std::exp(x);
+  } else {
+    const T result = detail::exp<A>(x);
+    return std::isnan(result) ? std::exp(x) : result;
+  }
+}
+
+template <Accuracy A = Accuracy::Ulp1, std::floating_point T> T log(T x) {
+  if constexpr (!Vectorizable<T>) {
+    return std::log(x);
+  } else {
+    const T result = detail::log<A>(x);
+    return std::isnan(result) ? std::log(x) : result;
+  }
+}
+
+template <Accuracy A = Accuracy::Ulp1, std::floating_point T>
+T pow(T x, T y) {
+  if constexpr (!Vectorizable<T>) {
+    return std::pow(x, y);
+  } else {
+    const T result = detail::pow<A>(x, y);
+    return std::isnan(result) ? std::pow(x, y) : result;
+  }
+}
+
+template <Accuracy A = Accuracy::Ulp1, std::floating_point T>
+void sincos(T x, T &s, T &c) {
+  if constexpr (Vectorizable<T>) {
+    detail::sincos<A>(x, s, c);
+    if (!std::isnan(s)) {
+      return;
+    }
+  }
+  s = std::sin(x);
+  c = std::cos(x);
+}
+
+//-----------------------------------------------------------------------------
+// Lane entry points: the bare kernels, branch-free and without the libm
+// fallback, for callers that vectorize a loop of their own (CP_SIMD) around
+// them. Outside a kernel's fast domain they return NaN; the caller keeps its
+// arguments inside it or fixes those lanes up afterwards.
+//-----------------------------------------------------------------------------
+
+namespace lane {
+
+template <Accuracy A = Accuracy::Ulp1, Vectorizable T> T exp(T x) {
+  return detail::exp<A>(x);
+}
+
+template <Accuracy A = Accuracy::Ulp1, Vectorizable T> T log(T x) {
+  return detail::log<A>(x);
+}
+
+template <Accuracy A = Accuracy::Ulp1, Vectorizable T> T pow(T x, T y) {
+  return detail::pow<A>(x, y);
+}
+
+template <Accuracy A = Accuracy::Ulp1, Vectorizable T>
+void sincos(T x, T &s, T &c) {
+  detail::sincos<A>(x, s, c);
+}
+
+/** @brief `condition ? a : b` without a branch that would stop vectorization */
+template <std::floating_point T> T select(bool condition, T a, T b) {
+  return detail::select(condition, a, b);
+}
+
+} // namespace lane
+
+//-----------------------------------------------------------------------------
+// Batch entry points: out[i] = f(x[i]). out may alias x.
+//-----------------------------------------------------------------------------
+
+namespace detail {
+
+template <typename T, typename Kernel, typename Fallback>
+void map(std::span<const T> x, std::span<T> out, Kernel kernel,
+         Fallback fallback) {
+  checkSizes(x.size(), out.size());
+  std::array<T, kBlock> block{};
+  for (std::size_t first = 0; first < x.size(); first += kBlock) {
+    const std::size_t count = std::min(kBlock, x.size() - first);
+    const T *in = x.data() + first;
+    CP_SIMD
+    for (std::size_t i = 0; i < count; ++i) {
+      block[i] = kernel(in[i]);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      out[first + i] = std::isnan(block[i]) ? fallback(in[i]) : block[i];
+    }
+  }
+}
+
+template <Accuracy A, typename T>
+void powBatch(std::span<const T> x, std::span<const T> y, std::span<T> out) {
+  checkSizes(x.size(), y.size());
+  checkSizes(x.size(), out.size());
+  std::array<T, kBlock> block{};
+  for (std::size_t first = 0; first < x.size(); first += kBlock) {
+    const std::size_t count = std::min(kBlock, x.size() - first);
+    const T *xs = x.data() + first;
+    const T *ys = y.data() + first;
+    CP_SIMD
+    for (std::size_t i = 0; i < count; ++i) {
+      block[i] = pow<A>(xs[i], ys[i]);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      out[first + i] =
+          std::isnan(block[i]) ? std::pow(xs[i], ys[i]) : block[i];
+    }
+  }
+}
+
+template <Accuracy A, typename T>
+void sincosBatch(std::span<const T> x, std::span<T> s, std::span<T> c) {
+  checkSizes(x.size(), s.size());
+  checkSizes(x.size(), c.size());
+  std::array<T, kBlock> sb{};
+  std::array<T, kBlock> cb{};
+  for (std::size_t first = 0; first < x.size(); first += kBlock) {
+    const std::size_t count = std::min(kBlock, x.size() - first);
+    const T *in = x.data() + first;
+    CP_SIMD
+    for (std::size_t i = 0; i < count; ++i) {
+      sincos<A>(in[i], sb[i], cb[i]);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      const T v = in[i];
+      const bool fallback = std::isnan(sb[i]);
+      s[first + i] = fallback ? std::sin(v) : sb[i];
+      c[first + i] = fallback ? std::cos(v) : cb[i];
+    }
+  }
+}
+
+} // namespace detail
+
+template <Accuracy A = Accuracy::Ulp1>
+void exp(std::span<const double> x, std::span<double> out) {
+  detail::map<double>(
+      x, out, [](double v) { return detail::exp<A>(v); },
+      [](double v) { return std::exp(v); });
+}
+template <Accuracy A = Accuracy::Ulp1>
+void exp(std::span<const float> x, std::span<float> out) {
+  detail::map<float>(
+      x, out, [](float v) { return detail::exp<A>(v); },
+      [](float v) { return std::exp(v); });
+}
+
+template <Accuracy A = Accuracy::Ulp1>
+void log(std::span<const double> x, std::span<double> out) {
+  detail::map<double>(
+      x, out, [](double v) { return detail::log<A>(v); },
+      [](double v) { return std::log(v); });
+}
+template <Accuracy A = Accuracy::Ulp1>
+void log(std::span<const float> x, std::span<float> out) {
+  detail::map<float>(
+      x, out, [](float v) { return detail::log<A>(v); },
+      [](float v) { return std::log(v); });
+}
+
+template <Accuracy A = Accuracy::Ulp1>
+void pow(std::span<const double> x, std::span<const double> y,
+         std::span<double> out) {
+  detail::powBatch<A, double>(x, y, out);
+}
+template <Accuracy A = Accuracy::Ulp1>
+void pow(std::span<const float> x, std::span<const float> y,
+         std::span<float> out) {
+  detail::powBatch<A, float>(x, y, out);
+}
+
+template <Accuracy A = Accuracy::Ulp1>
+void sincos(std::span<const double> x, std::span<double> s,
+            std::span<double> c) {
+  detail::sincosBatch<A, double>(x, s, c);
+}
+template <Accuracy A = Accuracy::Ulp1>
+void sincos(std::span<const float> x, std::span<float> s,
+            std::span<float> c) {
+  detail::sincosBatch<A, float>(x, s, c);
+}
+
+} // namespace Phy::simd
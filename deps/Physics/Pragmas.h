@@ -0,0 +1,30 @@
+// Pragmas.h
+
+#pragma once
+
+/**
+ * @file Pragmas.h
+ * @brief OpenMP pragmas that compile away in builds without OpenMP
+ *
+ * CP_SIMD marks a loop for vectorization (`#pragma omp simd`); without
+ * OpenMP the compiler's auto-vectorizer still handles the branch-free loops
+ * it is used on. CP_OMP(directive) emits `#pragma directive`, e.g.
+ * CP_OMP(omp parallel for), and nothing without OpenMP, where the loop runs
+ * serially. Both may be defined by the build to override them.
+ */
+
+#ifndef CP_SIMD
+#if defined(_OPENMP)
+#define CP_SIMD _Pragma("omp simd")
+#else
+#define CP_SIMD
+#endif
+#endif
+
+#ifndef CP_OMP
+#if defined(_OPENMP)
+#define CP_OMP(directive) _Pragma(#directive)
+#else
+#define CP_OMP(directive)
+#endif
+#endif
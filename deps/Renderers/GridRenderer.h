@@ -1,13 +1,20 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <Trace.h>
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 
 class GridRenderer {
 public:
   void renderGrid(sf::RenderWindow &window) {
-    sf::View currentView = window.getView();
+    update(window.getView());
+    draw(window);
+  }
+
+  // Rebuilds the grid if the view changed; returns true if it did.
+  bool update(const sf::View &currentView) {
     sf::Vector2f viewSize = currentView.getSize();
     sf::Vector2f viewCenter = currentView.getCenter();
 
@@ -17,34 +24,29 @@ public:
       lastViewSize = viewSize;
       lastViewCenter = viewCenter;
       needsUpdate = false;
+      return true;
     }
+    return false;
+  }
 
-    window.draw(secondaryLines);
-    window.draw(primaryLines);
-    window.draw(axisLines);
+  void draw(sf::RenderTarget &target) const {
+    target.draw(secondaryLines);
+    target.draw(primaryLines);
+    target.draw(axisLines);
   }
 
   void invalidate() { needsUpdate = true; }
 
-private:
-  sf::VertexArray primaryLines;
-  sf::VertexArray secondaryLines;
-  sf::VertexArray axisLines;
-
-  sf::Vector2f lastViewSize{0, 0};
-  sf::Vector2f lastViewCenter{0, 0};
-  bool needsUpdate = true;
-
-  const float primaryStep = 100.0F;
-  const float secondaryStep = 20.0F;
-  const int primaryLineFactor = 5;
-
-  const sf::Color primaryColor{100, 100, 100, 205};
-  const sf::Color secondaryColor{60, 60, 60, 155};
-  const sf::Color xAxisColor{118, 178, 23, 215};
-  const sf::Color yAxisColor{205, 56, 79, 215};
+  size_t getVertexCount() const {
+    return primaryLines.getVertexCount() + secondaryLines.getVertexCount() +
+           axisLines.getVertexCount();
+  }
+  size_t getMemoryBytes() const {
+    return getVertexCount() * sizeof(sf::Vertex);
+  }
 
   void buildGrid(const sf::View &view) {
+    CP_TRACE_SCOPE("GridRenderer::buildGrid");
     primaryLines.clear();
     secondaryLines.clear();
     axisLines.clear();
@@ -111,4 +113,22 @@ private:
       }
     }
   }
+
+private:
+  sf::VertexArray primaryLines;
+  sf::VertexArray secondaryLines;
+  sf::VertexArray axisLines;
+
+  sf::Vector2f lastViewSize{0, 0};
+  sf::Vector2f lastViewCenter{0, 0};
+  bool needsUpdate = true;
+
+  const float primaryStep = 100.0F;
+  const float secondaryStep = 20.0F;
+  const int primaryLineFactor = 5;
+
+  const sf::Color primaryColor{100, 100, 100, 205};
+  const sf::Color secondaryColor{60, 60, 60, 155};
+  const sf::Color xAxisColor{118, 178, 23, 215};
+  const sf::Color yAxisColor{205, 56, 79, 215};
 };
\ No newline at end of file
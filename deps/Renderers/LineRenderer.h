@@ -3,6 +3,7 @@
 #pragma once
 
 #include <SFML/Graphics.hpp>
+#include <Trace.h>
 #include <cmath>
 #include <vector>
 
@@ -14,8 +15,9 @@ public:
 
   void setData(const std::vector<float> &Data1, const std::vector<float> &Data2,
                float scaleX = 1.0F, float scaleY = 1.0F) {
+    CP_TRACE_SCOPE("LineRenderer::setData");
     if (Data1.size() != Data2.size() || Data1.size() < 2) {
-      m_vertices.clear();
+      clear();
       return;
     }
 
@@ -30,13 +32,17 @@ public:
 
       createSegment(p1, p2, i * 6);
     }
+
+    m_lastPoint = sf::Vector2f(Data1.back() * scaleX, Data2.back() * scaleY);
+    m_hasLastPoint = true;
   }
 
   void appendPoint(float x, float y, float scaleX = 1.0F, float scaleY = 1.0F) {
     sf::Vector2f newPoint(x * scaleX, y * scaleY);
 
-    if (m_vertices.getVertexCount() == 0) {
+    if (!m_hasLastPoint) {
       m_lastPoint = newPoint;
+      m_hasLastPoint = true;
       return;
     }
 
@@ -51,8 +57,12 @@ public:
   void clear() {
     m_vertices.clear();
     m_lastPoint = sf::Vector2f();
+    m_hasLastPoint = false;
   }
   size_t getVertexCount() const { return m_vertices.getVertexCount(); }
+  size_t getMemoryBytes() const {
+    return m_vertices.getVertexCount() * sizeof(sf::Vertex);
+  }
 
   void draw(sf::RenderTarget &target,
             const sf::RenderStates &states = sf::RenderStates::Default) const {
@@ -64,6 +74,7 @@ public:
 private:
   sf::VertexArray m_vertices;
   sf::Vector2f m_lastPoint;
+  bool m_hasLastPoint = false;
   float m_thickness;
   sf::Color m_color = sf::Color(225, 225, 225, 128);
 
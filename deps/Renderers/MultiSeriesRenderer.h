@@ -0,0 +1,172 @@
+// deps/Renderers/MultiSeriesRenderer.h
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <Trace.h>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief N y columns plotted against one shared x column, drawn with a
+ * single draw call
+ *
+ * Every series is a thick line made of two triangles per segment, like
+ * LineRenderer. The difference is that all series share one vertex
+ * buffer: x is scaled once per sample for every series, and each segment
+ * writes the quads of all series next to each other. Appending a sample
+ * only appends to the end of the buffer, and draw() issues one call
+ * however many series there are.
+ */
+class MultiSeriesRenderer {
+public:
+  /** @brief Adds a series; returns its index in the ys of setData/append */
+  std::size_t addSeries(const sf::Color &color) {
+    if (m_samples > 0) {
+      throw std::logic_error("series must be added before data");
+    }
+    m_colors.push_back(color);
+    m_lastY.push_back(0.0F);
+    return m_colors.size() - 1;
+  }
+
+  std::size_t getSeriesCount() const { return m_colors.size(); }
+
+  void setThickness(float thickness) { m_thickness = thickness; }
+
+  /**
+   * @brief Replaces the data; ys holds one column per series, each as long
+   * as x
+   */
+  void setData(const std::vector<float> &x,
+               const std::vector<const std::vector<float> *> &ys,
+               float scaleX = 1.0F, float scaleY = 1.0F) {
+    CP_TRACE_SCOPE("MultiSeriesRenderer::setData");
+    if (ys.size() != m_colors.size()) {
+      throw std::invalid_argument("one y column per series expected");
+    }
+    m_samples = 0;
+    for (const auto *y : ys) {
+      if (y->size() != x.size()) {
+        m_vertices.clear();
+        return;
+      }
+    }
+    if (x.empty()) {
+      m_vertices.clear();
+      return;
+    }
+
+    // Resizing to the previous size (a redraw of the same data) neither
+    // reallocates nor rewrites the buffer before it is overwritten.
+    const std::size_t series = m_colors.size();
+    const std::size_t stride = series * kVerticesPerSegment;
+    m_vertices.resize((x.size() - 1) * stride);
+    const float halfThickness = m_thickness * 0.5F;
+    for (std::size_t s = 0; s < series; ++s) {
+      m_lastY[s] = (*ys[s])[0] * scaleY;
+    }
+    float x0 = x[0] * scaleX;
+    for (std::size_t i = 1; i < x.size(); ++i) {
+      const float x1 = x[i] * scaleX;
+      sf::Vertex *segment = m_vertices.data() + ((i - 1) * stride);
+      for (std::size_t s = 0; s < series; ++s) {
+        const float y1 = (*ys[s])[i] * scaleY;
+        createSegment({x0, m_lastY[s]}, {x1, y1}, m_colors[s], halfThickness,
+                      segment + (s * kVerticesPerSegment));
+        m_lastY[s] = y1;
+      }
+      x0 = x1;
+    }
+    m_lastX = x0;
+    m_samples = x.size();
+  }
+
+  /** @brief Appends one sample: ys[s] is the value of series s at x */
+  void append(float x, std::span<const float> ys, float scaleX = 1.0F,
+              float scaleY = 1.0F) {
+    if (ys.size() != m_colors.size()) {
+      throw std::invalid_argument("one y value per series expected");
+    }
+    const float x1 = x * scaleX;
+    if (m_samples == 0) {
+      m_lastX = x1;
+      for (std::size_t s = 0; s < ys.size(); ++s) {
+        m_lastY[s] = ys[s] * scaleY;
+      }
+      m_samples = 1;
+      return;
+    }
+    const std::size_t first = m_vertices.size();
+    m_vertices.resize(first + (ys.size() * kVerticesPerSegment));
+    for (std::size_t s = 0; s < ys.size(); ++s) {
+      const float y1 = ys[s] * scaleY;
+      createSegment({m_lastX, m_lastY[s]}, {x1, y1}, m_colors[s],
+                    m_thickness * 0.5F,
+                    &m_vertices[first + (s * kVerticesPerSegment)]);
+      m_lastY[s] = y1;
+    }
+    m_lastX = x1;
+    ++m_samples;
+  }
+
+  /** @brief Removes the data and keeps the series */
+  void clear() {
+    m_vertices.clear();
+    m_samples = 0;
+  }
+
+  size_t getVertexCount() const { return m_vertices.size(); }
+  size_t getMemoryBytes() const {
+    return m_vertices.capacity() * sizeof(sf::Vertex);
+  }
+
+  void draw(sf::RenderTarget &target,
+            const sf::RenderStates &states = sf::RenderStates::Default) const {
+    if (!m_vertices.empty()) {
+      target.draw(m_vertices.data(), m_vertices.size(),
+                  sf::PrimitiveType::Triangles, states);
+    }
+  }
+
+private:
+  static constexpr std::size_t kVerticesPerSegment = 6;
+
+  // Quad from p1 to p2. Static so the vertex stores cannot alias the
+  // renderer's members.
+  static void createSegment(sf::Vector2f p1, sf::Vector2f p2, sf::Color color,
+                            float halfThickness, sf::Vertex *out) {
+    const sf::Vector2f dir = p2 - p1;
+    const float length = std::sqrt((dir.x * dir.x) + (dir.y * dir.y));
+
+    if (length < 1e-6F) {
+      // Degenerate segment - create point
+      for (std::size_t j = 0; j < kVerticesPerSegment; ++j) {
+        out[j] = sf::Vertex(p1, color);
+      }
+      return;
+    }
+
+    const float scale = halfThickness / length;
+    const sf::Vector2f perp(-dir.y * scale, dir.x * scale);
+
+    // Two triangles forming the line segment
+    out[0] = sf::Vertex(p1 + perp, color);
+    out[1] = sf::Vertex(p1 - perp, color);
+    out[2] = sf::Vertex(p2 + perp, color);
+
+    out[3] = sf::Vertex(p1 - perp, color);
+    out[4] = sf::Vertex(p2 - perp, color);
+    out[5] = sf::Vertex(p2 + perp, color);
+  }
+
+  std::vector<sf::Vertex> m_vertices;
+  std::vector<sf::Color> m_colors;
+  std::vector<float> m_lastY; // scaled, per series
+  float m_lastX = 0.0F;       // scaled
+  std::size_t m_samples = 0;
+  float m_thickness = 1.0F;
+};
@@ -0,0 +1,211 @@
+// deps/Renderers/ParticleRenderer.h
+
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Draws up to millions of particles per frame from position columns
+ *
+ * update() writes every particle inside the view into one vertex buffer
+ * that only ever grows, so a steady particle count allocates nothing after
+ * the first frame, and draw() issues one draw call. Particles are either
+ * single-pixel points (one vertex each, for dense clouds; a million of
+ * them fit a 60 fps frame) or squares of the set radius (two triangles
+ * each, six times the vertex traffic). Colour comes from a per-particle
+ * value such as speed or energy, mapped through a kLutSize-entry colour
+ * table; without values every particle gets the same colour.
+ *
+ * Culling against the view is branchless: every particle is written, and
+ * the write position only advances past the visible ones.
+ */
+class ParticleRenderer {
+public:
+  enum class Shape { Point, Quad };
+
+  static constexpr std::size_t kLutSize = 256;
+  using ColorMap = std::array<sf::Color, kLutSize>;
+
+  /** @brief Table interpolating evenly spaced colour stops */
+  static ColorMap gradient(std::span<const sf::Color> stops) {
+    if (stops.empty()) {
+      throw std::invalid_argument("gradient needs at least one colour");
+    }
+    ColorMap map;
+    const auto segments = static_cast<float>(stops.size() - 1);
+    for (std::size_t i = 0; i < kLutSize; ++i) {
+      const float at =
+          static_cast<float>(i) / static_cast<float>(kLutSize - 1) * segments;
+      const std::size_t k = std::min(static_cast<std::size_t>(at),
+                                     stops.size() - 1);
+      const sf::Color a = stops[k];
+      const sf::Color b = stops[std::min(k + 1, stops.size() - 1)];
+      const float t = at - static_cast<float>(k);
+      const auto mix = [t](std::uint8_t from, std::uint8_t to) {
+        return static_cast<std::uint8_t>(std::lround(
+            static_cast<float>(from) +
+            (t * (static_cast<float>(to) - static_cast<float>(from)))));
+      };
+      map[i] = sf::Color(mix(a.r, b.r), mix(a.g, b.g), mix(a.b, b.b),
+                         mix(a.a, b.a));
+    }
+    return map;
+  }
+
+  /** @brief Blue (slow, cold) through green to red (fast, hot) */
+  static ColorMap heatMap() {
+    const std::array<sf::Color, 5> stops{
+        sf::Color(40, 80, 225), sf::Color(0, 205, 205), sf::Color(0, 205, 0),
+        sf::Color(225, 205, 0), sf::Color(225, 40, 0)};
+    return gradient(stops);
+  }
+
+  ParticleRenderer() : m_colorMap(heatMap()) {}
+
+  void setShape(Shape shape) { m_shape = shape; }
+  /** @brief Half the side of a Quad, in scaled (view) units */
+  void setRadius(float radius) { m_radius = radius; }
+  void setColor(const sf::Color &color) { m_color = color; }
+  void setColorMap(const ColorMap &colorMap) { m_colorMap = colorMap; }
+  /** @brief Values mapped to the first and the last colour of the map */
+  void setColorRange(float low, float high) {
+    m_low = low;
+    m_high = high;
+  }
+
+  /**
+   * @brief Rebuilds the vertices from particle positions (times scale)
+   *
+   * values is empty or holds one value per particle for the colour map.
+   * Particles whose square lies entirely outside view are skipped.
+   */
+  void update(std::span<const float> x, std::span<const float> y,
+              std::span<const float> values, const sf::View &view,
+              float scale = 1.0F) {
+    CP_TRACE_SCOPE("ParticleRenderer::update");
+    if (x.size() != y.size() ||
+        (!values.empty() && values.size() != x.size())) {
+      throw std::invalid_argument("one x, y (and value) per particle");
+    }
+    const std::size_t perParticle = m_shape == Shape::Point ? 1 : 6;
+    if (m_vertices.size() < x.size() * perParticle) {
+      m_vertices.resize(x.size() * perParticle);
+    }
+
+    // The view's height is negative when y points up.
+    const sf::Vector2f center = view.getCenter();
+    const float margin = m_shape == Shape::Point ? 0.0F : m_radius;
+    const float halfWidth = (std::abs(view.getSize().x) / 2.0F) + margin;
+    const float halfHeight = (std::abs(view.getSize().y) / 2.0F) + margin;
+    const float left = center.x - halfWidth;
+    const float right = center.x + halfWidth;
+    const float bottom = center.y - halfHeight;
+    const float top = center.y + halfHeight;
+
+    const Frame frame{left, right, bottom, top, scale};
+    const bool colored = !values.empty();
+    if (m_shape == Shape::Point) {
+      m_visible = colored ? write<Shape::Point, true>(x, y, values, frame)
+                          : write<Shape::Point, false>(x, y, values, frame);
+    } else {
+      m_visible = colored ? write<Shape::Quad, true>(x, y, values, frame)
+                          : write<Shape::Quad, false>(x, y, values, frame);
+    }
+    m_written = m_shape;
+  }
+
+  /** @brief Particles written by the last update() */
+  std::size_t getVisibleCount() const { return m_visible; }
+  std::size_t getVertexCount() const {
+    return m_visible * (m_written == Shape::Point ? 1 : 6);
+  }
+  std::size_t getMemoryBytes() const {
+    return m_vertices.capacity() * sizeof(sf::Vertex);
+  }
+
+  void draw(sf::RenderTarget &target,
+            const sf::RenderStates &states = sf::RenderStates::Default) const {
+    if (m_visible > 0) {
+      target.draw(m_vertices.data(), getVertexCount(),
+                  m_written == Shape::Point ? sf::PrimitiveType::Points
+                                          : sf::PrimitiveType::Triangles,
+                  states);
+    }
+  }
+
+private:
+  struct Frame {
+    float left;
+    float right;
+    float bottom;
+    float top;
+    float scale;
+  };
+
+  // One loop per shape and colouring, so the loop body has no branch.
+  template <Shape S, bool Colored>
+  std::size_t write(std::span<const float> x, std::span<const float> y,
+                    std::span<const float> values, const Frame &frame) {
+    constexpr std::size_t perParticle = S == Shape::Point ? 1 : 6;
+    const float range = m_high - m_low;
+    const float toIndex =
+        range > 0.0F ? static_cast<float>(kLutSize - 1) / range : 0.0F;
+    constexpr auto maxIndex = static_cast<float>(kLutSize - 1);
+    const float low = m_low;
+    const sf::Color *colorMap = m_colorMap.data();
+
+    sf::Vertex *out = m_vertices.data();
+    std::size_t visible = 0;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+      const sf::Vector2f p(x[i] * frame.scale, y[i] * frame.scale);
+      sf::Color color = m_color;
+      if constexpr (Colored) {
+        // NaN fails both comparisons and lands on the first colour.
+        const float at = (values[i] - low) * toIndex;
+        const float index = at > 0.0F ? std::min(at, maxIndex) : 0.0F;
+        color = colorMap[static_cast<int>(index)];
+      }
+      // & rather than &&: no branch to mispredict on scattered particles
+      const bool inside = (p.x >= frame.left) & (p.x <= frame.right) &
+                          (p.y >= frame.bottom) & (p.y <= frame.top);
+      sf::Vertex *vertex = out + (visible * perParticle);
+      if constexpr (S == Shape::Point) {
+        vertex->position = p;
+        vertex->color = color;
+      } else {
+        writeQuad(p, color, vertex);
+      }
+      visible += inside ? 1 : 0;
+    }
+    return visible;
+  }
+
+  void writeQuad(sf::Vector2f p, sf::Color color, sf::Vertex *out) const {
+    const float r = m_radius;
+    out[0] = sf::Vertex({p.x - r, p.y - r}, color);
+    out[1] = sf::Vertex({p.x + r, p.y - r}, color);
+    out[2] = sf::Vertex({p.x + r, p.y + r}, color);
+    out[3] = sf::Vertex({p.x - r, p.y - r}, color);
+    out[4] = sf::Vertex({p.x + r, p.y + r}, color);
+    out[5] = sf::Vertex({p.x - r, p.y + r}, color);
+  }
+
+  std::vector<sf::Vertex> m_vertices; // only grows
+  std::size_t m_visible = 0;
+  Shape m_shape = Shape::Point;
+  Shape m_written = Shape::Point; // shape of the vertices in the buffer
+  float m_radius = 2.0F;
+  sf::Color m_color = sf::Color(225, 225, 225);
+  ColorMap m_colorMap;
+  float m_low = 0.0F;
+  float m_high = 1.0F;
+};
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Toggleable (F3) on-screen frame profiler.
+ *
+ * Keeps a rolling history of frame times and of the CPU time spent in each
+ * frame section, and draws it as a stacked bar graph in the top left corner
+ * of the window together with p50/p99 frame times and the vertex count and
+ * memory held by every tracked renderer.
+ *
+ * Sections are timed with measure(); each section scope also records a trace
+ * event when the build has CP_ENABLE_TRACING, so call sites do not need a
+ * separate CP_TRACE_SCOPE.
+ *
+ * Text needs a font: $CP_OVERLAY_FONT is tried first, then a few common
+ * system fonts. Without one only the graph is drawn and the statistics are
+ * printed to stdout once per second while the overlay is visible.
+ */
+class ProfilerOverlay {
+public:
+  enum class Section : std::size_t { Events, Load, Grid, Vertices, Draw };
+  static constexpr std::size_t kSectionCount = 5;
+  static constexpr std::size_t kHistory = 240;
+
+  using Clock = std::chrono::steady_clock;
+
+  /** @brief RAII timer adding its lifetime to one section of this frame. */
+  class Scope {
+  public:
+    Scope(ProfilerOverlay &overlay, Section section)
+        : m_overlay(overlay), m_section(section), m_start(Clock::now())
+#if defined(CP_ENABLE_TRACING) && CP_ENABLE_TRACING
+          ,
+          m_trace(sectionName(section))
+#endif
+    {
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    ~Scope() {
+      const std::chrono::duration<float, std::milli> elapsed =
+          Clock::now() - m_start;
+      m_overlay.m_current[static_cast<std::size_t>(m_section)] +=
+          elapsed.count();
+    }
+
+  private:
+    ProfilerOverlay &m_overlay;
+    Section m_section;
+    Clock::time_point m_start;
+#if defined(CP_ENABLE_TRACING) && CP_ENABLE_TRACING
+    Trace::Scope m_trace;
+#endif
+  };
+
+  ProfilerOverlay() { loadFont(); }
+  ProfilerOverlay(const ProfilerOverlay &) = delete;
+  ProfilerOverlay &operator=(const ProfilerOverlay &) = delete;
+
+  static const char *sectionName(Section section) {
+    static constexpr std::array<const char *, kSectionCount> names{
+        "events", "load", "grid", "vertices", "draw"};
+    return names[static_cast<std::size_t>(section)];
+  }
+
+  Scope measure(Section section) { return {*this, section}; }
+
+  /** @brief Closes the previous frame and starts timing a new one. */
+  void beginFrame() {
+    const auto now = Clock::now();
+    if (m_hasFrame) {
+      const std::chrono::duration<float, std::milli> frame =
+          now - m_frameStart;
+      Frame &slot = m_frames[m_next];
+      slot.total = frame.count();
+      slot.sections = m_current;
+      m_next = (m_next + 1) % kHistory;
+      m_count = std::min(m_count + 1, kHistory);
+    }
+    m_current.fill(0.0F);
+    m_frameStart = now;
+    m_hasFrame = true;
+  }
+
+  /** @brief Handles the F3 toggle; returns true if the event was consumed. */
+  bool handleEvent(const sf::Event &event) {
+    if (const auto *key = event.getIf<sf::Event::KeyPressed>()) {
+      if (key->code == sf::Keyboard::Key::F3) {
+        m_visible = !m_visible;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool isVisible() const { return m_visible; }
+  void setVisible(bool visible) { m_visible = visible; }
+
+  /**
+   * @brief Adds a renderer to the memory report. It must expose
+   * getVertexCount() and getMemoryBytes() and outlive the overlay.
+   */
+  template <typename Renderer>
+  void track(std::string label, const Renderer &renderer) {
+    m_renderers.push_back({std::move(label), [&renderer] {
+                             return std::pair<std::size_t, std::size_t>{
+                                 renderer.getVertexCount(),
+                                 renderer.getMemoryBytes()};
+                           }});
+  }
+
+  void track(std::string label, const sf::VertexArray &vertices) {
+    m_renderers.push_back({std::move(label), [&vertices] {
+                             return std::pair<std::size_t, std::size_t>{
+                                 vertices.getVertexCount(),
+                                 vertices.getVertexCount() *
+                                     sizeof(sf::Vertex)};
+                           }});
+  }
+
+  float percentile(float p) const {
+    if (m_count == 0) {
+      return 0.0F;
+    }
+    m_scratch.clear();
+    for (std::size_t i = 0; i < m_count; ++i) {
+      m_scratch.push_back(m_frames[i].total);
+    }
+    const auto rank = static_cast<std::size_t>(
+        p * static_cast<float>(m_scratch.size() - 1) + 0.5F);
+    std::nth_element(m_scratch.begin(), m_scratch.begin() + rank,
+                     m_scratch.end());
+    return m_scratch[rank];
+  }
+
+  /** @brief Draws the overlay in window pixel coordinates. */
+  void draw(sf::RenderWindow &window) {
+    if (!m_visible) {
+      return;
+    }
+    CP_TRACE_SCOPE("ProfilerOverlay::draw");
+
+    const sf::View previous = window.getView();
+    const sf::Vector2u size = window.getSize();
+    window.setView(sf::View(sf::FloatRect(
+        {0.0F, 0.0F},
+        {static_cast<float>(size.x), static_cast<float>(size.y)})));
+
+    buildGraph();
+    window.draw(m_graph);
+
+    const std::string report = buildReport();
+    if (m_text) {
+      m_text->setString(report);
+      m_text->setPosition({kMargin, kMargin + kGraphHeight + 4.0F});
+      window.draw(*m_text);
+    } else if (m_reportClock.getElapsedTime().asSeconds() >= 1.0F) {
+      m_reportClock.restart();
+      std::cout << report << '\n';
+    }
+
+    window.setView(previous);
+  }
+
+private:
+  struct Frame {
+    float total = 0.0F;
+    std::array<float, kSectionCount> sections{};
+  };
+
+  struct TrackedRenderer {
+    std::string label;
+    std::function<std::pair<std::size_t, std::size_t>()> stats;
+  };
+
+  static constexpr float kMargin = 8.0F;
+  static constexpr float kGraphHeight = 100.0F;
+  static constexpr float kPixelsPerMs = kGraphHeight / 50.0F;
+
+  void loadFont() {
+    std::vector<std::string> candidates;
+    if (const char *env = std::getenv("CP_OVERLAY_FONT")) {
+      candidates.emplace_back(env);
+    }
+    candidates.insert(candidates.end(),
+                      {"/System/Library/Fonts/Menlo.ttc",
+                       "/System/Library/Fonts/Supplemental/Arial.ttf",
+                       "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf",
+                       "/usr/share/fonts/TTF/DejaVuSansMono.ttf",
+                       "C:/Windows/Fonts/consola.ttf"});
+    for (const auto &path : candidates) {
+      sf::Font font;
+      if (font.openFromFile(path)) {
+        m_font = std::move(font);
+        m_text.emplace(*m_font, "", 12U);
+        m_text->setFillColor(sf::Color(225, 225, 225));
+        return;
+      }
+    }
+  }
+
+  void buildGraph() {
+    static const std::array<sf::Color, kSectionCount> colors{
+        sf::Color(0, 120, 225), sf::Color(0, 205, 205),
+        sf::Color(225, 175, 0), sf::Color(175, 0, 225),
+        sf::Color(0, 205, 0)};
+    const sf::Color idle(110, 110, 110, 180);
+    const sf::Color budget(205, 56, 79, 215);
+
+    m_graph.setPrimitiveType(sf::PrimitiveType::Triangles);
+    m_graph.clear();
+
+    const float bottom = kMargin + kGraphHeight;
+    addQuad(kMargin, kMargin, static_cast<float>(kHistory), kGraphHeight,
+            sf::Color(20, 20, 20, 200));
+
+    // Oldest frame on the left; each frame is a 1 px wide stacked column.
+    const std::size_t first = (m_next + kHistory - m_count) % kHistory;
+    for (std::size_t i = 0; i < m_count; ++i) {
+      const Frame &frame = m_frames[(first + i) % kHistory];
+      const float x = kMargin + static_cast<float>(kHistory - m_count + i);
+      float y = bottom;
+      float accounted = 0.0F;
+      for (std::size_t s = 0; s < kSectionCount; ++s) {
+        const float height = barHeight(frame.sections[s], y);
+        addQuad(x, y - height, 1.0F, height, colors[s]);
+        y -= height;
+        accounted += frame.sections[s];
+      }
+      const float height = barHeight(frame.total - accounted, y);
+      addQuad(x, y - height, 1.0F, height, idle);
+    }
+
+    // 60 Hz frame budget.
+    addQuad(kMargin, bottom - (1000.0F / 60.0F) * kPixelsPerMs,
+            static_cast<float>(kHistory), 1.0F, budget);
+  }
+
+  static float barHeight(float ms, float y) {
+    return std::clamp(ms * kPixelsPerMs, 0.0F, y - kMargin);
+  }
+
+  void addQuad(float x, float y, float width, float height, sf::Color color) {
+    const sf::Vector2f a{x, y};
+    const sf::Vector2f b{x + width, y};
+    const sf::Vector2f c{x + width, y + height};
+    const sf::Vector2f d{x, y + height};
+    for (const auto &p : {a, b, c, a, c, d}) {
+      m_graph.append(sf::Vertex{p, color});
+    }
+  }
+
+  std::string buildReport() const {
+    std::array<float, kSectionCount> mean{};
+    for (std::size_t i = 0; i < m_count; ++i) {
+      for (std::size_t s = 0; s < kSectionCount; ++s) {
+        mean[s] += m_frames[i].sections[s];
+      }
+    }
+    char line[128];
+    std::snprintf(line, sizeof(line), "frame p50 %.2f ms  p99 %.2f ms",
+                  percentile(0.50F), percentile(0.99F));
+    std::string report = line;
+    for (std::size_t s = 0; s < kSectionCount; ++s) {
+      const float avg = m_count > 0 ? mean[s] / static_cast<float>(m_count)
+                                    : 0.0F;
+      std::snprintf(line, sizeof(line), "\n%-9s %.3f ms",
+                    sectionName(static_cast<Section>(s)), avg);
+      report += line;
+    }
+    for (const auto &renderer : m_renderers) {
+      const auto [vertices, bytes] = renderer.stats();
+      std::snprintf(line, sizeof(line), "\n%s: %zu vertices, %.1f KiB",
+                    renderer.label.c_str(), vertices,
+                    static_cast<double>(bytes) / 1024.0);
+      report += line;
+    }
+    return report;
+  }
+
+  std::array<Frame, kHistory> m_frames{};
+  std::size_t m_next = 0;
+  std::size_t m_count = 0;
+  std::array<float, kSectionCount> m_current{};
+  Clock::time_point m_frameStart;
+  bool m_hasFrame = false;
+  bool m_visible = false;
+
+  std::vector<TrackedRenderer> m_renderers;
+  sf::VertexArray m_graph;
+  std::optional<sf::Font> m_font;
+  std::optional<sf::Text> m_text;
+  sf::Clock m_reportClock;
+  mutable std::vector<float> m_scratch;
+};
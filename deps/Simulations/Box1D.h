@@ -0,0 +1,133 @@
+// deps/Simulations/Box1D.h
+
+#pragma once
+
+#include <Fields.h>
+#include <Scalar.h>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace Sim {
+
+/**
+ * @brief Input parameters of the free particle in a box 0 < x < L
+ */
+struct Box1DParams {
+  float L = 1.0F;
+  float x0 = 0.5F;
+  float v0 = 1.0F;
+  float t0 = 0.0F;
+  float tf = 1.0F;
+  float dt = 0.01F;
+};
+
+/**
+ * @brief Free particle in a 1D box, integrated with x = x + v * dt
+ *
+ * T is the scalar of the state and of the integration; S selects plain or
+ * compensated accumulation of x.
+ */
+template <typename T = float, Summation S = Summation::Plain>
+class BasicBox1D {
+public:
+  using Scalar = T;
+  static constexpr Summation summation = S;
+
+  static constexpr std::string_view name = "box1d";
+  static constexpr std::array<std::string_view, 3> columns{"Time(s)", "x(t)",
+                                                           "v(t)"};
+  using Params = Box1DParams;
+  static constexpr std::array<Field<Params, float>, 6> fields{
+      {{"L", &Params::L},
+       {"x0", &Params::x0},
+       {"v0", &Params::v0},
+       {"t0", &Params::t0},
+       {"tf", &Params::tf},
+       {"dt", &Params::dt}}};
+  using Row = std::array<double, columns.size()>;
+
+  explicit BasicBox1D(const Params &params)
+      : m_params(params), m_L(params.L), m_t0(params.t0), m_tf(params.tf),
+        m_dt(params.dt), m_t(params.t0), m_x(T(params.x0)), m_v(params.v0) {
+    validate(params);
+  }
+
+  static void validate(const Params &p) {
+    if (p.L <= 0.0F) {
+      throw std::invalid_argument("L <= 0");
+    }
+    if (p.x0 < 0.0F) {
+      throw std::invalid_argument("x0 < 0");
+    }
+    if (p.x0 > p.L) {
+      throw std::invalid_argument("x0 > L");
+    }
+    if (p.v0 == 0.0F) {
+      throw std::invalid_argument("v0 = 0");
+    }
+    if (p.dt <= 0.0F) {
+      throw std::invalid_argument("dt <= 0");
+    }
+  }
+
+  bool done() const { return m_t >= m_tf; }
+
+  Row row() const {
+    return {static_cast<double>(m_t), static_cast<double>(m_x.value()),
+            static_cast<double>(m_v)};
+  }
+
+  void step() {
+    ++m_step;
+    m_t = m_t0 + (static_cast<T>(m_step) * m_dt);
+    m_x += m_v * m_dt;
+    const T x = m_x.value();
+    if (x < T(0) || x > m_L) {
+      m_v = -m_v;
+      ++m_bounces;
+    }
+  }
+
+  /** @brief Everything step() changes, for checkpoints (Checkpoint.h) */
+  struct State {
+    std::uint64_t step;
+    T t;
+    Accumulator<T, S> x;
+    T v;
+    int bounces;
+  };
+
+  State state() const { return {m_step, m_t, m_x, m_v, m_bounces}; }
+
+  void restore(const State &state) {
+    m_step = state.step;
+    m_t = state.t;
+    m_x = state.x;
+    m_v = state.v;
+    m_bounces = state.bounces;
+  }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  int bounces() const { return m_bounces; }
+  /** @brief Events so far (bounces), for Decimator */
+  int events() const { return m_bounces; }
+
+private:
+  Params m_params;
+  T m_L;
+  T m_t0;
+  T m_tf;
+  T m_dt;
+  std::uint64_t m_step = 0;
+  T m_t;
+  Accumulator<T, S> m_x;
+  T m_v;
+  int m_bounces = 0;
+};
+
+using Box1D = BasicBox1D<DefaultScalar<float>, kDefaultSummation>;
+
+} // namespace Sim
@@ -0,0 +1,171 @@
+// deps/Simulations/Box2D.h
+
+#pragma once
+
+#include <Fields.h>
+#include <Scalar.h>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace Sim {
+
+/**
+ * @brief Input parameters of the free particle in a box 0 < x < Lx,
+ * 0 < y < Ly
+ */
+struct Box2DParams {
+  float Lx = 1.0F;
+  float Ly = 1.0F;
+  float x0 = 0.5F;
+  float y0 = 0.5F;
+  float vx0 = 1.0F;
+  float vy0 = 1.0F;
+  float t0 = 0.0F;
+  float tf = 1.0F;
+  float dt = 0.01F;
+};
+
+/**
+ * @brief Free particle in a 2D box, integrated with x = x + vx * dt
+ *
+ * The kernel owns the complete simulation state so it can be driven from
+ * main(), a worker thread or a benchmark. Call row() to read the current
+ * sample and step() to advance until done() is true. T is the scalar of the
+ * state and of the integration; S selects plain or compensated accumulation
+ * of the positions.
+ */
+template <typename T = float, Summation S = Summation::Plain>
+class BasicBox2D {
+public:
+  using Scalar = T;
+  static constexpr Summation summation = S;
+
+  static constexpr std::string_view name = "box2d";
+  static constexpr std::array<std::string_view, 5> columns{
+      "Time(s)", "x(t)", "y(t)", "vx(t)", "vy(t)"};
+  using Params = Box2DParams;
+  static constexpr std::array<Field<Params, float>, 9> fields{
+      {{"Lx", &Params::Lx},
+       {"Ly", &Params::Ly},
+       {"x0", &Params::x0},
+       {"y0", &Params::y0},
+       {"vx0", &Params::vx0},
+       {"vy0", &Params::vy0},
+       {"t0", &Params::t0},
+       {"tf", &Params::tf},
+       {"dt", &Params::dt}}};
+  using Row = std::array<double, columns.size()>;
+
+  explicit BasicBox2D(const Params &params) : m_params(params) {
+    validate(params);
+    m_Lx = params.Lx;
+    m_Ly = params.Ly;
+    m_t0 = params.t0;
+    m_tf = params.tf;
+    m_dt = params.dt;
+    m_t = params.t0;
+    m_x = Accumulator<T, S>(params.x0);
+    m_y = Accumulator<T, S>(params.y0);
+    m_vx = params.vx0;
+    m_vy = params.vy0;
+  }
+
+  static void validate(const Params &p) {
+    if (p.Lx <= 0.0F || p.Ly <= 0.0F) {
+      throw std::invalid_argument("Lx and Ly should be +ve");
+    }
+    if (p.x0 < 0.0F || p.x0 > p.Lx) {
+      throw std::invalid_argument("The range of x will be: 0 < x0 < Lx");
+    }
+    if (p.y0 < 0.0F || p.y0 > p.Ly) {
+      throw std::invalid_argument("The range of y will be: 0 < y0 < Ly");
+    }
+    if ((p.vx0 * p.vx0) + (p.vy0 * p.vy0) == 0.0F) {
+      throw std::invalid_argument("v0 = 0");
+    }
+    if (p.dt <= 0.0F) {
+      throw std::invalid_argument("dt <= 0");
+    }
+  }
+
+  bool done() const { return m_t >= m_tf; }
+
+  Row row() const {
+    return {static_cast<double>(m_t), static_cast<double>(m_x.value()),
+            static_cast<double>(m_y.value()), static_cast<double>(m_vx),
+            static_cast<double>(m_vy)};
+  }
+
+  void step() {
+    ++m_step;
+    m_t = m_t0 + (static_cast<T>(m_step) * m_dt);
+    m_x += m_vx * m_dt;
+    m_y += m_vy * m_dt;
+    const T x = m_x.value();
+    const T y = m_y.value();
+    if (x < T(0) || x > m_Lx) {
+      m_vx = -m_vx;
+      ++m_nx;
+    }
+    if (y < T(0) || y > m_Ly) {
+      m_vy = -m_vy;
+      ++m_ny;
+    }
+  }
+
+  /** @brief Everything step() changes, for checkpoints (Checkpoint.h) */
+  struct State {
+    std::uint64_t step;
+    T t;
+    Accumulator<T, S> x;
+    Accumulator<T, S> y;
+    T vx;
+    T vy;
+    int nx;
+    int ny;
+  };
+
+  State state() const {
+    return {m_step, m_t, m_x, m_y, m_vx, m_vy, m_nx, m_ny};
+  }
+
+  void restore(const State &state) {
+    m_step = state.step;
+    m_t = state.t;
+    m_x = state.x;
+    m_y = state.y;
+    m_vx = state.vx;
+    m_vy = state.vy;
+    m_nx = state.nx;
+    m_ny = state.ny;
+  }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  int xBounces() const { return m_nx; }
+  int yBounces() const { return m_ny; }
+  /** @brief Events so far (bounces), for Decimator */
+  int events() const { return m_nx + m_ny; }
+
+private:
+  Params m_params;
+  T m_Lx = T(0);
+  T m_Ly = T(0);
+  T m_t0 = T(0);
+  T m_tf = T(0);
+  T m_dt = T(0);
+  std::uint64_t m_step = 0;
+  T m_t = T(0);
+  Accumulator<T, S> m_x;
+  Accumulator<T, S> m_y;
+  T m_vx = T(0);
+  T m_vy = T(0);
+  int m_nx = 0;
+  int m_ny = 0;
+};
+
+using Box2D = BasicBox2D<DefaultScalar<float>, kDefaultSummation>;
+
+} // namespace Sim
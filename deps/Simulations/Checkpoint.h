@@ -0,0 +1,419 @@
+// deps/Simulations/Checkpoint.h
+
+#pragma once
+
+#include <Fields.h>
+#include <Scalar.h>
+#include <Trace.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <concepts>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file Checkpoint.h
+ * @brief Binary snapshots of a running kernel, for restarting preempted runs
+ *
+ * A kernel is checkpointable when it has a trivially copyable `State` with
+ * `state()` and `restore()`; State holds everything step() mutates (step
+ * index, integrated variables, counters and, for stochastic kernels, the
+ * generator state) so a restored kernel continues bit-identically.
+ *
+ * Snapshot layout (native byte order; snapshots are not meant to move
+ * between architectures):
+ *   "CPCK" | u32 version | str tag | str params | u64 output offset |
+ *   u32 state size | State bytes | u64 FNV-1a of everything before
+ * where str is a u32 length followed by the bytes, tag is
+ * "<name>/<scalar>/<summation>" and params is formatFields() of the run's
+ * parameters, so a restart needs no input.
+ */
+
+namespace Sim {
+
+/**
+ * @brief 64-bit FNV-1a hash, continuing from seed
+ */
+inline std::uint64_t fnv1a(std::string_view bytes,
+                           std::uint64_t seed = 0xcbf29ce484222325ULL) {
+  std::uint64_t hash = seed;
+  for (const char c : bytes) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+template <typename Kernel>
+concept Checkpointable =
+    requires(Kernel kernel, const typename Kernel::State &state) {
+      { kernel.state() } -> std::same_as<typename Kernel::State>;
+      kernel.restore(state);
+    } && std::is_trivially_copyable_v<typename Kernel::State>;
+
+namespace detail {
+
+constexpr std::string_view kCheckpointMagic = "CPCK";
+constexpr std::uint32_t kCheckpointVersion = 1;
+
+template <typename T> void appendPod(std::string &out, const T &value) {
+  out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+inline void appendString(std::string &out, std::string_view text) {
+  appendPod(out, static_cast<std::uint32_t>(text.size()));
+  out.append(text);
+}
+
+class SnapshotReader {
+public:
+  explicit SnapshotReader(std::string_view bytes) : m_bytes(bytes) {}
+
+  template <typename T> T pod() {
+    T value;
+    std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+    return value;
+  }
+
+  std::string_view string() { return take(pod<std::uint32_t>()); }
+
+  std::string_view take(std::size_t count) {
+    if (count > m_bytes.size() - m_pos) {
+      throw std::runtime_error("truncated checkpoint");
+    }
+    const std::string_view out = m_bytes.substr(m_pos, count);
+    m_pos += count;
+    return out;
+  }
+
+  std::size_t position() const { return m_pos; }
+
+private:
+  std::string_view m_bytes;
+  std::size_t m_pos = 0;
+};
+
+template <typename Kernel> std::string checkpointTag() {
+  std::string tag(Kernel::name);
+  tag += '/';
+  tag += scalarName<typename Kernel::Scalar>();
+  tag += '/';
+  tag += summationName(Kernel::summation);
+  return tag;
+}
+
+inline volatile std::sig_atomic_t stopSignal = 0;
+
+inline void onStopSignal(int) { stopSignal = 1; }
+
+} // namespace detail
+
+/**
+ * @brief Serializes kernel, recording that the output file holds
+ * outputOffset bytes that belong to the steps before this one
+ */
+template <Checkpointable Kernel>
+std::string encodeCheckpoint(const Kernel &kernel,
+                             std::uint64_t outputOffset) {
+  using detail::appendPod;
+  std::string out(detail::kCheckpointMagic);
+  appendPod(out, detail::kCheckpointVersion);
+  detail::appendString(out, detail::checkpointTag<Kernel>());
+  detail::appendString(out, formatFields<Kernel>(kernel.params()));
+  appendPod(out, outputOffset);
+  const typename Kernel::State state = kernel.state();
+  appendPod(out, static_cast<std::uint32_t>(sizeof(state)));
+  appendPod(out, state);
+  appendPod(out, fnv1a(out));
+  return out;
+}
+
+/**
+ * @brief Rebuilds a kernel from a snapshot made by encodeCheckpoint()
+ *
+ * Throws std::runtime_error if the snapshot is corrupt or was written by a
+ * different kernel, scalar or summation mode.
+ */
+template <Checkpointable Kernel>
+Kernel decodeCheckpoint(std::string_view bytes, std::uint64_t &outputOffset) {
+  detail::SnapshotReader reader(bytes);
+  if (reader.take(detail::kCheckpointMagic.size()) !=
+      detail::kCheckpointMagic) {
+    throw std::runtime_error("not a checkpoint file");
+  }
+  if (reader.pod<std::uint32_t>() != detail::kCheckpointVersion) {
+    throw std::runtime_error("unsupported checkpoint version");
+  }
+  const std::string_view tag = reader.string();
+  if (tag != detail::checkpointTag<Kernel>()) {
+    throw std::runtime_error("checkpoint is for " + std::string(tag) +
+                             ", not " + detail::checkpointTag<Kernel>());
+  }
+  const std::string_view fields = reader.string();
+  outputOffset = reader.pod<std::uint64_t>();
+  if (reader.pod<std::uint32_t>() != sizeof(typename Kernel::State)) {
+    throw std::runtime_error("checkpoint state size mismatch");
+  }
+  const auto state = reader.pod<typename Kernel::State>();
+  const std::size_t payload = reader.position();
+  if (reader.pod<std::uint64_t>() != fnv1a(bytes.substr(0, payload))) {
+    throw std::runtime_error("checkpoint checksum mismatch");
+  }
+
+  typename Kernel::Params params;
+  std::istringstream assignments{std::string(fields)};
+  std::string assignment;
+  while (assignments >> assignment) {
+    const auto equals = assignment.find('=');
+    setField<Kernel>(params, assignment.substr(0, equals),
+                     assignment.substr(equals + 1));
+  }
+  Kernel kernel(params);
+  kernel.restore(state);
+  return kernel;
+}
+
+template <Checkpointable Kernel>
+Kernel loadCheckpoint(const std::filesystem::path &path,
+                      std::uint64_t &outputOffset) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("cannot open checkpoint " + path.string());
+  }
+  const std::string bytes{std::istreambuf_iterator<char>(in),
+                          std::istreambuf_iterator<char>()};
+  return decodeCheckpoint<Kernel>(bytes, outputOffset);
+}
+
+/**
+ * @brief Reopens an output file for appending after a restart, dropping
+ * anything written after the checkpoint was taken
+ */
+inline void reopenOutput(std::ofstream &file,
+                         const std::filesystem::path &path,
+                         std::uint64_t offset) {
+  if (!std::filesystem::exists(path) ||
+      std::filesystem::file_size(path) < offset) {
+    throw std::runtime_error(path.string() +
+                             " is shorter than the checkpoint expects");
+  }
+  std::filesystem::resize_file(path, offset);
+  file.open(path, std::ios::in | std::ios::out);
+  if (!file) {
+    throw std::runtime_error("cannot reopen " + path.string());
+  }
+  file.seekp(0, std::ios::end);
+}
+
+/**
+ * @brief Writes snapshots on a background thread
+ *
+ * submit() only hands the bytes over; if a snapshot is still being written
+ * when the next one arrives, the older pending one is dropped. Every file is
+ * written to "<path>.tmp" and renamed, so the checkpoint on disk is always
+ * complete.
+ */
+class CheckpointWriter {
+public:
+  explicit CheckpointWriter(std::filesystem::path path)
+      : m_path(std::move(path)), m_thread([this] { run(); }) {}
+  CheckpointWriter(const CheckpointWriter &) = delete;
+  CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+  ~CheckpointWriter() {
+    {
+      const std::lock_guard lock(m_mutex);
+      m_stop = true;
+    }
+    m_changed.notify_all();
+    m_thread.join();
+  }
+
+  void submit(std::string snapshot) {
+    {
+      const std::lock_guard lock(m_mutex);
+      m_pending = std::move(snapshot);
+    }
+    m_changed.notify_all();
+  }
+
+  /** @brief Blocks until every submitted snapshot is on disk. */
+  void flush() {
+    std::unique_lock lock(m_mutex);
+    m_changed.wait(lock, [this] { return !m_pending && !m_busy; });
+  }
+
+  std::uint64_t written() const {
+    return m_written.load(std::memory_order_relaxed);
+  }
+
+private:
+  void run() {
+    CP_TRACE_THREAD_NAME("checkpoint writer");
+    std::unique_lock lock(m_mutex);
+    while (true) {
+      m_changed.wait(lock, [this] { return m_pending || m_stop; });
+      if (!m_pending) {
+        return;
+      }
+      const std::string snapshot = std::move(*m_pending);
+      m_pending.reset();
+      m_busy = true;
+      lock.unlock();
+      write(snapshot);
+      lock.lock();
+      m_busy = false;
+      m_changed.notify_all();
+    }
+  }
+
+  void write(const std::string &snapshot) {
+    CP_TRACE_SCOPE("checkpoint");
+    std::filesystem::path partial = m_path;
+    partial += ".tmp";
+    {
+      std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+      out.write(snapshot.data(),
+                static_cast<std::streamsize>(snapshot.size()));
+      out.close();
+      if (!out) {
+        std::cerr << "Checkpoint: cannot write " << partial << '\n';
+        return;
+      }
+    }
+    std::error_code error;
+    std::filesystem::rename(partial, m_path, error);
+    if (error) {
+      std::cerr << "Checkpoint: " << error.message() << '\n';
+      return;
+    }
+    m_written.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::filesystem::path m_path;
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::optional<std::string> m_pending; // guarded by m_mutex
+  bool m_busy = false;                  // guarded by m_mutex
+  bool m_stop = false;                  // guarded by m_mutex
+  std::atomic<std::uint64_t> m_written{0};
+  std::thread m_thread;
+};
+
+/**
+ * @brief Command line options shared by the checkpointing executables
+ *
+ *   --checkpoint <file>            enable checkpoints (periodic and SIGTERM)
+ *   --checkpoint-interval <secs>   period, default 60
+ *   --restart                      resume from the checkpoint file
+ */
+struct CheckpointOptions {
+  std::filesystem::path path;
+  double interval = 60.0;
+  bool restart = false;
+
+  bool enabled() const { return !path.empty(); }
+
+  static CheckpointOptions parse(int argc, char *argv[]) {
+    CheckpointOptions options;
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--checkpoint" && i + 1 < argc) {
+        options.path = argv[++i];
+      } else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+        options.interval = std::atof(argv[++i]);
+      } else if (arg == "--restart") {
+        options.restart = true;
+      }
+    }
+    if (options.restart && !options.enabled()) {
+      throw std::invalid_argument("--restart needs --checkpoint <file>");
+    }
+    return options;
+  }
+};
+
+/**
+ * @brief Drives checkpoints from a step loop
+ *
+ * Call poll() at the top of every iteration, before the current row is
+ * written. It submits a snapshot every options.interval seconds and, after
+ * SIGTERM, writes a final one synchronously and returns true: the caller
+ * should then stop stepping and exit.
+ */
+class Checkpointer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit Checkpointer(const CheckpointOptions &options)
+      : m_interval(options.interval) {
+    if (options.enabled()) {
+      m_writer.emplace(options.path);
+      std::signal(SIGTERM, detail::onStopSignal);
+    }
+    m_last = Clock::now();
+  }
+
+  template <Checkpointable Kernel>
+  bool poll(const Kernel &kernel, std::ofstream &output) {
+    if (!m_writer) {
+      return false;
+    }
+    const bool stop = detail::stopSignal != 0;
+    // The clock is only read every 1024 steps; a step can be a few ns.
+    if (!stop && (kernel.stepIndex() % 1024 != 0 ||
+                  std::chrono::duration<double>(Clock::now() - m_last)
+                          .count() < m_interval)) {
+      return false;
+    }
+    std::uint64_t offset = 0;
+    if (output.is_open()) {
+      output.flush();
+      offset = static_cast<std::uint64_t>(output.tellp());
+    }
+    m_writer->submit(encodeCheckpoint(kernel, offset));
+    m_last = Clock::now();
+    if (stop) {
+      m_writer->flush();
+    }
+    return stop;
+  }
+
+  /**
+   * @brief Call once the run completed: waits for the writer and removes
+   * the checkpoint, which would otherwise restart a finished run
+   */
+  void finish(const std::filesystem::path &path) {
+    if (m_writer) {
+      m_writer.reset();
+      std::error_code ignored;
+      std::filesystem::remove(path, ignored);
+    }
+  }
+
+  /** @brief Exit status after a SIGTERM checkpoint (128 + SIGTERM). */
+  static constexpr int kStoppedStatus = 128 + SIGTERM;
+
+private:
+  double m_interval;
+  Clock::time_point m_last;
+  std::optional<CheckpointWriter> m_writer;
+};
+
+} // namespace Sim
@@ -0,0 +1,156 @@
+// deps/Simulations/Circle.h
+
+#pragma once
+
+#include <Physics.h>
+#include <PhysicsSimd.h>
+#include <Pragmas.h>
+#include <TimeGrid.h>
+#include <Fields.h>
+#include <Scalar.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace Sim {
+
+/**
+ * @brief Input parameters of uniform circular motion around (x0, y0)
+ */
+struct CircleParams {
+  double omega = 1.0;
+  double x0 = 0.0;
+  double y0 = 0.0;
+  double R = 1.0;
+  double t0 = 0.0;
+  double tf = 10.0;
+  double dt = 0.01;
+};
+
+/**
+ * @brief Uniform circular motion (closed-form solution), evaluated in T
+ */
+template <typename T = double> class BasicCircle {
+public:
+  using Scalar = T;
+
+  static constexpr std::string_view name = "circle";
+  static constexpr std::array<std::string_view, 5> columns{
+      "Time(s)", "x(t)", "y(t)", "Vx(t)", "Vy(t)"};
+  using Params = CircleParams;
+  static constexpr std::array<Field<Params>, 7> fields{
+      {{"omega", &Params::omega},
+       {"x0", &Params::x0},
+       {"y0", &Params::y0},
+       {"R", &Params::R},
+       {"t0", &Params::t0},
+       {"tf", &Params::tf},
+       {"dt", &Params::dt}}};
+  using Row = std::array<double, columns.size()>;
+
+  explicit BasicCircle(const Params &params)
+      : m_params(params), m_omega(static_cast<T>(params.omega)),
+        m_x0(static_cast<T>(params.x0)), m_y0(static_cast<T>(params.y0)),
+        m_R(static_cast<T>(params.R)), m_t0(static_cast<T>(params.t0)),
+        m_tf(static_cast<T>(params.tf)), m_dt(static_cast<T>(params.dt)) {
+    validate(params);
+  }
+
+  static void validate(const Params &p) {
+    if (p.R <= 0.0) {
+      throw std::invalid_argument("Invalid radius (R must be positive)");
+    }
+    if (p.omega <= 0.0) {
+      throw std::invalid_argument("Invalid omega (must be positive)");
+    }
+    if (p.dt <= 0.0) {
+      throw std::invalid_argument("Invalid dt (must be positive)");
+    }
+  }
+
+  bool done() const { return time() > m_tf; }
+  std::uint64_t size() const { return gridSize(m_t0, m_tf, m_dt); }
+
+  Row row() const { return at(m_step); }
+
+  /**
+   * @brief Row of step i; closed form, so steps can be evaluated in any
+   * order and in parallel
+   */
+  Row at(std::uint64_t i) const {
+    const T t = timeAt(i);
+    T s;
+    T c;
+    Phy::simd::sincos(m_omega * (t - m_t0), s, c);
+    const T wR = m_omega * m_R;
+    return {static_cast<double>(t), static_cast<double>(m_x0 + (m_R * c)),
+            static_cast<double>(m_y0 + (m_R * s)), static_cast<double>(-wR * s),
+            static_cast<double>(wR * c)};
+  }
+
+  /**
+   * @brief Steps [first, first + count) into one buffer per column, the
+   * phases of each batch through Phy::simd::sincos (see EvaluatesColumns)
+   */
+  void evaluateColumns(std::uint64_t first, std::size_t count,
+                       const std::array<double *, columns.size()> &out) const
+    requires Phy::simd::Vectorizable<T>
+  {
+    std::array<T, kGridBatch> theta{};
+    std::array<T, kGridBatch> s{};
+    std::array<T, kGridBatch> c{};
+    const T wR = m_omega * m_R;
+    for (std::size_t b = 0; b < count; b += kGridBatch) {
+      const std::size_t n = std::min(kGridBatch, count - b);
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        theta[j] = m_omega * (timeAt(first + b + j) - m_t0);
+      }
+      Phy::simd::sincos(std::span<const T>(theta.data(), n),
+                        std::span<T>(s.data(), n), std::span<T>(c.data(), n));
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        out[0][b + j] = static_cast<double>(timeAt(first + b + j));
+        out[1][b + j] = static_cast<double>(m_x0 + (m_R * c[j]));
+        out[2][b + j] = static_cast<double>(m_y0 + (m_R * s[j]));
+        out[3][b + j] = static_cast<double>(-wR * s[j]);
+        out[4][b + j] = static_cast<double>(wR * c[j]);
+      }
+    }
+  }
+
+  void step() { ++m_step; }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  double period() const { return 2.0 * Phy::Const::PI / m_params.omega; }
+  /** @brief Phase advanced per step (radians), for PeriodicReplay */
+  std::array<double, 1> phaseSteps() const {
+    return {m_params.omega * m_params.dt};
+  }
+
+private:
+  Params m_params;
+  T m_omega;
+  T m_x0;
+  T m_y0;
+  T m_R;
+  T m_t0;
+  T m_tf;
+  T m_dt;
+  std::uint64_t m_step = 0;
+
+  T time() const { return timeAt(m_step); }
+  T timeAt(std::uint64_t i) const {
+    return m_t0 + (static_cast<T>(i) * m_dt);
+  }
+};
+
+using Circle = BasicCircle<DefaultScalar<double>>;
+
+} // namespace Sim
@@ -0,0 +1,214 @@
+// deps/Simulations/Decimation.h
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace Sim {
+
+/**
+ * @brief Which integration steps the chapter executables write out
+ *
+ *   (default)            every step
+ *   --every <n>          every n-th step
+ *   --interval <dt>      one row per dt of simulated time, independent of
+ *                        the integration step
+ *   --tolerance <eps>    error-bounded piecewise-linear simplification: a
+ *                        row is dropped when linear interpolation between
+ *                        the rows kept around it reproduces every column to
+ *                        within eps
+ *   --events             additionally keep the rows on both sides of every
+ *                        event (bounce, hole entry)
+ *
+ * The first and the last row are always written.
+ */
+struct DecimationOptions {
+  enum class Mode { All, EveryNth, Interval, Error };
+
+  Mode mode = Mode::All;
+  std::uint64_t every = 1;
+  double interval = 0.0;
+  double tolerance = 0.0;
+  bool events = false;
+
+  bool enabled() const { return mode != Mode::All; }
+
+  static DecimationOptions parse(int argc, char *argv[]) {
+    DecimationOptions options;
+    const auto select = [&options](Mode mode) {
+      if (options.mode != Mode::All) {
+        throw std::invalid_argument(
+            "--every, --interval and --tolerance are exclusive");
+      }
+      options.mode = mode;
+    };
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--every" && i + 1 < argc) {
+        select(Mode::EveryNth);
+        options.every = std::strtoull(argv[++i], nullptr, 10);
+        if (options.every == 0) {
+          throw std::invalid_argument("--every must be at least 1");
+        }
+      } else if (arg == "--interval" && i + 1 < argc) {
+        select(Mode::Interval);
+        options.interval = std::atof(argv[++i]);
+        if (!(options.interval > 0.0)) {
+          throw std::invalid_argument("--interval must be > 0");
+        }
+      } else if (arg == "--tolerance" && i + 1 < argc) {
+        select(Mode::Error);
+        options.tolerance = std::atof(argv[++i]);
+        if (!(options.tolerance >= 0.0)) {
+          throw std::invalid_argument("--tolerance must be >= 0");
+        }
+      } else if (arg == "--events") {
+        options.events = true;
+      }
+    }
+    return options;
+  }
+};
+
+/**
+ * @brief Streaming filter between a kernel and its writers
+ *
+ * push() every row in order, flagging the rows that follow an event, then
+ * finish(); emit(row) is called for the rows that are kept, in order. With
+ * the default options every row is passed straight through.
+ *
+ * Error mode keeps, per column, the range of slopes from the last kept row
+ * (the anchor) that pass within the tolerance of every row dropped since.
+ * A new row can end the segment if its own slope is in that range; once
+ * one cannot, the row before it is kept and becomes the next anchor. That
+ * is O(1) per row and column, and bounds the interpolation error of every
+ * dropped row against the rows kept around it. Column 0 is time.
+ */
+template <std::size_t N> class Decimator {
+public:
+  using Row = std::array<double, N>;
+  using Mode = DecimationOptions::Mode;
+
+  explicit Decimator(const DecimationOptions &options) : m_options(options) {}
+
+  template <typename Emit> void push(const Row &row, bool event, Emit &&emit) {
+    const bool first = m_offered == 0;
+    bool keep = first;
+    if (m_options.events && event) {
+      // Keep the corner: the last row before the event and the first after.
+      if (!first && !m_lastEmitted) {
+        emitRow(m_last, emit);
+      }
+      keep = true;
+    }
+    switch (m_options.mode) {
+    case Mode::All:
+      keep = true;
+      break;
+    case Mode::EveryNth:
+      keep = keep || m_offered % m_options.every == 0;
+      break;
+    case Mode::Interval:
+      if (first) {
+        m_start = row[0];
+      }
+      if (row[0] >=
+          m_start + (static_cast<double>(m_slot) * m_options.interval)) {
+        keep = true;
+        m_slot = static_cast<std::uint64_t>(
+                     std::floor((row[0] - m_start) / m_options.interval)) +
+                 1;
+      }
+      break;
+    case Mode::Error:
+      if (!keep && !extends(row)) {
+        if (m_lastEmitted) {
+          keep = true; // time did not advance
+        } else {
+          emitRow(m_last, emit);
+          anchor(m_last);
+          keep = !extends(row);
+        }
+      }
+      break;
+    }
+    if (keep) {
+      emitRow(row, emit);
+      if (m_options.mode == Mode::Error) {
+        anchor(row);
+      }
+    }
+    m_last = row;
+    m_lastEmitted = keep;
+    ++m_offered;
+  }
+
+  // Writes the last row if it was dropped.
+  template <typename Emit> void finish(Emit &&emit) {
+    if (m_offered > 0 && !m_lastEmitted) {
+      emitRow(m_last, emit);
+      m_lastEmitted = true;
+    }
+  }
+
+  std::uint64_t offered() const { return m_offered; }
+  std::uint64_t emitted() const { return m_emitted; }
+
+private:
+  template <typename Emit> void emitRow(const Row &row, Emit &emit) {
+    emit(row);
+    ++m_emitted;
+  }
+
+  void anchor(const Row &row) {
+    m_anchor = row;
+    m_low.fill(-std::numeric_limits<double>::infinity());
+    m_high.fill(std::numeric_limits<double>::infinity());
+  }
+
+  // True if the segment from the anchor can end at row; row then narrows
+  // the slope ranges for the rows after it.
+  bool extends(const Row &row) {
+    const double dt = row[0] - m_anchor[0];
+    if (!(dt > 0.0)) {
+      return false;
+    }
+    for (std::size_t c = 1; c < N; ++c) {
+      const double slope = (row[c] - m_anchor[c]) / dt;
+      if (!(slope >= m_low[c] && slope <= m_high[c])) {
+        return false;
+      }
+    }
+    for (std::size_t c = 1; c < N; ++c) {
+      const double rise = row[c] - m_anchor[c];
+      m_low[c] = std::max(m_low[c], (rise - m_options.tolerance) / dt);
+      m_high[c] = std::min(m_high[c], (rise + m_options.tolerance) / dt);
+    }
+    return true;
+  }
+
+  DecimationOptions m_options;
+  std::uint64_t m_offered = 0;
+  std::uint64_t m_emitted = 0;
+  Row m_last{};
+  bool m_lastEmitted = false;
+
+  // Interval
+  double m_start = 0.0;
+  std::uint64_t m_slot = 0;
+
+  // Error
+  Row m_anchor{};
+  Row m_low{};
+  Row m_high{};
+};
+
+} // namespace Sim
@@ -0,0 +1,420 @@
+// deps/Simulations/DrivenPendulum.h
+
+#pragma once
+
+#include <Physics.h>
+#include <PhysicsSimd.h>
+#include <Pragmas.h>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Sim {
+
+/**
+ * @brief Driven damped pendulum
+ *
+ *   theta'' = -omega0^2 sin(theta) - gamma theta' + A cos(Omega t)
+ *
+ * omega0 = sqrt(g / l) is the natural frequency; the defaults are the
+ * classic chaotic pendulum of Baker and Gollub.
+ */
+struct DrivenPendulumParams {
+  double omega0 = 1.0;
+  double gamma = 0.5;
+  double A = 1.2;
+  double Omega = 2.0 / 3.0;
+  double theta0 = 0.2;
+  double dtheta0 = 0.0;
+};
+
+/**
+ * @brief A sweep of A or Omega for bifurcation()
+ *
+ * Each of the columns values from `from` to `to` is integrated with RK4
+ * from (theta0, dtheta0) for at most transient + samples drive periods and
+ * sampled once per period (the Poincare section at drive phase 0). A
+ * column whose section points repeat with some period p <= maxPeriod to
+ * within tolerance is periodic: its p points are emitted and it stops
+ * there. Other columns discard transient periods and emit the next
+ * samples points.
+ */
+struct BifurcationOptions {
+  enum class Sweep { Amplitude, Frequency };
+  Sweep sweep = Sweep::Amplitude;
+  double from = 1.0;
+  double to = 1.5;
+  std::size_t columns = 4000;
+  unsigned stepsPerPeriod = 128;
+  std::uint64_t transient = 300;
+  std::uint64_t samples = 200;
+  unsigned maxPeriod = 64;
+  double tolerance = 1e-9;
+  unsigned threads = 0; // 0: std::thread::hardware_concurrency()
+};
+
+/** @brief A point of a Poincare section; theta is wrapped to [-pi, pi] */
+struct SectionPoint {
+  double theta;
+  double dtheta;
+};
+
+/** @brief The section points of one value of the swept parameter */
+struct BifurcationColumn {
+  std::size_t index = 0;
+  double parameter = 0.0;
+  unsigned period = 0; // 0: no period up to maxPeriod was found
+  std::uint64_t periods = 0; // drive periods integrated
+  std::vector<SectionPoint> points;
+};
+
+/** @brief Columns a worker of bifurcation() integrates side by side */
+inline constexpr std::size_t kPendulumLanes = 8;
+
+/**
+ * @brief kPendulumLanes driven pendulums, each with its own drive
+ * amplitude A and RK4 step h (its drive period over stepsPerPeriod)
+ *
+ * A lane with A = h = 0 stands still.
+ */
+struct PendulumLanes {
+  std::array<double, kPendulumLanes> theta{};
+  std::array<double, kPendulumLanes> dtheta{};
+  std::array<double, kPendulumLanes> A{};
+  std::array<double, kPendulumLanes> h{};
+};
+
+/**
+ * @brief RK4 flow of driven pendulums over whole drive periods
+ *
+ * The step is the drive period over stepsPerPeriod, so the drive at every
+ * RK4 stage is an entry of a table of cos(pi k / stepsPerPeriod) shared by
+ * all A and Omega, and the only transcendental left per stage is
+ * sin(theta). A single pendulum is latency-bound on that sin; period()
+ * advances the lanes together in one vectorized loop with the sincos of
+ * Phy::simd, so their work overlaps. theta is wrapped once per period and
+ * stays far inside the domain of the kernel.
+ */
+class DrivenPendulumFlow {
+public:
+  DrivenPendulumFlow(const DrivenPendulumParams &params,
+                     unsigned stepsPerPeriod)
+      : m_omega02(params.omega0 * params.omega0), m_gamma(params.gamma),
+        m_drive(2 * static_cast<std::size_t>(stepsPerPeriod)) {
+    for (std::size_t k = 0; k < m_drive.size(); ++k) {
+      m_drive[k] = std::cos(Phy::Const::PI * static_cast<double>(k) /
+                            static_cast<double>(stepsPerPeriod));
+    }
+  }
+
+  /** @brief RK4 step for the drive frequency Omega */
+  double step(double Omega) const {
+    return 2.0 * Phy::Const::PI / Omega /
+           static_cast<double>(m_drive.size() / 2);
+  }
+
+  /**
+   * @brief Advances every lane by one drive period from phase 0 and wraps
+   * theta to [-pi, pi]
+   */
+  void period(PendulumLanes &lanes) const {
+    constexpr std::size_t L = kPendulumLanes;
+    const std::size_t half = m_drive.size();
+    const double omega02 = m_omega02;
+    const double gamma = m_gamma;
+    double *theta = lanes.theta.data();
+    double *dtheta = lanes.dtheta.data();
+    const double *amplitude = lanes.A.data();
+    const double *step = lanes.h.data();
+    for (std::size_t k = 0; k < half; k += 2) {
+      const double c0 = m_drive[k];
+      const double ch = m_drive[k + 1];
+      const double c1 = m_drive[k + 2 == half ? 0 : k + 2];
+      CP_SIMD
+      for (std::size_t l = 0; l < L; ++l) {
+        const auto acceleration = [&](double x, double v, double drive) {
+          double s = 0.0;
+          double c = 0.0;
+          Phy::simd::lane::sincos(x, s, c);
+          return (amplitude[l] * drive) - (omega02 * s) - (gamma * v);
+        };
+        const double h = step[l];
+        const double x = theta[l];
+        const double v = dtheta[l];
+        const double x1 = v;
+        const double v1 = acceleration(x, v, c0);
+        const double x2 = v + (0.5 * h * v1);
+        const double v2 = acceleration(x + (0.5 * h * x1), x2, ch);
+        const double x3 = v + (0.5 * h * v2);
+        const double v3 = acceleration(x + (0.5 * h * x2), x3, ch);
+        const double x4 = v + (h * v3);
+        const double v4 = acceleration(x + (h * x3), x4, c1);
+        theta[l] = x + (h / 6.0 * (x1 + (2.0 * (x2 + x3)) + x4));
+        dtheta[l] = v + (h / 6.0 * (v1 + (2.0 * (v2 + v3)) + v4));
+      }
+    }
+    for (std::size_t l = 0; l < L; ++l) {
+      theta[l] = std::remainder(theta[l], 2.0 * Phy::Const::PI);
+    }
+  }
+
+private:
+  double m_omega02;
+  double m_gamma;
+  std::vector<double> m_drive;
+};
+
+namespace bifurcation_detail {
+
+inline void validate(const DrivenPendulumParams &p,
+                     const BifurcationOptions &o) {
+  const bool amplitude = o.sweep == BifurcationOptions::Sweep::Amplitude;
+  if (!amplitude && (!(o.from > 0.0) || !(o.to > 0.0))) {
+    throw std::invalid_argument("swept Omega <= 0");
+  }
+  if (amplitude && !(p.Omega > 0.0)) {
+    throw std::invalid_argument("Omega <= 0");
+  }
+  if (p.gamma < 0.0) {
+    throw std::invalid_argument("gamma < 0");
+  }
+  if (o.columns == 0) {
+    throw std::invalid_argument("columns == 0");
+  }
+  if (o.stepsPerPeriod == 0) {
+    throw std::invalid_argument("stepsPerPeriod == 0");
+  }
+  if (o.samples == 0) {
+    throw std::invalid_argument("samples == 0");
+  }
+  if (o.maxPeriod == 0) {
+    throw std::invalid_argument("maxPeriod == 0");
+  }
+}
+
+inline double parameterAt(const BifurcationOptions &o, std::size_t i) {
+  if (o.columns == 1) {
+    return o.from;
+  }
+  return o.from + ((o.to - o.from) * static_cast<double>(i) /
+                   static_cast<double>(o.columns - 1));
+}
+
+// Smallest p such that point k matches point k - p of history, a ring of
+// the last maxPeriod + 1 section points; 0 if there is none.
+inline unsigned findPeriod(std::span<const SectionPoint> history,
+                           std::uint64_t k, double tolerance) {
+  const std::size_t n = history.size();
+  const SectionPoint &now = history[k % n];
+  const auto limit =
+      static_cast<unsigned>(std::min<std::uint64_t>(n - 1, k));
+  for (unsigned p = 1; p <= limit; ++p) {
+    const SectionPoint &then = history[(k - p) % n];
+    const double dtheta =
+        std::remainder(now.theta - then.theta, 2.0 * Phy::Const::PI);
+    if (std::abs(dtheta) <= tolerance &&
+        std::abs(now.dtheta - then.dtheta) <= tolerance) {
+      return p;
+    }
+  }
+  return 0;
+}
+
+// A column in flight in a lane of a worker.
+struct Run {
+  bool active = false;
+  std::uint64_t k = 0; // drive periods integrated
+  std::vector<SectionPoint> history;
+  BifurcationColumn column;
+
+  void start(std::size_t index, const DrivenPendulumParams &params,
+             const BifurcationOptions &o, const DrivenPendulumFlow &flow,
+             PendulumLanes &lanes, std::size_t l) {
+    DrivenPendulumParams p = params;
+    (o.sweep == BifurcationOptions::Sweep::Amplitude ? p.A : p.Omega) =
+        parameterAt(o, index);
+    active = true;
+    k = 0;
+    history.resize(static_cast<std::size_t>(o.maxPeriod) + 1);
+    column.index = index;
+    column.parameter = parameterAt(o, index);
+    column.period = 0;
+    column.periods = 0;
+    column.points.clear();
+    lanes.theta[l] = std::remainder(p.theta0, 2.0 * Phy::Const::PI);
+    lanes.dtheta[l] = p.dtheta0;
+    lanes.A[l] = p.A;
+    lanes.h[l] = flow.step(p.Omega);
+    history[0] = {lanes.theta[l], lanes.dtheta[l]};
+  }
+
+  // Records the section point after another period; true when the column
+  // is complete.
+  bool record(const BifurcationOptions &o, double theta, double dtheta) {
+    const std::size_t n = history.size();
+    ++k;
+    history[k % n] = {theta, dtheta};
+    column.periods = k;
+    if (const unsigned period = findPeriod(history, k, o.tolerance)) {
+      column.period = period;
+      column.points.clear();
+      for (std::uint64_t j = k - period + 1; j <= k; ++j) {
+        column.points.push_back(history[j % n]);
+      }
+      return true;
+    }
+    if (k > o.transient) {
+      column.points.push_back({theta, dtheta});
+    }
+    return k == o.transient + o.samples;
+  }
+};
+
+} // namespace bifurcation_detail
+
+/**
+ * @brief Computes the bifurcation diagram of the driven pendulum over the
+ * sweep of options and passes each column to
+ * emit(const BifurcationColumn &), in column order, on the calling thread
+ *
+ * Each worker thread integrates kPendulumLanes columns side by side and
+ * refills a lane from a shared counter as soon as its column completes:
+ * periodic columns stop when their orbit closes while chaotic ones run the
+ * full transient + samples periods, so any static partition would leave
+ * threads and lanes idle behind the chaotic windows. Completed columns are
+ * streamed out in order through a window of 16 * kPendulumLanes * threads
+ * slots; a worker never waits while it holds columns, so memory stays
+ * bounded whatever the number of columns. Every column follows the same
+ * arithmetic in any lane, so the diagram does not depend on the number of
+ * threads. Returns the number of section points emitted.
+ *
+ * @throws std::invalid_argument for invalid parameters or options
+ */
+template <typename Emit>
+std::uint64_t bifurcation(const DrivenPendulumParams &params,
+                          const BifurcationOptions &options, Emit &&emit) {
+  CP_TRACE_SCOPE("Sim::bifurcation");
+  bifurcation_detail::validate(params, options);
+  const DrivenPendulumFlow flow(params, options.stepsPerPeriod);
+  const std::size_t columns = options.columns;
+  unsigned threads = options.threads != 0
+                         ? options.threads
+                         : std::max(1U, std::thread::hardware_concurrency());
+  threads = static_cast<unsigned>(std::min<std::size_t>(threads, columns));
+  const std::size_t window =
+      16 * kPendulumLanes * static_cast<std::size_t>(threads);
+
+  struct Slot {
+    BifurcationColumn column;
+    bool ready = false;
+  };
+  std::vector<Slot> slots(window);
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::size_t next = 0;    // guarded by mutex
+  std::size_t emitted = 0; // guarded by mutex
+
+  auto worker = [&] {
+    CP_TRACE_THREAD_NAME("bifurcation worker");
+    using bifurcation_detail::Run;
+    PendulumLanes lanes;
+    std::array<Run, kPendulumLanes> runs;
+    std::size_t active = 0;
+    bool exhausted = false;
+    // Starts columns in the idle lanes while the window has room. Only a
+    // worker with no column in flight waits for room, so the column the
+    // emitter waits for is never held up.
+    const auto refill = [&] {
+      std::unique_lock lock(mutex);
+      if (active == 0) {
+        changed.wait(lock, [&] {
+          return next == columns || next < emitted + window;
+        });
+      }
+      for (std::size_t l = 0; l < kPendulumLanes; ++l) {
+        if (next == columns) {
+          exhausted = true;
+          break;
+        }
+        if (next >= emitted + window) {
+          break;
+        }
+        if (!runs[l].active) {
+          runs[l].start(next++, params, options, flow, lanes, l);
+          ++active;
+        }
+      }
+    };
+
+    while (true) {
+      if (!exhausted && active < kPendulumLanes) {
+        refill();
+      }
+      if (active == 0) {
+        return; // refill() only leaves no column in flight at the end
+      }
+      flow.period(lanes);
+      for (std::size_t l = 0; l < kPendulumLanes; ++l) {
+        Run &run = runs[l];
+        if (!run.active ||
+            !run.record(options, lanes.theta[l], lanes.dtheta[l])) {
+          continue;
+        }
+        run.active = false;
+        --active;
+        lanes.A[l] = 0.0;
+        lanes.h[l] = 0.0;
+        const std::lock_guard lock(mutex);
+        Slot &slot = slots[run.column.index % window];
+        std::swap(slot.column, run.column);
+        slot.ready = true;
+        changed.notify_all();
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads);
+  for (unsigned t = 0; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+
+  std::uint64_t points = 0;
+  BifurcationColumn column;
+  for (std::size_t i = 0; i < columns; ++i) {
+    Slot &slot = slots[i % window];
+    {
+      std::unique_lock lock(mutex);
+      changed.wait(lock, [&] { return slot.ready; });
+      std::swap(slot.column, column);
+    }
+    {
+      CP_TRACE_SCOPE("emit");
+      emit(static_cast<const BifurcationColumn &>(column));
+    }
+    points += column.points.size();
+    {
+      const std::lock_guard lock(mutex);
+      std::swap(slot.column, column); // hand the capacity back for reuse
+      slot.ready = false;
+      ++emitted;
+    }
+    changed.notify_all();
+  }
+
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  return points;
+}
+
+} // namespace Sim
@@ -0,0 +1,200 @@
+// deps/Simulations/Ensemble.h
+
+#pragma once
+
+#include <Random.h>
+#include <Pragmas.h>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Sim {
+
+/**
+ * @brief An uncertain input: mean and spread of a normal or uniform
+ * distribution
+ *
+ * spread is the standard deviation of a Normal input and the half-width of
+ * a Uniform one; 0 makes the input exact.
+ */
+struct Spread {
+  enum class Shape { Normal, Uniform };
+  double mean = 0.0;
+  double spread = 0.0;
+  Shape shape = Shape::Normal;
+
+  /**
+   * @brief Samples first, first + 1, ... of the input, drawn from stream
+   * of rng
+   */
+  void draw(const Rng::Philox &rng, std::uint64_t stream, std::uint64_t first,
+            std::span<double> out) const {
+    if (shape == Shape::Normal) {
+      rng.normal(stream, first, out);
+    } else {
+      rng.uniform(stream, first, out);
+    }
+    const double m = mean;
+    const double s = spread;
+    const bool uniform = shape == Shape::Uniform;
+    double *v = out.data();
+    CP_SIMD
+    for (std::size_t i = 0; i < out.size(); ++i) {
+      const double z = uniform ? (2.0 * v[i]) - 1.0 : v[i];
+      v[i] = m + (s * z);
+    }
+  }
+};
+
+/**
+ * @brief Streaming count, mean, variance and extent of an outcome
+ *
+ * add() folds a batch into the running values with Chan's parallel update
+ * (the batch's mean and squared deviations first, then one combine), the
+ * same update merge() applies to another Moments; nothing is stored per
+ * sample. NaN values are skipped.
+ */
+class Moments {
+public:
+  void add(std::span<const double> values) {
+    std::size_t n = 0;
+    double sum = 0.0;
+    double low = std::numeric_limits<double>::infinity();
+    double high = -std::numeric_limits<double>::infinity();
+    for (const double v : values) {
+      const bool present = !std::isnan(v);
+      n += present ? 1 : 0;
+      sum += present ? v : 0.0;
+      low = present ? std::min(low, v) : low;
+      high = present ? std::max(high, v) : high;
+    }
+    if (n == 0) {
+      return;
+    }
+    const double mean = sum / static_cast<double>(n);
+    double m2 = 0.0;
+    for (const double v : values) {
+      const double d = std::isnan(v) ? 0.0 : v - mean;
+      m2 += d * d;
+    }
+    m_min = std::min(m_min, low);
+    m_max = std::max(m_max, high);
+    combine(n, mean, m2);
+  }
+
+  void add(double value) { add(std::span<const double>(&value, 1)); }
+
+  void merge(const Moments &other) {
+    if (other.m_count == 0) {
+      return;
+    }
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    combine(other.m_count, other.m_mean, other.m_m2);
+  }
+
+  std::uint64_t count() const { return m_count; }
+  double mean() const { return m_mean; }
+  double variance() const {
+    return m_count < 2 ? 0.0 : m_m2 / static_cast<double>(m_count - 1);
+  }
+  double stddev() const { return std::sqrt(variance()); }
+  /** @brief Standard error of mean() */
+  double error() const {
+    return m_count == 0 ? 0.0
+                        : std::sqrt(variance() / static_cast<double>(m_count));
+  }
+  double min() const { return m_count == 0 ? 0.0 : m_min; }
+  double max() const { return m_count == 0 ? 0.0 : m_max; }
+
+private:
+  // Chan et al.: merges count values with the given mean and sum of
+  // squared deviations.
+  void combine(std::uint64_t count, double mean, double m2) {
+    const double na = static_cast<double>(m_count);
+    const double nb = static_cast<double>(count);
+    const double n = na + nb;
+    const double delta = mean - m_mean;
+    m_mean += delta * (nb / n);
+    m_m2 += m2 + (delta * delta * (na * nb / n));
+    m_count += count;
+  }
+
+  std::uint64_t m_count = 0;
+  double m_mean = 0.0;
+  double m_m2 = 0.0;
+  double m_min = std::numeric_limits<double>::infinity();
+  double m_max = -std::numeric_limits<double>::infinity();
+};
+
+struct EnsembleOptions {
+  std::uint64_t samples = 1000000;
+  std::uint64_t seed = 1;
+  unsigned threads = 0; // 0: std::thread::hardware_concurrency()
+};
+
+/** @brief Samples per work item of runEnsemble() */
+inline constexpr std::size_t kEnsembleChunk = 4096;
+
+/**
+ * @brief Runs a Monte Carlo ensemble of options.samples samples over
+ * worker threads and returns the merged per-chunk results
+ *
+ * The samples are cut into chunks of kEnsembleChunk. Worker threads take
+ * the next chunk from a shared counter and call
+ * body(partial, rng, first, count) for samples [first, first + count),
+ * with a fresh Partial per chunk; body draws sample i's inputs as variate i
+ * of its streams of rng (a counter-based Rng::Philox seeded with
+ * options.seed). The chunk results are merged in chunk order at the end, so
+ * both the samples and the floating-point reductions, and therefore the
+ * result, are the same for any number of threads. Partial needs a default
+ * constructor and merge(const Partial &).
+ */
+template <typename Partial, typename Body>
+Partial runEnsemble(const EnsembleOptions &options, Body body) {
+  CP_TRACE_SCOPE("runEnsemble");
+  const Rng::Philox rng(options.seed);
+  const std::uint64_t chunks =
+      (options.samples + kEnsembleChunk - 1) / kEnsembleChunk;
+  std::vector<Partial> partial(static_cast<std::size_t>(chunks));
+  std::atomic<std::uint64_t> next{0};
+  const auto work = [&] {
+    for (std::uint64_t c = next++; c < chunks; c = next++) {
+      const std::uint64_t first = c * kEnsembleChunk;
+      const auto count = static_cast<std::size_t>(
+          std::min<std::uint64_t>(kEnsembleChunk, options.samples - first));
+      body(partial[static_cast<std::size_t>(c)], rng, first, count);
+    }
+  };
+
+  unsigned threads = options.threads != 0
+                         ? options.threads
+                         : std::max(1U, std::thread::hardware_concurrency());
+  threads = static_cast<unsigned>(
+      std::clamp<std::uint64_t>(chunks, 1, threads));
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t) {
+    pool.emplace_back(work);
+  }
+  work();
+  for (auto &thread : pool) {
+    thread.join();
+  }
+
+  Partial result;
+  for (const Partial &p : partial) {
+    result.merge(p);
+  }
+  return result;
+}
+
+} // namespace Sim
@@ -0,0 +1,155 @@
+// deps/Simulations/Events.h
+
+#pragma once
+
+#include <RootFinding.h>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace Sim {
+
+/** @brief Direction in which an event function must cross zero */
+enum class Crossing { Any, Rising, Falling };
+
+/**
+ * @brief Whether g crosses zero from g0 (start of a step, excluded) to g1
+ * (end of the step, included)
+ *
+ * A step that starts exactly on zero does not count, so a run that is
+ * stopped or reflected at an event does not find it again.
+ */
+inline bool crosses(double g0, double g1, Crossing crossing) {
+  const bool rising = g0 < 0.0 && g1 >= 0.0;
+  const bool falling = g0 > 0.0 && g1 <= 0.0;
+  switch (crossing) {
+  case Crossing::Rising:
+    return rising;
+  case Crossing::Falling:
+    return falling;
+  default:
+    return rising || falling;
+  }
+}
+
+/** @brief Time tolerance of the event locators, relative to the step */
+inline constexpr double kEventTolerance = 1e-12;
+
+/**
+ * @brief Time in [t0, t1] where g(t) crosses zero, by Brent's method;
+ * g(t0) = g0 and g(t1) = g1 must straddle zero
+ */
+template <typename G>
+double locateCrossing(G g, double t0, double t1, double g0, double g1) {
+  return Roots::brent(g, t0, t1, g0, g1, kEventTolerance * (t1 - t0));
+}
+
+/**
+ * @brief First time in [t0, t1] where g(t) reaches zero, for a g that is
+ * positive at both ends of the step but may dip below zero in between
+ *
+ * This is the closest-approach test: a ball can pass through a hole between
+ * two steps that both end outside it. The minimum of g on the step is
+ * found with Brent's minimizer (g must be unimodal on the step, like a
+ * distance along a smooth path over one step), and the entry is located in
+ * [t0, minimum]. Returns std::nullopt if g stays positive.
+ */
+template <typename G>
+std::optional<double> locateApproach(G g, double t0, double t1, double g0) {
+  const Roots::Minimum closest =
+      Roots::minimize(g, t0, t1, kEventTolerance * (t1 - t0));
+  if (closest.fx > 0.0) {
+    return std::nullopt;
+  }
+  return locateCrossing(g, t0, closest.x, g0, closest.fx);
+}
+
+/**
+ * @brief A user-defined event of a kernel with rows of type Row
+ *
+ * g is evaluated on rows; the event happens where it crosses zero in the
+ * given direction. With approach set, a step whose ends are both positive
+ * is also searched for a dip through zero (see locateApproach()).
+ */
+template <typename Row> struct Event {
+  std::string name;
+  std::function<double(const Row &)> g;
+  Crossing crossing = Crossing::Any;
+  bool approach = false;
+};
+
+/** @brief An event located in a step: which one, when, and the row then */
+template <typename Row> struct EventHit {
+  std::size_t event;
+  double t;
+  Row row;
+};
+
+/**
+ * @brief Earliest event of events in the step from (t0, row0) to
+ * (t1, row1)
+ *
+ * dense(t) must return the row at any t in [t0, t1] (the closed form of
+ * the projectile kernels, or the interpolant of an integrator). Events
+ * are detected by a sign change of g over the step or, for approach
+ * events, by a closest-approach search, and refined with Brent's method,
+ * so the time is accurate to about 1e-12 of the step whatever dt is.
+ */
+template <typename Row, typename Dense>
+std::optional<EventHit<Row>> firstEvent(std::span<const Event<Row>> events,
+                                        double t0, const Row &row0, double t1,
+                                        const Row &row1, Dense dense) {
+  std::optional<EventHit<Row>> first;
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    const Event<Row> &event = events[i];
+    // Only the part of the step before an earlier event matters.
+    const double end = first ? first->t : t1;
+    const auto g = [&](double t) { return event.g(dense(t)); };
+    const double g0 = event.g(row0);
+    const double g1 = first ? g(end) : event.g(row1);
+    std::optional<double> t;
+    if (crosses(g0, g1, event.crossing)) {
+      t = locateCrossing(g, t0, end, g0, g1);
+    } else if (event.approach && g0 > 0.0 && g1 > 0.0) {
+      t = locateApproach(g, t0, end, g0);
+    }
+    if (t && (!first || *t < first->t)) {
+      first = EventHit<Row>{i, *t, dense(*t)};
+    }
+  }
+  return first;
+}
+
+/**
+ * @brief A kernel whose run can end on an event between two steps (the
+ * ground impact of a projectile, the capture or exit of a golf ball)
+ *
+ * terminalRow() is the row at that event, to be written after the rows of
+ * the steps before done(); std::nullopt if the run ends at its final time
+ * instead. A stepped kernel (MiniGolf) knows it once done(), a closed-form
+ * kernel (the projectiles) from the start.
+ */
+template <typename Kernel>
+concept EndsOnEvent = requires(const Kernel &kernel) {
+  {
+    kernel.terminalRow()
+  } -> std::same_as<std::optional<typename Kernel::Row>>;
+};
+
+/** @brief kernel.terminalRow(), or std::nullopt for other kernels */
+template <typename Kernel>
+std::optional<typename Kernel::Row> terminalRowOf(const Kernel &kernel) {
+  if constexpr (EndsOnEvent<Kernel>) {
+    return kernel.terminalRow();
+  } else {
+    return std::nullopt;
+  }
+}
+
+} // namespace Sim
@@ -0,0 +1,76 @@
+// deps/Simulations/Fields.h
+
+#pragma once
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace Sim {
+
+/**
+ * @brief Named member of a kernel's Params struct
+ *
+ * Every kernel lists its parameters in a static `fields` table so tools that
+ * run kernels without the interactive prompts (batch runner, result cache)
+ * can set and print them by name.
+ */
+template <typename Params, typename Scalar = double> struct Field {
+  std::string_view name;
+  Scalar Params::*member;
+};
+
+/**
+ * @brief Sets the parameter called key from its textual value
+ *
+ * Throws std::invalid_argument for an unknown key or a malformed number.
+ */
+template <typename Kernel>
+void setField(typename Kernel::Params &params, std::string_view key,
+              std::string_view value) {
+  for (const auto &field : Kernel::fields) {
+    if (field.name != key) {
+      continue;
+    }
+    const std::string text(value);
+    char *end = nullptr;
+    errno = 0;
+    const double parsed = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || errno == ERANGE) {
+      throw std::invalid_argument("invalid value '" + text + "' for " +
+                                  std::string(key));
+    }
+    using Scalar = std::remove_reference_t<decltype(params.*field.member)>;
+    params.*field.member = static_cast<Scalar>(parsed);
+    return;
+  }
+  throw std::invalid_argument("unknown parameter '" + std::string(key) +
+                              "' for " + std::string(Kernel::name));
+}
+
+/**
+ * @brief Canonical "key=value ..." form of params, in field-table order and
+ * with round-trip precision
+ */
+template <typename Kernel>
+std::string formatFields(const typename Kernel::Params &params) {
+  std::string out;
+  char value[32];
+  for (const auto &field : Kernel::fields) {
+    std::snprintf(value, sizeof(value), "%.17g",
+                  static_cast<double>(params.*field.member));
+    if (!out.empty()) {
+      out += ' ';
+    }
+    out += field.name;
+    out += '=';
+    out += value;
+  }
+  return out;
+}
+
+} // namespace Sim
@@ -0,0 +1,539 @@
+// deps/Simulations/HardDisks.h
+
+#pragma once
+
+#include <Fields.h>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace Sim {
+
+/**
+ * @brief Input parameters of the hard-disk gas in a box 0 < x < Lx,
+ * 0 < y < Ly
+ *
+ * dt is the sampling interval of the observables, not an integration step:
+ * the dynamics between samples is exact.
+ */
+struct HardDisksParams {
+  float Lx = 1.0F;
+  float Ly = 1.0F;
+  float N = 1000.0F;
+  float radius = 0.005F;
+  float v0 = 1.0F;
+  float seed = 1.0F;
+  float t0 = 0.0F;
+  float tf = 1.0F;
+  float dt = 0.01F;
+};
+
+/**
+ * @brief Event-driven molecular dynamics of N equal hard disks (unit mass)
+ * with elastic walls
+ *
+ * Disks fly freely between collisions, so the simulation jumps from one
+ * collision to the next instead of stepping time. Every disk owns exactly
+ * one pending event: the earliest of its next wall collision, its next
+ * cell-boundary crossing and its next collision with a disk in the 3x3
+ * neighbouring cells of a cell list (cells are at least a diameter wide, so
+ * disks about to touch are always neighbours). The priority queue is an
+ * event tree with one leaf per disk, so re-predicting a disk overwrites its
+ * old event in O(log N) and the queue never grows. A collision event also
+ * stores the partner's collision counter and is stale once the partner
+ * collided with someone else; that is only noticed when the event reaches
+ * the root, and the owner is re-predicted then, instead of searching for
+ * every event naming the partner. Positions are kept at each disk's last
+ * event time and extrapolated on demand.
+ *
+ * step() processes every event up to the next sample time and updates the
+ * observables of the interval: pressure from the momentum given to the
+ * walls, kT from the kinetic energy (exactly conserved), and the
+ * compressibility factor Z = P A / (N kT). P and A are those of the region
+ * the centres can reach, (Lx - 2r)(Ly - 2r): the walls stop a disk when its
+ * centre is a radius away. State is double regardless of
+ * the scalar used by the other kernels: collision times are differences of
+ * nearly equal numbers.
+ */
+class HardDisks {
+public:
+  static constexpr std::string_view name = "harddisks";
+  // 2: P and Z of the region the centres reach.
+  static constexpr std::uint32_t outputVersion = 2;
+  static constexpr std::array<std::string_view, 5> columns{
+      "Time(s)", "collisions", "P", "kT", "Z"};
+  using Params = HardDisksParams;
+  static constexpr std::array<Field<Params, float>, 9> fields{
+      {{"Lx", &Params::Lx},
+       {"Ly", &Params::Ly},
+       {"N", &Params::N},
+       {"radius", &Params::radius},
+       {"v0", &Params::v0},
+       {"seed", &Params::seed},
+       {"t0", &Params::t0},
+       {"tf", &Params::tf},
+       {"dt", &Params::dt}}};
+  using Row = std::array<double, columns.size()>;
+
+  explicit HardDisks(const Params &params)
+      : m_params(params), m_Lx(params.Lx), m_Ly(params.Ly),
+        m_radius(params.radius), m_sigma2(4.0 * m_radius * m_radius),
+        m_t0(params.t0), m_tf(params.tf), m_dt(params.dt), m_now(params.t0),
+        m_t(params.t0) {
+    validate(params);
+    CP_TRACE_SCOPE("HardDisks::HardDisks");
+    const auto n = static_cast<std::size_t>(params.N);
+    m_disks.resize(n);
+    for (Disk &disk : m_disks) {
+      disk.t = m_now;
+    }
+
+    // Cells at least one diameter wide, at most ~2 disks per cell.
+    const double diameter = 2.0 * m_radius;
+    const double perCell = std::sqrt(m_Lx * m_Ly / static_cast<double>(n));
+    const double side = std::max(diameter, perCell);
+    m_cellsX = std::max(1, static_cast<int>(m_Lx / side));
+    m_cellsY = std::max(1, static_cast<int>(m_Ly / side));
+    m_cellW = m_Lx / m_cellsX;
+    m_cellH = m_Ly / m_cellsY;
+    m_head.assign(static_cast<std::size_t>(m_cellsX) * m_cellsY, kNone);
+    m_events.resize(n);
+    m_leaves = std::bit_ceil(n);
+    m_tree.assign(2 * m_leaves, Node{});
+
+    placeOnLattice();
+    drawVelocities(static_cast<std::uint64_t>(params.seed));
+    for (std::size_t i = 0; i < n; ++i) {
+      Disk &disk = m_disks[i];
+      disk.cellX =
+          std::clamp(static_cast<int>(disk.x / m_cellW), 0, m_cellsX - 1);
+      disk.cellY =
+          std::clamp(static_cast<int>(disk.y / m_cellH), 0, m_cellsY - 1);
+      link(static_cast<Index>(i));
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      predict(static_cast<Index>(i));
+    }
+    m_kT = kineticEnergy() / static_cast<double>(n);
+  }
+
+  static void validate(const Params &p) {
+    if (p.Lx <= 0.0F || p.Ly <= 0.0F) {
+      throw std::invalid_argument("Lx and Ly should be +ve");
+    }
+    if (p.N < 1.0F || p.N > 1e8F) {
+      throw std::invalid_argument("N should be in [1, 1e8]");
+    }
+    if (p.radius <= 0.0F) {
+      throw std::invalid_argument("radius <= 0");
+    }
+    if (p.v0 <= 0.0F) {
+      throw std::invalid_argument("v0 <= 0");
+    }
+    if (p.dt <= 0.0F) {
+      throw std::invalid_argument("dt <= 0");
+    }
+    const Lattice lattice = latticeFor(p);
+    if (std::min(p.Lx / static_cast<float>(lattice.columns),
+                 p.Ly / static_cast<float>(lattice.rows)) <= 2.0F * p.radius) {
+      throw std::invalid_argument("N disks of this radius do not fit the box");
+    }
+  }
+
+  bool done() const { return m_t >= m_tf; }
+
+  Row row() const {
+    return {m_t, static_cast<double>(m_collisions), m_pressure, m_kT, m_Z};
+  }
+
+  /** @brief Processes every event up to the next sample time */
+  void step() {
+    CP_TRACE_SCOPE("HardDisks::step");
+    ++m_step;
+    const double target = m_t0 + (static_cast<double>(m_step) * m_dt);
+    m_wallImpulse = 0.0;
+    while (m_tree[1].t <= target) {
+      process(m_tree[1].i, m_tree[1].t);
+    }
+    m_now = target;
+    m_t = target;
+
+    const double n = static_cast<double>(m_disks.size());
+    m_kT = kineticEnergy() / n;
+    // The centres move in the box shrunk by a radius on every side, and
+    // they reach its walls.
+    const double width = m_Lx - (2.0 * m_radius);
+    const double height = m_Ly - (2.0 * m_radius);
+    m_pressure = m_wallImpulse / (2.0 * (width + height) * m_dt);
+    m_Z = m_kT > 0.0 ? m_pressure * width * height / (n * m_kT) : 0.0;
+  }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  std::size_t size() const { return m_disks.size(); }
+  /** @brief Disk-disk collisions so far */
+  std::uint64_t collisions() const { return m_collisions; }
+  /** @brief Events processed so far, stale ones and cell crossings included */
+  std::uint64_t eventsProcessed() const { return m_processed; }
+  double packingFraction() const {
+    return static_cast<double>(m_disks.size()) * std::numbers::pi * m_radius *
+           m_radius / (m_Lx * m_Ly);
+  }
+
+  /** @brief Disk centres at the current sample time */
+  void positions(std::vector<float> &x, std::vector<float> &y) const {
+    x.resize(m_disks.size());
+    y.resize(m_disks.size());
+    for (std::size_t i = 0; i < m_disks.size(); ++i) {
+      const Disk &disk = m_disks[i];
+      const double age = m_t - disk.t;
+      x[i] = static_cast<float>(disk.x + (disk.vx * age));
+      y[i] = static_cast<float>(disk.y + (disk.vy * age));
+    }
+  }
+
+  /** @brief Speed of every disk */
+  void speeds(std::vector<float> &v) const {
+    v.resize(m_disks.size());
+    for (std::size_t i = 0; i < m_disks.size(); ++i) {
+      v[i] = static_cast<float>(std::hypot(m_disks[i].vx, m_disks[i].vy));
+    }
+  }
+
+private:
+  using Index = std::int32_t;
+  static constexpr Index kNone = -1;
+  // Partners that are not disks
+  static constexpr Index kWallX = -1;
+  static constexpr Index kWallY = -2;
+  static constexpr Index kCellX = -3;
+  static constexpr Index kCellY = -4;
+  static constexpr double kNever = std::numeric_limits<double>::infinity();
+
+  // One cache line per disk: a pair test touches one line of the partner.
+  // Position is at the disk's own last event time t.
+  struct alignas(64) Disk {
+    double x = 0.0;
+    double y = 0.0;
+    double vx = 0.0;
+    double vy = 0.0;
+    double t = 0.0;
+    std::uint32_t count = 0; // velocity changes
+    int cellX = 0;
+    int cellY = 0;
+    Index next = kNone; // cell list
+    Index prev = kNone;
+  };
+
+  // The pending event of a disk; its time is in the event tree.
+  struct Event {
+    Index partner = kWallX;        // disk index, or kWallX ... kCellY
+    std::uint32_t countPartner = 0; // partner's count when predicted
+  };
+
+  // Event tree node: the earliest event below it and its owner.
+  struct Node {
+    double t = kNever;
+    Index i = kNone;
+  };
+
+  struct Lattice {
+    std::size_t columns;
+    std::size_t rows;
+  };
+
+  static Lattice latticeFor(const Params &p) {
+    const double n = std::floor(p.N);
+    const auto columns = static_cast<std::size_t>(
+        std::max(1.0, std::ceil(std::sqrt(n * p.Lx / p.Ly))));
+    const auto rows = static_cast<std::size_t>(
+        std::ceil(n / static_cast<double>(columns)));
+    return {columns, rows};
+  }
+
+  void placeOnLattice() {
+    const Lattice lattice = latticeFor(m_params);
+    const double sx = m_Lx / static_cast<double>(lattice.columns);
+    const double sy = m_Ly / static_cast<double>(lattice.rows);
+    for (std::size_t i = 0; i < m_disks.size(); ++i) {
+      m_disks[i].x = (static_cast<double>(i % lattice.columns) + 0.5) * sx;
+      m_disks[i].y = (static_cast<double>(i / lattice.columns) + 0.5) * sy;
+    }
+  }
+
+  // Random directions at speed v0, then zero total momentum and rescaled to
+  // kT = v0^2 / 2.
+  void drawVelocities(std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> angle(0.0, 2.0 * std::numbers::pi);
+    double px = 0.0;
+    double py = 0.0;
+    for (Disk &disk : m_disks) {
+      const double a = angle(rng);
+      disk.vx = m_params.v0 * std::cos(a);
+      disk.vy = m_params.v0 * std::sin(a);
+      px += disk.vx;
+      py += disk.vy;
+    }
+    const double n = static_cast<double>(m_disks.size());
+    if (m_disks.size() > 1) {
+      for (Disk &disk : m_disks) {
+        disk.vx -= px / n;
+        disk.vy -= py / n;
+      }
+    }
+    const double target = 0.5 * m_params.v0 * m_params.v0 * n;
+    const double energy = kineticEnergy();
+    const double scale = energy > 0.0 ? std::sqrt(target / energy) : 1.0;
+    for (Disk &disk : m_disks) {
+      disk.vx *= scale;
+      disk.vy *= scale;
+    }
+  }
+
+  double kineticEnergy() const {
+    double sum = 0.0;
+    for (const Disk &disk : m_disks) {
+      sum += (disk.vx * disk.vx) + (disk.vy * disk.vy);
+    }
+    return 0.5 * sum;
+  }
+
+  std::size_t cellOf(const Disk &disk) const {
+    return (static_cast<std::size_t>(disk.cellY) * m_cellsX) + disk.cellX;
+  }
+
+  void link(Index i) {
+    Disk &disk = m_disks[i];
+    Index &head = m_head[cellOf(disk)];
+    disk.prev = kNone;
+    disk.next = head;
+    if (head != kNone) {
+      m_disks[head].prev = i;
+    }
+    head = i;
+  }
+
+  void unlink(Index i) {
+    const Disk &disk = m_disks[i];
+    if (disk.prev != kNone) {
+      m_disks[disk.prev].next = disk.next;
+    } else {
+      m_head[cellOf(disk)] = disk.next;
+    }
+    if (disk.next != kNone) {
+      m_disks[disk.next].prev = disk.prev;
+    }
+  }
+
+  // Moves a disk to the current time.
+  void advance(Disk &disk) const {
+    const double age = m_now - disk.t;
+    disk.x += disk.vx * age;
+    disk.y += disk.vy * age;
+    disk.t = m_now;
+  }
+
+  // Time from now until a and b touch, or kNever. a is at the current time.
+  double pairTime(const Disk &a, const Disk &b) const {
+    const double age = m_now - b.t;
+    const double dx = b.x + (b.vx * age) - a.x;
+    const double dy = b.y + (b.vy * age) - a.y;
+    const double dvx = b.vx - a.vx;
+    const double dvy = b.vy - a.vy;
+    const double approach = (dx * dvx) + (dy * dvy);
+    if (approach >= 0.0) {
+      return kNever; // moving apart
+    }
+    const double v2 = (dvx * dvx) + (dvy * dvy);
+    const double r2 = (dx * dx) + (dy * dy);
+    const double d = (approach * approach) - (v2 * (r2 - m_sigma2));
+    if (d < 0.0) {
+      return kNever; // miss
+    }
+    // Roundoff can leave touching disks a hair inside each other.
+    return std::max(0.0, (-approach - std::sqrt(d)) / v2);
+  }
+
+  static double wallTime(double x, double v, double low, double high) {
+    if (v > 0.0) {
+      return std::max(0.0, (high - x) / v);
+    }
+    if (v < 0.0) {
+      return std::max(0.0, (low - x) / v);
+    }
+    return kNever;
+  }
+
+  static double crossingTime(double x, double v, int cell, int cells,
+                             double width) {
+    if (v > 0.0 && cell + 1 < cells) {
+      return std::max(0.0, ((cell + 1) * width - x) / v);
+    }
+    if (v < 0.0 && cell > 0) {
+      return std::max(0.0, (cell * width - x) / v);
+    }
+    return kNever;
+  }
+
+  // Replaces the pending event of disk i with its earliest one from now.
+  void predict(Index i) {
+    Disk &disk = m_disks[i];
+    advance(disk);
+    double next = kNever;
+    Event event;
+    const auto consider = [&next, &event](double t, Index partner) {
+      if (t < next) {
+        next = t;
+        event.partner = partner;
+      }
+    };
+    consider(wallTime(disk.x, disk.vx, m_radius, m_Lx - m_radius), kWallX);
+    consider(wallTime(disk.y, disk.vy, m_radius, m_Ly - m_radius), kWallY);
+    consider(crossingTime(disk.x, disk.vx, disk.cellX, m_cellsX, m_cellW),
+             kCellX);
+    consider(crossingTime(disk.y, disk.vy, disk.cellY, m_cellsY, m_cellH),
+             kCellY);
+    const int x0 = std::max(0, disk.cellX - 1);
+    const int x1 = std::min(m_cellsX - 1, disk.cellX + 1);
+    const int y0 = std::max(0, disk.cellY - 1);
+    const int y1 = std::min(m_cellsY - 1, disk.cellY + 1);
+    for (int cy = y0; cy <= y1; ++cy) {
+      for (int cx = x0; cx <= x1; ++cx) {
+        const std::size_t cell = (static_cast<std::size_t>(cy) * m_cellsX) + cx;
+        for (Index j = m_head[cell]; j != kNone; j = m_disks[j].next) {
+          if (j != i) {
+            consider(pairTime(disk, m_disks[j]), j);
+          }
+        }
+      }
+    }
+    if (event.partner >= 0) {
+      event.countPartner = m_disks[event.partner].count;
+    }
+    m_events[i] = event;
+    schedule(i, m_now + next); // kNever at rest
+  }
+
+  // Sets the event time of disk i and restores the tree above its leaf.
+  void schedule(Index i, double t) {
+    std::size_t k = m_leaves + static_cast<std::size_t>(i);
+    m_tree[k] = {t, i};
+    while (k > 1) {
+      const Node &a = m_tree[k];
+      const Node &b = m_tree[k ^ 1];
+      const Node winner = a.t <= b.t ? a : b;
+      k >>= 1;
+      if (m_tree[k].t == winner.t && m_tree[k].i == winner.i) {
+        break; // the ancestors are unchanged
+      }
+      m_tree[k] = winner;
+    }
+  }
+
+  // Processes the earliest event, the one of disk i at time t.
+  void process(Index i, double t) {
+    ++m_processed;
+    Disk &a = m_disks[i];
+    const Event event = m_events[i];
+    const Index j = event.partner;
+    m_now = t;
+    if (j >= 0 && m_disks[j].count != event.countPartner) {
+      // The partner changed course since: i's next event is something else.
+      predict(i);
+      return;
+    }
+    advance(a);
+    switch (j) {
+    case kWallX:
+      m_wallImpulse += 2.0 * std::abs(a.vx);
+      a.vx = -a.vx;
+      ++a.count;
+      break;
+    case kWallY:
+      m_wallImpulse += 2.0 * std::abs(a.vy);
+      a.vy = -a.vy;
+      ++a.count;
+      break;
+    case kCellX:
+    case kCellY:
+      // Step the index rather than recompute it from x, which may round
+      // back into the old cell.
+      unlink(i);
+      if (j == kCellX) {
+        a.cellX += a.vx > 0.0 ? 1 : -1;
+      } else {
+        a.cellY += a.vy > 0.0 ? 1 : -1;
+      }
+      link(i);
+      break;
+    default: {
+      Disk &b = m_disks[j];
+      advance(b);
+      const double dx = b.x - a.x;
+      const double dy = b.y - a.y;
+      const double k = ((dx * (b.vx - a.vx)) + (dy * (b.vy - a.vy))) /
+                       ((dx * dx) + (dy * dy));
+      // Equal masses swap the normal components of their velocities.
+      a.vx += k * dx;
+      a.vy += k * dy;
+      b.vx -= k * dx;
+      b.vy -= k * dy;
+      ++a.count;
+      ++b.count;
+      ++m_collisions;
+      predict(j);
+      break;
+    }
+    }
+    predict(i);
+  }
+
+  Params m_params;
+  double m_Lx;
+  double m_Ly;
+  double m_radius;
+  double m_sigma2; // contact distance squared
+  double m_t0;
+  double m_tf;
+  double m_dt;
+  std::uint64_t m_step = 0;
+  double m_now; // time of the last event
+  double m_t;   // last sample time
+
+  std::vector<Disk> m_disks;
+
+  // Cell list: per-cell heads of doubly linked lists through Disk::next
+  int m_cellsX = 1;
+  int m_cellsY = 1;
+  double m_cellW = 0.0;
+  double m_cellH = 0.0;
+  std::vector<Index> m_head;
+
+  // Event tree: a complete binary tree over one leaf per disk (leaf of
+  // disk i at m_leaves + i), every node holding the earliest event below
+  // it, so the next event is at the root m_tree[1].
+  std::vector<Event> m_events;
+  std::size_t m_leaves = 1;
+  std::vector<Node> m_tree;
+  std::uint64_t m_collisions = 0;
+  std::uint64_t m_processed = 0;
+
+  // Observables of the last sample interval
+  double m_wallImpulse = 0.0;
+  double m_pressure = 0.0;
+  double m_kT = 0.0;
+  double m_Z = 0.0;
+};
+
+} // namespace Sim
@@ -0,0 +1,232 @@
+// deps/Simulations/LaunchEnsemble.h
+
+#pragma once
+
+#include <Ensemble.h>
+#include <MiniGolf.h>
+#include <Physics.h>
+#include <PhysicsSimd.h>
+#include <Pragmas.h>
+#include <Projectile.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Sim {
+
+/**
+ * @brief Uncertain launch of the projectile and mini golf kernels
+ *
+ * theta is in degrees; k (1/s) is only used by the air-resistance model,
+ * and samples with k <= 0 fly without drag.
+ */
+struct LaunchSpread {
+  Spread v0{10.0, 0.0};
+  Spread theta{45.0, 0.0};
+  Spread k{0.0, 0.0};
+};
+
+/**
+ * @brief Per-outcome statistics of a launch ensemble
+ *
+ * The projectile models fill range, height and time (the flight time to
+ * y = 0); the mini golf model fills time (until the ball drops or leaves
+ * the table) and successes.
+ */
+struct LaunchStats {
+  Moments range;
+  Moments height;
+  Moments time;
+  std::uint64_t samples = 0;
+  std::uint64_t successes = 0;
+  std::uint64_t unfinished = 0; // mini golf balls stopped at kMaxGolfSteps
+
+  void merge(const LaunchStats &other) {
+    range.merge(other.range);
+    height.merge(other.height);
+    time.merge(other.time);
+    samples += other.samples;
+    successes += other.successes;
+    unfinished += other.unfinished;
+  }
+
+  double successProbability() const {
+    return samples == 0 ? 0.0
+                        : static_cast<double>(successes) /
+                              static_cast<double>(samples);
+  }
+  /** @brief Binomial standard error of successProbability() */
+  double successError() const {
+    const double p = successProbability();
+    return samples == 0
+               ? 0.0
+               : std::sqrt(p * (1.0 - p) / static_cast<double>(samples));
+  }
+};
+
+namespace launch {
+
+// Stream of each input in the ensemble's Philox generator
+inline constexpr std::uint64_t kStreamV0 = 0;
+inline constexpr std::uint64_t kStreamTheta = 1;
+inline constexpr std::uint64_t kStreamK = 2;
+
+// A mini golf shot straight up the table never returns; it is stopped here.
+inline constexpr std::uint64_t kMaxGolfSteps = 10000000;
+
+struct Inputs {
+  std::array<double, kEnsembleChunk> v0;
+  std::array<double, kEnsembleChunk> vx;
+  std::array<double, kEnsembleChunk> vy;
+  std::array<double, kEnsembleChunk> k;
+};
+
+// Draws the chunk's samples and splits v0 along theta.
+inline void draw(const LaunchSpread &spread, const Rng::Philox &rng,
+                 std::uint64_t first, std::size_t count, bool withK,
+                 Inputs &in) {
+  const std::span<double> v0(in.v0.data(), count);
+  const std::span<double> theta(in.vx.data(), count);
+  spread.v0.draw(rng, kStreamV0, first, v0);
+  spread.theta.draw(rng, kStreamTheta, first, theta);
+  if (withK) {
+    spread.k.draw(rng, kStreamK, first, std::span<double>(in.k.data(), count));
+  }
+  constexpr double toRadians = Phy::Const::PI / 180.0;
+  CP_SIMD
+  for (std::size_t i = 0; i < count; ++i) {
+    theta[i] *= toRadians;
+  }
+  const std::span<double> s(in.vy.data(), count);
+  Phy::simd::sincos(std::span<const double>(theta), s, theta);
+  CP_SIMD
+  for (std::size_t i = 0; i < count; ++i) {
+    in.vx[i] *= in.v0[i];
+    in.vy[i] *= in.v0[i];
+  }
+}
+
+// Flight of the linear-drag projectile from (0, 0) back to y = 0:
+// {range, height, time}, the time from flightTime().
+inline std::array<double, 3> dragFlight(double vx, double vy, double k) {
+  const double g = Phy::Const::g;
+  if (vy <= 0.0) {
+    return {0.0, 0.0, 0.0};
+  }
+  const double t = flightTime(vy, k);
+  if (!(k > 1e-9)) {
+    return {vx * t, vy * vy / (2.0 * g), t};
+  }
+  const double terminal = g / k;
+  const double height =
+      (vy / k) - (terminal / k * std::log1p(vy / terminal));
+  return {vx / k * (1.0 - std::exp(-k * t)), height, t};
+}
+
+} // namespace launch
+
+/** @brief Drag-free projectile (closed form) over an uncertain launch */
+inline LaunchStats projectileEnsemble(const LaunchSpread &spread,
+                                      const EnsembleOptions &options) {
+  return runEnsemble<LaunchStats>(
+      options, [&spread](LaunchStats &stats, const Rng::Philox &rng,
+                         std::uint64_t first, std::size_t count) {
+        launch::Inputs in;
+        launch::draw(spread, rng, first, count, false, in);
+        std::array<double, kEnsembleChunk> range;
+        std::array<double, kEnsembleChunk> height;
+        std::array<double, kEnsembleChunk> time;
+        const double g = Phy::Const::g;
+        CP_SIMD
+        for (std::size_t i = 0; i < count; ++i) {
+          const double vy = std::max(in.vy[i], 0.0);
+          time[i] = 2.0 * vy / g;
+          range[i] = in.vx[i] * time[i];
+          height[i] = vy * vy / (2.0 * g);
+        }
+        stats.range.add(std::span<const double>(range.data(), count));
+        stats.height.add(std::span<const double>(height.data(), count));
+        stats.time.add(std::span<const double>(time.data(), count));
+        stats.samples += count;
+      });
+}
+
+/** @brief Projectile with linear air resistance over an uncertain launch
+ * and drag coefficient */
+inline LaunchStats airResistanceEnsemble(const LaunchSpread &spread,
+                                         const EnsembleOptions &options) {
+  return runEnsemble<LaunchStats>(
+      options, [&spread](LaunchStats &stats, const Rng::Philox &rng,
+                         std::uint64_t first, std::size_t count) {
+        launch::Inputs in;
+        launch::draw(spread, rng, first, count, true, in);
+        std::array<double, kEnsembleChunk> range;
+        std::array<double, kEnsembleChunk> height;
+        std::array<double, kEnsembleChunk> time;
+        for (std::size_t i = 0; i < count; ++i) {
+          const auto [r, h, t] =
+              launch::dragFlight(in.vx[i], in.vy[i], in.k[i]);
+          range[i] = r;
+          height[i] = h;
+          time[i] = t;
+        }
+        stats.range.add(std::span<const double>(range.data(), count));
+        stats.height.add(std::span<const double>(height.data(), count));
+        stats.time.add(std::span<const double>(time.data(), count));
+        stats.samples += count;
+      });
+}
+
+/**
+ * @brief Mini golf on the table of `table` over an uncertain shot; each
+ * sample runs the MiniGolf kernel to the end
+ *
+ * Shots with v0 <= 0 never reach the hole and count as failures; theta is
+ * clamped to [-90, 90].
+ */
+inline LaunchStats miniGolfEnsemble(const MiniGolfParams &table,
+                                    const LaunchSpread &spread,
+                                    const EnsembleOptions &options) {
+  MiniGolfParams shot = table; // only the table is checked here
+  shot.v0 = 1.0;
+  shot.theta = 0.0;
+  MiniGolf::validate(shot);
+  return runEnsemble<LaunchStats>(
+      options, [&table, &spread](LaunchStats &stats, const Rng::Philox &rng,
+                                 std::uint64_t first, std::size_t count) {
+        std::array<double, kEnsembleChunk> v0;
+        std::array<double, kEnsembleChunk> theta;
+        std::array<double, kEnsembleChunk> time;
+        spread.v0.draw(rng, launch::kStreamV0, first,
+                       std::span<double>(v0.data(), count));
+        spread.theta.draw(rng, launch::kStreamTheta, first,
+                          std::span<double>(theta.data(), count));
+        std::size_t timed = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+          if (!(v0[i] > 0.0)) {
+            continue;
+          }
+          MiniGolfParams p = table;
+          p.v0 = v0[i];
+          p.theta = std::clamp(theta[i], -90.0, 90.0);
+          MiniGolf ball(p);
+          while (!ball.done() && ball.stepIndex() < launch::kMaxGolfSteps) {
+            ball.step();
+          }
+          if (!ball.done()) {
+            ++stats.unfinished;
+            continue;
+          }
+          stats.successes +=
+              ball.result() == MiniGolfResult::Success ? 1 : 0;
+          time[timed++] = ball.row()[0];
+        }
+        stats.time.add(std::span<const double>(time.data(), timed));
+        stats.samples += count;
+      });
+}
+
+} // namespace Sim
@@ -0,0 +1,616 @@
+// deps/Simulations/LennardJones.h
+
+#pragma once
+
+#include <Fields.h>
+#include <Physics.h>
+#include <Pragmas.h>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace Sim {
+
+/**
+ * @brief Input parameters of the Lennard-Jones fluid in a box 0 < x < Lx,
+ * 0 < y < Ly
+ *
+ * Lengths are in units of sigma and times in units of
+ * tau = sigma sqrt(m / epsilon); T0 is in kelvin and epsilon in joules
+ * (argon by default), which fixes the temperature scale epsilon / k_B.
+ */
+struct LennardJonesParams {
+  float Lx = 40.0F;
+  float Ly = 40.0F;
+  float N = 1000.0F;
+  float T0 = 120.0F;
+  float epsilon = 1.654e-21F;
+  float rc = 2.5F;
+  float skin = 0.3F;
+  float seed = 1.0F;
+  float t0 = 0.0F;
+  float tf = 10.0F;
+  float dt = 0.005F;
+};
+
+/** @brief Box walls of the Lennard-Jones kernel, fixed at compile time */
+enum class Walls { Periodic, Reflecting };
+
+/**
+ * @brief Molecular dynamics of N Lennard-Jones particles, integrated with
+ * velocity Verlet
+ *
+ * The pair potential 4 (r^-12 - r^-6) is cut at rc and shifted to zero
+ * there. Forces come from Verlet neighbour lists holding every pair closer
+ * than rc + skin, each pair once. The lists stay valid until some particle
+ * moved skin / 2 since they were built, so they are rebuilt only then: the
+ * particles are binned into cells at least rc + skin wide (a counting sort,
+ * which also reorders the particle arrays by cell so neighbours are close
+ * in memory) and each particle is tested against its own cell and half of
+ * the neighbouring ones.
+ *
+ * With OpenMP the particles are split into one contiguous block per
+ * thread. Each block has its own neighbour list and its own force buffer,
+ * which receives both halves of every pair the block owns; the buffers are
+ * summed afterwards, so no force update needs an atomic. Without OpenMP
+ * there is a single block and no buffer to sum.
+ *
+ * W selects periodic boundaries (minimum image) or specular reflection at
+ * the walls. The temperature is 2 KE / (k_B dof) with epsilon converting
+ * the reduced kinetic energy to joules; energies and the virial pressure
+ * are reduced (per particle, and epsilon / sigma^2). With reflecting walls
+ * the pressure is the bulk virial estimate, without the walls' impulse.
+ */
+template <Walls W = Walls::Periodic> class BasicLennardJones {
+public:
+  static constexpr Walls walls = W;
+  static constexpr std::string_view name =
+      W == Walls::Periodic ? "lennardjones" : "lennardjones-walls";
+  static constexpr std::array<std::string_view, 7> columns{
+      "Time(s)", "T(K)", "KE", "PE", "E", "P", "rebuilds"};
+  using Params = LennardJonesParams;
+  static constexpr std::array<Field<Params, float>, 11> fields{
+      {{"Lx", &Params::Lx},
+       {"Ly", &Params::Ly},
+       {"N", &Params::N},
+       {"T0", &Params::T0},
+       {"epsilon", &Params::epsilon},
+       {"rc", &Params::rc},
+       {"skin", &Params::skin},
+       {"seed", &Params::seed},
+       {"t0", &Params::t0},
+       {"tf", &Params::tf},
+       {"dt", &Params::dt}}};
+  using Row = std::array<double, columns.size()>;
+
+  explicit BasicLennardJones(const Params &params)
+      : m_params(params), m_Lx(params.Lx), m_Ly(params.Ly),
+        m_rc2(static_cast<double>(params.rc) * params.rc),
+        m_list2(static_cast<double>(params.rc + params.skin) *
+                (params.rc + params.skin)),
+        m_halfSkin2(0.25 * params.skin * params.skin), m_t0(params.t0),
+        m_tf(params.tf), m_dt(params.dt), m_t(params.t0) {
+    validate(params);
+    CP_TRACE_SCOPE("LennardJones::LennardJones");
+    const double inv6 = 1.0 / (m_rc2 * m_rc2 * m_rc2);
+    m_shift = 4.0 * inv6 * (inv6 - 1.0);
+
+    const auto n = static_cast<std::size_t>(params.N);
+    for (auto *v : {&m_x, &m_y, &m_vx, &m_vy, &m_fx, &m_fy, &m_x0, &m_y0}) {
+      v->resize(n);
+    }
+    m_cell.resize(n);
+    m_end.resize(n);
+
+    const double side = params.rc + params.skin;
+    m_cellsX = std::max(1, static_cast<int>(m_Lx / side));
+    m_cellsY = std::max(1, static_cast<int>(m_Ly / side));
+    m_cellW = m_Lx / m_cellsX;
+    m_cellH = m_Ly / m_cellsY;
+    m_cellStart.resize((static_cast<std::size_t>(m_cellsX) * m_cellsY) + 1);
+
+#if defined(_OPENMP)
+    m_blocks = static_cast<std::size_t>(std::max(1, omp_get_max_threads()));
+#endif
+    m_blocks = std::min(m_blocks, n);
+    m_lists.resize(m_blocks);
+    m_bufX.resize(m_blocks - 1);
+    m_bufY.resize(m_blocks - 1);
+    for (std::size_t b = 0; b + 1 < m_blocks; ++b) {
+      m_bufX[b].resize(n);
+      m_bufY[b].resize(n);
+    }
+
+    placeOnLattice();
+    drawVelocities(static_cast<std::uint64_t>(params.seed));
+    rebuild();
+    computeForces();
+    m_kinetic = kineticEnergy();
+  }
+
+  static void validate(const Params &p) {
+    if (p.Lx <= 0.0F || p.Ly <= 0.0F) {
+      throw std::invalid_argument("Lx and Ly should be +ve");
+    }
+    if (p.N < 1.0F || p.N > 1e8F) {
+      throw std::invalid_argument("N should be in [1, 1e8]");
+    }
+    if (p.T0 < 0.0F) {
+      throw std::invalid_argument("T0 < 0");
+    }
+    if (p.epsilon <= 0.0F) {
+      throw std::invalid_argument("epsilon <= 0");
+    }
+    if (p.rc <= 0.0F || p.skin <= 0.0F) {
+      throw std::invalid_argument("rc and skin should be +ve");
+    }
+    if (p.dt <= 0.0F) {
+      throw std::invalid_argument("dt <= 0");
+    }
+    if (W == Walls::Periodic &&
+        std::min(p.Lx, p.Ly) < 3.0F * (p.rc + p.skin)) {
+      throw std::invalid_argument(
+          "periodic box should be at least 3 (rc + skin) wide");
+    }
+    const Lattice lattice = latticeFor(p);
+    if (std::min(p.Lx / static_cast<float>(lattice.columns),
+                 p.Ly / static_cast<float>(lattice.rows)) < 0.8F) {
+      throw std::invalid_argument(
+          "N particles start closer than 0.8 sigma: enlarge the box");
+    }
+  }
+
+  bool done() const { return m_t >= m_tf; }
+
+  Row row() const {
+    const double n = static_cast<double>(m_x.size());
+    const double temperature = reducedTemperature();
+    const double pressure =
+        ((n * temperature) + (0.5 * m_virial)) / (m_Lx * m_Ly);
+    return {m_t,
+            temperature * m_params.epsilon / Phy::Const::k_B,
+            m_kinetic / n,
+            m_potential / n,
+            (m_kinetic + m_potential) / n,
+            pressure,
+            static_cast<double>(m_rebuilds)};
+  }
+
+  /** @brief One velocity Verlet step; rebuilds the lists when needed */
+  void step() {
+    CP_TRACE_SCOPE("LennardJones::step");
+    ++m_step;
+    m_t = m_t0 + (static_cast<double>(m_step) * m_dt);
+    if (kickAndDrift() > m_halfSkin2) {
+      rebuild();
+    }
+    computeForces();
+    m_kinetic = kick();
+  }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  std::size_t size() const { return m_x.size(); }
+  /** @brief Neighbour-list rebuilds, the one at construction included */
+  std::uint64_t rebuilds() const { return m_rebuilds; }
+  /** @brief Pairs in the neighbour lists */
+  std::size_t pairs() const {
+    std::size_t count = 0;
+    for (const auto &list : m_lists) {
+      count += list.size();
+    }
+    return count;
+  }
+  /** @brief Threads sharing the force computation */
+  std::size_t blocks() const { return m_blocks; }
+
+  /** @brief Particle positions, in the order of the last rebuild */
+  void positions(std::vector<float> &x, std::vector<float> &y) const {
+    x.assign(m_x.begin(), m_x.end());
+    y.assign(m_y.begin(), m_y.end());
+  }
+
+  /** @brief Speed of every particle, in the order of positions() */
+  void speeds(std::vector<float> &v) const {
+    v.resize(m_vx.size());
+    for (std::size_t i = 0; i < m_vx.size(); ++i) {
+      v[i] = static_cast<float>(std::hypot(m_vx[i], m_vy[i]));
+    }
+  }
+
+private:
+  using Index = std::int32_t;
+
+  struct Lattice {
+    std::size_t columns;
+    std::size_t rows;
+  };
+
+  static Lattice latticeFor(const Params &p) {
+    const double n = std::floor(p.N);
+    const auto columns = static_cast<std::size_t>(
+        std::max(1.0, std::ceil(std::sqrt(n * p.Lx / p.Ly))));
+    const auto rows = static_cast<std::size_t>(
+        std::ceil(n / static_cast<double>(columns)));
+    return {columns, rows};
+  }
+
+  void placeOnLattice() {
+    const Lattice lattice = latticeFor(m_params);
+    const double sx = m_Lx / static_cast<double>(lattice.columns);
+    const double sy = m_Ly / static_cast<double>(lattice.rows);
+    for (std::size_t i = 0; i < m_x.size(); ++i) {
+      m_x[i] = (static_cast<double>(i % lattice.columns) + 0.5) * sx;
+      m_y[i] = (static_cast<double>(i / lattice.columns) + 0.5) * sy;
+    }
+  }
+
+  // Degrees of freedom: total momentum is conserved with periodic walls.
+  double degreesOfFreedom() const {
+    const double dof = 2.0 * static_cast<double>(m_x.size());
+    return W == Walls::Periodic && m_x.size() > 1 ? dof - 2.0 : dof;
+  }
+
+  double reducedTemperature() const {
+    return 2.0 * m_kinetic / degreesOfFreedom();
+  }
+
+  // Gaussian velocities, zero total momentum, rescaled to exactly T0.
+  void drawVelocities(std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> normal;
+    double px = 0.0;
+    double py = 0.0;
+    for (std::size_t i = 0; i < m_vx.size(); ++i) {
+      m_vx[i] = normal(rng);
+      m_vy[i] = normal(rng);
+      px += m_vx[i];
+      py += m_vy[i];
+    }
+    const double n = static_cast<double>(m_vx.size());
+    if (m_vx.size() > 1) {
+      for (std::size_t i = 0; i < m_vx.size(); ++i) {
+        m_vx[i] -= px / n;
+        m_vy[i] -= py / n;
+      }
+    }
+    const double target =
+        m_params.T0 * Phy::Const::k_B / m_params.epsilon;
+    const double energy = kineticEnergy();
+    const double scale =
+        energy > 0.0 ? std::sqrt(0.5 * target * degreesOfFreedom() / energy)
+                     : 0.0;
+    for (std::size_t i = 0; i < m_vx.size(); ++i) {
+      m_vx[i] *= scale;
+      m_vy[i] *= scale;
+    }
+  }
+
+  double kineticEnergy() const {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < m_vx.size(); ++i) {
+      sum += (m_vx[i] * m_vx[i]) + (m_vy[i] * m_vy[i]);
+    }
+    return 0.5 * sum;
+  }
+
+  // Shortest periodic image of a separation; no-op with reflecting walls.
+  static double image(double d, double length, double inverse) {
+    if constexpr (W == Walls::Periodic) {
+      return d - (length * std::nearbyint(d * inverse));
+    } else {
+      return d;
+    }
+  }
+
+  static void wall(double &x, double &v, double length) {
+    if constexpr (W == Walls::Periodic) {
+      x -= length * std::floor(x / length);
+    } else {
+      const bool low = x < 0.0;
+      const bool high = x > length;
+      x = low ? -x : (high ? (2.0 * length) - x : x);
+      v = low || high ? -v : v;
+    }
+  }
+
+  // Half kick, drift and walls. Returns the largest squared displacement
+  // since the last rebuild.
+  double kickAndDrift() {
+    const std::size_t n = m_x.size();
+    const double half = 0.5 * m_dt;
+    const double dt = m_dt;
+    const double Lx = m_Lx;
+    const double Ly = m_Ly;
+    const double invLx = 1.0 / m_Lx;
+    const double invLy = 1.0 / m_Ly;
+    double *x = m_x.data();
+    double *y = m_y.data();
+    double *vx = m_vx.data();
+    double *vy = m_vy.data();
+    const double *fx = m_fx.data();
+    const double *fy = m_fy.data();
+    const double *x0 = m_x0.data();
+    const double *y0 = m_y0.data();
+    double moved = 0.0;
+    CP_OMP(omp parallel for reduction(max : moved))
+    for (std::size_t i = 0; i < n; ++i) {
+      vx[i] += fx[i] * half;
+      vy[i] += fy[i] * half;
+      x[i] += vx[i] * dt;
+      y[i] += vy[i] * dt;
+      wall(x[i], vx[i], Lx);
+      wall(y[i], vy[i], Ly);
+      const double dx = image(x[i] - x0[i], Lx, invLx);
+      const double dy = image(y[i] - y0[i], Ly, invLy);
+      moved = std::max(moved, (dx * dx) + (dy * dy));
+    }
+    return moved;
+  }
+
+  // Second half kick. Returns the kinetic energy.
+  double kick() {
+    const std::size_t n = m_x.size();
+    const double half = 0.5 * m_dt;
+    double *vx = m_vx.data();
+    double *vy = m_vy.data();
+    const double *fx = m_fx.data();
+    const double *fy = m_fy.data();
+    double sum = 0.0;
+    CP_OMP(omp parallel for reduction(+ : sum))
+    for (std::size_t i = 0; i < n; ++i) {
+      vx[i] += fx[i] * half;
+      vy[i] += fy[i] * half;
+      sum += (vx[i] * vx[i]) + (vy[i] * vy[i]);
+    }
+    return 0.5 * sum;
+  }
+
+  std::size_t blockBegin(std::size_t b) const {
+    return m_x.size() * b / m_blocks;
+  }
+
+  std::size_t cellOf(double x, double y) const {
+    const int cx = std::clamp(static_cast<int>(x / m_cellW), 0, m_cellsX - 1);
+    const int cy = std::clamp(static_cast<int>(y / m_cellH), 0, m_cellsY - 1);
+    return (static_cast<std::size_t>(cy) * m_cellsX) + cx;
+  }
+
+  // Sorts the particles by cell and rebuilds every block's neighbour list.
+  void rebuild() {
+    CP_TRACE_SCOPE("LennardJones::rebuild");
+    ++m_rebuilds;
+    const std::size_t n = m_x.size();
+
+    // Counting sort by cell
+    std::fill(m_cellStart.begin(), m_cellStart.end(), 0);
+    for (std::size_t i = 0; i < n; ++i) {
+      m_cell[i] = static_cast<Index>(cellOf(m_x[i], m_y[i]));
+      ++m_cellStart[static_cast<std::size_t>(m_cell[i]) + 1];
+    }
+    for (std::size_t c = 1; c < m_cellStart.size(); ++c) {
+      m_cellStart[c] += m_cellStart[c - 1];
+    }
+    m_order.resize(n);
+    {
+      std::vector<Index> next(m_cellStart.begin(), m_cellStart.end() - 1);
+      for (std::size_t i = 0; i < n; ++i) {
+        m_order[next[static_cast<std::size_t>(m_cell[i])]++] =
+            static_cast<Index>(i);
+      }
+    }
+    for (auto *v : {&m_x, &m_y, &m_vx, &m_vy}) {
+      permute(*v);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      m_cell[i] = static_cast<Index>(cellOf(m_x[i], m_y[i]));
+    }
+    m_x0 = m_x;
+    m_y0 = m_y;
+
+    CP_OMP(omp parallel for schedule(static, 1))
+    for (std::size_t b = 0; b < m_blocks; ++b) {
+      buildList(b);
+    }
+  }
+
+  void permute(std::vector<double> &values) {
+    m_scratch.resize(values.size());
+    const double *from = values.data();
+    double *to = m_scratch.data();
+    const Index *order = m_order.data();
+    const std::size_t n = values.size();
+    CP_OMP(omp parallel for)
+    for (std::size_t i = 0; i < n; ++i) {
+      to[i] = from[order[i]];
+    }
+    values.swap(m_scratch);
+  }
+
+  // Pairs (i, j) within rc + skin for the particles i of block b: j later
+  // in i's own cell, or anywhere in the cells right, above-left, above and
+  // above-right of it, so every pair is listed once.
+  void buildList(std::size_t b) {
+    static constexpr std::array<std::array<int, 2>, 4> kHalfStencil{
+        {{1, 0}, {-1, 1}, {0, 1}, {1, 1}}};
+    std::vector<Index> &list = m_lists[b];
+    list.clear();
+    const double invLx = 1.0 / m_Lx;
+    const double invLy = 1.0 / m_Ly;
+    const std::size_t last = blockBegin(b + 1);
+    for (std::size_t i = blockBegin(b); i < last; ++i) {
+      const double xi = m_x[i];
+      const double yi = m_y[i];
+      const auto consider = [&](std::size_t from, std::size_t to) {
+        for (std::size_t j = from; j < to; ++j) {
+          const double dx = image(xi - m_x[j], m_Lx, invLx);
+          const double dy = image(yi - m_y[j], m_Ly, invLy);
+          if ((dx * dx) + (dy * dy) < m_list2) {
+            list.push_back(static_cast<Index>(j));
+          }
+        }
+      };
+      const auto c = static_cast<std::size_t>(m_cell[i]);
+      consider(i + 1, static_cast<std::size_t>(m_cellStart[c + 1]));
+      const int cx = static_cast<int>(c % m_cellsX);
+      const int cy = static_cast<int>(c / m_cellsX);
+      for (const auto &[ox, oy] : kHalfStencil) {
+        int nx = cx + ox;
+        int ny = cy + oy;
+        if constexpr (W == Walls::Periodic) {
+          nx = (nx + m_cellsX) % m_cellsX;
+          ny = ny % m_cellsY;
+        } else if (nx < 0 || nx >= m_cellsX || ny >= m_cellsY) {
+          continue;
+        }
+        const std::size_t neighbour =
+            (static_cast<std::size_t>(ny) * m_cellsX) + nx;
+        consider(static_cast<std::size_t>(m_cellStart[neighbour]),
+                 static_cast<std::size_t>(m_cellStart[neighbour + 1]));
+      }
+      m_end[i] = list.size();
+    }
+  }
+
+  void computeForces() {
+    CP_TRACE_SCOPE("LennardJones::forces");
+    const std::size_t n = m_x.size();
+    double potential = 0.0;
+    double virial = 0.0;
+    CP_OMP(omp parallel for schedule(static, 1)
+               reduction(+ : potential, virial))
+    for (std::size_t b = 0; b < m_blocks; ++b) {
+      double *fx = b == 0 ? m_fx.data() : m_bufX[b - 1].data();
+      double *fy = b == 0 ? m_fy.data() : m_bufY[b - 1].data();
+      std::fill(fx, fx + n, 0.0);
+      std::fill(fy, fy + n, 0.0);
+      const auto [u, w] = blockForces(b, fx, fy);
+      potential += u;
+      virial += w;
+    }
+    if (m_blocks > 1) {
+      double *fx = m_fx.data();
+      double *fy = m_fy.data();
+      CP_OMP(omp parallel for)
+      for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t b = 0; b + 1 < m_blocks; ++b) {
+          fx[i] += m_bufX[b][i];
+          fy[i] += m_bufY[b][i];
+        }
+      }
+    }
+    m_potential = potential;
+    m_virial = virial;
+  }
+
+  struct Sums {
+    double potential;
+    double virial;
+  };
+
+  // Forces of block b's pairs into (fx, fy), both halves of each pair.
+  Sums blockForces(std::size_t b, double *fx, double *fy) const {
+    const double *x = m_x.data();
+    const double *y = m_y.data();
+    const Index *list = m_lists[b].data();
+    const double Lx = m_Lx;
+    const double Ly = m_Ly;
+    const double invLx = 1.0 / m_Lx;
+    const double invLy = 1.0 / m_Ly;
+    const double rc2 = m_rc2;
+    const double shift = m_shift;
+    double potential = 0.0;
+    double virial = 0.0;
+    std::size_t k = 0;
+    const std::size_t last = blockBegin(b + 1);
+    for (std::size_t i = blockBegin(b); i < last; ++i) {
+      const double xi = x[i];
+      const double yi = y[i];
+      double fxi = 0.0;
+      double fyi = 0.0;
+      for (const std::size_t end = m_end[i]; k < end; ++k) {
+        const auto j = static_cast<std::size_t>(list[k]);
+        const double dx = image(xi - x[j], Lx, invLx);
+        const double dy = image(yi - y[j], Ly, invLy);
+        const double r2 = (dx * dx) + (dy * dy);
+        if (r2 >= rc2) {
+          continue; // in the skin
+        }
+        const double inv2 = 1.0 / r2;
+        const double inv6 = inv2 * inv2 * inv2;
+        // |F| / r, so that F = f (dx, dy)
+        const double f = 24.0 * inv2 * inv6 * ((2.0 * inv6) - 1.0);
+        fxi += f * dx;
+        fyi += f * dy;
+        fx[j] -= f * dx;
+        fy[j] -= f * dy;
+        potential += (4.0 * inv6 * (inv6 - 1.0)) - shift;
+        virial += f * r2;
+      }
+      fx[i] += fxi;
+      fy[i] += fyi;
+    }
+    return {potential, virial};
+  }
+
+  Params m_params;
+  double m_Lx;
+  double m_Ly;
+  double m_rc2;       // cutoff squared
+  double m_list2;     // (rc + skin) squared
+  double m_halfSkin2; // (skin / 2) squared: rebuild threshold
+  double m_shift = 0.0;
+  double m_t0;
+  double m_tf;
+  double m_dt;
+  std::uint64_t m_step = 0;
+  double m_t;
+
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+  std::vector<double> m_vx;
+  std::vector<double> m_vy;
+  std::vector<double> m_fx;
+  std::vector<double> m_fy;
+  std::vector<double> m_x0; // positions at the last rebuild
+  std::vector<double> m_y0;
+
+  // Cells: particles of cell c are [m_cellStart[c], m_cellStart[c + 1])
+  // after a rebuild.
+  int m_cellsX = 1;
+  int m_cellsY = 1;
+  double m_cellW = 0.0;
+  double m_cellH = 0.0;
+  std::vector<Index> m_cellStart;
+  std::vector<Index> m_cell;
+  std::vector<Index> m_order;
+  std::vector<double> m_scratch;
+
+  // One neighbour list and (but the first) one force buffer per block;
+  // particle i's neighbours end at m_lists[block][m_end[i]].
+  std::size_t m_blocks = 1;
+  std::vector<std::vector<Index>> m_lists;
+  std::vector<std::size_t> m_end;
+  std::vector<std::vector<double>> m_bufX;
+  std::vector<std::vector<double>> m_bufY;
+  std::uint64_t m_rebuilds = 0;
+
+  double m_kinetic = 0.0;
+  double m_potential = 0.0;
+  double m_virial = 0.0;
+};
+
+using LennardJones = BasicLennardJones<Walls::Periodic>;
+
+} // namespace Sim
@@ -0,0 +1,166 @@
+// deps/Simulations/Lissajous.h
+
+#pragma once
+
+#include <Physics.h>
+#include <PhysicsSimd.h>
+#include <Pragmas.h>
+#include <TimeGrid.h>
+#include <Fields.h>
+#include <Scalar.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace Sim {
+
+/**
+ * @brief Input parameters of the Lissajous curve x = R cos(w1 t),
+ * y = R sin(w2 t)
+ */
+struct LissajousParams {
+  double w1 = 1.0;
+  double w2 = 2.0;
+  double R = 1.0;
+  double t0 = 0.0;
+  double tf = 10.0;
+  double dt = 0.01;
+};
+
+/**
+ * @brief Lissajous figure (closed-form solution), evaluated in T
+ */
+template <typename T = double> class BasicLissajous {
+public:
+  using Scalar = T;
+
+  static constexpr std::string_view name = "lissajous";
+  static constexpr std::array<std::string_view, 5> columns{
+      "Time(s)", "x(t)", "y(t)", "Vx(t)", "Vy(t)"};
+  using Params = LissajousParams;
+  static constexpr std::array<Field<Params>, 6> fields{
+      {{"w1", &Params::w1},
+       {"w2", &Params::w2},
+       {"R", &Params::R},
+       {"t0", &Params::t0},
+       {"tf", &Params::tf},
+       {"dt", &Params::dt}}};
+  using Row = std::array<double, columns.size()>;
+
+  explicit BasicLissajous(const Params &params)
+      : m_params(params), m_w1(static_cast<T>(params.w1)),
+        m_w2(static_cast<T>(params.w2)), m_R(static_cast<T>(params.R)),
+        m_t0(static_cast<T>(params.t0)), m_tf(static_cast<T>(params.tf)),
+        m_dt(static_cast<T>(params.dt)) {
+    validate(params);
+  }
+
+  static void validate(const Params &p) {
+    if (p.w1 <= 0.0 || p.w2 <= 0.0) {
+      throw std::invalid_argument("Angular frequencies must be positive.");
+    }
+    if (p.dt <= 0.0) {
+      throw std::invalid_argument("Time step must be positive.");
+    }
+  }
+
+  bool done() const { return time() > m_tf; }
+  std::uint64_t size() const { return gridSize(m_t0, m_tf, m_dt); }
+
+  Row row() const { return at(m_step); }
+
+  /**
+   * @brief Row of step i; closed form, so steps can be evaluated in any
+   * order and in parallel
+   */
+  Row at(std::uint64_t i) const {
+    const T t = timeAt(i);
+    const T R = m_R;
+    T s1;
+    T c1;
+    T s2;
+    T c2;
+    Phy::simd::sincos(m_w1 * t, s1, c1);
+    Phy::simd::sincos(m_w2 * t, s2, c2);
+    return {static_cast<double>(t), static_cast<double>(R * c1),
+            static_cast<double>(R * s2), static_cast<double>(-R * m_w1 * s1),
+            static_cast<double>(R * m_w2 * c2)};
+  }
+
+  /**
+   * @brief Steps [first, first + count) into one buffer per column, the
+   * phases of each batch through Phy::simd::sincos (see EvaluatesColumns)
+   */
+  void evaluateColumns(std::uint64_t first, std::size_t count,
+                       const std::array<double *, columns.size()> &out) const
+    requires Phy::simd::Vectorizable<T>
+  {
+    std::array<T, kGridBatch> t{};
+    std::array<T, kGridBatch> phase{};
+    std::array<T, kGridBatch> s1{};
+    std::array<T, kGridBatch> c1{};
+    std::array<T, kGridBatch> s2{};
+    std::array<T, kGridBatch> c2{};
+    const T R = m_R;
+    for (std::size_t b = 0; b < count; b += kGridBatch) {
+      const std::size_t n = std::min(kGridBatch, count - b);
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        t[j] = timeAt(first + b + j);
+        phase[j] = m_w1 * t[j];
+      }
+      Phy::simd::sincos(std::span<const T>(phase.data(), n),
+                        std::span<T>(s1.data(), n), std::span<T>(c1.data(), n));
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        phase[j] = m_w2 * t[j];
+      }
+      Phy::simd::sincos(std::span<const T>(phase.data(), n),
+                        std::span<T>(s2.data(), n), std::span<T>(c2.data(), n));
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        out[0][b + j] = static_cast<double>(t[j]);
+        out[1][b + j] = static_cast<double>(R * c1[j]);
+        out[2][b + j] = static_cast<double>(R * s2[j]);
+        out[3][b + j] = static_cast<double>(-R * m_w1 * s1[j]);
+        out[4][b + j] = static_cast<double>(R * m_w2 * c2[j]);
+      }
+    }
+  }
+
+  void step() { ++m_step; }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  double period1() const { return 2.0 * Phy::Const::PI / m_params.w1; }
+  double period2() const { return 2.0 * Phy::Const::PI / m_params.w2; }
+  /** @brief Phases of x and y advanced per step (radians), for
+   * PeriodicReplay */
+  std::array<double, 2> phaseSteps() const {
+    return {m_params.w1 * m_params.dt, m_params.w2 * m_params.dt};
+  }
+
+private:
+  Params m_params;
+  T m_w1;
+  T m_w2;
+  T m_R;
+  T m_t0;
+  T m_tf;
+  T m_dt;
+  std::uint64_t m_step = 0;
+
+  T time() const { return timeAt(m_step); }
+  T timeAt(std::uint64_t i) const {
+    return m_t0 + (static_cast<T>(i) * m_dt);
+  }
+};
+
+using Lissajous = BasicLissajous<DefaultScalar<double>>;
+
+} // namespace Sim
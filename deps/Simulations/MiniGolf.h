@@ -0,0 +1,341 @@
+// deps/Simulations/MiniGolf.h
+
+#pragma once
+
+#include <Events.h>
+#include <Physics.h>
+#include <Fields.h>
+#include <Scalar.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace Sim {
+
+/**
+ * @brief Input parameters of the mini golf table
+ *
+ * The box 0 < x < Lx, 0 < y < Ly is open at x = 0 and has a hole at
+ * (xc, yc) of radius R. The ball is shot from (0, Ly/2) with speed v0 at
+ * angle theta (degrees).
+ */
+struct MiniGolfParams {
+  double Lx = 10.0;
+  double Ly = 5.0;
+  double xc = 8.0;
+  double yc = 2.5;
+  double R = 0.5;
+  double v0 = 5.0;
+  double theta = 10.0;
+  double dt = 0.01;
+};
+
+/** @brief Outcome of a mini golf run */
+enum class MiniGolfResult { Running, Success, Failure };
+
+/**
+ * @brief Mini golf ball integrated with x = x + vx * dt
+ *
+ * The run ends when the ball falls in the hole (success) or leaves the
+ * table through x = 0 (failure). T is the scalar of the state and of the
+ * integration; S selects plain or compensated accumulation of the
+ * positions.
+ *
+ * Walls, the open side and the hole are events located inside the step
+ * (Events.h): the ball reflects at the moment it reaches a wall, and it
+ * drops in the hole if its path crosses the circle anywhere in the step,
+ * not only if a step happens to end inside it. The outcome and the bounce
+ * points therefore do not depend on dt; the last row (terminalRow()) is at
+ * the exact time of the capture or exit.
+ */
+template <typename T = double, Summation S = Summation::Plain>
+class BasicMiniGolf {
+public:
+  using Result = MiniGolfResult;
+  using Scalar = T;
+  static constexpr Summation summation = S;
+
+  static constexpr std::string_view name = "minigolf";
+  // 2: the row of the capture or exit is the last row.
+  static constexpr std::uint32_t outputVersion = 2;
+  static constexpr std::array<std::string_view, 5> columns{
+      "Time(s)", "x(t)", "y(t)", "Vx(t)", "Vy(t)"};
+  using Params = MiniGolfParams;
+  static constexpr std::array<Field<Params>, 8> fields{
+      {{"Lx", &Params::Lx},
+       {"Ly", &Params::Ly},
+       {"xc", &Params::xc},
+       {"yc", &Params::yc},
+       {"R", &Params::R},
+       {"v0", &Params::v0},
+       {"theta", &Params::theta},
+       {"dt", &Params::dt}}};
+  using Row = std::array<double, columns.size()>;
+
+  static constexpr double x0 = 0.00001;
+
+  explicit BasicMiniGolf(const Params &params)
+      : m_params(params), m_boundaries(boundaries(params)) {
+    validate(params);
+    const T theta = static_cast<T>(Phy::utils::deg2rad(params.theta));
+    m_R = static_cast<T>(params.R);
+    m_Lx = static_cast<T>(params.Lx);
+    m_Ly = static_cast<T>(params.Ly);
+    m_xc = static_cast<T>(params.xc);
+    m_yc = static_cast<T>(params.yc);
+    m_dt = static_cast<T>(params.dt);
+    m_x = Accumulator<T, S>(static_cast<T>(x0));
+    m_y = Accumulator<T, S>(m_Ly / T(2));
+    m_vx = static_cast<T>(params.v0) * std::cos(theta);
+    m_vy = static_cast<T>(params.v0) * std::sin(theta);
+  }
+
+  static void validate(const Params &p) {
+    if (p.Lx <= 0.0) {
+      throw std::invalid_argument("Lx <= 0");
+    }
+    if (p.Ly <= 0.0) {
+      throw std::invalid_argument("Ly <= 0");
+    }
+    if (p.v0 <= 0.0) {
+      throw std::invalid_argument("v0 <= 0");
+    }
+    if (std::abs(p.theta) > 90.0) {
+      throw std::invalid_argument("theta > 90");
+    }
+    if (p.dt <= 0.0) {
+      throw std::invalid_argument("dt <= 0");
+    }
+  }
+
+  bool done() const { return m_result != Result::Running; }
+
+  Row row() const {
+    return {static_cast<double>(m_t), static_cast<double>(m_x.value()),
+            static_cast<double>(m_y.value()), static_cast<double>(m_vx),
+            static_cast<double>(m_vy)};
+  }
+
+  /** @brief Row of the capture or exit, once done() */
+  std::optional<Row> terminalRow() const {
+    if (!done()) {
+      return std::nullopt;
+    }
+    return row();
+  }
+
+  void step() {
+    ++m_step;
+    if (clearStep()) {
+      m_x += m_vx * m_dt;
+      m_y += m_vy * m_dt;
+      m_t = static_cast<T>(m_step) * m_dt;
+      return;
+    }
+    T left = m_dt; // of this step, still to move
+    while (true) {
+      const Move move = nextEvent(left);
+      m_x += m_vx * static_cast<T>(move.time);
+      m_y += m_vy * static_cast<T>(move.time);
+      left -= static_cast<T>(move.time);
+      switch (move.event) {
+      case Boundary::None:
+        m_t = static_cast<T>(m_step) * m_dt;
+        return;
+      case Boundary::Hole:
+      case Boundary::Open:
+        m_t = (static_cast<T>(m_step) * m_dt) - left;
+        m_result = move.event == Boundary::Hole ? Result::Success
+                                                : Result::Failure;
+        return;
+      case Boundary::Right:
+        m_x = Accumulator<T, S>(m_Lx);
+        m_vx = -m_vx;
+        ++m_nx;
+        break;
+      case Boundary::Bottom:
+      case Boundary::Top:
+        m_y = Accumulator<T, S>(move.event == Boundary::Top ? m_Ly : T(0));
+        m_vy = -m_vy;
+        ++m_ny;
+        break;
+      }
+    }
+  }
+
+  /** @brief Everything step() changes, for checkpoints (Checkpoint.h) */
+  struct State {
+    std::uint64_t step;
+    T t;
+    Accumulator<T, S> x;
+    Accumulator<T, S> y;
+    T vx;
+    T vy;
+    int nx;
+    int ny;
+    Result result;
+  };
+
+  State state() const {
+    return {m_step, m_t, m_x, m_y, m_vx, m_vy, m_nx, m_ny, m_result};
+  }
+
+  void restore(const State &state) {
+    m_step = state.step;
+    m_t = state.t;
+    m_x = state.x;
+    m_y = state.y;
+    m_vx = state.vx;
+    m_vy = state.vy;
+    m_nx = state.nx;
+    m_ny = state.ny;
+    m_result = state.result;
+  }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  Result result() const { return m_result; }
+  int xBounces() const { return m_nx; }
+  int yBounces() const { return m_ny; }
+  /** @brief Events so far (bounces; entering the hole ends the run), for
+   * Decimator */
+  int events() const { return m_nx + m_ny; }
+
+  static constexpr std::string_view toString(Result result) {
+    switch (result) {
+    case Result::Success:
+      return "Success";
+    case Result::Failure:
+      return "Failure";
+    default:
+      return "Running";
+    }
+  }
+
+private:
+  enum class Boundary { None, Hole, Open, Right, Bottom, Top };
+  struct Move {
+    Boundary event;
+    double time; // into the rest of the step
+  };
+
+  // Most steps end inside the table far from the hole: comparisons against
+  // the walls and the hole's bounding square tell them apart.
+  bool clearStep() const {
+    const T x0 = m_x.value();
+    const T y0 = m_y.value();
+    const T x1 = x0 + (m_vx * m_dt);
+    const T y1 = y0 + (m_vy * m_dt);
+    const bool inside = x1 > T(0) && x1 < m_Lx && y1 > T(0) && y1 < m_Ly;
+    const bool farFromHole = std::max(x0, x1) < m_xc - m_R ||
+                             std::min(x0, x1) > m_xc + m_R ||
+                             std::max(y0, y1) < m_yc - m_R ||
+                             std::min(y0, y1) > m_yc + m_R;
+    return inside && farFromHole;
+  }
+
+  // First boundary the ball reaches in the next `left` seconds of straight
+  // motion. Only a step that ends beyond a wall or passes within R of the
+  // hole centre is searched.
+  Move nextEvent(T left) const {
+    const double x0 = static_cast<double>(m_x.value());
+    const double y0 = static_cast<double>(m_y.value());
+    const double vx = static_cast<double>(m_vx);
+    const double vy = static_cast<double>(m_vy);
+    const double dt = static_cast<double>(left);
+    const double x1 = x0 + (vx * dt);
+    const double y1 = y0 + (vy * dt);
+    const double Lx = static_cast<double>(m_Lx);
+    const double Ly = static_cast<double>(m_Ly);
+    const double xc = static_cast<double>(m_xc);
+    const double yc = static_cast<double>(m_yc);
+    const double R = static_cast<double>(m_R);
+
+    // Closest point of the step to the hole centre
+    const double v2 = (vx * vx) + (vy * vy);
+    const double along =
+        v2 > 0.0 ? std::clamp((((xc - x0) * vx) + ((yc - y0) * vy)) / v2,
+                              0.0, dt)
+                 : 0.0;
+    const double cx = x0 + (vx * along) - xc;
+    const double cy = y0 + (vy * along) - yc;
+    const bool nearHole = (cx * cx) + (cy * cy) <= R * R;
+    if (!nearHole && x1 > 0.0 && x1 < Lx && y1 > 0.0 && y1 < Ly) {
+      return {Boundary::None, dt};
+    }
+
+    // The step as rows {s, x, y, vx, vy}, s seconds into it
+    const auto dense = [&](double s) -> Row {
+      return {s, x0 + (vx * s), y0 + (vy * s), vx, vy};
+    };
+    const Row row0 = dense(0.0);
+    if (nearHole && m_boundaries[kHole].g(row0) <= 0.0) {
+      return {Boundary::Hole, 0.0};
+    }
+    const std::span<const Event<Row>> events(m_boundaries.data(),
+                                             nearHole ? kHole + 1 : kHole);
+    const auto hit = firstEvent<Row>(events, 0.0, row0, dt, dense(dt), dense);
+    if (!hit) {
+      return {Boundary::None, dt};
+    }
+    return {kBoundaryOf[hit->event], hit->t};
+  }
+
+  // Walls, open side and hole as events of the rows of a straight move;
+  // the hole is last and only searched when the move passes near it.
+  static constexpr std::size_t kHole = 4;
+  static constexpr std::array<Boundary, kHole + 1> kBoundaryOf{
+      Boundary::Open, Boundary::Right, Boundary::Bottom, Boundary::Top,
+      Boundary::Hole};
+
+  // The geometry is rounded to T like the state.
+  static std::array<Event<Row>, kHole + 1> boundaries(const Params &p) {
+    const auto inT = [](double v) {
+      return static_cast<double>(static_cast<T>(v));
+    };
+    const double Lx = inT(p.Lx);
+    const double Ly = inT(p.Ly);
+    const double xc = inT(p.xc);
+    const double yc = inT(p.yc);
+    const double R = inT(p.R);
+    return {{{"open", [](const Row &r) { return r[1]; }, Crossing::Falling},
+             {"right", [Lx](const Row &r) { return Lx - r[1]; },
+              Crossing::Falling},
+             {"bottom", [](const Row &r) { return r[2]; }, Crossing::Falling},
+             {"top", [Ly](const Row &r) { return Ly - r[2]; },
+              Crossing::Falling},
+             {"hole",
+              [xc, yc, R](const Row &r) {
+                return std::hypot(r[1] - xc, r[2] - yc) - R;
+              },
+              Crossing::Falling, true}}};
+  }
+
+  Params m_params;
+  T m_Lx = T(0);
+  T m_Ly = T(0);
+  T m_xc = T(0);
+  T m_yc = T(0);
+  T m_dt = T(0);
+  T m_R = T(0);
+  std::array<Event<Row>, kHole + 1> m_boundaries;
+  std::uint64_t m_step = 0;
+  T m_t = T(0);
+  Accumulator<T, S> m_x;
+  Accumulator<T, S> m_y;
+  T m_vx = T(0);
+  T m_vy = T(0);
+  int m_nx = 0;
+  int m_ny = 0;
+  Result m_result = Result::Running;
+};
+
+using MiniGolf = BasicMiniGolf<DefaultScalar<double>, kDefaultSummation>;
+
+} // namespace Sim
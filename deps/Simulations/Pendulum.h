@@ -0,0 +1,169 @@
+// deps/Simulations/Pendulum.h
+
+#pragma once
+
+#include <Physics.h>
+#include <PhysicsSimd.h>
+#include <Pragmas.h>
+#include <TimeGrid.h>
+#include <Fields.h>
+#include <Scalar.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace Sim {
+
+/**
+ * @brief Input parameters of the simple pendulum (small-angle solution)
+ */
+struct PendulumParams {
+  double l = 1.0;
+  double theta0 = 0.2;
+  double t0 = 0.0;
+  double tf = 10.0;
+  double dt = 0.01;
+};
+
+/**
+ * @brief Simple pendulum evaluated from theta(t) = theta0 cos(omega t)
+ *
+ * Time is computed as t0 + i * dt rather than accumulated, so long runs do
+ * not drift. Evaluated in T.
+ */
+template <typename T = double> class BasicPendulum {
+public:
+  using Scalar = T;
+
+  static constexpr std::string_view name = "pendulum";
+  static constexpr std::array<std::string_view, 7> columns{
+      "Time(s)", "x(t)", "y(t)", "Vx(t)", "Vy(t)", "theta(t)", "dtheta(t)"};
+  using Params = PendulumParams;
+  static constexpr std::array<Field<Params>, 5> fields{
+      {{"l", &Params::l},
+       {"theta0", &Params::theta0},
+       {"t0", &Params::t0},
+       {"tf", &Params::tf},
+       {"dt", &Params::dt}}};
+  using Row = std::array<double, columns.size()>;
+
+  explicit BasicPendulum(const Params &params)
+      : m_params(params), m_omega(std::sqrt(static_cast<T>(Phy::Const::g) /
+                                            static_cast<T>(params.l))),
+        m_l(static_cast<T>(params.l)), m_theta0(static_cast<T>(params.theta0)),
+        m_t0(static_cast<T>(params.t0)), m_tf(static_cast<T>(params.tf)),
+        m_dt(static_cast<T>(params.dt)) {
+    validate(params);
+  }
+
+  static void validate(const Params &p) {
+    if (p.l <= 0.0) {
+      throw std::invalid_argument("l <= 0");
+    }
+    if (p.dt <= 0.0) {
+      throw std::invalid_argument("dt <= 0");
+    }
+  }
+
+  bool done() const { return time() > m_tf; }
+  std::uint64_t size() const { return gridSize(m_t0, m_tf, m_dt); }
+
+  Row row() const { return at(m_step); }
+
+  /**
+   * @brief Row of step i; closed form, so steps can be evaluated in any
+   * order and in parallel
+   */
+  Row at(std::uint64_t i) const {
+    const T t = timeAt(i);
+    T sinPhase;
+    T cosPhase;
+    Phy::simd::sincos(m_omega * (t - m_t0), sinPhase, cosPhase);
+    const T theta = m_theta0 * cosPhase;
+    const T dthetaDt = -m_omega * m_theta0 * sinPhase;
+    T s;
+    T c;
+    Phy::simd::sincos(theta, s, c);
+    const T l = m_l;
+    return {static_cast<double>(t),
+            static_cast<double>(l * s),
+            static_cast<double>(-l * c),
+            static_cast<double>(l * dthetaDt * c),
+            static_cast<double>(l * dthetaDt * s),
+            static_cast<double>(theta),
+            static_cast<double>(dthetaDt)};
+  }
+
+  /**
+   * @brief Steps [first, first + count) into one buffer per column, both
+   * sincos of each batch through Phy::simd (see EvaluatesColumns)
+   */
+  void evaluateColumns(std::uint64_t first, std::size_t count,
+                       const std::array<double *, columns.size()> &out) const
+    requires Phy::simd::Vectorizable<T>
+  {
+    std::array<T, kGridBatch> phase{};
+    std::array<T, kGridBatch> s{};
+    std::array<T, kGridBatch> c{};
+    std::array<T, kGridBatch> theta{};
+    std::array<T, kGridBatch> dthetaDt{};
+    const T l = m_l;
+    for (std::size_t b = 0; b < count; b += kGridBatch) {
+      const std::size_t n = std::min(kGridBatch, count - b);
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        phase[j] = m_omega * (timeAt(first + b + j) - m_t0);
+      }
+      Phy::simd::sincos(std::span<const T>(phase.data(), n),
+                        std::span<T>(s.data(), n), std::span<T>(c.data(), n));
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        theta[j] = m_theta0 * c[j];
+        dthetaDt[j] = -m_omega * m_theta0 * s[j];
+      }
+      Phy::simd::sincos(std::span<const T>(theta.data(), n),
+                        std::span<T>(s.data(), n), std::span<T>(c.data(), n));
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        out[0][b + j] = static_cast<double>(timeAt(first + b + j));
+        out[1][b + j] = static_cast<double>(l * s[j]);
+        out[2][b + j] = static_cast<double>(-l * c[j]);
+        out[3][b + j] = static_cast<double>(l * dthetaDt[j] * c[j]);
+        out[4][b + j] = static_cast<double>(l * dthetaDt[j] * s[j]);
+        out[5][b + j] = static_cast<double>(theta[j]);
+        out[6][b + j] = static_cast<double>(dthetaDt[j]);
+      }
+    }
+  }
+
+  void step() { ++m_step; }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  double omega() const { return static_cast<double>(m_omega); }
+  double period() const { return 2.0 * Phy::Const::PI / omega(); }
+
+private:
+  Params m_params;
+  T m_omega;
+  T m_l;
+  T m_theta0;
+  T m_t0;
+  T m_tf;
+  T m_dt;
+  std::uint64_t m_step = 0;
+
+  T time() const { return timeAt(m_step); }
+  T timeAt(std::uint64_t i) const {
+    return m_t0 + (static_cast<T>(i) * m_dt);
+  }
+};
+
+using Pendulum = BasicPendulum<DefaultScalar<double>>;
+
+} // namespace Sim
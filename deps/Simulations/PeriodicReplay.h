@@ -0,0 +1,224 @@
+// deps/Simulations/PeriodicReplay.h
+
+#pragma once
+
+#include <Physics.h>
+#include <TimeGrid.h>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Sim {
+
+/**
+ * @brief When PeriodicReplay may serve rows from its cached period
+ *
+ * tolerance bounds the phase error (radians) of every replayed row over
+ * the whole run, so positions are off by at most tolerance times the
+ * amplitude and velocities by tolerance times the amplitude of the
+ * velocity. maxRows bounds the memory of the cache.
+ */
+struct ReplayOptions {
+  double tolerance = 1e-9;
+  std::uint64_t maxRows = std::uint64_t{1} << 16;
+};
+
+/** @brief A common period on a time grid; steps == 0 if there is none */
+struct GridPeriod {
+  std::uint64_t steps = 0;
+  double drift = 0.0; // largest phase error of a replayed row (radians)
+};
+
+/**
+ * @brief Smallest M < rows such that every phase of phases (radians per
+ * grid step) turns by whole turns in M steps, to within a drift that stays
+ * below options.tolerance over rows steps
+ *
+ * Row i + j M is then row i with phases off by j times the per-period
+ * residue. The period exists exactly when the drive periods are
+ * commensurate with each other and with the step (omega dt / 2 pi
+ * rational), otherwise only as an approximation that is accepted if the
+ * run is short enough for its drift.
+ */
+inline GridPeriod findGridPeriod(std::span<const double> phases,
+                                 std::uint64_t rows,
+                                 const ReplayOptions &options = {}) {
+  const std::uint64_t limit =
+      rows == 0 ? 0 : std::min(options.maxRows, rows - 1);
+  for (std::uint64_t m = 1; m <= limit; ++m) {
+    double residue = 0.0;
+    for (const double phase : phases) {
+      residue = std::max(
+          residue, std::abs(std::remainder(static_cast<double>(m) * phase,
+                                           2.0 * Phy::Const::PI)));
+    }
+    const double drift = residue * static_cast<double>((rows - 1) / m);
+    if (drift <= options.tolerance) {
+      return {m, drift};
+    }
+  }
+  return {};
+}
+
+/**
+ * @brief A periodic closed-form kernel (Circle, Lissajous) that evaluates
+ * one common period of its time grid and serves every other row from it
+ *
+ * Kernel must provide phaseSteps(), the phase (radians) each of its
+ * periodic terms advances per grid step. If findGridPeriod() finds a
+ * period of M steps, the first M rows are evaluated once and row i is row
+ * i % M with the time column of step i: the cost of the run is O(M) in
+ * memory and evaluation and O(1) per served row, however far tf is.
+ * Otherwise rows are evaluated by the kernel as before. The replay has the
+ * kernel API, so writeGrid(), the live channel and SimulationWorker take it
+ * in place of the kernel; writeGrid() also formats the columns after time
+ * once per period through formatter() when the rows are replayed, and
+ * evaluates them column by column like the kernel's otherwise.
+ */
+template <typename Kernel> class PeriodicReplay {
+public:
+  using Scalar = typename Kernel::Scalar;
+
+  static constexpr std::string_view name = Kernel::name;
+  static constexpr auto columns = Kernel::columns;
+  using Params = typename Kernel::Params;
+  static constexpr auto fields = Kernel::fields;
+  using Row = typename Kernel::Row;
+
+  explicit PeriodicReplay(const Params &params,
+                          const ReplayOptions &options = {})
+      : m_kernel(params), m_size(m_kernel.size()),
+        m_t0(static_cast<Scalar>(params.t0)),
+        m_dt(static_cast<Scalar>(params.dt)) {
+    CP_TRACE_SCOPE("PeriodicReplay");
+    const auto phases = m_kernel.phaseSteps();
+    m_period = findGridPeriod(phases, m_size, options);
+    m_rows.resize(m_period.steps);
+    for (std::uint64_t i = 0; i < m_period.steps; ++i) {
+      m_rows[i] = m_kernel.at(i);
+    }
+  }
+
+  static void validate(const Params &p) { Kernel::validate(p); }
+
+  bool done() const { return m_step >= m_size; }
+  std::uint64_t size() const { return m_size; }
+
+  Row row() const { return at(m_step); }
+
+  Row at(std::uint64_t i) const {
+    if (m_rows.empty()) {
+      return m_kernel.at(i);
+    }
+    Row row = m_rows[i % m_rows.size()];
+    // The kernel's own t0 + i * dt in Scalar.
+    row[0] = static_cast<double>(m_t0 + (static_cast<Scalar>(i) * m_dt));
+    return row;
+  }
+
+  /**
+   * @brief Steps [first, first + count) into one buffer per column: by the
+   * kernel's batches unless rows are replayed (see EvaluatesColumns)
+   */
+  void evaluateColumns(std::uint64_t first, std::size_t count,
+                       const std::array<double *, columns.size()> &out) const
+    requires EvaluatesColumns<Kernel>
+  {
+    if (m_rows.empty()) {
+      m_kernel.evaluateColumns(first, count, out);
+      return;
+    }
+    for (std::size_t j = 0; j < count; ++j) {
+      const Row row = at(first + j);
+      for (std::size_t c = 0; c < row.size(); ++c) {
+        out[c][j] = row[c];
+      }
+    }
+  }
+
+  void step() { ++m_step; }
+
+  const Params &params() const { return m_kernel.params(); }
+  std::uint64_t stepIndex() const { return m_step; }
+
+  /**
+   * @brief Appends rows [first, first + count) as text in the layout of
+   * formatColumns(); the columns after time are formatted once per cached
+   * row
+   */
+  class Formatter {
+  public:
+    Formatter(const PeriodicReplay &replay, const GridFormat &format)
+        : m_replay(&replay), m_format(format) {
+      const std::size_t period = replay.m_rows.size();
+      m_offsets.reserve(period + 1);
+      m_offsets.push_back(0);
+      for (const Row &row : replay.m_rows) {
+        for (std::size_t c = 1; c < row.size(); ++c) {
+          m_tails += format.separator;
+          append(m_tails, row[c]);
+        }
+        m_tails += '\n';
+        m_offsets.push_back(m_tails.size());
+      }
+    }
+
+    void operator()(std::uint64_t first, std::size_t count,
+                    std::string &text) const {
+      const PeriodicReplay &replay = *m_replay;
+      const std::size_t period = m_offsets.size() - 1;
+      for (std::size_t j = 0; j < count; ++j) {
+        append(text, replay.at(first + j)[0]);
+        const std::size_t k = (first + j) % period;
+        text.append(m_tails, m_offsets[k], m_offsets[k + 1] - m_offsets[k]);
+      }
+    }
+
+  private:
+    const PeriodicReplay *m_replay;
+    GridFormat m_format;
+    std::string m_tails;
+    std::vector<std::size_t> m_offsets;
+
+    void append(std::string &text, double value) const {
+      char buffer[32];
+      const auto result =
+          std::to_chars(buffer, buffer + sizeof(buffer), value,
+                        std::chars_format::general, m_format.precision);
+      text.append(buffer, result.ptr);
+    }
+  };
+
+  /** @brief The row formatter of writeGrid(); empty unless periodic() */
+  std::optional<Formatter> formatter(const GridFormat &format) const {
+    if (!periodic()) {
+      return std::nullopt;
+    }
+    return Formatter(*this, format);
+  }
+
+  const Kernel &kernel() const { return m_kernel; }
+  /** @brief Whether rows are replayed from a cached period */
+  bool periodic() const { return m_period.steps != 0; }
+  const GridPeriod &gridPeriod() const { return m_period; }
+
+private:
+  Kernel m_kernel;
+  std::uint64_t m_size;
+  Scalar m_t0;
+  Scalar m_dt;
+  GridPeriod m_period;
+  std::vector<Row> m_rows;
+  std::uint64_t m_step = 0;
+};
+
+} // namespace Sim
@@ -0,0 +1,372 @@
+// deps/Simulations/Projectile.h
+
+#pragma once
+
+#include <Events.h>
+#include <Fields.h>
+#include <Physics.h>
+#include <PhysicsSimd.h>
+#include <Pragmas.h>
+#include <Scalar.h>
+#include <TimeGrid.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace Sim {
+
+/**
+ * @brief Input parameters of a projectile launched from (0, 0)
+ *
+ * k is the linear air-resistance coefficient (1/s); it is only used by
+ * ProjectileAirResistance.
+ */
+struct ProjectileParams {
+  double v0 = 10.0;
+  double theta = 45.0; // degrees
+  double k = 0.0;
+  double tf = 2.0;
+  double dt = 0.01;
+};
+
+inline constexpr std::array<Field<ProjectileParams>, 5> projectileFields{
+    {{"v0", &ProjectileParams::v0},
+     {"theta", &ProjectileParams::theta},
+     {"k", &ProjectileParams::k},
+     {"tf", &ProjectileParams::tf},
+     {"dt", &ProjectileParams::dt}}};
+
+/**
+ * @brief Time at which a projectile launched from y = 0 with vertical
+ * velocity vy > 0 and linear drag k (1/s) is back at y = 0; 2 vy / g
+ * without drag
+ *
+ * y(t) is concave, so Newton's method started at the drag-free flight time
+ * (an upper bound) decreases monotonically onto the impact time.
+ */
+inline double flightTime(double vy, double k) {
+  const double g = Phy::Const::g;
+  double t = 2.0 * vy / g;
+  if (!(vy > 0.0) || !(k > 1e-9)) {
+    return std::max(t, 0.0);
+  }
+  const double terminal = g / k;
+  for (int i = 0; i < 100; ++i) {
+    const double decay = std::exp(-k * t);
+    const double y = ((vy + terminal) * (1.0 - decay) / k) - (terminal * t);
+    const double slope = ((vy + terminal) * decay) - terminal;
+    const double next = t - (y / slope);
+    if (!(next < t) || t - next <= 1e-15 * t) {
+      return std::min(t, next);
+    }
+    t = next;
+  }
+  return t;
+}
+
+/** @brief The ground impact of a projectile kernel: y falls through 0 */
+template <typename Row> Event<Row> groundEvent() {
+  return {"ground", [](const Row &row) { return row[2]; }, Crossing::Falling};
+}
+
+/**
+ * @brief Time at which a closed-form projectile kernel launched with
+ * vertical velocity v0y > 0 lands, by firstEvent() on its groundEvent()
+ *
+ * The search runs from the apex (time apex, where y > 0) to 3 v0y / g,
+ * where even the drag-free projectile is below the ground.
+ */
+template <typename Kernel>
+double groundImpact(const Kernel &kernel, double apex, double v0y) {
+  using Row = typename Kernel::Row;
+  const std::array<Event<Row>, 1> events{groundEvent<Row>()};
+  const double end = 3.0 * v0y / Phy::Const::g;
+  const auto hit = firstEvent<Row>(
+      events, apex, kernel.rowAt(apex), end, kernel.rowAt(end),
+      [&kernel](double t) { return kernel.rowAt(t); });
+  return hit ? hit->t : end;
+}
+
+/**
+ * @brief Projectile without air resistance (closed-form solution),
+ * evaluated in T
+ *
+ * The run ends at tf or at the ground impact (groundImpact(), t = 2 v0y / g
+ * up to the event tolerance), whichever is first; an impact is written as
+ * the last row (terminalRow()).
+ */
+template <typename T = double> class BasicProjectile {
+public:
+  using Scalar = T;
+
+  static constexpr std::string_view name = "projectile";
+  // 2: rows stop at the ground impact, which is the last row.
+  // 3: the impact is located by its ground event.
+  static constexpr std::uint32_t outputVersion = 3;
+  static constexpr std::array<std::string_view, 5> columns{
+      "Time(s)", "x(t)", "y(t)", "Vx(t)", "Vy(t)"};
+  using Params = ProjectileParams;
+  static constexpr const auto &fields = projectileFields;
+  using Row = std::array<double, columns.size()>;
+
+  explicit BasicProjectile(const Params &params)
+      : m_params(params), m_tf(static_cast<T>(params.tf)),
+        m_dt(static_cast<T>(params.dt)) {
+    validate(params);
+    const T theta = static_cast<T>(Phy::utils::deg2rad(params.theta));
+    m_v0x = static_cast<T>(params.v0) * std::cos(theta);
+    m_v0y = static_cast<T>(params.v0) * std::sin(theta);
+    m_lands = m_v0y > T(0);
+    if (m_lands) {
+      const double v0y = static_cast<double>(m_v0y);
+      m_impact = static_cast<T>(
+          groundImpact(*this, v0y / Phy::Const::g, v0y));
+    }
+  }
+
+  static void validate(const Params &p) {
+    if (p.v0 <= 0.0) {
+      throw std::invalid_argument("Illegal value of v0<=0");
+    }
+    if (p.theta <= 0.0) {
+      throw std::invalid_argument("Illegal value of theta");
+    }
+    if (p.dt <= 0.0) {
+      throw std::invalid_argument("Illegal value of dt<=0");
+    }
+  }
+
+  bool done() const {
+    return time() > m_tf || (m_lands && time() >= m_impact);
+  }
+  std::uint64_t size() const {
+    const std::uint64_t steps = gridSize(T(0), m_tf, m_dt);
+    return m_lands ? std::min(steps, gridSizeBefore(T(0), m_impact, m_dt))
+                   : steps;
+  }
+
+  Row row() const { return at(m_step); }
+
+  /**
+   * @brief Row of step i; closed form, so steps can be evaluated in any
+   * order and in parallel
+   */
+  Row at(std::uint64_t i) const { return evaluate(timeAt(i)); }
+
+  /** @brief Row at any time t, for event location (Events.h) */
+  Row rowAt(double t) const { return evaluate(static_cast<T>(t)); }
+
+  /** @brief Time of the ground impact, if it is not after tf */
+  std::optional<double> impactTime() const {
+    if (!m_lands || m_impact > m_tf) {
+      return std::nullopt;
+    }
+    return static_cast<double>(m_impact);
+  }
+
+  /** @brief Row of the ground impact, if it is not after tf */
+  std::optional<Row> terminalRow() const {
+    if (!impactTime()) {
+      return std::nullopt;
+    }
+    return evaluate(m_impact);
+  }
+
+  void step() { ++m_step; }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  double v0x() const { return static_cast<double>(m_v0x); }
+  double v0y() const { return static_cast<double>(m_v0y); }
+
+private:
+  Params m_params;
+  T m_tf;
+  T m_dt;
+  T m_v0x = T(0);
+  T m_v0y = T(0);
+  T m_impact = T(0);
+  bool m_lands = false;
+  std::uint64_t m_step = 0;
+
+  T time() const { return timeAt(m_step); }
+  T timeAt(std::uint64_t i) const { return static_cast<T>(i) * m_dt; }
+
+  Row evaluate(T t) const {
+    const T g = static_cast<T>(Phy::Const::g);
+    return {static_cast<double>(t), static_cast<double>(m_v0x * t),
+            static_cast<double>((m_v0y * t) - (T(0.5) * g * t * t)),
+            static_cast<double>(m_v0x), static_cast<double>(m_v0y - (g * t))};
+  }
+};
+
+using Projectile = BasicProjectile<DefaultScalar<double>>;
+
+/**
+ * @brief Projectile with linear air resistance F = -k m v (closed form),
+ * evaluated in T
+ *
+ * The run ends at tf or at the ground impact (groundImpact()), whichever
+ * is first; an impact is written as the last row (terminalRow()).
+ */
+template <typename T = double> class BasicProjectileAirResistance {
+public:
+  using Scalar = T;
+
+  static constexpr std::string_view name = "projectile_air";
+  // 2: rows stop at the ground impact, which is the last row.
+  // 3: the impact is located by its ground event.
+  static constexpr std::uint32_t outputVersion = 3;
+  static constexpr std::array<std::string_view, 5> columns{
+      "Time(s)", "x(t)", "y(t)", "Vx(t)", "Vy(t)"};
+  using Params = ProjectileParams;
+  static constexpr const auto &fields = projectileFields;
+  using Row = std::array<double, columns.size()>;
+
+  explicit BasicProjectileAirResistance(const Params &params)
+      : m_params(params), m_k(static_cast<T>(params.k)),
+        m_tf(static_cast<T>(params.tf)), m_dt(static_cast<T>(params.dt)) {
+    validate(params);
+    const T theta = static_cast<T>(Phy::utils::deg2rad(params.theta));
+    m_v0x = static_cast<T>(params.v0) * std::cos(theta);
+    m_v0y = static_cast<T>(params.v0) * std::sin(theta);
+    m_lands = m_v0y > T(0);
+    if (m_lands) {
+      const double v0y = static_cast<double>(m_v0y);
+      const double k = static_cast<double>(m_k);
+      const double apex = std::log1p(k * v0y / Phy::Const::g) / k;
+      m_impact = static_cast<T>(groundImpact(*this, apex, v0y));
+    }
+  }
+
+  static void validate(const Params &p) {
+    if (p.v0 <= 0.0) {
+      throw std::invalid_argument("Illegal value of v0 <= 0");
+    }
+    if (p.k <= 0.0) {
+      throw std::invalid_argument("Illegal value of k <= 0");
+    }
+    if (p.theta <= 0.0) {
+      throw std::invalid_argument("Illegal value of theta <= 0");
+    }
+    if (p.theta >= 90.0) {
+      throw std::invalid_argument("Illegal value of theta >= 90");
+    }
+    if (p.dt <= 0.0) {
+      throw std::invalid_argument("Illegal value of dt <= 0");
+    }
+  }
+
+  bool done() const {
+    return time() > m_tf || (m_lands && time() >= m_impact);
+  }
+  std::uint64_t size() const {
+    const std::uint64_t steps = gridSize(T(0), m_tf, m_dt);
+    return m_lands ? std::min(steps, gridSizeBefore(T(0), m_impact, m_dt))
+                   : steps;
+  }
+
+  Row row() const { return at(m_step); }
+
+  /**
+   * @brief Row of step i; closed form, so steps can be evaluated in any
+   * order and in parallel
+   */
+  Row at(std::uint64_t i) const { return evaluate(timeAt(i)); }
+
+  /** @brief Row at any time t, for event location (Events.h) */
+  Row rowAt(double t) const { return evaluate(static_cast<T>(t)); }
+
+  /**
+   * @brief Steps [first, first + count) into one buffer per column, the
+   * decay factors of each batch through Phy::simd::exp (see
+   * EvaluatesColumns)
+   */
+  void evaluateColumns(std::uint64_t first, std::size_t count,
+                       const std::array<double *, columns.size()> &out) const
+    requires Phy::simd::Vectorizable<T>
+  {
+    std::array<T, kGridBatch> t{};
+    std::array<T, kGridBatch> decay{};
+    for (std::size_t b = 0; b < count; b += kGridBatch) {
+      const std::size_t n = std::min(kGridBatch, count - b);
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        t[j] = timeAt(first + b + j);
+        decay[j] = -m_k * t[j];
+      }
+      Phy::simd::exp(std::span<const T>(decay.data(), n),
+                     std::span<T>(decay.data(), n));
+      CP_SIMD
+      for (std::size_t j = 0; j < n; ++j) {
+        const Row row = fromDecay(t[j], decay[j]);
+        for (std::size_t c = 0; c < row.size(); ++c) {
+          out[c][b + j] = row[c];
+        }
+      }
+    }
+  }
+
+  /** @brief Time of the ground impact, if it is not after tf */
+  std::optional<double> impactTime() const {
+    if (!m_lands || m_impact > m_tf) {
+      return std::nullopt;
+    }
+    return static_cast<double>(m_impact);
+  }
+
+  /** @brief Row of the ground impact, if it is not after tf */
+  std::optional<Row> terminalRow() const {
+    if (!impactTime()) {
+      return std::nullopt;
+    }
+    return evaluate(m_impact);
+  }
+
+  void step() { ++m_step; }
+
+  const Params &params() const { return m_params; }
+  std::uint64_t stepIndex() const { return m_step; }
+  double v0x() const { return static_cast<double>(m_v0x); }
+  double v0y() const { return static_cast<double>(m_v0y); }
+
+private:
+  Params m_params;
+  T m_k;
+  T m_tf;
+  T m_dt;
+  T m_v0x = T(0);
+  T m_v0y = T(0);
+  T m_impact = T(0);
+  bool m_lands = false;
+  std::uint64_t m_step = 0;
+
+  T time() const { return timeAt(m_step); }
+  T timeAt(std::uint64_t i) const { return static_cast<T>(i) * m_dt; }
+
+  Row evaluate(T t) const { return fromDecay(t, Phy::simd::exp(-m_k * t)); }
+
+  // The row at t, given decay = exp(-k t).
+  Row fromDecay(T t, T decay) const {
+    const T k = m_k;
+    const T g = static_cast<T>(Phy::Const::g);
+    return {static_cast<double>(t),
+            static_cast<double>((m_v0x / k) * (T(1) - decay)),
+            static_cast<double>(((T(1) / k) * (m_v0y + (g / k)) *
+                                 (T(1) - decay)) -
+                                ((g / k) * t)),
+            static_cast<double>(m_v0x * decay),
+            static_cast<double>(((m_v0y + (g / k)) * decay) - (g * t))};
+  }
+};
+
+using ProjectileAirResistance =
+    BasicProjectileAirResistance<DefaultScalar<double>>;
+
+} // namespace Sim
@@ -0,0 +1,493 @@
+// deps/Simulations/ResultCache.h
+
+#pragma once
+
+#include <Checkpoint.h>
+#include <Fields.h>
+#include <Scalar.h>
+#include <Trace.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+/**
+ * @file ResultCache.h
+ * @brief Content-addressed on-disk cache of simulation outputs
+ *
+ * An output is stored under the FNV-1a digest of its key, the canonical
+ * text of everything that determines it (see resultKey()):
+ *   <dir>/<digest>.dat   the output, hard-linked to the file it came from
+ *   <dir>/<digest>.key   the key, to tell a digest collision from a hit;
+ *                        its mtime is the entry's last use
+ *   <dir>/stats-<id>     hit/miss counters, one file per ResultCache
+ *                        instance; the lifetime counters are their sum
+ * A hit hard-links the stored output to the requested path (a copy if the
+ * cache is on another file system), so it costs no recomputation and, for
+ * a link, no copy. Entries are written under temporary names and renamed
+ * into place, so processes sharing a cache never see a partial entry.
+ * Outputs are shared with the cache by the link: they must be replaced,
+ * never modified in place.
+ */
+
+namespace Sim {
+
+/** @brief Layout of the cache and its keys; a change invalidates entries */
+inline constexpr std::uint32_t kResultCacheVersion = 1;
+
+/**
+ * @brief Version of a kernel's rows for the result cache: a kernel whose
+ * output changes for the same parameters declares a higher
+ * `static constexpr std::uint32_t outputVersion`; 1 otherwise
+ */
+template <typename Kernel> constexpr std::uint32_t outputVersion() {
+  if constexpr (requires { Kernel::outputVersion; }) {
+    return Kernel::outputVersion;
+  } else {
+    return 1;
+  }
+}
+
+/**
+ * @brief Canonical cache key of a run of Kernel with params:
+ * "<cache version> <name>[/<scalar>][/<summation>] v<output version>
+ * <formatFields(params)>"
+ */
+template <typename Kernel>
+std::string resultKey(const typename Kernel::Params &params) {
+  std::string key = std::to_string(kResultCacheVersion);
+  key += ' ';
+  key += Kernel::name;
+  if constexpr (requires { typename Kernel::Scalar; }) {
+    key += '/';
+    key += scalarName<typename Kernel::Scalar>();
+  }
+  if constexpr (requires { Kernel::summation; }) {
+    key += '/';
+    key += summationName(Kernel::summation);
+  }
+  key += " v";
+  key += std::to_string(outputVersion<Kernel>());
+  key += ' ';
+  key += formatFields<Kernel>(params);
+  return key;
+}
+
+/** @brief Counters and size of a ResultCache */
+struct ResultCacheStats {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
+  std::uint64_t stores = 0;
+  std::uint64_t evictions = 0;
+  std::uint64_t entries = 0;
+  std::uint64_t bytes = 0;
+
+  double hitRate() const {
+    const std::uint64_t lookups = hits + misses;
+    return lookups == 0 ? 0.0
+                        : static_cast<double>(hits) /
+                              static_cast<double>(lookups);
+  }
+};
+
+/**
+ * @brief Result cache in a directory, kept under a size budget by evicting
+ * the least recently used entries
+ *
+ * Methods are thread-safe, and processes may share the directory. The
+ * total size is tracked in memory from one scan at opening; the directory
+ * is scanned again only when a store takes it over the budget, and then
+ * entries are evicted down to kLowWater of the budget, so a batch costs
+ * a number of scans proportional to the bytes it stores, not to the
+ * square of its entries.
+ *
+ * Counters of this instance are written to its own stats file by flush()
+ * and the destructor, so processes never overwrite each other's counts.
+ * flush() also folds the files of other instances into its own: it
+ * renames one away before reading it, so only one process can take it.
+ */
+class ResultCache {
+public:
+  /** @brief Fraction of the budget an eviction leaves the cache at */
+  static constexpr double kLowWater = 0.9;
+
+  ResultCache(std::filesystem::path dir, std::uint64_t budget)
+      : m_dir(std::move(dir)), m_budget(budget), m_statsName(uniqueName()) {
+    std::filesystem::create_directories(m_dir);
+    m_bytes = totalBytes(entries());
+    if (m_bytes > m_budget) {
+      evict(); // the budget may be smaller than when the cache was filled
+    }
+  }
+
+  ResultCache(const ResultCache &) = delete;
+  ResultCache &operator=(const ResultCache &) = delete;
+
+  ~ResultCache() {
+    try {
+      flush();
+    } catch (...) {
+      // The counters are advisory; a destructor must not throw.
+    }
+  }
+
+  /** @brief 16 hex digits of the FNV-1a hash of key */
+  static std::string digest(std::string_view key) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::uint64_t hash = fnv1a(key);
+    std::string out(16, '0');
+    for (std::size_t i = 16; i-- > 0; hash >>= 4) {
+      out[i] = kHex[hash & 0xF];
+    }
+    return out;
+  }
+
+  /**
+   * @brief On a hit, places the stored output for key at output (which must
+   * not exist) and returns true; counts a hit or a miss
+   */
+  bool fetch(const std::string &key, const std::filesystem::path &output) {
+    CP_TRACE_SCOPE("ResultCache::fetch");
+    const std::lock_guard lock(m_mutex);
+    const std::string name = digest(key);
+    std::error_code error;
+    if (readFile(keyPath(name)) != key ||
+        !std::filesystem::exists(dataPath(name), error)) {
+      ++m_run.misses;
+      return false;
+    }
+    if (!place(dataPath(name), output)) {
+      ++m_run.misses;
+      return false;
+    }
+    std::filesystem::last_write_time(
+        keyPath(name), std::filesystem::file_time_type::clock::now(), error);
+    ++m_run.hits;
+    return true;
+  }
+
+  /**
+   * @brief Stores the complete output file for key, then evicts the least
+   * recently used entries if the cache is over its budget; returns whether
+   * the output was stored
+   *
+   * Caching is best effort: the output is already complete when this is
+   * called, so nothing here throws. An output larger than the whole budget
+   * is not stored.
+   */
+  bool store(const std::string &key,
+             const std::filesystem::path &output) noexcept {
+    CP_TRACE_SCOPE("ResultCache::store");
+    try {
+      const std::lock_guard lock(m_mutex);
+      std::error_code error;
+      const std::uint64_t bytes = std::filesystem::file_size(output, error);
+      if (error || bytes > m_budget) {
+        return false;
+      }
+      const std::string name = digest(key);
+      std::filesystem::path partial = dataPath(name);
+      partial += ".tmp";
+      std::filesystem::remove(partial, error);
+      if (!place(output, partial)) {
+        return false;
+      }
+      // An entry stored again (by a concurrent duplicate) is replaced.
+      const std::uint64_t replaced =
+          std::filesystem::file_size(dataPath(name), error);
+      const bool existed = !error;
+      std::filesystem::rename(partial, dataPath(name), error);
+      if (error) {
+        std::filesystem::remove(partial, error);
+        return false;
+      }
+      std::filesystem::path keyPartial = keyPath(name);
+      keyPartial += ".tmp";
+      {
+        std::ofstream file(keyPartial, std::ios::binary);
+        file << key;
+        file.close();
+        if (!file) {
+          error = std::make_error_code(std::errc::io_error);
+        }
+      }
+      if (!error) {
+        std::filesystem::rename(keyPartial, keyPath(name), error);
+      }
+      if (error) {
+        // A .dat without its .key is never served, counted or evicted.
+        std::filesystem::remove(keyPartial, error);
+        std::filesystem::remove(dataPath(name), error);
+        return false;
+      }
+      ++m_run.stores;
+      m_bytes += bytes;
+      m_bytes -= existed ? std::min(replaced, m_bytes) : 0;
+      if (m_bytes > m_budget) {
+        evict();
+      }
+      return true;
+    } catch (const std::exception &) {
+      return false;
+    }
+  }
+
+  /** @brief Counters of this instance since it was opened */
+  ResultCacheStats run() const {
+    const std::lock_guard lock(m_mutex);
+    ResultCacheStats stats = m_run;
+    measure(stats);
+    return stats;
+  }
+
+  /** @brief Lifetime counters, including this instance's, and the size */
+  ResultCacheStats lifetime() const {
+    const std::lock_guard lock(m_mutex);
+    ResultCacheStats stats;
+    bool taken = m_written.has_value();
+    for (const auto &path : statsFiles()) {
+      if (path.filename() == m_statsName) {
+        taken = false;
+      } else {
+        add(stats, readStats(path));
+      }
+    }
+    // A file another instance took over is counted in that instance's file.
+    if (taken) {
+      add(stats, minus(m_run, *m_written));
+    } else {
+      add(stats, m_carried);
+      add(stats, minus(m_run, m_absorbed));
+    }
+    measure(stats);
+    return stats;
+  }
+
+  /**
+   * @brief Writes this instance's counters, with those of other instances'
+   * files it takes over, to its own stats file
+   */
+  void flush() {
+    const std::lock_guard lock(m_mutex);
+    std::error_code error;
+    // Own file first: if it cannot be claimed after it was written, another
+    // instance has taken it over with the counts in it.
+    std::vector<std::filesystem::path> claimed;
+    const std::filesystem::path path = m_dir / m_statsName;
+    if (m_written && !claim(path, claimed)) {
+      m_carried = {};
+      m_absorbed = *m_written;
+    }
+    for (const auto &other : statsFiles()) {
+      if (claim(other, claimed)) {
+        add(m_carried, readStats(claimed.back()));
+      }
+    }
+    ResultCacheStats stats = m_carried;
+    add(stats, minus(m_run, m_absorbed));
+    std::filesystem::path partial = path;
+    partial += ".tmp";
+    {
+      std::ofstream file(partial);
+      file << "hits " << stats.hits << "\nmisses " << stats.misses
+           << "\nstores " << stats.stores << "\nevictions " << stats.evictions
+           << '\n';
+    }
+    std::filesystem::rename(partial, path);
+    m_written = m_run;
+    for (const auto &file : claimed) {
+      std::filesystem::remove(file, error);
+    }
+  }
+
+  const std::filesystem::path &directory() const { return m_dir; }
+  std::uint64_t budget() const { return m_budget; }
+
+private:
+  struct Entry {
+    std::string name;
+    std::uint64_t bytes;
+    std::filesystem::file_time_type used;
+  };
+
+  std::filesystem::path m_dir;
+  std::uint64_t m_budget;
+  std::string m_statsName;
+  mutable std::mutex m_mutex;
+  std::uint64_t m_bytes = 0; // of the entries, as far as this instance knows
+  ResultCacheStats m_run;
+  ResultCacheStats m_carried;  // taken over from other instances' files
+  ResultCacheStats m_absorbed; // of m_run, in a file another instance took
+  std::optional<ResultCacheStats> m_written; // m_run at the last flush
+
+  std::filesystem::path dataPath(const std::string &name) const {
+    return m_dir / (name + ".dat");
+  }
+  std::filesystem::path keyPath(const std::string &name) const {
+    return m_dir / (name + ".key");
+  }
+
+  static std::string readFile(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()};
+  }
+
+  // Hard link from to to, or a copy across file systems.
+  static bool place(const std::filesystem::path &from,
+                    const std::filesystem::path &to) {
+    std::error_code error;
+    std::filesystem::create_hard_link(from, to, error);
+    if (!error) {
+      return true;
+    }
+    std::filesystem::copy_file(from, to, error);
+    return !error;
+  }
+
+  std::vector<Entry> entries() const {
+    std::vector<Entry> out;
+    std::error_code error;
+    for (const auto &item : std::filesystem::directory_iterator(m_dir)) {
+      if (item.path().extension() != ".dat") {
+        continue;
+      }
+      const std::string name = item.path().stem().string();
+      const auto used = std::filesystem::last_write_time(keyPath(name), error);
+      if (error) {
+        continue; // a .dat whose .key is not renamed into place yet
+      }
+      out.push_back({name, item.file_size(error), used});
+    }
+    return out;
+  }
+
+  static std::uint64_t totalBytes(const std::vector<Entry> &all) {
+    std::uint64_t bytes = 0;
+    for (const Entry &entry : all) {
+      bytes += entry.bytes;
+    }
+    return bytes;
+  }
+
+  void measure(ResultCacheStats &stats) const {
+    const std::vector<Entry> all = entries();
+    stats.entries = all.size();
+    stats.bytes = totalBytes(all);
+  }
+
+  // Rescans the directory, which other processes may have changed, and
+  // evicts the least recently used entries down to kLowWater of the budget.
+  void evict() {
+    std::vector<Entry> all = entries();
+    m_bytes = totalBytes(all);
+    if (m_bytes <= m_budget) {
+      return;
+    }
+    const auto target =
+        static_cast<std::uint64_t>(kLowWater * static_cast<double>(m_budget));
+    std::sort(all.begin(), all.end(), [](const Entry &a, const Entry &b) {
+      return a.used < b.used;
+    });
+    std::error_code error;
+    for (const Entry &entry : all) {
+      if (m_bytes <= target) {
+        break;
+      }
+      std::filesystem::remove(keyPath(entry.name), error);
+      std::filesystem::remove(dataPath(entry.name), error);
+      m_bytes -= entry.bytes;
+      ++m_run.evictions;
+    }
+  }
+
+  // stats-<16 hex digits>: distinct for every instance, in this process or
+  // another.
+  static std::string uniqueName() {
+    std::random_device device;
+    std::string seed = std::to_string(device()) + ' ' +
+                       std::to_string(device()) + ' ' +
+                       std::to_string(std::chrono::steady_clock::now()
+                                          .time_since_epoch()
+                                          .count());
+    return "stats-" + digest(seed);
+  }
+
+  // "stats" (the single file of earlier versions) and every stats-<id>.
+  std::vector<std::filesystem::path> statsFiles() const {
+    std::vector<std::filesystem::path> out;
+    for (const auto &item : std::filesystem::directory_iterator(m_dir)) {
+      const std::string name = item.path().filename().string();
+      if (name == "stats" ||
+          (name.starts_with("stats-") && !name.ends_with(".tmp"))) {
+        out.push_back(item.path());
+      }
+    }
+    return out;
+  }
+
+  // Renames path away to claim-<own stats name>-<n>; the rename fails if
+  // another instance claimed it first.
+  bool claim(const std::filesystem::path &path,
+             std::vector<std::filesystem::path> &claimed) const {
+    const std::filesystem::path to =
+        m_dir /
+        ("claim-" + m_statsName + "-" + std::to_string(claimed.size()));
+    std::error_code error;
+    std::filesystem::rename(path, to, error);
+    if (error) {
+      return false;
+    }
+    claimed.push_back(to);
+    return true;
+  }
+
+  static ResultCacheStats minus(const ResultCacheStats &a,
+                                const ResultCacheStats &b) {
+    ResultCacheStats out;
+    out.hits = a.hits - b.hits;
+    out.misses = a.misses - b.misses;
+    out.stores = a.stores - b.stores;
+    out.evictions = a.evictions - b.evictions;
+    return out;
+  }
+
+  static void add(ResultCacheStats &to, const ResultCacheStats &from) {
+    to.hits += from.hits;
+    to.misses += from.misses;
+    to.stores += from.stores;
+    to.evictions += from.evictions;
+  }
+
+  static ResultCacheStats readStats(const std::filesystem::path &path) {
+    ResultCacheStats stats;
+    std::ifstream file(path);
+    std::string name;
+    std::uint64_t value = 0;
+    while (file >> name >> value) {
+      if (name == "hits") {
+        stats.hits = value;
+      } else if (name == "misses") {
+        stats.misses = value;
+      } else if (name == "stores") {
+        stats.stores = value;
+      } else if (name == "evictions") {
+        stats.evictions = value;
+      }
+    }
+    return stats;
+  }
+};
+
+} // namespace Sim
@@ -0,0 +1,56 @@
+// deps/Simulations/RowWriter.h
+
+#pragma once
+
+#include <Events.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+namespace Sim {
+
+/**
+ * @brief Writes the "Time(s), x(t), ..." header line used by every .dat file
+ */
+template <std::size_t N>
+void writeHeader(std::ostream &out,
+                 const std::array<std::string_view, N> &columns) {
+  for (std::size_t i = 0; i < N; ++i) {
+    out << (i == 0 ? "" : ", ") << columns[i];
+  }
+  out << '\n';
+}
+
+template <std::size_t N>
+void writeRow(std::ostream &out, const std::array<double, N> &row) {
+  for (std::size_t i = 0; i < N; ++i) {
+    out << (i == 0 ? "" : ", ") << row[i];
+  }
+  out << '\n';
+}
+
+/**
+ * @brief Runs kernel to completion, writing the header and one line per
+ * step in the format of the chapter executables, then the row of the event
+ * that ended the run, if any (see EndsOnEvent). Returns the row count.
+ */
+template <typename Kernel>
+std::uint64_t writeRun(Kernel &kernel, std::ostream &out) {
+  out.precision(17);
+  writeHeader(out, Kernel::columns);
+  std::uint64_t rows = 0;
+  while (!kernel.done()) {
+    writeRow(out, kernel.row());
+    kernel.step();
+    ++rows;
+  }
+  if (const auto last = terminalRowOf(kernel)) {
+    writeRow(out, *last);
+    ++rows;
+  }
+  return rows;
+}
+
+} // namespace Sim
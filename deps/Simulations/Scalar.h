@@ -0,0 +1,93 @@
+// deps/Simulations/Scalar.h
+
+#pragma once
+
+#include <cmath>
+#include <string_view>
+#include <type_traits>
+
+namespace Sim {
+
+/**
+ * @brief How a kernel accumulates its integrated state (positions and, where
+ * it is stepped, time)
+ *
+ * Plain is the textbook `x += v * dt`. Compensated uses Neumaier's variant
+ * of Kahan summation, which carries the rounding error of every addition in
+ * a second term, so the accumulated value no longer drifts with the number
+ * of steps.
+ */
+enum class Summation { Plain, Compensated };
+
+/**
+ * @brief Running sum of T with the selected summation mode
+ */
+template <typename T, Summation S = Summation::Plain> class Accumulator {
+public:
+  Accumulator() = default;
+  explicit Accumulator(T value) : m_sum(value) {}
+
+  Accumulator &operator+=(T value) {
+    if constexpr (S == Summation::Compensated) {
+      const T sum = m_sum + value;
+      if (std::abs(m_sum) >= std::abs(value)) {
+        m_error += (m_sum - sum) + value;
+      } else {
+        m_error += (value - sum) + m_sum;
+      }
+      m_sum = sum;
+    } else {
+      m_sum += value;
+    }
+    return *this;
+  }
+
+  T value() const {
+    if constexpr (S == Summation::Compensated) {
+      return m_sum + m_error;
+    } else {
+      return m_sum;
+    }
+  }
+
+private:
+  T m_sum = T(0);
+  T m_error = T(0);
+};
+
+/**
+ * @brief Scalar of the default kernel aliases (Sim::Box1D, Sim::MiniGolf,
+ * ...)
+ *
+ * The build can force one scalar for every kernel with CP_SIM_SCALAR (float,
+ * double or long double, CMake option of the same name); otherwise each
+ * kernel keeps its own default. The templates (Sim::BasicBox1D, ...) can be
+ * instantiated with any scalar regardless.
+ */
+#if defined(CP_SIM_SCALAR)
+template <typename Default> using DefaultScalar = CP_SIM_SCALAR;
+#else
+template <typename Default> using DefaultScalar = Default;
+#endif
+
+#if defined(CP_SIM_COMPENSATED) && CP_SIM_COMPENSATED
+inline constexpr Summation kDefaultSummation = Summation::Compensated;
+#else
+inline constexpr Summation kDefaultSummation = Summation::Plain;
+#endif
+
+template <typename T> constexpr std::string_view scalarName() {
+  if constexpr (std::is_same_v<T, float>) {
+    return "float";
+  } else if constexpr (std::is_same_v<T, double>) {
+    return "double";
+  } else {
+    return "long double";
+  }
+}
+
+constexpr std::string_view summationName(Summation summation) {
+  return summation == Summation::Compensated ? "compensated" : "plain";
+}
+
+} // namespace Sim
@@ -0,0 +1,299 @@
+// deps/Simulations/TimeGrid.h
+
+#pragma once
+
+#include <Events.h>
+#include <Pragmas.h>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Sim {
+
+/**
+ * @brief Number of samples t_i = t0 + i * dt with t_i <= tf
+ *
+ * Matches the done() test of the closed-form kernels exactly, including
+ * rounding of t0 + i * dt near tf; T is the kernel's scalar.
+ */
+template <typename T> std::uint64_t gridSize(T t0, T tf, T dt) {
+  if (!(dt > T(0)) || t0 > tf) {
+    return 0;
+  }
+  auto n = static_cast<std::uint64_t>(std::floor((tf - t0) / dt));
+  while (t0 + (static_cast<T>(n + 1) * dt) <= tf) {
+    ++n;
+  }
+  while (n > 0 && t0 + (static_cast<T>(n) * dt) > tf) {
+    --n;
+  }
+  return n + 1;
+}
+
+/**
+ * @brief Number of samples t_i = t0 + i * dt with t_i < end: the steps
+ * before an event at end, matching a done() test t_i >= end
+ */
+template <typename T> std::uint64_t gridSizeBefore(T t0, T end, T dt) {
+  if (!(dt > T(0)) || !(t0 < end)) {
+    return 0;
+  }
+  auto n = static_cast<std::uint64_t>(std::ceil((end - t0) / dt));
+  while (t0 + (static_cast<T>(n) * dt) < end) {
+    ++n;
+  }
+  while (n > 0 && t0 + (static_cast<T>(n - 1) * dt) >= end) {
+    --n;
+  }
+  return n;
+}
+
+/**
+ * @brief Text layout of the rows written by writeGrid()
+ *
+ * precision has the meaning of std::ostream::precision() with default
+ * floatfield, so the output is identical to streaming the values.
+ */
+struct GridFormat {
+  std::string_view separator = " ";
+  int precision = 6;
+  unsigned threads = 0; // 0: std::thread::hardware_concurrency()
+  std::size_t chunkRows = std::size_t{1} << 16;
+};
+
+/**
+ * @brief Rows per batch of a kernel's evaluateColumns(): its scratch
+ * buffers of times and phases stay in L1
+ */
+inline constexpr std::size_t kGridBatch = 256;
+
+/**
+ * @brief A closed-form kernel that evaluates a run of steps column by
+ * column itself: evaluateColumns(first, count, out) fills out[c][j] with
+ * column c of step first + j, exactly as at(first + j) would
+ *
+ * The kernels fill a batch of times, hand it to the batch functions of
+ * PhysicsSimd.h (sincos, exp) and derive the columns in vectorizable loops;
+ * at() goes through the scalar entry points of the same functions.
+ */
+template <typename Kernel>
+concept EvaluatesColumns =
+    requires(const Kernel &kernel, std::uint64_t first, std::size_t count,
+             const std::array<double *, Kernel::columns.size()> &out) {
+      kernel.evaluateColumns(first, count, out);
+    };
+
+/**
+ * @brief Evaluates steps [first, first + count) of a closed-form kernel into
+ * one buffer per column: in batches if the kernel provides them (see
+ * EvaluatesColumns), one row of at() at a time otherwise
+ */
+template <typename Kernel>
+void evaluateColumns(const Kernel &kernel, std::uint64_t first,
+                     std::size_t count,
+                     const std::array<double *, Kernel::columns.size()> &out) {
+  if constexpr (EvaluatesColumns<Kernel>) {
+    kernel.evaluateColumns(first, count, out);
+  } else {
+    for (std::size_t j = 0; j < count; ++j) {
+      const auto row = kernel.at(first + j);
+      for (std::size_t c = 0; c < row.size(); ++c) {
+        out[c][j] = row[c];
+      }
+    }
+  }
+}
+
+template <std::size_t N>
+void formatColumns(const std::array<std::vector<double>, N> &columns,
+                   std::size_t count, const GridFormat &format,
+                   std::string &text) {
+  char buffer[32];
+  for (std::size_t j = 0; j < count; ++j) {
+    for (std::size_t c = 0; c < N; ++c) {
+      if (c != 0) {
+        text += format.separator;
+      }
+      const auto result =
+          std::to_chars(buffer, buffer + sizeof(buffer), columns[c][j],
+                        std::chars_format::general, format.precision);
+      text.append(buffer, result.ptr);
+    }
+    text += '\n';
+  }
+}
+
+/** @brief Appends one row in the layout of formatColumns() */
+template <std::size_t N>
+void formatRow(const std::array<double, N> &row, const GridFormat &format,
+               std::string &text) {
+  char buffer[32];
+  for (std::size_t c = 0; c < N; ++c) {
+    if (c != 0) {
+      text += format.separator;
+    }
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), row[c],
+                                      std::chars_format::general,
+                                      format.precision);
+    text.append(buffer, result.ptr);
+  }
+  text += '\n';
+}
+
+/**
+ * @brief A kernel with its own row formatter for writeGrid(): formatter(format)
+ * returns an optional function object, empty when the kernel has no faster
+ * way to format this run
+ */
+template <typename Kernel>
+concept FormatsRows = requires(const Kernel &kernel, const GridFormat &format,
+                               std::string &text) {
+  static_cast<bool>(kernel.formatter(format));
+  (*kernel.formatter(format))(std::uint64_t{}, std::size_t{}, text);
+};
+
+/**
+ * @brief Writes every row of a closed-form kernel, from step 0 to done()
+ *
+ * The time grid is cut into chunks of format.chunkRows steps. Worker threads
+ * claim chunks, evaluate them into column buffers with evaluateColumns() and
+ * format them with std::to_chars; the calling thread writes the formatted
+ * chunks in order. At most 2 * threads formatted chunks are buffered.
+ * The row of the event that ends the run, if any (see EndsOnEvent), is
+ * written last.
+ * A kernel that can format its rows faster (PeriodicReplay, whose rows
+ * repeat) provides formatter(format) (see FormatsRows), a function object
+ * that appends rows [first, first + count) to a string; it is used instead
+ * of evaluating and formatting column by column when it is not empty.
+ * Returns the number of rows written.
+ */
+template <typename Kernel>
+std::uint64_t writeGrid(const Kernel &kernel, std::ostream &out,
+                        const GridFormat &format = {}) {
+  CP_TRACE_SCOPE("Sim::writeGrid");
+  constexpr std::size_t N = Kernel::columns.size();
+  const std::uint64_t total = kernel.size();
+  const std::size_t chunkRows = std::max<std::size_t>(1, format.chunkRows);
+  const std::uint64_t chunks = (total + chunkRows - 1) / chunkRows;
+  if (chunks == 0) {
+    return 0;
+  }
+  unsigned threads = format.threads != 0
+                         ? format.threads
+                         : std::max(1U, std::thread::hardware_concurrency());
+  threads = static_cast<unsigned>(std::min<std::uint64_t>(threads, chunks));
+  const std::size_t slotCount = 2 * static_cast<std::size_t>(threads);
+  const auto formatter = [&] {
+    if constexpr (FormatsRows<Kernel>) {
+      return kernel.formatter(format);
+    } else {
+      return false;
+    }
+  }();
+
+  struct Slot {
+    std::string text;
+    bool ready = false;
+  };
+  std::vector<Slot> slots(slotCount);
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::uint64_t nextChunk = 0; // guarded by mutex
+  std::uint64_t written = 0;   // guarded by mutex
+
+  auto worker = [&] {
+    CP_TRACE_THREAD_NAME("grid worker");
+    std::array<std::vector<double>, N> columns;
+    std::array<double *, N> pointers{};
+    for (std::size_t c = 0; c < N; ++c) {
+      columns[c].resize(chunkRows);
+      pointers[c] = columns[c].data();
+    }
+    std::string text;
+    while (true) {
+      std::uint64_t chunk = 0;
+      {
+        const std::lock_guard lock(mutex);
+        if (nextChunk == chunks) {
+          return;
+        }
+        chunk = nextChunk++;
+      }
+      const std::uint64_t first = chunk * chunkRows;
+      const auto count = static_cast<std::size_t>(
+          std::min<std::uint64_t>(chunkRows, total - first));
+      text.clear();
+      if (formatter) {
+        if constexpr (FormatsRows<Kernel>) {
+          CP_TRACE_SCOPE("format");
+          (*formatter)(first, count, text);
+        }
+      } else {
+        {
+          CP_TRACE_SCOPE("evaluate");
+          evaluateColumns(kernel, first, count, pointers);
+        }
+        CP_TRACE_SCOPE("format");
+        formatColumns(columns, count, format, text);
+      }
+      std::unique_lock lock(mutex);
+      changed.wait(lock, [&] { return chunk < written + slotCount; });
+      Slot &slot = slots[chunk % slotCount];
+      slot.text.swap(text);
+      slot.ready = true;
+      changed.notify_all();
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads);
+  for (unsigned t = 0; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+
+  std::string text;
+  for (std::uint64_t chunk = 0; chunk < chunks; ++chunk) {
+    Slot &slot = slots[chunk % slotCount];
+    {
+      std::unique_lock lock(mutex);
+      changed.wait(lock, [&] { return slot.ready; });
+      slot.text.swap(text);
+    }
+    {
+      CP_TRACE_SCOPE("write");
+      out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+    text.clear();
+    {
+      const std::lock_guard lock(mutex);
+      slot.text.swap(text); // hand the capacity back for reuse
+      slot.ready = false;
+      ++written;
+    }
+    changed.notify_all();
+  }
+
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  if (const auto last = terminalRowOf(kernel)) {
+    text.clear();
+    formatRow(*last, format, text);
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    return total + 1;
+  }
+  return total;
+}
+
+} // namespace Sim
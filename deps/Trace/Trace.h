@@ -0,0 +1,241 @@
+// deps/Trace/Trace.h
+
+#pragma once
+
+/**
+ * @file Trace.h
+ * @brief Low-overhead scoped tracing with Chrome trace / Perfetto export
+ *
+ * Usage:
+ *   CP_TRACE_SESSION("PlotGraph.trace.json"); // once, at the top of main()
+ *   CP_TRACE_SCOPE("parse");                  // times the enclosing scope
+ *   CP_TRACE_THREAD_NAME("worker");           // label the calling thread
+ *
+ * Every thread records into its own buffer; recording is two clock reads
+ * and a store, with no locks and no shared cache lines. The session writes
+ * all buffers as a Chrome trace JSON file when it goes out of scope (open
+ * it in chrome://tracing or ui.perfetto.dev). CP_TRACE_FILE overrides the
+ * output path at run time.
+ *
+ * Scope names must be string literals: only the pointer is stored.
+ *
+ * Unless the build defines CP_ENABLE_TRACING (cmake -DCP_ENABLE_TRACING=ON)
+ * the macros expand to nothing and none of this is compiled.
+ */
+
+#if defined(CP_ENABLE_TRACING) && CP_ENABLE_TRACING
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Trace {
+
+struct Event {
+  const char *name;
+  std::int64_t startNs;
+  std::int64_t durationNs;
+};
+
+inline std::int64_t nowNs() {
+  static const auto epoch = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - epoch)
+      .count();
+}
+
+/**
+ * @brief Append-only event storage owned by one thread
+ *
+ * Events live in fixed-size chunks that are never moved, so the exporter
+ * can read the published prefix (count, acquire) while the owner keeps
+ * recording. Once all chunks are used further events are only counted.
+ */
+class ThreadBuffer {
+public:
+  static constexpr std::size_t kChunkSize = std::size_t{1} << 14;
+  static constexpr std::size_t kMaxChunks = 256; // ~4M events per thread
+
+  explicit ThreadBuffer(std::uint32_t tid) : m_tid(tid) {}
+
+  void record(const Event &event) {
+    const std::size_t n = m_count.load(std::memory_order_relaxed);
+    const std::size_t chunk = n / kChunkSize;
+    if (chunk >= kMaxChunks) {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (!m_chunks[chunk]) {
+      m_chunks[chunk] = std::make_unique<Event[]>(kChunkSize);
+    }
+    m_chunks[chunk][n % kChunkSize] = event;
+    m_count.store(n + 1, std::memory_order_release);
+  }
+
+  template <typename Fn> void forEach(Fn &&fn) const {
+    const std::size_t n = m_count.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < n; ++i) {
+      fn(m_chunks[i / kChunkSize][i % kChunkSize]);
+    }
+  }
+
+  std::uint32_t tid() const { return m_tid; }
+  std::uint64_t dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+  void setName(std::string name) {
+    std::lock_guard<std::mutex> lock(m_nameMutex);
+    m_name = std::move(name);
+  }
+  std::string name() const {
+    std::lock_guard<std::mutex> lock(m_nameMutex);
+    return m_name;
+  }
+
+private:
+  std::uint32_t m_tid;
+  std::atomic<std::size_t> m_count{0};
+  std::atomic<std::uint64_t> m_dropped{0};
+  std::array<std::unique_ptr<Event[]>, kMaxChunks> m_chunks;
+  mutable std::mutex m_nameMutex;
+  std::string m_name;
+};
+
+/**
+ * @brief Owns every thread's buffer; buffers outlive their threads so the
+ * session can still export events recorded by a finished worker
+ */
+class Registry {
+public:
+  static Registry &instance() {
+    static Registry registry;
+    return registry;
+  }
+
+  ThreadBuffer *registerThread() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto tid = static_cast<std::uint32_t>(m_buffers.size() + 1);
+    m_buffers.push_back(std::make_unique<ThreadBuffer>(tid));
+    return m_buffers.back().get();
+  }
+
+  bool writeChromeTrace(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    bool first = true;
+    auto separator = [&]() -> std::ostream & {
+      out << (first ? "\n" : ",\n");
+      first = false;
+      return out;
+    };
+
+    out.precision(3);
+    out << std::fixed;
+    for (const auto &buffer : m_buffers) {
+      const std::string name = buffer->name();
+      if (!name.empty()) {
+        separator() << R"({"name": "thread_name", "ph": "M", "pid": 1, )"
+                    << "\"tid\": " << buffer->tid()
+                    << R"(, "args": {"name": ")" << name << "\"}}";
+      }
+      buffer->forEach([&](const Event &e) {
+        separator() << "{\"name\": \"" << e.name
+                    << R"(", "cat": "cp", "ph": "X", "pid": 1, "tid": )"
+                    << buffer->tid()
+                    << ", \"ts\": " << static_cast<double>(e.startNs) / 1e3
+                    << ", \"dur\": "
+                    << static_cast<double>(e.durationNs) / 1e3 << "}";
+      });
+      if (buffer->dropped() > 0) {
+        std::cerr << "Trace: thread " << buffer->tid() << " dropped "
+                  << buffer->dropped() << " events\n";
+      }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+  }
+
+private:
+  Registry() = default;
+  mutable std::mutex m_mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+};
+
+inline ThreadBuffer &localBuffer() {
+  thread_local ThreadBuffer *buffer = Registry::instance().registerThread();
+  return *buffer;
+}
+
+inline void setThreadName(std::string name) {
+  localBuffer().setName(std::move(name));
+}
+
+class Scope {
+public:
+  explicit Scope(const char *name) : m_name(name), m_start(nowNs()) {}
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+  ~Scope() { localBuffer().record({m_name, m_start, nowNs() - m_start}); }
+
+private:
+  const char *m_name;
+  std::int64_t m_start;
+};
+
+/**
+ * @brief Writes the trace file when it goes out of scope
+ */
+class Session {
+public:
+  explicit Session(std::string path) : m_path(std::move(path)) {
+    if (const char *overridePath = std::getenv("CP_TRACE_FILE")) {
+      m_path = overridePath;
+    }
+    setThreadName("main");
+  }
+  Session(const Session &) = delete;
+  Session &operator=(const Session &) = delete;
+  ~Session() {
+    if (Registry::instance().writeChromeTrace(m_path)) {
+      std::cerr << "Trace written to " << m_path << '\n';
+    } else {
+      std::cerr << "Trace: could not write " << m_path << '\n';
+    }
+  }
+
+private:
+  std::string m_path;
+};
+
+} // namespace Trace
+
+#define CP_TRACE_CONCAT_IMPL(a, b) a##b
+#define CP_TRACE_CONCAT(a, b) CP_TRACE_CONCAT_IMPL(a, b)
+#define CP_TRACE_SCOPE(name)                                                   \
+  const ::Trace::Scope CP_TRACE_CONCAT(cpTraceScope, __LINE__)(name)
+#define CP_TRACE_SESSION(path) const ::Trace::Session cpTraceSession(path)
+#define CP_TRACE_THREAD_NAME(name) ::Trace::setThreadName(name)
+
+#else
+
+#define CP_TRACE_SCOPE(name) static_cast<void>(0)
+#define CP_TRACE_SESSION(path) static_cast<void>(0)
+#define CP_TRACE_THREAD_NAME(name) static_cast<void>(0)
+
+#endif
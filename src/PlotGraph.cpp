@@ -1,11 +1,37 @@
 // src/PlotGraph.cpp
+//
+// Usage:
+//   PlotGraph                          plot Box2D.dat
+//   PlotGraph --follow                 plot Box2D.dat and keep appending rows
+//                                      while a simulation is still writing it
+//   PlotGraph --speed                  also plot |v| = hypot(vx, vy); may be
+//                                      combined with --follow
+//   PlotGraph --shm <name> [cols...]   follow a running simulation published
+//                                      with --shm <name>; plots the listed
+//                                      columns (default: all) against column 0
+//
+// F3 toggles the frame profiler overlay.
 
+#include <ColumnExpr.h>
+#include <ColumnStats.h>
 #include <DataLoader.h>
 #include <GridRenderer.h>
-#include <LineRenderer.h>
+#include <MultiSeriesRenderer.h>
+#include <ProfilerOverlay.h>
 #include <SFML/Graphics.hpp>
+#include <SharedChannel.h>
+#include <Trace.h>
 #include <Vector2D.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <memory>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 void updateViewOnResize(sf::RenderWindow &window, sf::View &view) {
   sf::Vector2u size = window.getSize();
@@ -15,8 +41,12 @@ void updateViewOnResize(sf::RenderWindow &window, sf::View &view) {
   window.setView(view);
 }
 
-void handleEvents(sf::RenderWindow &window, sf::View &view) {
+void handleEvents(sf::RenderWindow &window, sf::View &view,
+                  ProfilerOverlay &overlay) {
   while (const std::optional<sf::Event> event = window.pollEvent()) {
+    if (overlay.handleEvent(*event)) {
+      continue;
+    }
     if (event->is<sf::Event::Closed>()) {
       window.close();
     } else if (event->is<sf::Event::Resized>()) {
@@ -25,61 +55,257 @@ void handleEvents(sf::RenderWindow &window, sf::View &view) {
   }
 }
 
-int main() {
-  DataLoader loader("Box2D.dat");
-  const auto &Time = loader.getColumn("Time(s)");
-  const auto &xData = loader.getColumn("x(t)");
-  const auto &yData = loader.getColumn("y(t)");
-  const auto &vx = loader.getColumn("vx(t)");
-  const auto &vy = loader.getColumn("vy(t)");
+// Used when there is no data to fit yet (--shm, or --follow before the
+// simulation wrote its first rows).
+const float defaultScaleX = 5.0F;
+const float defaultScaleY = 10.0F;
 
-  sf::ContextSettings settings;
-  settings.antiAliasingLevel = 8;
+// Fraction of the half view the data may fill.
+const float fitMargin = 0.9F;
 
-  sf::RenderWindow window(sf::VideoMode({800U, 600U}), "Data Visualizer",
-                          sf::Style::Default, sf::State::Windowed, settings);
-  window.setFramerateLimit(60);
+const std::array<sf::Color, 6> seriesColors{
+    sf::Color(0, 205, 0, 200),   sf::Color(205, 0, 0, 200),
+    sf::Color(0, 120, 225, 200), sf::Color(225, 175, 0, 200),
+    sf::Color(175, 0, 225, 200), sf::Color(0, 205, 205, 200)};
 
-  sf::View view;
-  updateViewOnResize(window, view);
+int plotFile(sf::RenderWindow &window, sf::View &view, bool follow,
+             bool speed) {
+  DataLoader loader("Box2D.dat", ',',
+                    follow ? DataLoader::Mode::Follow : DataLoader::Mode::Once);
+  // With --speed, |v| is a lazy expression over vx and vy: its rows are
+  // computed block by block together with the plotted columns and never
+  // stored.
+  const auto speedOf = [](const Expr::Column &vx, const Expr::Column &vy) {
+    return Expr::hypot(vx, vy);
+  };
+
+  // Fit the view to the data; with --follow the scale stays at what the
+  // first rows needed.
+  ColumnStats velocity = loader.getStats("vx(t)");
+  velocity.merge(loader.getStats("vy(t)"));
+  if (speed) {
+    velocity.merge(Expr::stats(speedOf(Expr::column(loader, "vx(t)"),
+                                       Expr::column(loader, "vy(t)"))));
+  }
+  const float scaleX =
+      fitScale(loader.getStats("Time(s)"),
+               fitMargin * view.getSize().x / 2.0F, defaultScaleX);
+  const float scaleY = fitScale(
+      velocity, fitMargin * std::abs(view.getSize().y) / 2.0F, defaultScaleY);
 
   GridRenderer gridRenderer;
-  LineRenderer lineRenderer1;
-  LineRenderer lineRenderer2;
-  LineRenderer lineRenderer3;
-  LineRenderer lineRenderer4;
+  MultiSeriesRenderer plot;
+  plot.setThickness(2.0F);
+  plot.addSeries(sf::Color(0, 205, 0, 200)); // vx(t)
+  plot.addSeries(sf::Color(205, 0, 0, 200)); // vy(t)
+  if (speed) {
+    plot.addSeries(sf::Color(0, 120, 225, 200)); // |v(t)|
+  }
+
+  // The columns are looked up again on every call: the loader rebuilds them
+  // when the file is truncated.
+  const auto appendRows = [&](size_t firstRow, size_t lastRow) {
+    const auto time = Expr::column(loader, "Time(s)");
+    const auto vx = Expr::column(loader, "vx(t)");
+    const auto vy = Expr::column(loader, "vy(t)");
+    if (!speed) {
+      Expr::forEachBlock(
+          firstRow, lastRow,
+          [&](size_t, std::span<const float> t, std::span<const float> x,
+              std::span<const float> y) {
+            for (size_t i = 0; i < t.size(); ++i) {
+              const std::array<float, 2> values{x[i], y[i]};
+              plot.append(t[i], values, scaleX, scaleY);
+            }
+          },
+          time, vx, vy);
+      return;
+    }
+    Expr::forEachBlock(
+        firstRow, lastRow,
+        [&](size_t, std::span<const float> t, std::span<const float> x,
+            std::span<const float> y, std::span<const float> v) {
+          for (size_t i = 0; i < t.size(); ++i) {
+            const std::array<float, 3> values{x[i], y[i], v[i]};
+            plot.append(t[i], values, scaleX, scaleY);
+          }
+        },
+        time, vx, vy, speedOf(vx, vy));
+  };
+  appendRows(0, loader.getRowCount());
 
-  const float scaleX = 5.0F;
-  const float scaleY = 10.0F;
+  ProfilerOverlay overlay;
+  overlay.track("grid", gridRenderer);
+  overlay.track(speed ? "vx(t), vy(t), |v(t)|" : "vx(t), vy(t)", plot);
 
-  //   lineRenderer1.setThickness(2.0F);
-  //   lineRenderer1.setColor(sf::Color(205, 0, 0, 200));
-  //   lineRenderer1.setData(Time, xData, scaleX, scaleY);
+  // Only the appended rows are turned into new segments. The listener runs
+  // inside loader.update() and just records them, so reading the file and
+  // building vertices are timed as separate sections.
+  bool reset = false;
+  size_t pendingFirst = 0;
+  size_t pendingEnd = 0;
+  loader.addListener([&](size_t firstRow, size_t count) {
+    if (firstRow == 0) {
+      reset = true;
+      pendingFirst = 0;
+    } else if (pendingFirst == pendingEnd) {
+      pendingFirst = firstRow;
+    }
+    pendingEnd = firstRow + count;
+  });
 
-  //   lineRenderer2.setThickness(2.0F);
-  //   lineRenderer2.setColor(sf::Color(0, 205, 0, 200));
-  //   lineRenderer2.setData(Time, yData, scaleX, scaleY);
+  while (window.isOpen()) {
+    CP_TRACE_SCOPE("frame");
+    overlay.beginFrame();
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Events);
+      handleEvents(window, view, overlay);
+    }
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Load);
+      loader.update();
+    }
+    if (reset || pendingFirst != pendingEnd) {
+      auto section = overlay.measure(ProfilerOverlay::Section::Vertices);
+      if (reset) {
+        plot.clear();
+        reset = false;
+      }
+      appendRows(pendingFirst, pendingEnd);
+      pendingFirst = pendingEnd;
+    }
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Grid);
+      gridRenderer.update(window.getView());
+    }
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Draw);
+      window.clear(sf::Color{33, 33, 33, 105});
+      gridRenderer.draw(window);
 
-  lineRenderer3.setThickness(2.0F);
-  lineRenderer3.setColor(sf::Color(0, 205, 0, 200));
-  lineRenderer3.setData(Time, vx, scaleX, scaleY);
+      plot.draw(window);
+    }
+    overlay.draw(window);
+    CP_TRACE_SCOPE("display");
+    window.display();
+  }
+
+  return 0;
+}
 
-  lineRenderer4.setThickness(2.0F);
-  lineRenderer4.setColor(sf::Color(205, 0, 0, 200));
-  lineRenderer4.setData(Time, vy, scaleX, scaleY);
+int plotChannel(sf::RenderWindow &window, sf::View &view,
+                const std::string &name,
+                const std::vector<std::string> &requested) {
+  GridRenderer gridRenderer;
+  std::unique_ptr<Live::SharedChannelReader> reader;
+  std::vector<std::size_t> series;
+  std::vector<float> values; // one row of the plotted columns
+  MultiSeriesRenderer plot;
+  plot.setThickness(2.0F);
+  bool finishedReported = false;
+
+  ProfilerOverlay overlay;
+  overlay.track("grid", gridRenderer);
+  overlay.track("series", plot);
 
   while (window.isOpen()) {
-    handleEvents(window, view);
-    window.clear(sf::Color{33, 33, 33, 105});
-    gridRenderer.renderGrid(window);
+    CP_TRACE_SCOPE("frame");
+    overlay.beginFrame();
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Events);
+      handleEvents(window, view, overlay);
+    }
 
-    // lineRenderer1.draw(window);
-    // lineRenderer2.draw(window);
-    lineRenderer3.draw(window);
-    lineRenderer4.draw(window);
+    // The simulation may not have created the segment yet; keep trying.
+    if (!reader) {
+      try {
+        reader = std::make_unique<Live::SharedChannelReader>(name);
+      } catch (const std::runtime_error &) {
+      }
+
+      if (reader) {
+        const auto &columns = reader->columns();
+        for (std::size_t i = 1; i < columns.size(); ++i) {
+          if (requested.empty() ||
+              std::find(requested.begin(), requested.end(), columns[i]) !=
+                  requested.end()) {
+            series.push_back(i);
+          }
+        }
+        values.resize(series.size());
+        for (std::size_t i = 0; i < series.size(); ++i) {
+          plot.addSeries(seriesColors[i % seriesColors.size()]);
+          std::cout << "Plotting " << columns[series[i]] << " vs "
+                    << columns[0] << '\n';
+        }
+      }
+    }
 
+    if (reader) {
+      auto section = overlay.measure(ProfilerOverlay::Section::Vertices);
+      reader->poll([&](std::span<const double> row) {
+        for (std::size_t i = 0; i < series.size(); ++i) {
+          values[i] = static_cast<float>(row[series[i]]);
+        }
+        plot.append(static_cast<float>(row[0]), values, defaultScaleX,
+                    defaultScaleY);
+      });
+      if (reader->finished() && !finishedReported) {
+        std::cout << "Simulation finished, rows skipped= "
+                  << reader->skipped() << '\n';
+        finishedReported = true;
+      }
+    }
+
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Grid);
+      gridRenderer.update(window.getView());
+    }
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Draw);
+      window.clear(sf::Color{33, 33, 33, 105});
+      gridRenderer.draw(window);
+      plot.draw(window);
+    }
+    overlay.draw(window);
+    CP_TRACE_SCOPE("display");
     window.display();
   }
 
   return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("PlotGraph.trace.json");
+  std::string channel;
+  std::vector<std::string> columns;
+  bool follow = false;
+  bool speed = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--follow") {
+      follow = true;
+    } else if (arg == "--speed") {
+      speed = true;
+    } else if (arg == "--shm" && i + 1 < argc) {
+      channel = argv[++i];
+    } else if (!channel.empty()) {
+      columns.push_back(arg);
+    }
+  }
+
+  sf::ContextSettings settings;
+  settings.antiAliasingLevel = 8;
+
+  sf::RenderWindow window(sf::VideoMode({800U, 600U}), "Data Visualizer",
+                          sf::Style::Default, sf::State::Windowed, settings);
+  window.setFramerateLimit(60);
+
+  sf::View view;
+  updateViewOnResize(window, view);
+
+  if (!channel.empty()) {
+    return plotChannel(window, view, channel, columns);
+  }
+  return plotFile(window, view, follow, speed);
+}
@@ -0,0 +1,331 @@
+// src/chapter1/BatchRunner.cpp
+//
+// Runs many scenarios of the simulation kernels in a single process.
+//
+// Usage:
+//   BatchRunner <manifest> [--out <dir>] [--threads <n>]
+//               [--cache <dir>] [--cache-budget <bytes>[K|M|G]]
+//   BatchRunner --cache <dir> --cache-stats
+//
+// Every non-empty manifest line not starting with '#' is one scenario:
+//   <id> <simulation> key=value ...
+// for example
+//   golf-001 minigolf v0=5 theta=12 dt=0.001
+// <simulation> is a kernel name (box1d, box2d, circle, harddisks,
+// lennardjones, lissajous, minigolf, pendulum, projectile, projectile_air);
+// keys that are not given keep the kernel defaults. Scenario <id> is
+// written to <dir>/<id>.dat (default dir: batch) through a temporary file
+// that is renamed once complete, so an interrupted batch can simply be
+// rerun: scenarios whose output already exists are skipped.
+//
+// With --cache, outputs are also kept in a content-addressed result cache
+// (see ResultCache.h) keyed by the kernel and its canonical parameters, so
+// a scenario that any earlier batch already ran is hard-linked from the
+// cache instead of being recomputed, whatever its id. The cache keeps to
+// its budget (default 10G) by evicting the least recently used outputs.
+// --cache-stats prints its lifetime hit/miss counters and size.
+
+#include <Box1D.h>
+#include <Box2D.h>
+#include <Circle.h>
+#include <Fields.h>
+#include <HardDisks.h>
+#include <LennardJones.h>
+#include <Lissajous.h>
+#include <MiniGolf.h>
+#include <Pendulum.h>
+#include <Projectile.h>
+#include <ResultCache.h>
+#include <RowWriter.h>
+#include <Trace.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct Scenario;
+// Rows computed for the scenario, or nothing if its output came from the
+// cache.
+using Runner = std::optional<std::uint64_t> (*)(const Scenario &,
+                                                const fs::path &,
+                                                Sim::ResultCache *);
+
+struct Scenario {
+  std::string id;
+  std::string simulation;
+  std::vector<std::pair<std::string, std::string>> assignments;
+  Runner run = nullptr;
+};
+
+template <typename Kernel>
+std::optional<std::uint64_t> runScenario(const Scenario &scenario,
+                                         const fs::path &output,
+                                         Sim::ResultCache *cache) {
+  CP_TRACE_SCOPE("scenario");
+  typename Kernel::Params params;
+  for (const auto &[key, value] : scenario.assignments) {
+    Sim::setField<Kernel>(params, key, value);
+  }
+  const std::string key = Sim::resultKey<Kernel>(params);
+  if (cache != nullptr && cache->fetch(key, output)) {
+    return std::nullopt;
+  }
+  Kernel kernel(params);
+
+  fs::path partial = output;
+  partial += ".tmp";
+  std::uint64_t rows = 0;
+  {
+    std::ofstream file(partial);
+    if (!file) {
+      throw std::runtime_error("cannot open " + partial.string());
+    }
+    rows = Sim::writeRun(kernel, file);
+    file.close();
+    if (!file) {
+      throw std::runtime_error("write failed: " + partial.string());
+    }
+  }
+  fs::rename(partial, output);
+  if (cache != nullptr) {
+    cache->store(key, output);
+  }
+  return rows;
+}
+
+const std::array<std::pair<std::string_view, Runner>, 10> runners{{
+    {Sim::Box1D::name, &runScenario<Sim::Box1D>},
+    {Sim::Box2D::name, &runScenario<Sim::Box2D>},
+    {Sim::Circle::name, &runScenario<Sim::Circle>},
+    {Sim::HardDisks::name, &runScenario<Sim::HardDisks>},
+    {Sim::LennardJones::name, &runScenario<Sim::LennardJones>},
+    {Sim::Lissajous::name, &runScenario<Sim::Lissajous>},
+    {Sim::MiniGolf::name, &runScenario<Sim::MiniGolf>},
+    {Sim::Pendulum::name, &runScenario<Sim::Pendulum>},
+    {Sim::Projectile::name, &runScenario<Sim::Projectile>},
+    {Sim::ProjectileAirResistance::name,
+     &runScenario<Sim::ProjectileAirResistance>},
+}};
+
+Runner findRunner(std::string_view simulation) {
+  for (const auto &[name, run] : runners) {
+    if (name == simulation) {
+      return run;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<Scenario> readManifest(const std::string &path) {
+  std::ifstream manifest(path);
+  if (!manifest) {
+    throw std::runtime_error("cannot open manifest " + path);
+  }
+
+  std::vector<Scenario> scenarios;
+  std::set<std::string> ids;
+  std::string line;
+  for (std::size_t number = 1; std::getline(manifest, line); ++number) {
+    std::istringstream tokens(line);
+    Scenario scenario;
+    if (!(tokens >> scenario.id) || scenario.id.front() == '#') {
+      continue;
+    }
+    const std::string where = path + ":" + std::to_string(number) + ": ";
+    if (scenario.id.find_first_of("/\\") != std::string::npos) {
+      throw std::runtime_error(where + "id must not contain a path separator");
+    }
+    if (!ids.insert(scenario.id).second) {
+      throw std::runtime_error(where + "duplicate id " + scenario.id);
+    }
+    if (!(tokens >> scenario.simulation) ||
+        (scenario.run = findRunner(scenario.simulation)) == nullptr) {
+      throw std::runtime_error(where + "unknown simulation '" +
+                               scenario.simulation + "'");
+    }
+    std::string assignment;
+    while (tokens >> assignment) {
+      const auto equals = assignment.find('=');
+      if (equals == std::string::npos) {
+        throw std::runtime_error(where + "expected key=value, got " +
+                                 assignment);
+      }
+      scenario.assignments.emplace_back(assignment.substr(0, equals),
+                                        assignment.substr(equals + 1));
+    }
+    scenarios.push_back(std::move(scenario));
+  }
+  return scenarios;
+}
+
+// Parses "<n>[K|M|G]" (binary multiples) as a byte count.
+std::uint64_t parseBytes(const std::string &text) {
+  std::size_t end = 0;
+  const unsigned long long value = std::stoull(text, &end);
+  const std::string suffix = text.substr(end);
+  const int shift = suffix.empty() ? 0
+                    : suffix == "K" ? 10
+                    : suffix == "M" ? 20
+                    : suffix == "G" ? 30
+                                    : -1;
+  if (shift < 0) {
+    throw std::invalid_argument("invalid size " + text);
+  }
+  return static_cast<std::uint64_t>(value) << shift;
+}
+
+void printCacheStats(const char *label, const Sim::ResultCacheStats &stats,
+                     std::uint64_t budget) {
+  std::cout << label << ": " << stats.hits << " hits, " << stats.misses
+            << " misses (hit rate " << 100.0 * stats.hitRate() << " %), "
+            << stats.stores << " stored, " << stats.evictions
+            << " evicted; " << stats.entries << " entries, " << stats.bytes
+            << " of " << budget << " bytes\n";
+}
+
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("BatchRunner.trace.json");
+  std::string manifestPath;
+  fs::path outDir = "batch";
+  fs::path cacheDir;
+  std::uint64_t cacheBudget = std::uint64_t{10} << 30;
+  bool cacheStats = false;
+  unsigned threads = std::max(1U, std::thread::hardware_concurrency());
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--out" && i + 1 < argc) {
+      outDir = argv[++i];
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--cache" && i + 1 < argc) {
+      cacheDir = argv[++i];
+    } else if (arg == "--cache-budget" && i + 1 < argc) {
+      try {
+        cacheBudget = parseBytes(argv[++i]);
+      } catch (const std::exception &) {
+        std::cerr << "Invalid cache budget " << argv[i] << '\n';
+        exit(1);
+      }
+    } else if (arg == "--cache-stats") {
+      cacheStats = true;
+    } else if (manifestPath.empty()) {
+      manifestPath = arg;
+    } else {
+      std::cerr << "Unexpected argument " << arg << '\n';
+      exit(1);
+    }
+  }
+  if ((manifestPath.empty() && !cacheStats) ||
+      (cacheStats && cacheDir.empty())) {
+    std::cerr << "Usage: BatchRunner <manifest> [--out <dir>] "
+                 "[--threads <n>] [--cache <dir>] "
+                 "[--cache-budget <bytes>[K|M|G]] [--cache-stats]\n";
+    exit(1);
+  }
+
+  std::unique_ptr<Sim::ResultCache> cache;
+  std::vector<Scenario> scenarios;
+  try {
+    if (!cacheDir.empty()) {
+      cache = std::make_unique<Sim::ResultCache>(cacheDir, cacheBudget);
+    }
+    if (manifestPath.empty()) {
+      printCacheStats("Cache", cache->lifetime(), cache->budget());
+      return 0;
+    }
+    scenarios = readManifest(manifestPath);
+    fs::create_directories(outDir);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
+  threads = std::min<unsigned>(
+      threads, std::max<std::size_t>(1, scenarios.size()));
+
+  // Workers claim the next scenario as they free up, so a few long runs do
+  // not leave the other threads idle.
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> completed{0};
+  std::atomic<std::size_t> cached{0};
+  std::atomic<std::size_t> skipped{0};
+  std::atomic<std::size_t> failed{0};
+  std::atomic<std::uint64_t> rows{0};
+  std::mutex logMutex;
+
+  auto worker = [&] {
+    CP_TRACE_THREAD_NAME("batch worker");
+    for (std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+         i < scenarios.size();
+         i = next.fetch_add(1, std::memory_order_relaxed)) {
+      const Scenario &scenario = scenarios[i];
+      const fs::path output = outDir / (scenario.id + ".dat");
+      if (fs::exists(output)) {
+        skipped.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      try {
+        const std::optional<std::uint64_t> computed =
+            scenario.run(scenario, output, cache.get());
+        if (!computed) {
+          cached.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+        rows.fetch_add(*computed, std::memory_order_relaxed);
+        completed.fetch_add(1, std::memory_order_relaxed);
+      } catch (const std::exception &e) {
+        failed.fetch_add(1, std::memory_order_relaxed);
+        const std::lock_guard lock(logMutex);
+        std::cerr << scenario.id << " (" << scenario.simulation
+                  << "): " << e.what() << '\n';
+      }
+    }
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> pool;
+  pool.reserve(threads);
+  for (unsigned t = 0; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  const double seconds = std::max(elapsed.count(), 1e-9);
+  std::cout << "Scenarios: " << scenarios.size() << " (" << completed
+            << " run, " << cached << " from cache, " << skipped
+            << " skipped, " << failed << " failed)\n";
+  std::cout << "Threads: " << threads << ", time: " << elapsed.count()
+            << " s\n";
+  std::cout << "Throughput: " << static_cast<double>(completed) / seconds
+            << " scenarios/s, " << static_cast<double>(rows) / seconds
+            << " rows/s\n";
+  if (cache) {
+    printCacheStats("Cache (this batch)", cache->run(), cache->budget());
+    if (cacheStats) {
+      printCacheStats("Cache (lifetime)", cache->lifetime(), cache->budget());
+    }
+  }
+  return failed == 0 ? 0 : 1;
+}
@@ -1,17 +1,18 @@
+#include <ColumnStats.h>
 #include <DataLoader.h>
 #include <GridRenderer.h>
+#include <ProfilerOverlay.h>
 #include <SFML/Graphics.hpp>
+#include <Trace.h>
+#include <TrajectorySampler.h>
 #include <Vector2D.h>
-#include <algorithm>
 #include <cmath>
+#include <iostream>
 #include <optional>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
-inline float lerp(float a, float b, float t) {
-  t = std::clamp(t, 0.0F, 1.0F);
-  return a + (t * (b - a));
-}
-
 void updateViewOnResize(sf::RenderWindow &window, sf::View &view) {
   sf::Vector2u size = window.getSize();
   float aspectRatio = static_cast<float>(size.x) / static_cast<float>(size.y);
@@ -21,14 +22,21 @@ void updateViewOnResize(sf::RenderWindow &window, sf::View &view) {
 }
 
 int main() {
+  CP_TRACE_SESSION("DataVisualizer.trace.json");
   DataLoader loader("MiniGolf.dat");
   const std::vector<float> &timeData = loader.getColumn("Time(s)");
-  const std::vector<float> &xData = loader.getColumn("x(t)");
-  const std::vector<float> &yData = loader.getColumn("y(t)");
 
   if (timeData.empty()) {
     return 1;
   }
+  // Hermite between rows: MiniGolf.dat carries Vx(t) and Vy(t)
+  std::optional<TrajectorySampler> sampler;
+  try {
+    sampler.emplace(loader, std::vector<std::string>{"x(t)", "y(t)"});
+  } catch (const std::invalid_argument &e) {
+    std::cerr << "Error: MiniGolf.dat: " << e.what() << std::endl;
+    return 1;
+  }
 
   sf::RenderWindow window(sf::VideoMode({800U, 600U}), "Data Visualizer");
   window.setFramerateLimit(60);
@@ -42,19 +50,35 @@ int main() {
   marker.setOrigin({4.0F, 4.0F});
   marker.setFillColor(sf::Color::Red);
 
+  ProfilerOverlay overlay;
+  overlay.track("grid", gridRenderer);
+  overlay.track("trail", trail);
+
   sf::Clock clock;
-  const float simulationScale = 35.0F;
+  // Largest |x| or |y| of the course at 90% of the half view height
+  ColumnStats extent = loader.getStats("x(t)");
+  extent.merge(loader.getStats("y(t)"));
+  const float simulationScale =
+      fitScale(extent, 0.9F * std::abs(view.getSize().y) / 2.0F, 35.0F);
   const float totalTime = timeData.back() - timeData.front();
   size_t currentIndex = 0;
 
   while (window.isOpen()) {
+    CP_TRACE_SCOPE("frame");
+    overlay.beginFrame();
     // Handle events
-    while (const std::optional<sf::Event> event = window.pollEvent()) {
-      if (event->is<sf::Event::Closed>()) {
-        window.close();
-      } else if (event->is<sf::Event::Resized>()) {
-        updateViewOnResize(window, view);
-        trail.clear();
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Events);
+      while (const std::optional<sf::Event> event = window.pollEvent()) {
+        if (overlay.handleEvent(*event)) {
+          continue;
+        }
+        if (event->is<sf::Event::Closed>()) {
+          window.close();
+        } else if (event->is<sf::Event::Resized>()) {
+          updateViewOnResize(window, view);
+          trail.clear();
+        }
       }
     }
 
@@ -62,11 +86,9 @@ int main() {
     float elapsed = clock.getElapsedTime().asSeconds();
     float currentTime = timeData[0] + fmod(elapsed, totalTime);
 
-    // Find data index using binary search
-    std::__wrap_iter<const float *> it =
-        std::upper_bound(timeData.begin(), timeData.end(), currentTime);
-    size_t newIndex =
-        (it == timeData.begin()) ? 0 : std::distance(timeData.begin(), it) - 1;
+    // Find the data row (O(1) if the time grid is uniform, as undecimated
+    // MiniGolf.dat is; a search of one block of rows otherwise)
+    const size_t newIndex = sampler->locate(currentTime);
 
     if (newIndex < currentIndex) {
       trail.clear();
@@ -74,24 +96,34 @@ int main() {
     currentIndex = newIndex;
 
     // Interpolate position
-    size_t nextIndex = std::min(currentIndex + 1, timeData.size() - 1);
-    float t = (timeData[nextIndex] > timeData[currentIndex])
-                  ? (currentTime - timeData[currentIndex]) /
-                        (timeData[nextIndex] - timeData[currentIndex])
-                  : 0.0F;
-
-    float x = lerp(xData[currentIndex], xData[nextIndex], t) * simulationScale;
-    float y = lerp(yData[currentIndex], yData[nextIndex], t) * simulationScale;
+    float x = 0.0F;
+    float y = 0.0F;
+    sampler->sample({&currentTime, 1}, {&x, &y},
+                   TrajectorySampler::Interpolation::Hermite);
+    x *= simulationScale;
+    y *= simulationScale;
 
     // Update graphics
-    trail.append({{x, y}, sf::Color(225, 225, 225, 128)});
-    marker.setPosition({x, y});
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Vertices);
+      trail.append({{x, y}, sf::Color(225, 225, 225, 128)});
+      marker.setPosition({x, y});
+    }
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Grid);
+      gridRenderer.update(window.getView());
+    }
 
     // Render
-    window.clear(sf::Color{33, 33, 33, 105});
-    gridRenderer.renderGrid(window);
-    window.draw(trail);
-    window.draw(marker);
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Draw);
+      window.clear(sf::Color{33, 33, 33, 105});
+      gridRenderer.draw(window);
+      window.draw(trail);
+      window.draw(marker);
+    }
+    overlay.draw(window);
+    CP_TRACE_SCOPE("display");
     window.display();
   }
 
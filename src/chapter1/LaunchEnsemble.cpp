@@ -0,0 +1,113 @@
+//=========================================================
+// File LaunchEnsemble.cpp
+// Monte Carlo propagation of launch uncertainty: v0, theta
+// (and k for air resistance) are drawn from normal
+// distributions and every sample is flown to the end.
+// Models:
+// projectile      closed-form drag-free flight
+// projectile_air  linear drag, impact time by Newton
+// minigolf        the MiniGolf kernel on a given table
+// Samples use a counter-based generator, so the results
+// are the same for any number of threads.
+//---------------------------------------------------------
+
+#include <LaunchEnsemble.h>
+#include <Trace.h>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void print(const char *label, const Sim::Moments &m) {
+  std::cout << std::format("{:<8} mean = {:.6g} +- {:.2g}  sd = {:.6g}  "
+                           "min = {:.6g}  max = {:.6g}\n",
+                           label, m.mean(), m.error(), m.stddev(), m.min(),
+                           m.max());
+}
+
+} // namespace
+
+int main() {
+  CP_TRACE_SESSION("LaunchEnsemble.trace.json");
+  std::string model;
+  std::string buf;
+  Sim::LaunchSpread spread;
+  Sim::MiniGolfParams table;
+  Sim::EnsembleOptions options;
+
+  std::cout << "Enter model (projectile, projectile_air, minigolf): ";
+  std::cin >> model;
+  std::getline(std::cin, buf);
+  if (model != "projectile" && model != "projectile_air" &&
+      model != "minigolf") {
+    std::cerr << "Unknown model " << model << '\n';
+    exit(1);
+  }
+  if (model == "minigolf") {
+    std::cout << "Enter Lx, Ly: ";
+    std::cin >> table.Lx >> table.Ly;
+    std::getline(std::cin, buf);
+    std::cout << "Enter hole position and radius: (xc, yc), R: ";
+    std::cin >> table.xc >> table.yc >> table.R;
+    std::getline(std::cin, buf);
+    std::cout << "Enter dt: ";
+    std::cin >> table.dt;
+    std::getline(std::cin, buf);
+  }
+  std::cout << "Enter v0 and its standard deviation: ";
+  std::cin >> spread.v0.mean >> spread.v0.spread;
+  std::getline(std::cin, buf);
+  std::cout << "Enter theta (degrees) and its standard deviation: ";
+  std::cin >> spread.theta.mean >> spread.theta.spread;
+  std::getline(std::cin, buf);
+  if (model == "projectile_air") {
+    std::cout << "Enter k (1/s) and its standard deviation: ";
+    std::cin >> spread.k.mean >> spread.k.spread;
+    std::getline(std::cin, buf);
+  }
+  std::cout << "Enter samples, seed, threads (0: all cores): ";
+  std::cin >> options.samples >> options.seed >> options.threads;
+  std::getline(std::cin, buf);
+
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  Sim::LaunchStats stats;
+  try {
+    if (model == "projectile") {
+      stats = Sim::projectileEnsemble(spread, options);
+    } else if (model == "projectile_air") {
+      stats = Sim::airResistanceEnsemble(spread, options);
+    } else {
+      stats = Sim::miniGolfEnsemble(table, spread, options);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
+  const double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::cout << std::format("{} samples in {:.3f} s ({:.3g} samples/s)\n",
+                           stats.samples, seconds,
+                           static_cast<double>(stats.samples) / seconds);
+  if (model == "minigolf") {
+    std::cout << std::format("P(success) = {:.6f} +- {:.2g}\n",
+                             stats.successProbability(),
+                             stats.successError());
+    if (stats.unfinished > 0) {
+      std::cout << std::format("{} shots still rolling after {} steps\n",
+                               stats.unfinished,
+                               Sim::launch::kMaxGolfSteps);
+    }
+    print("time", stats.time);
+    return 0;
+  }
+  print("range", stats.range);
+  print("height", stats.height);
+  print("time", stats.time);
+  return 0;
+}
@@ -1,50 +1,86 @@
-#include "Physics.h"
-#include <Vector2D.h>
+#include <Lissajous.h>
+#include <PeriodicReplay.h>
+#include <SharedChannel.h>
+#include <TimeGrid.h>
+#include <Trace.h>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 
-int main() {
-  Vector2D Position;
-  Vector2D velocity;
-  double R = 1.0;
-  double t0 = 0.0;
-  double tf;
-  double dt;
-  double w1;
-  double w2;
-  double T1;
-  double T2;
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("Lissajous.trace.json");
+  Live::OutputOptions output;
+  try {
+    output = Live::OutputOptions::parse(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  Sim::LissajousParams params;
 
   std::cout << "Enter the angular frequencies (w1, w2): ";
-  std::cin >> w1 >> w2;
+  std::cin >> params.w1 >> params.w2;
   std::cout << "Enter the final time (tf) and time step (dt): ";
-  std::cin >> tf >> dt;
+  std::cin >> params.tf >> params.dt;
 
-  if (w1 <= 0.0 || w2 <= 0.0) {
-    std::cerr << "Error: Angular frequencies must be positive." << std::endl;
+  std::unique_ptr<Live::SharedChannelWriter> channel;
+  try {
+    Sim::Lissajous::validate(params);
+    channel = output.openChannel(Sim::Lissajous::columns);
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
     return 1;
   }
 
-  T1 = 2.0 * Phy::Const::PI / w1;
-  T2 = 2.0 * Phy::Const::PI / w2;
+  // When T1, T2 and dt share a common period on the time grid (w1 / w2
+  // rational and the step commensurate), one period is evaluated and
+  // replayed up to tf.
+  Sim::PeriodicReplay<Sim::Lissajous> sim(params);
 
-  std::cout << "w1 = " << w1 << ", w2 = " << w2 << "\n";
-  std::cout << "t0 = " << t0 << ", tf = " << tf << ", dt = " << dt << "\n";
-  std::cout << "T1 = " << T1 << ", T2 = " << T2 << "\n";
+  std::cout << "w1 = " << params.w1 << ", w2 = " << params.w2 << "\n";
+  std::cout << "t0 = " << params.t0 << ", tf = " << params.tf
+            << ", dt = " << params.dt << "\n";
+  std::cout << "T1 = " << sim.kernel().period1()
+            << ", T2 = " << sim.kernel().period2() << "\n";
+  if (sim.periodic()) {
+    std::cout << "Common period = " << sim.gridPeriod().steps
+              << " steps (phase drift <= " << sim.gridPeriod().drift
+              << "), replayed\n";
+  }
 
-  std::ofstream file("Lissajous.dat");
-  file.precision(10);
+  std::ofstream file;
+  if (output.writeFile) {
+    file.open("Lissajous.dat");
+    file.precision(10);
+    file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) " << "Vy(t)" << '\n';
+  }
 
-  file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) " << "Vy(t)" << '\n';
+  // Rows are only needed one at a time when they are published live;
+  // otherwise the closed-form time grid is evaluated and formatted in
+  // parallel chunks.
+  if (!channel) {
+    if (file.is_open()) {
+      Sim::writeGrid(sim, file, {.separator = " ", .precision = 10});
+    }
+    return 0;
+  }
 
-  double t = t0;
-  while (t <= tf) {
-    Position = {R * cos(w1 * t), R * sin(w2 * t)};
-    velocity = {-R * w1 * sin(w1 * t), R * w2 * cos(w2 * t)};
-    file << t << " " << Position.x << " " << Position.y << " " << velocity.x
-         << " " << velocity.y << "\n";
-    t += dt;
+  while (!sim.done()) {
+    const auto row = sim.row();
+    {
+      CP_TRACE_SCOPE("write");
+      if (file.is_open()) {
+        const auto [t, x, y, vx, vy] = row;
+        file << t << " " << x << " " << y << " " << vx << " " << vy << "\n";
+      }
+      if (channel) {
+        channel->publish(row);
+      }
+    }
+    CP_TRACE_SCOPE("step");
+    sim.step();
   }
 
   return 0;
-}
\ No newline at end of file
+}
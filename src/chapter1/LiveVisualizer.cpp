@@ -0,0 +1,264 @@
+// src/chapter1/LiveVisualizer.cpp
+//
+// Runs a simulation kernel (box2d, circle, lissajous, minigolf, pendulum) on
+// a worker thread and draws its trajectory while it is being computed.
+// Samples travel through a wait-free SPSC ring; when the renderer falls
+// behind, both the worker and the frame loop decimate instead of stalling
+// the physics. Circle and Lissajous figures are replayed from one cached
+// period when the time grid has one, and their trail stops growing once
+// that period is drawn.
+//
+// Usage: LiveVisualizer [box2d|circle|lissajous|minigolf|pendulum]
+//                       [realTimeFactor]
+
+#include <Box2D.h>
+#include <Circle.h>
+#include <GridRenderer.h>
+#include <LineRenderer.h>
+#include <Lissajous.h>
+#include <MiniGolf.h>
+#include <Pendulum.h>
+#include <PeriodicReplay.h>
+#include <SFML/Graphics.hpp>
+#include <SimulationWorker.h>
+#include <Trace.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+void updateViewOnResize(sf::RenderWindow &window, sf::View &view) {
+  sf::Vector2u size = window.getSize();
+  float aspectRatio = static_cast<float>(size.x) / static_cast<float>(size.y);
+  view.setSize({600.0F * aspectRatio, -600.0F});
+  view.setCenter({0.0F, 0.0F});
+  window.setView(view);
+}
+
+// Sample-to-screen latency, measured after window.display() for the newest
+// sample drawn in that frame.
+struct LatencyStats {
+  double lastMs = 0.0;
+  double sumMs = 0.0;
+  double maxMs = 0.0;
+  std::size_t frames = 0;
+
+  void record(double ms) {
+    lastMs = ms;
+    sumMs += ms;
+    maxMs = std::max(maxMs, ms);
+    ++frames;
+  }
+
+  double meanMs() const {
+    return frames > 0 ? sumMs / static_cast<double>(frames) : 0.0;
+  }
+};
+
+// Samples after step trailSteps only move the marker: for a periodic
+// kernel the trail already holds the whole curve.
+template <typename Kernel>
+int runLive(Kernel kernel, float scale, double realTimeFactor,
+            std::uint64_t trailSteps =
+                std::numeric_limits<std::uint64_t>::max()) {
+  using Worker = Live::SimulationWorker<Kernel>;
+  Worker worker(std::move(kernel), 1U << 14, realTimeFactor);
+
+  sf::RenderWindow window(sf::VideoMode({800U, 600U}), "Live Visualizer");
+  window.setFramerateLimit(60);
+
+  sf::View view;
+  updateViewOnResize(window, view);
+
+  GridRenderer gridRenderer;
+  LineRenderer trail;
+  trail.setThickness(2.0F);
+  sf::CircleShape marker(4.0F);
+  marker.setOrigin({4.0F, 4.0F});
+  marker.setFillColor(sf::Color::Red);
+
+  // Upper bound on segments appended per frame; a larger backlog is thinned
+  // out so a frame never costs more than this.
+  const std::size_t frameBudget = 4096;
+
+  LatencyStats total;
+  LatencyStats window1s;
+  std::size_t drawnSamples = 0;
+  auto lastReport = Live::Clock::now();
+  bool finishedReported = false;
+
+  worker.start();
+
+  while (window.isOpen()) {
+    CP_TRACE_SCOPE("frame");
+    {
+      CP_TRACE_SCOPE("events");
+      while (const std::optional<sf::Event> event = window.pollEvent()) {
+        if (event->is<sf::Event::Closed>()) {
+          window.close();
+        } else if (event->is<sf::Event::Resized>()) {
+          updateViewOnResize(window, view);
+        }
+      }
+    }
+
+    const std::size_t backlog = worker.ring().size();
+    const std::size_t keepEvery =
+        backlog > frameBudget ? (backlog + frameBudget - 1) / frameBudget : 1;
+    std::optional<Live::Clock::time_point> newest;
+    std::size_t index = 0;
+
+    {
+      CP_TRACE_SCOPE("consume");
+      worker.ring().drain(backlog, [&](const typename Worker::SampleType &s) {
+        if (index % keepEvery == 0 || index + 1 == backlog) {
+          const auto x = static_cast<float>(s.row[1]);
+          const auto y = static_cast<float>(s.row[2]);
+          if (s.step <= trailSteps) {
+            trail.appendPoint(x, y, scale, scale);
+          }
+          marker.setPosition({x * scale, y * scale});
+          ++drawnSamples;
+        }
+        newest = s.published;
+        ++index;
+      });
+    }
+
+    {
+      CP_TRACE_SCOPE("draw");
+      window.clear(sf::Color{33, 33, 33, 105});
+      gridRenderer.renderGrid(window);
+      trail.draw(window);
+      window.draw(marker);
+    }
+    {
+      CP_TRACE_SCOPE("display");
+      window.display();
+    }
+
+    const auto now = Live::Clock::now();
+    if (newest) {
+      const double ms =
+          std::chrono::duration<double, std::milli>(now - *newest).count();
+      total.record(ms);
+      window1s.record(ms);
+    }
+
+    if (now - lastReport >= std::chrono::seconds(1) && window1s.frames > 0) {
+      std::cout << "latency(ms) last= " << window1s.lastMs
+                << " mean= " << window1s.meanMs()
+                << " max= " << window1s.maxMs << " | drawn= " << drawnSamples
+                << " published= " << worker.published()
+                << " dropped= " << worker.dropped()
+                << " stride= " << worker.stride() << '\n';
+      window1s = LatencyStats{};
+      lastReport = now;
+    }
+
+    if (worker.finished() && worker.ring().size() == 0 && !finishedReported) {
+      std::cout << "Simulation finished\n";
+      finishedReported = true;
+    }
+  }
+
+  worker.stop();
+  std::cout << "Frames with new samples= " << total.frames
+            << " mean latency(ms)= " << total.meanMs()
+            << " max latency(ms)= " << total.maxMs << '\n';
+  return 0;
+}
+
+template <typename Kernel>
+int runReplay(Sim::PeriodicReplay<Kernel> replay, float scale,
+              double realTimeFactor) {
+  if (!replay.periodic()) {
+    return runLive(std::move(replay), scale, realTimeFactor);
+  }
+  const std::uint64_t period = replay.gridPeriod().steps;
+  std::cout << "Common period = " << period << " steps, replayed\n";
+  return runLive(std::move(replay), scale, realTimeFactor, period);
+}
+
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("LiveVisualizer.trace.json");
+  const std::string simulation = argc > 1 ? argv[1] : "box2d";
+  const double realTimeFactor = argc > 2 ? std::atof(argv[2]) : 1.0;
+  std::string buf;
+
+  try {
+    if (simulation == Sim::Box2D::name) {
+      Sim::Box2DParams p;
+      std::cout << "Enter Lx, Ly: ";
+      std::cin >> p.Lx >> p.Ly;
+      std::cout << "Enter x0, y0, vx, vy: ";
+      std::cin >> p.x0 >> p.y0 >> p.vx0 >> p.vy0;
+      std::cout << "Enter t0, tf, dt: ";
+      std::cin >> p.t0 >> p.tf >> p.dt;
+      std::getline(std::cin, buf);
+      return runLive(Sim::Box2D(p), 35.0F, realTimeFactor);
+    }
+    if (simulation == Sim::Circle::name) {
+      Sim::CircleParams p;
+      std::cout << "Enter omega: ";
+      std::cin >> p.omega;
+      std::cout << "Enter x0, y0, R: ";
+      std::cin >> p.x0 >> p.y0 >> p.R;
+      std::cout << "Enter t0, tf, dt: ";
+      std::cin >> p.t0 >> p.tf >> p.dt;
+      std::getline(std::cin, buf);
+      return runReplay(Sim::PeriodicReplay<Sim::Circle>(p), 100.0F,
+                       realTimeFactor);
+    }
+    if (simulation == Sim::Lissajous::name) {
+      Sim::LissajousParams p;
+      std::cout << "Enter w1, w2: ";
+      std::cin >> p.w1 >> p.w2;
+      std::cout << "Enter R: ";
+      std::cin >> p.R;
+      std::cout << "Enter t0, tf, dt: ";
+      std::cin >> p.t0 >> p.tf >> p.dt;
+      std::getline(std::cin, buf);
+      return runReplay(Sim::PeriodicReplay<Sim::Lissajous>(p), 100.0F,
+                       realTimeFactor);
+    }
+    if (simulation == Sim::MiniGolf::name) {
+      Sim::MiniGolfParams p;
+      std::cout << "Enter Lx, Ly: ";
+      std::cin >> p.Lx >> p.Ly;
+      std::cout << "Enter hole position and radius: (xc, yc), R: ";
+      std::cin >> p.xc >> p.yc >> p.R;
+      std::cout << "Enter v0, theta(degrees): ";
+      std::cin >> p.v0 >> p.theta;
+      std::cout << "Enter dt: ";
+      std::cin >> p.dt;
+      std::getline(std::cin, buf);
+      return runLive(Sim::MiniGolf(p), 35.0F, realTimeFactor);
+    }
+    if (simulation == Sim::Pendulum::name) {
+      Sim::PendulumParams p;
+      std::cout << "Enter l: ";
+      std::cin >> p.l;
+      std::cout << "Enter theta0: ";
+      std::cin >> p.theta0;
+      std::cout << "Enter t0, tf, dt: ";
+      std::cin >> p.t0 >> p.tf >> p.dt;
+      std::getline(std::cin, buf);
+      return runLive(Sim::Pendulum(p), 100.0F, realTimeFactor);
+    }
+  } catch (const std::invalid_argument &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+
+  std::cerr << "Unknown simulation '" << simulation
+            << "' (expected box2d, circle, lissajous, minigolf or "
+               "pendulum)\n";
+  return 1;
+}
@@ -9,134 +9,163 @@
 // Ball stops in hole (success) or at x=0 (failure)
 //---------------------------------------------------------------
 
-#include <Physics.h>
-#include <cmath>
+#include <Checkpoint.h>
+#include <ColumnCodec.h>
+#include <Decimation.h>
+#include <MiniGolf.h>
+#include <SharedChannel.h>
+#include <Trace.h>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
 
-int main() {
-  double Lx;
-  double Ly;
-  double x0;
-  double y0;
-  double v0x;
-  double v0y;
-  double t0;
-  double tf;
-  double dt;
-  double t;
-  double x;
-  double y;
-  double vx;
-  double vy;
-  double v0;
-  double theta;
-  double xc;
-  double yc;
-  double R;
-  double R2;
-  int i;
-  int nx;
-  int ny;
-  std::string result;
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("MiniGolf.trace.json");
+  Live::OutputOptions output;
+  Sim::CheckpointOptions checkpoint;
+  Sim::DecimationOptions decimation;
+  try {
+    output = Live::OutputOptions::parse(argc, argv, true);
+    checkpoint = Sim::CheckpointOptions::parse(argc, argv);
+    decimation = Sim::DecimationOptions::parse(argc, argv);
+    if (output.compress && checkpoint.enabled()) {
+      throw std::invalid_argument("--compress cannot be combined with "
+                                  "--checkpoint");
+    }
+    if ((decimation.enabled() || decimation.events) &&
+        checkpoint.enabled()) {
+      throw std::invalid_argument("--every, --interval, --tolerance and "
+                                  "--events cannot be combined with "
+                                  "--checkpoint");
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    std::exit(1);
+  }
+  Sim::MiniGolfParams params;
   std::string buf;
+  std::optional<Sim::MiniGolf> restored;
+  std::uint64_t offset = 0;
 
-  std::cout << "Enter Lx, Ly: ";
-  std::cin >> Lx >> Ly;
-  std::getline(std::cin, buf);
-  std::cout << "Lx = " << Lx << " Ly = " << Ly << std::endl;
-
-  std::cout << "Enter hole position and radius: (xc, yc), R: ";
-  std::cin >> xc >> yc >> R;
-  std::getline(std::cin, buf);
-  std::cout << " (xc, yc) = ( " << xc << ", " << yc << " ) "
-            << " R= " << R << std::endl;
-
-  std::cout << "Enter v0, theta(degrees): ";
-  std::cin >> v0 >> theta;
-  std::getline(std::cin, buf);
-  std::cout << "v0= " << v0 << " theta= " << theta << " degrees " << std::endl;
-
-  std::cout << "Enter dt: ";
-  std::cin >> dt;
-  std::getline(std::cin, buf);
+  if (checkpoint.restart) {
+    try {
+      restored = Sim::loadCheckpoint<Sim::MiniGolf>(checkpoint.path, offset);
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << '\n';
+      std::exit(1);
+    }
+    params = restored->params();
+    std::cout << "Restarting from " << checkpoint.path.string() << " at step "
+              << restored->stepIndex() << std::endl;
+  } else {
+    std::cout << "Enter Lx, Ly: ";
+    std::cin >> params.Lx >> params.Ly;
+    std::getline(std::cin, buf);
+  }
+  std::cout << "Lx = " << params.Lx << " Ly = " << params.Ly << std::endl;
 
-  if (Lx <= 0.0) {
-    std::cerr << "Lx <= 0\n";
-    std::exit(1);
+  if (!checkpoint.restart) {
+    std::cout << "Enter hole position and radius: (xc, yc), R: ";
+    std::cin >> params.xc >> params.yc >> params.R;
+    std::getline(std::cin, buf);
   }
-  if (Ly <= 0.0) {
-    std::cerr << "Ly <= 0\n";
-    std::exit(1);
+  std::cout << " (xc, yc) = ( " << params.xc << ", " << params.yc << " ) "
+            << " R= " << params.R << std::endl;
+
+  if (!checkpoint.restart) {
+    std::cout << "Enter v0, theta(degrees): ";
+    std::cin >> params.v0 >> params.theta;
+    std::getline(std::cin, buf);
   }
-  if (v0 <= 0.0) {
-    std::cerr << "v0 <= 0\n";
-    std::exit(1);
+  std::cout << "v0= " << params.v0 << " theta= " << params.theta
+            << " degrees " << std::endl;
+
+  if (!checkpoint.restart) {
+    std::cout << "Enter dt: ";
+    std::cin >> params.dt;
+    std::getline(std::cin, buf);
   }
-  if (std::abs(theta) > 90.0) {
-    std::cerr << "theta > 90\n";
+
+  std::unique_ptr<Live::SharedChannelWriter> channel;
+  try {
+    Sim::MiniGolf::validate(params);
+    channel = output.openChannel(Sim::MiniGolf::columns);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
     std::exit(1);
   }
 
-  t0 = 0.0;
-  x0 = 0.00001;
-  y0 = Ly / 2.0;
-  R2 = R * R;
-  theta = Phy::utils::deg2rad(theta);
-  v0x = v0 * std::cos(theta);
-  v0y = v0 * std::sin(theta);
-
-  std::cout << "x0= " << x0 << " y0= " << y0 << " v0x= " << v0x
-            << " v0y= " << v0y << std::endl;
-
-  i = 0;
-  nx = 0;
-  ny = 0;
-  t = t0;
-  x = x0;
-  y = y0;
-  vx = v0x;
-  vy = v0y;
-
-  std::ofstream file("MiniGolf.dat");
-  file.precision(17);
-  file << "Time(s), " << "x(t), " << "y(t), " << "Vx(t), "
-       << "Vy(t)\n";
-
-  while (true) {
-    file << t << ", " << x << ", " << y << ", " << vx << ", " << vy << "\n";
-
-    i++;
-    t = t0 + i * dt;
-    x += vx * dt;
-    y += vy * dt;
+  Sim::MiniGolf sim = restored ? *restored : Sim::MiniGolf(params);
+  if (!checkpoint.restart) {
+    const auto [t0, x0, y0, v0x, v0y] = sim.row();
+    std::cout << "x0= " << x0 << " y0= " << y0 << " v0x= " << v0x
+              << " v0y= " << v0y << std::endl;
+  }
 
-    if (x > Lx) {
-      vx = -vx;
-      nx++;
-    }
-    if (y < 0.0) {
-      vy = -vy;
-      ny++;
+  std::ofstream file;
+  std::unique_ptr<Codec::Writer> packed;
+  if (output.writeFile && checkpoint.restart) {
+    try {
+      Sim::reopenOutput(file, "MiniGolf.dat", offset);
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << '\n';
+      std::exit(1);
     }
-    if (y > Ly) {
-      vy = -vy;
-      ny++;
+    file.precision(17);
+  } else if (output.writeFile && output.compress) {
+    file.open("MiniGolf.dat", std::ios::binary);
+    packed = std::make_unique<Codec::Writer>(file, Sim::MiniGolf::columns);
+  } else if (output.writeFile) {
+    file.open("MiniGolf.dat");
+    file.precision(17);
+    file << "Time(s), " << "x(t), " << "y(t), " << "Vx(t), "
+         << "Vy(t)\n";
+  }
+
+  // Rows are written as the decimation policy keeps them.
+  const auto write = [&](const Sim::MiniGolf::Row &row) {
+    CP_TRACE_SCOPE("write");
+    if (packed) {
+      packed->append(row);
+    } else if (file.is_open()) {
+      const auto [t, x, y, vx, vy] = row;
+      file << t << ", " << x << ", " << y << ", " << vx << ", " << vy << "\n";
     }
-    if (x <= 0.0) {
-      result = "Failure";
-      break;
+    if (channel) {
+      channel->publish(row);
     }
-    if (((x - xc) * (x - xc) + (y - yc) * (y - yc)) <= R2) {
-      result = "Success";
-      break;
+  };
+  Sim::Decimator<Sim::MiniGolf::columns.size()> decimator(decimation);
+
+  Sim::Checkpointer checkpointer(checkpoint);
+  int events = sim.events();
+  while (!sim.done()) {
+    if (checkpointer.poll(sim, file)) {
+      std::cout << "Stopped at step " << sim.stepIndex() << ", checkpoint in "
+                << checkpoint.path.string() << std::endl;
+      return Sim::Checkpointer::kStoppedStatus;
     }
+    decimator.push(sim.row(), sim.events() != events, write);
+    events = sim.events();
+    CP_TRACE_SCOPE("step");
+    sim.step();
+  }
+  // The row where the ball drops or leaves the table, located exactly.
+  if (const auto last = sim.terminalRow()) {
+    decimator.push(*last, true, write);
   }
+  decimator.finish(write);
 
+  packed.reset();
   file.close();
+  checkpointer.finish(checkpoint.path);
   std::cout << "Number of collisions:\n";
-  std::cout << "Result= " << result << " nx= " << nx << " ny= " << ny
+  std::cout << "Result= " << Sim::MiniGolf::toString(sim.result())
+            << " nx= " << sim.xBounces() << " ny= " << sim.yBounces()
             << std::endl;
-}
\ No newline at end of file
+}
@@ -1,86 +1,102 @@
 //========================================================
 // File ProjectileAirResistance.cpp
 // Shooting a projectile near the earth surface.
-// No air resistance.
+// Linear air resistance F = -k m v.
 // Starts at (0,0), set k, (vO, theta) .
 //--------------------------------------------------------
 
-#include <Physics.h>
-#include <Vector2D.h>
-#include <cmath>
+#include <Projectile.h>
+#include <SharedChannel.h>
+#include <TimeGrid.h>
+#include <Trace.h>
+#include <array>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
-int main() {
-  double x0;
-  double y0;
-  double R;
-  double x;
-  double y;
-  double vx;
-  double vy;
-  double t;
-  double tf;
-  double dt;
-  double k;
-  double theta;
-  double v0;
-  double v0x;
-  double v0y;
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("ProjectileAirResistance.trace.json");
+  Live::OutputOptions output;
+  try {
+    output = Live::OutputOptions::parse(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
+  Sim::ProjectileParams params;
   std::string buf;
 
   std::cout << "Enter k,v0,theta (in degrees): ";
-  std::cin >> k >> v0 >> theta;
+  std::cin >> params.k >> params.v0 >> params.theta;
   std::getline(std::cin, buf);
   std::cout << "Enter tf,dt: ";
-  std::cin >> tf >> dt;
+  std::cin >> params.tf >> params.dt;
   std::getline(std::cin, buf);
-  std::cout << "k = " << k << std::endl;
-  std::cout << "v0= " << v0 << " theta= " << theta << "o (degrees)"
+  std::cout << "k = " << params.k << std::endl;
+  std::cout << "v0= " << params.v0 << " theta= " << params.theta
+            << "o (degrees)" << std::endl;
+  std::cout << "t0= " << 0.0 << " tf= " << params.tf << " dt= " << params.dt
             << std::endl;
-  std::cout << "t0= " << 0.0 << " tf= " << tf << " dt= " << dt << std::endl;
 
-  if (v0 <= 0.0) {
-    std::cerr << "Illegal value of v0 <= 0\n";
-    std::exit(1);
-  }
-  if (k <= 0.0) {
-    std::cerr << "Illegal value of k <= 0\n";
-    std::exit(1);
-  }
-  if (theta <= 0.0) {
-    std::cerr << "Illegal value of theta <= 0\n";
-    std::exit(1);
-  }
-  if (theta >= 90.0) {
-    std::cerr << "Illegal value of theta >= 90\n";
+  std::unique_ptr<Live::SharedChannelWriter> channel;
+  try {
+    Sim::ProjectileAirResistance::validate(params);
+    channel = output.openChannel(Sim::ProjectileAirResistance::columns);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
     std::exit(1);
   }
 
-  theta = Phy::utils::deg2rad(theta);
-  v0x = v0 * std::cos(theta);
-  v0y = v0 * std::sin(theta);
+  // The kernel stops at the ground impact (its ground event, located on the
+  // closed form) and ends with the impact row.
+  Sim::ProjectileAirResistance sim(params);
 
-  std::cout << "v0x= " << v0x << " v0y= " << v0y << std::endl;
+  std::cout << "v0x= " << sim.v0x() << " v0y= " << sim.v0y() << std::endl;
+  if (const auto impact = sim.terminalRow()) {
+    std::cout << "Impact at t= " << (*impact)[0] << " range= " << (*impact)[1]
+              << std::endl;
+  }
 
-  std::ofstream file("ProjectileAirResistance.dat");
-  file.precision(17);
+  std::ofstream file;
+  if (output.writeFile) {
+    file.open("ProjectileAirResistance.dat");
+    file.precision(17);
+    file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) "
+         << "Vy(t) " << std::endl;
+  }
 
-  file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) "
-       << "Vy(t) " << std::endl;
+  // Rows are only needed one at a time when they are published live;
+  // otherwise the closed-form time grid is evaluated and formatted in
+  // parallel chunks.
+  if (!channel) {
+    if (file.is_open()) {
+      Sim::writeGrid(sim, file, {.separator = " ", .precision = 17});
+    }
+    return 0;
+  }
 
-  t = 0.0;
-  while (t <= tf) {
-    x = (v0x / k) * (1.0 - std::exp(-k * t));
-    y = (1.0 / k) * (v0y + (Phy::Const::g / k)) * (1.0 - std::exp(-k * t)) -
-        (Phy::Const::g / k) * t;
-    vx = v0x * std::exp(-k * t);
-    vy = (v0y + (Phy::Const::g / k)) * std::exp(-k * t) - Phy::Const::g * t;
-    file << t << " " << x << " " << y << " " << vx << " " << vy << std::endl;
-    t += dt;
+  const auto write = [&](const Sim::ProjectileAirResistance::Row &row) {
+    CP_TRACE_SCOPE("write");
+    if (file.is_open()) {
+      const auto [t, x, y, vx, vy] = row;
+      file << t << " " << x << " " << y << " " << vx << " " << vy
+           << std::endl;
+    }
+    channel->publish(row);
+  };
+  while (!sim.done()) {
+    write(sim.row());
+    CP_TRACE_SCOPE("step");
+    sim.step();
+  }
+  if (const auto impact = sim.terminalRow()) {
+    write(*impact);
   }
 
   file.close();
 
   return 0;
-}
\ No newline at end of file
+}
@@ -1,52 +1,86 @@
-#include <Physics.h>
-#include <Vector2D.h>
-#include <cmath>
+#include <Pendulum.h>
+#include <SharedChannel.h>
+#include <TimeGrid.h>
+#include <Trace.h>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 
-int main() {
-  double l;
-  double theta0;
-  double t0;
-  double tf;
-  double dt;
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("SimplePendulum.trace.json");
+  Live::OutputOptions output;
+  try {
+    output = Live::OutputOptions::parse(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
+  Sim::PendulumParams params;
 
   // Ask user for input
   std::cout << "Enter l: ";
-  std::cin >> l;
+  std::cin >> params.l;
   std::cout << "Enter theta0: ";
-  std::cin >> theta0;
+  std::cin >> params.theta0;
 
   std::cout << "Enter t0, tf, dt: ";
-  std::cin >> t0 >> tf >> dt;
+  std::cin >> params.t0 >> params.tf >> params.dt;
+
+  std::cout << "l= " << params.l << " theta0= " << params.theta0 << '\n';
+  std::cout << "t0 = " << params.t0 << " tf = " << params.tf
+            << " dt = " << params.dt << '\n';
 
-  std::cout << "l= " << l << " theta0= " << theta0 << '\n';
-  std::cout << "t0 = " << t0 << " tf = " << tf << " dt = " << dt << '\n';
+  std::unique_ptr<Live::SharedChannelWriter> channel;
+  try {
+    Sim::Pendulum::validate(params);
+    channel = output.openChannel(Sim::Pendulum::columns);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    std::exit(1);
+  }
 
   // Initialize
-  double omega = std::sqrt(Phy::Const::G / l);
-  std::cout << "omega = " << omega << " T = " << (2.0 * Phy::Const::PI / omega)
-            << '\n';
+  Sim::Pendulum sim(params);
+  std::cout << "omega = " << sim.omega() << " T = " << sim.period() << '\n';
 
   // Open file to save data
-  std::ofstream file("SimplePendulum.dat");
+  std::ofstream file;
+  if (output.writeFile) {
+    file.open("SimplePendulum.dat");
+    file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) " << "Vy(t) "
+         << "theta(t) " << "dtheta(t)" << '\n';
+  }
 
-  file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) " << "Vy(t)" << "theta(𝚯)"
-       << "dθ" << '\n';
+  // Rows are only needed one at a time when they are published live;
+  // otherwise the closed-form time grid is evaluated and formatted in
+  // parallel chunks.
+  if (!channel) {
+    if (file.is_open()) {
+      Sim::writeGrid(sim, file, {.separator = " "});
+    }
+    return 0;
+  }
 
   // Compute
-  for (double t = t0; t <= tf; t += dt) {
-    double theta = theta0 * std::cos(omega * (t - t0));
-    double dthetaDt = -omega * theta0 * std::sin(omega * (t - t0));
-    double x = l * std::sin(theta);
-    double y = -l * std::cos(theta);
-    double vx = l * dthetaDt * std::cos(theta);
-    double vy = l * dthetaDt * std::sin(theta);
-
-    file << t << " " << x << " " << y << " " << vx << " " << vy << " " << theta
-         << " " << dthetaDt << '\n';
+  while (!sim.done()) {
+    const auto row = sim.row();
+    {
+      CP_TRACE_SCOPE("write");
+      if (file.is_open()) {
+        const auto [t, x, y, vx, vy, theta, dthetaDt] = row;
+        file << t << " " << x << " " << y << " " << vx << " " << vy << " "
+             << theta << " " << dthetaDt << '\n';
+      }
+      if (channel) {
+        channel->publish(row);
+      }
+    }
+    CP_TRACE_SCOPE("step");
+    sim.step();
   }
 
   file.close();
   return 0;
-}
\ No newline at end of file
+}
@@ -4,67 +4,74 @@
 // Use integration with time step dt : x = x + v * dt
 //--------------------------------------------------------
 
+#include <Box1D.h>
+#include <SharedChannel.h>
+#include <Trace.h>
 #include <cstdlib>
 #include <format>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
 
-int main() {
-  float L;
-  float x0;
-  float v0;
-  float t0;
-  float tf;
-  float dt;
-  float t;
-  float x;
-  float v;
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("Box1D.trace.json");
+  Live::OutputOptions output;
+  try {
+    output = Live::OutputOptions::parse(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
+  Sim::Box1DParams params;
   std::string buf;
   std::cout << "Enter L: ";
-  std::cin >> L;
+  std::cin >> params.L;
   std::getline(std::cin, buf);
   std::cout << "Enter x0, v0: ";
-  std::cin >> x0 >> v0;
+  std::cin >> params.x0 >> params.v0;
   std::cout << "Enter t0, tf, dt: ";
-  std::cin >> t0 >> tf >> dt;
+  std::cin >> params.t0 >> params.tf >> params.dt;
   std::getline(std::cin, buf);
-  std::cout << std::format("t0 = {}\ntf = {}\ndt = {}\n", t0, tf, dt);
-  if (L <= 0.0F) {
-    std::cerr << "L <= 0\n";
-    exit(1);
-  }
-  if (x0 < 0.0F) {
-    std::cerr << "x0 < 0\n";
-    exit(1);
-  }
-  if (x0 > L) {
-    std::cerr << "x0 > L\n";
-    exit(1);
-  }
-  if (v0 == 0.0F) {
-    std::cerr << "v0 = 0\n";
+  std::cout << std::format("t0 = {}\ntf = {}\ndt = {}\n", params.t0,
+                           params.tf, params.dt);
+
+  std::unique_ptr<Live::SharedChannelWriter> channel;
+  try {
+    Sim::Box1D::validate(params);
+    channel = output.openChannel(Sim::Box1D::columns);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
     exit(1);
   }
 
-  t = t0;
-  std::ofstream file("box1D.dat");
-  file.precision(9);
-  file << std::setw(17) << "Time(s)" << " " << std::setw(17) << "x(t)" << " "
-       << std::setw(17) << "v(t)" << '\n';
+  Sim::Box1D sim(params);
+  std::ofstream file;
+  if (output.writeFile) {
+    file.open("box1D.dat");
+    file.precision(9);
+    file << std::setw(17) << "Time(s)" << " " << std::setw(17) << "x(t)"
+         << " " << std::setw(17) << "v(t)" << '\n';
+  }
 
-  while (t < tf) {
-    x = x0 + v0 * (t - t0);
-    file << std::setw(17) << t << " " << std::setw(17) << x << " "
-         << std::setw(17) << v << '\n';
-    if (x < 0.0F || x > L) {
-      x0 = x;
-      t0 = t0;
-      v0 = -v0;
+  while (!sim.done()) {
+    const auto row = sim.row();
+    {
+      CP_TRACE_SCOPE("write");
+      if (file.is_open()) {
+        const auto [t, x, v] = row;
+        file << std::setw(17) << t << " " << std::setw(17) << x << " "
+             << std::setw(17) << v << '\n';
+      }
+      if (channel) {
+        channel->publish(row);
+      }
     }
-    t += dt;
+    CP_TRACE_SCOPE("step");
+    sim.step();
   }
   file.close();
   return 0;
-}
\ No newline at end of file
+}
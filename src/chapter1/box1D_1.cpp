@@ -4,14 +4,24 @@
 // Use integration with time step dt : x = x + v * dt
 //--------------------------------------------------------
 
+#include <Scalar.h>
+#include <SharedChannel.h>
 #include <cstdlib>
 #include <format>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
 
-int main() {
+int main(int argc, char *argv[]) {
+  Live::OutputOptions output;
+  try {
+    output = Live::OutputOptions::parse(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
   float L;
   float x0;
   float v0;
@@ -19,9 +29,7 @@ int main() {
     float t0;
     float tf;
     float dt;
-    float t;
   };
-  float x;
   float v;
   std::string buf;
   Time time;
@@ -52,19 +60,36 @@ int main() {
     exit(1);
   }
 
-  time.t = time.t0;
-  x = x0;
+  std::unique_ptr<Live::SharedChannelWriter> channel;
+  try {
+    channel = output.openChannel({"Time(s)", "x(t)", "v(t)"});
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
+
+  // Plain `+=` unless the build enables CP_SIM_COMPENSATED.
+  Sim::Accumulator<float, Sim::kDefaultSummation> t(time.t0);
+  Sim::Accumulator<float, Sim::kDefaultSummation> x(x0);
   v = v0;
-  std::ofstream file("box1D_1.dat");
-  file.precision(9);
-  file << std::setw(17) << "Time(s)" << " " << std::setw(17) << "x(t)" << " "
-       << std::setw(17) << "v(t)" << '\n';
-  while (time.t < time.tf) {
-    file << std::setw(17) << time.t << " " << std::setw(17) << x << " "
-         << std::setw(17) << v << '\n';
+  std::ofstream file;
+  if (output.writeFile) {
+    file.open("box1D_1.dat");
+    file.precision(9);
+    file << std::setw(17) << "Time(s)" << " " << std::setw(17) << "x(t)"
+         << " " << std::setw(17) << "v(t)" << '\n';
+  }
+  while (t.value() < time.tf) {
+    if (file.is_open()) {
+      file << std::setw(17) << t.value() << " " << std::setw(17) << x.value()
+           << " " << std::setw(17) << v << '\n';
+    }
+    if (channel) {
+      channel->publish({t.value(), x.value(), v});
+    }
     x += v * time.dt;
-    time.t += time.dt;
-    if (x < 0.0F || x > L) {
+    t += time.dt;
+    if (x.value() < 0.0F || x.value() > L) {
       v = -v;
     }
   }
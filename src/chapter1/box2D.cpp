@@ -6,90 +6,137 @@
 // y = y + vy * dt
 //---------------------------------------------------------
 
+#include <Box2D.h>
+#include <Checkpoint.h>
+#include <ColumnCodec.h>
+#include <Decimation.h>
+#include <SharedChannel.h>
+#include <Trace.h>
+#include <cstdint>
 #include <cstdlib>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
 
-int main() {
-  float Lx;
-  float Ly;
-  float x0;
-  float y0;
-  float v0x;
-  float v0y;
-  float t0;
-  float tf;
-  float dt;
-  float t;
-  float x;
-  float y;
-  float vx;
-  float vy;
-  int i;
-  int nx;
-  int ny;
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("Box2D.trace.json");
+  Live::OutputOptions output;
+  Sim::CheckpointOptions checkpoint;
+  Sim::DecimationOptions decimation;
+  try {
+    output = Live::OutputOptions::parse(argc, argv, true);
+    checkpoint = Sim::CheckpointOptions::parse(argc, argv);
+    decimation = Sim::DecimationOptions::parse(argc, argv);
+    if (output.compress && checkpoint.enabled()) {
+      throw std::invalid_argument("--compress cannot be combined with "
+                                  "--checkpoint");
+    }
+    if ((decimation.enabled() || decimation.events) &&
+        checkpoint.enabled()) {
+      throw std::invalid_argument("--every, --interval, --tolerance and "
+                                  "--events cannot be combined with "
+                                  "--checkpoint");
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
+  Sim::Box2DParams params;
   std::string buf;
+  std::optional<Sim::Box2D> restored;
+  std::uint64_t offset = 0;
 
   std::cout << "Motion of a free particle in a box 0 < x < Lx 0 < y < Ly\n";
-  std::cout << "Enter Lx, Ly: ";
-  std::cin >> Lx >> Ly;
-  std::getline(std::cin, buf);
-  std::cout << "Enter x0, y0, vx, vy: ";
-  std::cin >> x0 >> y0 >> vx >> vy;
-  std::cout << "Enter t0, tf, dt: ";
-  std::cin >> t0 >> tf >> dt;
-  std::getline(std::cin, buf);
-  std::cout << std::format("t0 = {}\ntf = {}\ndt = {}\n", t0, tf, dt);
-
-  if (Lx <= 0.0 || Ly <= 0.0) {
-    std::cerr << "Lx and Ly should be +ve\n";
-    exit(1);
-  }
-  if (x0 < 0.0 || x0 > Lx) {
-    std::cerr << "The range of x will be: 0 < x0 < Lx\n";
-    exit(1);
-  }
-  std::cerr << "\n";
-  if (y0 < 0.0 || y0 > Ly) {
-    std::cerr << "The range of y will be: 0 < y0 < Ly\n";
-    exit(1);
+  if (checkpoint.restart) {
+    try {
+      restored = Sim::loadCheckpoint<Sim::Box2D>(checkpoint.path, offset);
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << '\n';
+      exit(1);
+    }
+    params = restored->params();
+    std::cout << "Restarting from " << checkpoint.path.string() << " at step "
+              << restored->stepIndex() << '\n';
+  } else {
+    std::cout << "Enter Lx, Ly: ";
+    std::cin >> params.Lx >> params.Ly;
+    std::getline(std::cin, buf);
+    std::cout << "Enter x0, y0, vx, vy: ";
+    std::cin >> params.x0 >> params.y0 >> params.vx0 >> params.vy0;
+    std::cout << "Enter t0, tf, dt: ";
+    std::cin >> params.t0 >> params.tf >> params.dt;
+    std::getline(std::cin, buf);
   }
-  if (v0x * v0x + v0y * v0y == 0.0) {
-    std::cerr << "v0 = 0\n";
+  std::cout << std::format("t0 = {}\ntf = {}\ndt = {}\n", params.t0,
+                           params.tf, params.dt);
+
+  std::unique_ptr<Live::SharedChannelWriter> channel;
+  try {
+    Sim::Box2D::validate(params);
+    channel = output.openChannel(Sim::Box2D::columns);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
     exit(1);
   }
 
-  i = 0;
-  nx = 0;
-  ny = 0;
-  t = t0;
-  x = x0;
-  y = y0;
-  vx = v0x;
-  vy = v0y;
-  std::ofstream file("box2D.dat");
-  file.precision(17);
-  file << "Time(s), " << "x(t), " << "y(t), " << "vx(t), " << "vy(t)" << '\n';
+  Sim::Box2D sim = restored ? *restored : Sim::Box2D(params);
+  std::ofstream file;
+  std::unique_ptr<Codec::Writer> packed;
+  if (output.writeFile && checkpoint.restart) {
+    try {
+      Sim::reopenOutput(file, "box2D.dat", offset);
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << '\n';
+      exit(1);
+    }
+    file.precision(17);
+  } else if (output.writeFile && output.compress) {
+    file.open("box2D.dat", std::ios::binary);
+    packed = std::make_unique<Codec::Writer>(file, Sim::Box2D::columns);
+  } else if (output.writeFile) {
+    file.open("box2D.dat");
+    file.precision(17);
+    file << "Time(s), " << "x(t), " << "y(t), " << "vx(t), " << "vy(t)"
+         << '\n';
+  }
 
-  while (t < tf) {
-    file << t << ", " << x << ", " << y << ", " << vx << ", " << vy << '\n';
-    i++;
-    t = y0 + i * dt;
-    x += vx * dt;
-    y += vy * dt;
-    if (x < 0.0 || x > Lx) {
-      vx = -vx;
-      nx++;
+  // Rows are written as the decimation policy keeps them.
+  const auto write = [&](const Sim::Box2D::Row &row) {
+    CP_TRACE_SCOPE("write");
+    if (packed) {
+      packed->append(row);
+    } else if (file.is_open()) {
+      const auto [t, x, y, vx, vy] = row;
+      file << t << ", " << x << ", " << y << ", " << vx << ", " << vy << '\n';
     }
-    if (y < 0.0 || y > Ly) {
-      vy = -vy;
-      ny++;
+    if (channel) {
+      channel->publish(row);
+    }
+  };
+  Sim::Decimator<Sim::Box2D::columns.size()> decimator(decimation);
+
+  Sim::Checkpointer checkpointer(checkpoint);
+  int events = sim.events();
+  while (!sim.done()) {
+    if (checkpointer.poll(sim, file)) {
+      std::cout << "Stopped at step " << sim.stepIndex() << ", checkpoint in "
+                << checkpoint.path.string() << '\n';
+      return Sim::Checkpointer::kStoppedStatus;
     }
+    decimator.push(sim.row(), sim.events() != events, write);
+    events = sim.events();
+    CP_TRACE_SCOPE("step");
+    sim.step();
   }
+  decimator.finish(write);
+  packed.reset();
   file.close();
-  std::cout << "Number of x bounces = " << nx << '\n';
-  std::cout << "Number of y bounces = " << ny << '\n';
+  checkpointer.finish(checkpoint.path);
+  std::cout << "Number of x bounces = " << sim.xBounces() << '\n';
+  std::cout << "Number of y bounces = " << sim.yBounces() << '\n';
   return 0;
-}
\ No newline at end of file
+}
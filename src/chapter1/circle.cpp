@@ -1,72 +1,98 @@
-#include <Physics.h>
-#include <cmath>
+#include <Circle.h>
+#include <PeriodicReplay.h>
+#include <SharedChannel.h>
+#include <TimeGrid.h>
+#include <Trace.h>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 
-int main() {
-  // Variables
-  double x0;
-  double y0;
-  double R;
-  double x;
-  double y;
-  double vx;
-  double vy;
-  double t;
-  double t0;
-  double tf;
-  double dt;
-  double theta;
-  double omega;
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("Circle.trace.json");
+  Live::OutputOptions output;
+  try {
+    output = Live::OutputOptions::parse(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return 1;
+  }
+  Sim::CircleParams params;
 
   // User input
   std::cout << "Enter angular velocity (omega): ";
-  std::cin >> omega;
+  std::cin >> params.omega;
 
   std::cout << "Enter center of circle (x0, y0) and radius (R): ";
-  std::cin >> x0 >> y0 >> R;
+  std::cin >> params.x0 >> params.y0 >> params.R;
 
   std::cout << "Enter initial time (t0), final time (tf), and time step (dt): ";
-  std::cin >> t0 >> tf >> dt;
+  std::cin >> params.t0 >> params.tf >> params.dt;
 
-  std::cout << "Omega = " << omega << '\n';
-  std::cout << "Center: (" << x0 << ", " << y0 << ")  Radius = " << R << '\n';
-  std::cout << "Time range: t0 = " << t0 << ", tf = " << tf << ", dt = " << dt
-            << '\n';
+  std::cout << "Omega = " << params.omega << '\n';
+  std::cout << "Center: (" << params.x0 << ", " << params.y0
+            << ")  Radius = " << params.R << '\n';
+  std::cout << "Time range: t0 = " << params.t0 << ", tf = " << params.tf
+            << ", dt = " << params.dt << '\n';
 
   // Validity checks
-  if (R <= 0.0) {
-    std::cerr << "Error: Invalid radius (R must be positive)" << '\n';
-    return 1;
-  }
-  if (omega <= 0.0) {
-    std::cerr << "Error: Invalid omega (must be positive)" << '\n';
+  std::unique_ptr<Live::SharedChannelWriter> channel;
+  try {
+    Sim::Circle::validate(params);
+    channel = output.openChannel(Sim::Circle::columns);
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << '\n';
     return 1;
   }
 
-  std::cout << "Time period T = " << (2.0 * Phy::Const::PI / omega) << '\n';
+  // One period of the time grid is evaluated and replayed up to tf when the
+  // step divides a whole number of turns.
+  Sim::PeriodicReplay<Sim::Circle> sim(params);
+  std::cout << "Time period T = " << sim.kernel().period() << '\n';
+  if (sim.periodic()) {
+    std::cout << "Common period = " << sim.gridPeriod().steps
+              << " steps (phase drift <= " << sim.gridPeriod().drift
+              << "), replayed\n";
+  }
 
   // Open file to store results
-  std::ofstream file("Circle.dat");
-  if (!file) {
-    std::cerr << "Error: Could not open file for writing" << '\n';
-    return 1;
+  std::ofstream file;
+  if (output.writeFile) {
+    file.open("Circle.dat");
+    if (!file) {
+      std::cerr << "Error: Could not open file for writing" << '\n';
+      return 1;
+    }
+    file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) " << "Vy(t)" << '\n';
   }
 
-  file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) " << "Vy(t)" << '\n';
+  // Rows are only needed one at a time when they are published live;
+  // otherwise the closed-form time grid is evaluated and formatted in
+  // parallel chunks.
+  if (!channel) {
+    if (file.is_open()) {
+      Sim::writeGrid(sim, file, {.separator = " "});
+    }
+    return 0;
+  }
 
   // Compute motion
-  t = t0;
-  while (t <= tf) {
-    theta = omega * (t - t0);
-    x = x0 + R * cos(theta);
-    y = y0 + R * sin(theta);
-    vx = -omega * R * sin(theta);
-    vy = omega * R * cos(theta);
-    file << t << " " << x << " " << y << " " << vx << " " << vy << '\n';
-    t += dt;
+  while (!sim.done()) {
+    const auto row = sim.row();
+    {
+      CP_TRACE_SCOPE("write");
+      if (file.is_open()) {
+        const auto [t, x, y, vx, vy] = row;
+        file << t << " " << x << " " << y << " " << vx << " " << vy << '\n';
+      }
+      if (channel) {
+        channel->publish(row);
+      }
+    }
+    CP_TRACE_SCOPE("step");
+    sim.step();
   }
 
   file.close();
   return 0;
-}
\ No newline at end of file
+}
@@ -1,60 +1,76 @@
+#include <Projectile.h>
+#include <SharedChannel.h>
+#include <Trace.h>
+#include <array>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 
-constexpr double g = 9.81;
-constexpr double PI = 3.1415927;
-
-int main() {
-
-  double x0;
-  double y0;
-  double R;
-  double x;
-  double y;
-  double vx;
-  double vy;
-  double t;
-  double tf;
-  double dt;
-  double theta;
-  double v0x;
-  double v0y;
-  double v0;
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("Projectile.trace.json");
+  Live::OutputOptions output;
+  try {
+    output = Live::OutputOptions::parse(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+  Sim::ProjectileParams params;
 
   std::cout << "Enter v0, theta (in degrees): ";
-  std::cin >> v0 >> theta;
+  std::cin >> params.v0 >> params.theta;
   std::cout << "Enter final Time in, dt: ";
-  std::cin >> tf >> dt;
-  std::cout << "v0 = " << v0 << "  theta = " << theta << "°"
-            << "  t0 = " << 0.0 << "  tf = " << tf << "  dt = " << dt << '\n';
+  std::cin >> params.tf >> params.dt;
+  std::cout << "v0 = " << params.v0 << "  theta = " << params.theta << "°"
+            << "  t0 = " << 0.0 << "  tf = " << params.tf
+            << "  dt = " << params.dt << '\n';
 
-  if (v0 <= 0.0) {
-    throw std::invalid_argument("Illegal value of v0<=0");
-  }
-  if (theta <= 0.0) {
-    throw std::invalid_argument("Illegal value of theta");
+  std::unique_ptr<Live::SharedChannelWriter> channel;
+  try {
+    Sim::Projectile::validate(params);
+    channel = output.openChannel(Sim::Projectile::columns);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    std::exit(1);
   }
 
-  theta = (PI / 180.0) * theta;
-  v0x = v0 * std::cos(theta);
-  v0y = v0 * std::sin(theta);
+  Sim::Projectile sim(params);
 
-  std::cout << "v0x = " << v0x << "  v0y = " << v0y;
+  std::cout << "v0x = " << sim.v0x() << "  v0y = " << sim.v0y();
 
-  std::ofstream file("Projectile.dat");
-
-  file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) " << "Vy(t)" << '\n';
-
-  t = 0.0;
-  while (t <= tf) {
-    x = v0x * t;
-    y = v0y * t - 0.5 * g * t * t;
-    vx = v0x;
-    vy = v0y - g * t;
-    file << t << " " << x << " " << y << " " << vx << " " << vy << std::endl;
-    t += dt;
+  std::ofstream file;
+  if (output.writeFile) {
+    file.open("Projectile.dat");
+    file << "Time(s) " << "x(t) " << "y(t) " << "Vx(t) " << "Vy(t)" << '\n';
   }
 
+  // The kernel stops at the ground impact, its ground event located on the
+  // closed form, and ends with the impact row whatever dt is.
+  const auto write = [&](const Sim::Projectile::Row &row) {
+    CP_TRACE_SCOPE("write");
+    if (file.is_open()) {
+      const auto [t, x, y, vx, vy] = row;
+      file << t << " " << x << " " << y << " " << vx << " " << vy
+           << std::endl;
+    }
+    if (channel) {
+      channel->publish(row);
+    }
+  };
+  while (!sim.done()) {
+    write(sim.row());
+    CP_TRACE_SCOPE("step");
+    sim.step();
+  }
+  const auto impact = sim.terminalRow();
+  if (impact) {
+    write(*impact);
+    std::cout << "\nImpact at t= " << (*impact)[0]
+              << "  range= " << (*impact)[1] << '\n';
+  } else {
+    std::cout << "\nNo impact before tf\n";
+  }
   return 0;
-}
\ No newline at end of file
+}
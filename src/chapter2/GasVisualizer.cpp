@@ -0,0 +1,173 @@
+//=========================================================
+// File GasVisualizer.cpp
+// Draws every particle of the chapter 2 gases while they
+// are integrated: one sample interval dt per frame, all
+// positions in one vertex buffer (ParticleRenderer),
+// coloured by speed from slow (blue) to fast (red).
+//
+// Usage: GasVisualizer [harddisks|lennardjones|
+//                       lennardjones-walls] [key=value ...]
+// Keys are the kernel's parameters (as in BatchRunner
+// manifests), e.g. GasVisualizer harddisks N=200000
+// radius=0.0005 tf=100. F3 toggles the frame profiler.
+//---------------------------------------------------------
+
+#include <Fields.h>
+#include <HardDisks.h>
+#include <LennardJones.h>
+#include <ParticleRenderer.h>
+#include <ProfilerOverlay.h>
+#include <SFML/Graphics.hpp>
+#include <Trace.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Box 0 < x < Lx, 0 < y < Ly filling 90% of the view, y up.
+void fitView(sf::RenderWindow &window, sf::View &view, float Lx, float Ly,
+             float scale) {
+  const sf::Vector2u size = window.getSize();
+  const float aspectRatio =
+      static_cast<float>(size.x) / static_cast<float>(size.y);
+  view.setSize({600.0F * aspectRatio, -600.0F});
+  view.setCenter({Lx * scale / 2.0F, Ly * scale / 2.0F});
+  window.setView(view);
+}
+
+template <typename Kernel> int run(const typename Kernel::Params &params) {
+  Kernel sim(params);
+  const float Lx = params.Lx;
+  const float Ly = params.Ly;
+  const float scale = 540.0F / std::max(Lx, Ly);
+  // Disks at their size while they are a few pixels wide; points otherwise.
+  float radius = 0.5F; // Lennard-Jones: sigma / 2
+  if constexpr (requires { params.radius; }) {
+    radius = params.radius;
+  }
+  std::cout << sim.size() << " particles\n";
+
+  sf::RenderWindow window(sf::VideoMode({800U, 600U}), "Gas Visualizer");
+  window.setFramerateLimit(60);
+  sf::View view;
+  fitView(window, view, Lx, Ly, scale);
+
+  sf::RectangleShape box({Lx * scale, Ly * scale});
+  box.setFillColor(sf::Color::Transparent);
+  box.setOutlineColor(sf::Color(160, 160, 160));
+  box.setOutlineThickness(2.0F);
+
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> speed;
+  ParticleRenderer particles;
+  if (radius * scale >= 1.5F) {
+    particles.setShape(ParticleRenderer::Shape::Quad);
+    particles.setRadius(radius * scale);
+  }
+  // Colours span 0 .. 2.5 rms speeds of the start, which keeps the
+  // Maxwell-Boltzmann tail of an equilibrated gas on the scale.
+  sim.speeds(speed);
+  double sum2 = 0.0;
+  for (const float v : speed) {
+    sum2 += static_cast<double>(v) * v;
+  }
+  const auto rms = static_cast<float>(
+      std::sqrt(sum2 / static_cast<double>(std::max<std::size_t>(
+                           1, speed.size()))));
+  particles.setColorRange(0.0F, rms > 0.0F ? 2.5F * rms : 1.0F);
+
+  ProfilerOverlay overlay;
+  overlay.track("particles", particles);
+
+  bool reported = false;
+  while (window.isOpen()) {
+    CP_TRACE_SCOPE("frame");
+    overlay.beginFrame();
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Events);
+      while (const std::optional<sf::Event> event = window.pollEvent()) {
+        if (overlay.handleEvent(*event)) {
+          continue;
+        }
+        if (event->is<sf::Event::Closed>()) {
+          window.close();
+        } else if (event->is<sf::Event::Resized>()) {
+          fitView(window, view, Lx, Ly, scale);
+        }
+      }
+    }
+
+    if (!sim.done()) {
+      CP_TRACE_SCOPE("step");
+      sim.step();
+    } else if (!reported) {
+      std::cout << "Simulation finished at t= " << sim.row()[0] << '\n';
+      reported = true;
+    }
+
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Vertices);
+      sim.positions(x, y);
+      sim.speeds(speed);
+      particles.update(x, y, speed, view, scale);
+    }
+    {
+      auto section = overlay.measure(ProfilerOverlay::Section::Draw);
+      window.clear(sf::Color{33, 33, 33, 105});
+      window.draw(box);
+      particles.draw(window);
+    }
+    overlay.draw(window);
+    CP_TRACE_SCOPE("display");
+    window.display();
+  }
+  return 0;
+}
+
+template <typename Kernel> int parseAndRun(int argc, char *argv[]) {
+  typename Kernel::Params params;
+  try {
+    for (int i = 2; i < argc; ++i) {
+      const std::string_view assignment = argv[i];
+      const auto equals = assignment.find('=');
+      if (equals == std::string_view::npos) {
+        throw std::invalid_argument("expected key=value, got " +
+                                    std::string(assignment));
+      }
+      Sim::setField<Kernel>(params, assignment.substr(0, equals),
+                            assignment.substr(equals + 1));
+    }
+    Kernel::validate(params);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+  return run<Kernel>(params);
+}
+
+int main(int argc, char *argv[]) {
+  CP_TRACE_SESSION("GasVisualizer.trace.json");
+  const std::string_view simulation =
+      argc > 1 ? argv[1] : Sim::HardDisks::name;
+  if (simulation == Sim::HardDisks::name) {
+    return parseAndRun<Sim::HardDisks>(argc, argv);
+  }
+  if (simulation == Sim::LennardJones::name) {
+    return parseAndRun<Sim::LennardJones>(argc, argv);
+  }
+  using Walled = Sim::BasicLennardJones<Sim::Walls::Reflecting>;
+  if (simulation == Walled::name) {
+    return parseAndRun<Walled>(argc, argv);
+  }
+  std::cerr << "Unknown simulation '" << simulation
+            << "' (expected harddisks, lennardjones or "
+               "lennardjones-walls)\n";
+  return 1;
+}
@@ -0,0 +1,114 @@
+//=========================================================
+// File HardDiskGas.cpp
+// N hard disks in a box 0<x<Lx 0<y<Ly, event driven:
+// disks fly freely from one elastic collision to the next,
+// so there is no time step. Every dt the pressure on the
+// walls, kT and the compressibility factor Z = P A / (N kT)
+// (A = (Lx-2r)(Ly-2r), where the centres move) are written,
+// and the speeds are histogrammed and compared
+// with the 2D Maxwell-Boltzmann distribution
+// f(v) = v / kT exp(-v^2 / (2 kT))
+//---------------------------------------------------------
+
+#include <HardDisks.h>
+#include <RowWriter.h>
+#include <Trace.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main() {
+  CP_TRACE_SESSION("HardDiskGas.trace.json");
+  Sim::HardDisksParams params;
+  std::string buf;
+
+  std::cout << "Hard disk gas in a box 0 < x < Lx 0 < y < Ly\n";
+  std::cout << "Enter Lx, Ly: ";
+  std::cin >> params.Lx >> params.Ly;
+  std::getline(std::cin, buf);
+  std::cout << "Enter N, radius, v0: ";
+  std::cin >> params.N >> params.radius >> params.v0;
+  std::getline(std::cin, buf);
+  std::cout << "Enter t0, tf, dt: ";
+  std::cin >> params.t0 >> params.tf >> params.dt;
+  std::getline(std::cin, buf);
+  std::cout << std::format("t0 = {}\ntf = {}\ndt = {}\n", params.t0,
+                           params.tf, params.dt);
+
+  try {
+    Sim::HardDisks::validate(params);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
+  Sim::HardDisks sim(params);
+  const double eta = sim.packingFraction();
+  std::cout << std::format("N = {}, packing fraction = {:.4f}\n", sim.size(),
+                           eta);
+
+  std::ofstream file("HardDisks.dat");
+  file.precision(17);
+  Sim::writeHeader(file, Sim::HardDisks::columns);
+
+  // Speeds up to 4 v0 in kBins bins; samples of the first fifth of the run
+  // are left out while the lattice start relaxes.
+  constexpr std::size_t kBins = 80;
+  const double vMax = 4.0 * params.v0;
+  const double width = vMax / kBins;
+  const double equilibrated = params.t0 + ((params.tf - params.t0) / 5.0);
+  std::vector<std::uint64_t> histogram(kBins);
+  std::vector<float> speeds;
+  std::uint64_t counted = 0;
+  double sumZ = 0.0;
+  double sumKT = 0.0;
+  std::uint64_t samples = 0;
+
+  while (!sim.done()) {
+    const Sim::HardDisks::Row row = sim.row();
+    Sim::writeRow(file, row);
+    if (row[0] >= equilibrated && sim.stepIndex() > 0) {
+      sumZ += row[4];
+      sumKT += row[3];
+      ++samples;
+      sim.speeds(speeds);
+      for (const float v : speeds) {
+        const auto bin = static_cast<std::size_t>(v / width);
+        if (bin < kBins) {
+          ++histogram[bin];
+        }
+        ++counted;
+      }
+    }
+    CP_TRACE_SCOPE("step");
+    sim.step();
+  }
+  file.close();
+
+  std::ofstream speedFile("HardDisksSpeeds.dat");
+  speedFile << "v, f(v), MB(v)\n";
+  const double kT = samples > 0 ? sumKT / static_cast<double>(samples) : 0.0;
+  for (std::size_t b = 0; b < kBins && kT > 0.0; ++b) {
+    const double v = (static_cast<double>(b) + 0.5) * width;
+    const double measured = static_cast<double>(histogram[b]) /
+                            (static_cast<double>(counted) * width);
+    const double expected = v / kT * std::exp(-v * v / (2.0 * kT));
+    speedFile << v << ", " << measured << ", " << expected << '\n';
+  }
+
+  std::cout << "Disk collisions = " << sim.collisions() << '\n';
+  std::cout << "Events processed = " << sim.eventsProcessed() << '\n';
+  if (samples > 0) {
+    const double henderson =
+        (1.0 + (eta * eta / 8.0)) / ((1.0 - eta) * (1.0 - eta));
+    std::cout << std::format("<Z> = {:.4f} (Henderson EOS {:.4f})\n",
+                             sumZ / static_cast<double>(samples), henderson);
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+//=========================================================
+// File LennardJonesGas.cpp
+// N Lennard-Jones particles in a box 0<x<Lx 0<y<Ly
+// (lengths in sigma, times in tau), integrated with
+// velocity Verlet:
+// v = v + F / m * dt / 2
+// x = x + v * dt
+// v = v + F / m * dt / 2
+// Forces use Verlet neighbour lists that are rebuilt only
+// when some particle moved half the skin distance.
+//---------------------------------------------------------
+
+#include <LennardJones.h>
+#include <RowWriter.h>
+#include <Trace.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+template <typename Kernel> int run(const Sim::LennardJonesParams &params) {
+  try {
+    Kernel::validate(params);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    exit(1);
+  }
+  Kernel sim(params);
+  std::cout << std::format("{} particles, {} neighbour pairs, {} thread(s)\n",
+                           sim.size(), sim.pairs(), sim.blocks());
+
+  std::ofstream file("LennardJones.dat");
+  file.precision(17);
+  Sim::writeHeader(file, Kernel::columns);
+
+  using Clock = std::chrono::steady_clock;
+  Clock::duration stepping{};
+  const std::uint64_t initialRebuilds = sim.rebuilds();
+  while (!sim.done()) {
+    Sim::writeRow(file, sim.row());
+    CP_TRACE_SCOPE("step");
+    const auto start = Clock::now();
+    sim.step();
+    stepping += Clock::now() - start;
+  }
+  Sim::writeRow(file, sim.row());
+  file.close();
+
+  const auto steps = static_cast<double>(sim.stepIndex());
+  const auto rebuilds = static_cast<double>(sim.rebuilds() - initialRebuilds);
+  const double ms = std::chrono::duration<double, std::milli>(stepping).count();
+  std::cout << std::format("Time per step = {:.3f} ms\n",
+                           steps > 0.0 ? ms / steps : 0.0);
+  std::cout << std::format("Neighbour-list rebuilds = {} (every {:.1f} "
+                           "steps)\n",
+                           rebuilds, rebuilds > 0.0 ? steps / rebuilds : 0.0);
+  std::cout << std::format("Final T = {:.2f} K\n", sim.row()[1]);
+  return 0;
+}
+
+int main() {
+  CP_TRACE_SESSION("LennardJonesGas.trace.json");
+  Sim::LennardJonesParams params;
+  std::string buf;
+  int walls = 0;
+
+  std::cout << "Lennard-Jones fluid in a box 0 < x < Lx 0 < y < Ly\n";
+  std::cout << "Enter Lx, Ly (sigma): ";
+  std::cin >> params.Lx >> params.Ly;
+  std::getline(std::cin, buf);
+  std::cout << "Enter N, T0 (K): ";
+  std::cin >> params.N >> params.T0;
+  std::getline(std::cin, buf);
+  std::cout << "Enter rc, skin (sigma): ";
+  std::cin >> params.rc >> params.skin;
+  std::getline(std::cin, buf);
+  std::cout << "Enter walls (0: periodic, 1: reflecting): ";
+  std::cin >> walls;
+  std::getline(std::cin, buf);
+  std::cout << "Enter t0, tf, dt (tau): ";
+  std::cin >> params.t0 >> params.tf >> params.dt;
+  std::getline(std::cin, buf);
+  std::cout << std::format("t0 = {}\ntf = {}\ndt = {}\n", params.t0,
+                           params.tf, params.dt);
+
+  // Both boundary kinds are compiled; the choice only picks the kernel.
+  if (walls == 0) {
+    return run<Sim::LennardJones>(params);
+  }
+  return run<Sim::BasicLennardJones<Sim::Walls::Reflecting>>(params);
+}